@@ -125,6 +125,31 @@ void gp_get_realtime(long *ptm);
  */
 void gp_get_usertime(long *ptm);
 
+/* ------ Processes ------ */
+
+/*
+ * Start a copy of the current process, which shares the state of the
+ * original until either changes it, as fork does on Unix. Buffered output
+ * is flushed first, so that it is not written twice. Returns 0 in the new
+ * process and a positive process id in the original, or a negative value
+ * if the platform can't do this.
+ */
+int gp_fork_process(void);
+
+/*
+ * Wait for a process started by gp_fork_process to finish, and return its
+ * exit status, or a negative value if it could not be waited for or was
+ * terminated abnormally.
+ */
+int gp_wait_process(int pid);
+
+/*
+ * End a process started by gp_fork_process with the given exit status,
+ * after flushing its buffered output, without running any of the cleanup
+ * which belongs to the original process.
+ */
+void gp_exit_process(int status);
+
 /* ------ Reading lines from stdin ------ */
 
 /*
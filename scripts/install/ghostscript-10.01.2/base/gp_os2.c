@@ -138,6 +138,26 @@ gp_get_usertime(long *pdt)
     gp_get_realtime(pdt);	/* Use an approximation for now.  */
 }
 
+/* ------ Processes ------ */
+
+/* This platform can't start copies of the current process. */
+int
+gp_fork_process(void)
+{
+    return -1;
+}
+
+int
+gp_wait_process(int pid)
+{
+    return -1;
+}
+
+void
+gp_exit_process(int status)
+{
+}
+
 /* ------ Console management ------ */
 
 /* Answer whether a given file is the console (input or output). */
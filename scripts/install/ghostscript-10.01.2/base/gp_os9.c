@@ -103,6 +103,26 @@ gp_get_usertime(long *pdt)
     return gp_get_realtime(pdt);	/* not yet implemented */
 }
 
+/* ------ Processes ------ */
+
+/* This platform can't start copies of the current process. */
+int
+gp_fork_process(void)
+{
+    return -1;
+}
+
+int
+gp_wait_process(int pid)
+{
+    return -1;
+}
+
+void
+gp_exit_process(int status)
+{
+}
+
 /* ------ Printer accessing ------ */
 
 /* Open a connection to a printer.  A null file name means use the */
@@ -22,6 +22,8 @@
 #include "pipe_.h"
 #include "string_.h"
 #include "time_.h"
+#include "errno_.h"
+#include "unistd_.h"
 #include "gx.h"
 #include "gsexit.h"
 #include "gp.h"
@@ -31,6 +33,10 @@
 #  include <fontconfig/fontconfig.h>
 #endif
 
+#ifndef __MINGW32__
+#  include <sys/wait.h>
+#endif
+
 /*
  * This is the only place in Ghostscript that calls 'exit'.  Including
  * <stdlib.h> is overkill, but that's where it's declared on ANSI systems.
@@ -200,6 +206,44 @@ gp_get_usertime(long *pdt)
 #endif
 }
 
+/* ------ Processes ------ */
+
+int
+gp_fork_process(void)
+{
+#ifdef __MINGW32__
+    return -1;
+#else
+    fflush(NULL);
+    return (int)fork();
+#endif
+}
+
+int
+gp_wait_process(int pid)
+{
+#ifdef __MINGW32__
+    return -1;
+#else
+    int status;
+
+    while (waitpid((pid_t)pid, &status, 0) < 0) {
+        if (errno != EINTR)
+            return -1;
+    }
+    if (!WIFEXITED(status))
+        return -1;
+    return WEXITSTATUS(status);
+#endif
+}
+
+void
+gp_exit_process(int status)
+{
+    fflush(NULL);
+    _exit(status);
+}
+
 /* ------ Screen management ------ */
 
 /* Get the environment variable that specifies the display to use. */
@@ -83,6 +83,26 @@ gp_get_usertime(long *pdt)
     }
 }
 
+/* ------ Processes ------ */
+
+/* This platform can't start copies of the current process. */
+int
+gp_fork_process(void)
+{
+    return -1;
+}
+
+int
+gp_wait_process(int pid)
+{
+    return -1;
+}
+
+void
+gp_exit_process(int status)
+{
+}
+
 /* ------ Console management ------ */
 
 /* Answer whether a given file is the console (input or output). */
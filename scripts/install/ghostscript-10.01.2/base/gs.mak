@@ -142,7 +142,7 @@
 #	BAND_LIST_STORAGE - normally file; if set to memory, stores band
 #	    lists in memory (with compression if needed).
 #	BAND_LIST_COMPRESSOR - normally zlib: selects the compression method
-#	    to use for band lists in memory.
+#	    to use for band lists in memory (zlib or lz4).
 #	FILE_IMPLEMENTATION - normally stdio; if set to fd, uses file
 #	    descriptors instead of buffered stdio for file I/O; if set to
 #	    both, provides both implementations with different procedure
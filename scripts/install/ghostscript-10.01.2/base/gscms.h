@@ -467,16 +467,33 @@ struct gsicc_link_s {
 /* ICC Cache. The size of the cache is limited by max_memory_size.
  * Links are added if there is sufficient memory and if the number
  * of links does not exceed a (soft) limit.
+ *
+ * The links are kept in a number of shards, chosen by the link hash,
+ * each a list with its own lock, so that threads finding and releasing
+ * different links (the band threads of a clist device, say) don't wait
+ * on each other. The cache lock is only taken to add or remove links.
  */
 
-typedef struct gsicc_link_cache_s {
+#define ICC_CACHE_SHARDS 8
+
+typedef struct gsicc_link_shard_s {
     gsicc_link_t *head;
+    gx_monitor_t *lock;		/* protects the list and the link ref_counts */
+    long hits;			/* lookups that found a link */
+    long misses;		/* lookups that didn't */
+    long waits;			/* hits that had to wait for the link to be built */
+} gsicc_link_shard_t;
+
+typedef struct gsicc_link_cache_s {
+    gsicc_link_shard_t shard[ICC_CACHE_SHARDS];
     int num_links;
     rc_header rc;
     gs_memory_t *memory;
     gx_monitor_t *lock;		/* handle for the monitor */
     bool cache_full;		/* flag that some thread needs a cache slot */
     gx_semaphore_t *full_wait;	/* semaphore for waiting when the cache is full */
+    long full_waits;		/* times a thread waited for a cache slot */
+    int next_shard;		/* shard to look in first for a link to reuse */
 } gsicc_link_cache_t;
 
 /* A linked list structure to keep DeviceN ICC profiles
@@ -684,6 +684,13 @@ gs_cachestatus(register const gs_font_dir * pdir, register uint pstat[7])
     pstat[5] = pdir->ccache.cmax;
     pstat[6] = pdir->ccache.upper;
 }
+void
+gs_cachestats(const gs_font_dir * pdir, long pstat[3])
+{
+    pstat[0] = pdir->ccache.hits;
+    pstat[1] = pdir->ccache.misses;
+    pstat[2] = pdir->ccache.oversize;
+}
 
 /* setcacheparams */
 int
@@ -72,6 +72,8 @@ gs_font *gs_find_font_by_id(gs_font_dir *pdir, gs_id id, gs_matrix *FontMatrix);
 
 /* Font cache parameter operations */
 void gs_cachestatus(const gs_font_dir *, uint[7]);
+/* Character cache hits, misses, and chars too big to cache. */
+void gs_cachestats(const gs_font_dir *, long[3]);
 
 #define gs_setcachelimit(pdir,limit) gs_setcacheupper(pdir,limit)
 uint gs_currentcachesize(const gs_font_dir *);
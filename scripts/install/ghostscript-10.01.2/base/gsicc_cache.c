@@ -79,9 +79,39 @@ gs_private_st_ptrs3_final(st_icc_link, gsicc_link_t, "gsiccmanage_link",
 
 struct_proc_finalize(icc_linkcache_finalize);
 
-gs_private_st_ptrs3_final(st_icc_linkcache, gsicc_link_cache_t, "gsiccmanage_linkcache",
-                    icc_linkcache_enum_ptrs, icc_linkcache_reloc_ptrs, icc_linkcache_finalize,
-                    head, lock, full_wait);
+gs_private_st_composite_use_final(st_icc_linkcache, gsicc_link_cache_t,
+                    "gsiccmanage_linkcache", icc_linkcache_enum_ptrs,
+                    icc_linkcache_reloc_ptrs, icc_linkcache_finalize);
+
+static
+ENUM_PTRS_WITH(icc_linkcache_enum_ptrs, gsicc_link_cache_t *link_cache)
+{
+    /* The list heads and locks of the shards */
+    index -= 2;
+    if (index < 2 * ICC_CACHE_SHARDS) {
+        if (index & 1)
+            ENUM_RETURN(link_cache->shard[index >> 1].lock);
+        ENUM_RETURN(link_cache->shard[index >> 1].head);
+    }
+    return 0;
+}
+ENUM_PTR(0, gsicc_link_cache_t, lock);
+ENUM_PTR(1, gsicc_link_cache_t, full_wait);
+ENUM_PTRS_END
+
+static
+RELOC_PTRS_WITH(icc_linkcache_reloc_ptrs, gsicc_link_cache_t *link_cache)
+{
+    int i;
+
+    RELOC_VAR(link_cache->lock);
+    RELOC_VAR(link_cache->full_wait);
+    for (i = 0; i < ICC_CACHE_SHARDS; i++) {
+        RELOC_VAR(link_cache->shard[i].head);
+        RELOC_VAR(link_cache->shard[i].lock);
+    }
+}
+RELOC_PTRS_END
 
 /* These are used to construct a hash for the ICC link based upon the
    render parameters */
@@ -99,6 +129,7 @@ gsicc_link_cache_t *
 gsicc_cache_new(gs_memory_t *memory)
 {
     gsicc_link_cache_t *result;
+    int i;
 
     /* We want this to be maintained in stable_memory.  It should be be effected by the
        save and restores */
@@ -107,9 +138,17 @@ gsicc_cache_new(gs_memory_t *memory)
                              "gsicc_cache_new");
     if ( result == NULL )
         return(NULL);
-    result->head = NULL;
+    for (i = 0; i < ICC_CACHE_SHARDS; i++) {
+        result->shard[i].head = NULL;
+        result->shard[i].lock = NULL;
+        result->shard[i].hits = 0;
+        result->shard[i].misses = 0;
+        result->shard[i].waits = 0;
+    }
     result->num_links = 0;
     result->cache_full = false;
+    result->full_waits = 0;
+    result->next_shard = 0;
     result->memory = memory;
     result->full_wait = NULL; /* Required so finaliser can work when result freed. */
     rc_init_free(result, memory, 1, rc_gsicc_link_cache_free);
@@ -126,6 +165,14 @@ gsicc_cache_new(gs_memory_t *memory)
         rc_decrement(result, "gsicc_cache_new");
         return(NULL);
     }
+    for (i = 0; i < ICC_CACHE_SHARDS; i++) {
+        result->shard[i].lock = gx_monitor_label(gx_monitor_alloc(memory),
+                                                 "gsicc_cache_new");
+        if (result->shard[i].lock == NULL) {
+            rc_decrement(result, "gsicc_cache_new");
+            return(NULL);
+        }
+    }
     if_debug2m(gs_debug_flag_icc, memory,
                "[icc] Allocating link cache = "PRI_INTPTR" memory = "PRI_INTPTR"\n",
 	       (intptr_t)result, (intptr_t)result->memory);
@@ -154,19 +201,30 @@ void
 icc_linkcache_finalize(const gs_memory_t *mem, void *ptr)
 {
     gsicc_link_cache_t *link_cache = (gsicc_link_cache_t * ) ptr;
+    gsicc_link_t *head;
+    long hits = 0, misses = 0, waits = 0;
+    int i;
 
     /* mem is unused, but we are passed it anyway by the ref counting mechanisms. */
     assert(link_cache != NULL && mem == link_cache->memory);
     if (link_cache == NULL)
         return;
-    while (link_cache->head != NULL) {
-        if (link_cache->head->ref_count != 0) {
-            emprintf2(link_cache->memory, "link at "PRI_INTPTR" being removed, but has ref_count = %d\n",
-                      (intptr_t)link_cache->head, link_cache->head->ref_count);
-            link_cache->head->ref_count = 0;	/* force removal */
+    for (i = 0; i < ICC_CACHE_SHARDS; i++) {
+        while ((head = link_cache->shard[i].head) != NULL) {
+            if (head->ref_count != 0) {
+                emprintf2(link_cache->memory, "link at "PRI_INTPTR" being removed, but has ref_count = %d\n",
+                          (intptr_t)head, head->ref_count);
+                head->ref_count = 0;	/* force removal */
+            }
+            gsicc_remove_link(head);
         }
-        gsicc_remove_link(link_cache->head);
+        hits += link_cache->shard[i].hits;
+        misses += link_cache->shard[i].misses;
+        waits += link_cache->shard[i].waits;
     }
+    if_debug5m(gs_debug_flag_icc, link_cache->memory,
+               "[icc] Link cache = "PRI_INTPTR" hits = %ld misses = %ld waits = %ld full waits = %ld\n",
+               (intptr_t)link_cache, hits, misses, waits, link_cache->full_waits);
 #ifdef DEBUG
     if (link_cache->num_links != 0) {
         emprintf1(link_cache->memory, "num_links is %d, should be 0.\n", link_cache->num_links);
@@ -175,11 +233,27 @@ icc_linkcache_finalize(const gs_memory_t *mem, void *ptr)
     if (link_cache->rc.ref_count == 0) {
         gx_monitor_free(link_cache->lock);
         link_cache->lock = NULL;
+        for (i = 0; i < ICC_CACHE_SHARDS; i++) {
+            gx_monitor_free(link_cache->shard[i].lock);
+            link_cache->shard[i].lock = NULL;
+        }
         gx_semaphore_free(link_cache->full_wait);
         link_cache->full_wait = 0;
     }
 }
 
+/* The shard of the cache that holds the links with a given hash */
+static gsicc_link_shard_t *
+gsicc_link_shard(gsicc_link_cache_t *icc_link_cache, int64_t hashcode)
+{
+    uint64_t h = (uint64_t)hashcode;
+
+    h ^= h >> 32;
+    h ^= h >> 16;
+    h ^= h >> 8;
+    return &icc_link_cache->shard[h % ICC_CACHE_SHARDS];
+}
+
 /* This is a special allocation for a link that is used by devices for
    doing color management on post rendered data.  It is not tied into the
    profile cache like gsicc_alloc_link. Also it goes ahead and creates
@@ -331,7 +405,9 @@ gsicc_set_link_data(gsicc_link_t *icc_link, void *link_handle,
                     bool includes_softproof, bool includes_devlink,
                     bool pageneutralcolor, gsicc_colorbuffer_t data_cs)
 {
-    gx_monitor_enter(lock);		/* lock the cache while changing data */
+    /* Lock the shard that holds the link while changing data, since that
+       is the lock under which gsicc_findcachelink reads valid and hashcode */
+    gx_monitor_enter(lock);
     icc_link->link_handle = link_handle;
     gscms_get_link_dim(link_handle, &(icc_link->num_input), &(icc_link->num_output),
         icc_link->memory);
@@ -358,6 +434,27 @@ gsicc_set_link_data(gsicc_link_t *icc_link, void *link_handle,
     gx_monitor_leave(lock);	/* done with updating, let everyone run */
 }
 
+/* Set the hashcode of a link returned by gsicc_alloc_link_entry, whose
+   contents this thread has filled in, and make it valid so that other threads
+   can use it. As with gsicc_set_link_data, this is done under the lock of the
+   shard that holds the link, since that is what gsicc_findcachelink reads
+   valid and hashcode under. */
+void
+gsicc_link_validate(gsicc_link_t *icc_link, gsicc_hashlink_t hashcode)
+{
+    gx_monitor_t *lock =
+        gsicc_link_shard(icc_link->icc_link_cache, hashcode.link_hashcode)->lock;
+
+    gx_monitor_enter(lock);
+    icc_link->hashcode.link_hashcode = hashcode.link_hashcode;
+    icc_link->hashcode.des_hash = hashcode.des_hash;
+    icc_link->hashcode.src_hash = hashcode.src_hash;
+    icc_link->hashcode.rend_hash = hashcode.rend_hash;
+    icc_link->valid = true;
+    gx_monitor_leave(icc_link->lock);
+    gx_monitor_leave(lock);	/* done with updating, let everyone run */
+}
+
 static void
 gsicc_link_free_contents(gsicc_link_t *icc_link)
 {
@@ -546,13 +643,14 @@ gsicc_findcachelink(gsicc_hashlink_t hash, gsicc_link_cache_t *icc_link_cache,
     gsicc_link_t *curr, *prev;
     int64_t hashcode = hash.link_hashcode;
     int cache_loop = 0;
+    gsicc_link_shard_t *shard = gsicc_link_shard(icc_link_cache, hashcode);
 
-    /* Look through the cache for the hashcode */
-    gx_monitor_enter(icc_link_cache->lock);
+    /* Look through the shard for the hashcode */
+    gx_monitor_enter(shard->lock);
 
     /* List scanning is fast, so we scan the entire list, this includes   */
     /* links that are currently unused, but still in the cache (zero_ref) */
-    curr = icc_link_cache->head;
+    curr = shard->head;
     prev = NULL;
 
     while (curr != NULL ) {
@@ -564,15 +662,18 @@ gsicc_findcachelink(gsicc_hashlink_t hash, gsicc_link_cache_t *icc_link_cache,
             if (prev != NULL) {
                 /* if prev == NULL, curr is already the head */
                 prev->next = curr->next;
-                curr->next = icc_link_cache->head;
-                icc_link_cache->head = curr;
+                curr->next = shard->head;
+                shard->head = curr;
             }
             /* bump the ref_count since we will be using this one */
             curr->ref_count++;
+            shard->hits++;
             if_debug3m('^', curr->memory, "[^]%s "PRI_INTPTR" ++ => %d\n",
                        "icclink", (intptr_t)curr, curr->ref_count);
+            if (curr->valid == false)
+                shard->waits++;
             while (curr->valid == false) {
-                gx_monitor_leave(icc_link_cache->lock); /* exit to let other threads run briefly */
+                gx_monitor_leave(shard->lock); /* exit to let other threads run briefly */
                 if (cache_loop > ICC_CACHE_NOT_VALID_COUNT) {
                     /* Clearly something is wrong.  Return NULL.
                        File a bug report. */
@@ -588,15 +689,16 @@ gsicc_findcachelink(gsicc_hashlink_t hash, gsicc_link_cache_t *icc_link_cache,
                 if (curr->valid == false) {
 		            emprintf1(curr->memory, "link "PRI_INTPTR" lock released, but still not valid.\n", (intptr_t)curr);	/* Breakpoint here */
                 }
-                gx_monitor_enter(icc_link_cache->lock);	/* re-enter to loop and check */
+                gx_monitor_enter(shard->lock);	/* re-enter to loop and check */
             }
-            gx_monitor_leave(icc_link_cache->lock);
+            gx_monitor_leave(shard->lock);
             return curr;	/* success */
         }
         prev = curr;
         curr = curr->next;
     }
-    gx_monitor_leave(icc_link_cache->lock);
+    shard->misses++;
+    gx_monitor_leave(shard->lock);
     return NULL;
 }
 
@@ -607,16 +709,19 @@ gsicc_remove_link(gsicc_link_t *link)
     gsicc_link_t *curr, *prev;
     gsicc_link_cache_t *icc_link_cache = link->icc_link_cache;
     const gs_memory_t *memory = link->memory;
+    gsicc_link_shard_t *shard =
+        gsicc_link_shard(icc_link_cache, link->hashcode.link_hashcode);
 
     if_debug2m(gs_debug_flag_icc, memory,
                "[icc] Removing link = "PRI_INTPTR" memory = "PRI_INTPTR"\n",
                (intptr_t)link, (intptr_t)memory);
     /* NOTE: link->ref_count must be 0: assert ? */
     gx_monitor_enter(icc_link_cache->lock);
+    gx_monitor_enter(shard->lock);
     if (link->ref_count != 0) {
       emprintf2(memory, "link at "PRI_INTPTR" being removed, but has ref_count = %d\n", (intptr_t)link, link->ref_count);
     }
-    curr = icc_link_cache->head;
+    curr = shard->head;
     prev = NULL;
 
     while (curr != NULL ) {
@@ -624,7 +729,7 @@ gsicc_remove_link(gsicc_link_t *link)
         if (curr == link && link->ref_count == 0) {
             /* remove this one from the list */
             if (prev == NULL)
-                icc_link_cache->head = curr->next;
+                shard->head = curr->next;
             else
                 prev->next = curr->next;
             break;
@@ -632,6 +737,7 @@ gsicc_remove_link(gsicc_link_t *link)
         prev = curr;
         curr = curr->next;
     }
+    gx_monitor_leave(shard->lock);
     /* if curr != link we didn't find it or another thread may have decided to */
     /* use it (ref_count > 0). Skip freeing it if so.                          */
     if (curr == link && link->ref_count == 0) {
@@ -893,8 +999,11 @@ gsicc_alloc_link_entry(gsicc_link_cache_t *icc_link_cache,
                        bool include_softproof, bool include_devlink)
 {
     gs_memory_t *cache_mem = icc_link_cache->memory;
-    gsicc_link_t *link;
+    gsicc_link_t *link, *curr;
+    gsicc_link_shard_t *shard;
     int retries = 0;
+    bool was_full;
+    int i;
 
     assert(cache_mem == cache_mem->stable_memory);
 
@@ -903,26 +1012,36 @@ gsicc_alloc_link_entry(gsicc_link_cache_t *icc_link_cache,
     /* TODO: this should be based on memory usage, not just num_links */
     gx_monitor_enter(icc_link_cache->lock);
     while (icc_link_cache->num_links >= ICC_CACHE_MAXLINKS) {
-        /* Look through the cache for first zero ref count to re-use that entry.
-           When ref counts go to zero, the icc_link will have been moved to
-           the end of the list, so the first we find is the 'oldest'.
-           If we get to the last entry we release the lock, set the cache_full
-           flag and wait on full_wait for some other thread to let this thread
-           run again after releasing a cache slot. Release the cache lock to
-           let other threads run and finish with (release) a cache entry.
+        /* Look through the shards for a zero ref count link to re-use that
+           entry. When ref counts go to zero, the icc_link will have been
+           moved to after the links in use in its shard, so the last we
+           find in a shard is the 'oldest'. The search starts from the shard
+           after the one we last took a link from.
+           We set the cache_full flag before looking, so that a thread
+           releasing a link in a shard we have already looked in will let
+           us run (see gsicc_release_link). If no link is free we release
+           the lock and wait on full_wait for some other thread to let this
+           thread run again after releasing a cache slot. Release the cache
+           lock to let other threads run and finish with (release) a cache
+           entry.
         */
-        link = icc_link_cache->head;
-        while (link != NULL ) {
-            if (link->ref_count == 0) {
-                /* we will use this one */
-                if_debug3m('^', cache_mem, "[^]%s "PRI_INTPTR" ++ => %d\n",
-                           "icclink", (intptr_t)link, link->ref_count);
-                break;
+        was_full = icc_link_cache->cache_full;
+        icc_link_cache->cache_full = true;
+        link = NULL;
+        for (i = 0; i < ICC_CACHE_SHARDS && link == NULL; i++) {
+            shard = &icc_link_cache->shard[(icc_link_cache->next_shard + i) %
+                                           ICC_CACHE_SHARDS];
+            gx_monitor_enter(shard->lock);
+            for (curr = shard->head; curr != NULL; curr = curr->next) {
+                if (curr->ref_count == 0)
+                    link = curr;
             }
-            link = link->next;
+            gx_monitor_leave(shard->lock);
         }
+        icc_link_cache->next_shard = (icc_link_cache->next_shard + i) %
+                                     ICC_CACHE_SHARDS;
         if (link == NULL) {
-            icc_link_cache->cache_full = true;
+            icc_link_cache->full_waits++;
             /* unlock while waiting for a link to come available */
             gx_monitor_leave(icc_link_cache->lock);
             gx_semaphore_wait(icc_link_cache->full_wait);
@@ -937,9 +1056,15 @@ gsicc_alloc_link_entry(gsicc_link_cache_t *icc_link_cache,
             gx_monitor_enter(icc_link_cache->lock);	    /* restore the lock */
             /* we will re-test the num_links above while locked to insure */
             /* that some other thread didn't grab the slot and max us out */
-            if (retries++ > 10)
+            if (retries++ > 10) {
+                gx_monitor_leave(icc_link_cache->lock);
                 return false;
+            }
         } else {
+            /* we will use this one, so we aren't waiting after all */
+            if_debug3m('^', cache_mem, "[^]%s "PRI_INTPTR" ++ => %d\n",
+                       "icclink", (intptr_t)link, link->ref_count);
+            icc_link_cache->cache_full = was_full;
             /* Remove the zero ref_count link profile we found.		*/
             /* Even if we remove this link, we may still be maxed out so*/
             /* the outermost 'while' will check to make sure some other	*/
@@ -954,9 +1079,12 @@ gsicc_alloc_link_entry(gsicc_link_cache_t *icc_link_cache,
     /* NB: the link returned will be have the lock owned by this thread */
     /* the lock will be released when the link becomes valid.           */
     if (*ret_link) {
+        shard = gsicc_link_shard(icc_link_cache, hash.link_hashcode);
         (*ret_link)->icc_link_cache = icc_link_cache;
-        (*ret_link)->next = icc_link_cache->head;
-        icc_link_cache->head = *ret_link;
+        gx_monitor_enter(shard->lock);
+        (*ret_link)->next = shard->head;
+        shard->head = *ret_link;
+        gx_monitor_leave(shard->lock);
         icc_link_cache->num_links++;
     }
     /* unlock before returning */
@@ -1283,7 +1411,8 @@ gsicc_get_link_profile(const gs_gstate *pgs, gx_device *dev,
         if (gs_input_profile->data_cs == gsGRAY)
             pageneutralcolor = false;
 
-        gsicc_set_link_data(link, link_handle, hash, icc_link_cache->lock,
+        gsicc_set_link_data(link, link_handle, hash,
+                            gsicc_link_shard(icc_link_cache, hash.link_hashcode)->lock,
                             include_softproof, include_devicelink, pageneutralcolor,
                             gs_input_profile->data_cs);
         if_debug2m(gs_debug_flag_icc, cache_mem,
@@ -1808,13 +1937,16 @@ void
 gsicc_release_link(gsicc_link_t *icclink)
 {
     gsicc_link_cache_t *icc_link_cache;
+    gsicc_link_shard_t *shard;
+    bool wake = false;
 
     if (icclink == NULL)
         return;
 
     icc_link_cache = icclink->icc_link_cache;
+    shard = gsicc_link_shard(icc_link_cache, icclink->hashcode.link_hashcode);
 
-    gx_monitor_enter(icc_link_cache->lock);
+    gx_monitor_enter(shard->lock);
     if_debug2m('^', icclink->memory, "[^]icclink "PRI_INTPTR" -- => %d\n",
                (intptr_t)icclink, icclink->ref_count - 1);
     /* Decrement the reference count */
@@ -1822,9 +1954,9 @@ gsicc_release_link(gsicc_link_t *icclink)
 
         gsicc_link_t *curr, *prev;
 
-        /* Find link in cache, and move it to the end of the list.  */
-        /* This way zero ref_count links are found LRU first	*/
-        curr = icc_link_cache->head;
+        /* Find link in the shard, and move it to after the links in use. */
+        /* This way the last zero ref_count link is the LRU one */
+        curr = shard->head;
         prev = NULL;
         while (curr != icclink) {
             prev = curr;
@@ -1832,12 +1964,12 @@ gsicc_release_link(gsicc_link_t *icclink)
         };
         if (prev == NULL) {
             /* this link was the head */
-            icc_link_cache->head = curr->next;
+            shard->head = curr->next;
         } else {
             prev->next = curr->next;		/* de-link this one */
         }
         /* Find the first zero-ref entry on the list */
-        curr = icc_link_cache->head;
+        curr = shard->head;
         prev = NULL;
         while (curr != NULL && curr->ref_count > 0) {
             prev = curr;
@@ -1845,20 +1977,28 @@ gsicc_release_link(gsicc_link_t *icclink)
         }
         /* Found where to link this one into the tail of the list */
         if (prev == NULL) {
-            icc_link_cache->head = icclink;
-            icclink->next = icc_link_cache->head->next;
+            icclink->next = shard->head;
+            shard->head = icclink;
         } else {
             /* link this one in here */
             prev->next = icclink;
             icclink->next = curr;
         }
-        /* Finally, if some thread was waiting because the cache was full, let it run */
+        /* A thread waiting for a cache slot sets cache_full before it
+           looks through the shards for an unused link, so either it sees
+           this one, or we see the flag. */
+        wake = icc_link_cache->cache_full;
+    }
+    gx_monitor_leave(shard->lock);
+    /* Finally, if some thread was waiting because the cache was full, let it run */
+    if (wake) {
+        gx_monitor_enter(icc_link_cache->lock);
         if (icc_link_cache->cache_full) {
             icc_link_cache->cache_full = false;
             gx_semaphore_signal(icc_link_cache->full_wait);	/* let a waiting thread run */
         }
+        gx_monitor_leave(icc_link_cache->lock);
     }
-    gx_monitor_leave(icc_link_cache->lock);
 }
 
 /* Used to initialize the buffer description prior to color conversion */
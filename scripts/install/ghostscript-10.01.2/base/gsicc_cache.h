@@ -40,6 +40,7 @@ void gsicc_init_buffer(gsicc_bufferdesc_t *buffer_desc, unsigned char num_chan,
 bool gsicc_alloc_link_entry(gsicc_link_cache_t *icc_link_cache,
                             gsicc_link_t **ret_link, gsicc_hashlink_t hash,
                             bool include_softproof, bool include_devlink);
+void gsicc_link_validate(gsicc_link_t *icc_link, gsicc_hashlink_t hashcode);
 gsicc_link_t* gsicc_get_link(const gs_gstate * pgs, gx_device *dev,
                              const gs_color_space  *input_colorspace,
                              gs_color_space *output_colorspace,
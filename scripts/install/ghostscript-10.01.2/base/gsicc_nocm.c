@@ -400,7 +400,6 @@ gsicc_nocm_get_link(const gs_gstate *pgs, gx_device *dev,
     result->procs.map_buffer = gsicc_nocm_transform_color_buffer;
     result->procs.map_color = gsicc_nocm_transform_color;
     result->procs.free_link = gsicc_nocm_freelink;
-    result->hashcode = hash;
     nocm_link = (nocm_link_t *) gs_alloc_bytes(mem, sizeof(nocm_link_t),
                                                "gsicc_nocm_get_link");
     if (nocm_link == NULL)
@@ -431,10 +430,6 @@ gsicc_nocm_get_link(const gs_gstate *pgs, gx_device *dev,
     result->num_input = nocm_link->num_in;
     result->num_output = nocm_link->num_out;
     result->link_handle = nocm_link;
-    result->hashcode.link_hashcode = hash.link_hashcode;
-    result->hashcode.des_hash = hash.des_hash;
-    result->hashcode.src_hash = hash.src_hash;
-    result->hashcode.rend_hash = hash.rend_hash;
     result->includes_softproof = false;
     result->includes_devlink = false;
     if (hash.src_hash == hash.des_hash) {
@@ -452,9 +447,8 @@ gsicc_nocm_get_link(const gs_gstate *pgs, gx_device *dev,
     if (pageneutralcolor && nocm_link->num_in != 1) {
         gsicc_mcm_set_link(result);
     }
-    result->valid = true;
-    /* Now release any tasks/threads waiting for these contents by unlocking */
-    gx_monitor_leave(result->lock);	/* done with updating, let everyone run */
+    /* Now release any tasks/threads waiting for these contents */
+    gsicc_link_validate(result, hash);
 
     return result;
 }
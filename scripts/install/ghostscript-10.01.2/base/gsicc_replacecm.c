@@ -353,7 +353,6 @@ gsicc_rcm_get_link(const gs_gstate *pgs, gx_device *dev,
     result->procs.map_buffer = gsicc_rcm_transform_color_buffer;
     result->procs.map_color = gsicc_rcm_transform_color;
     result->procs.free_link = gsicc_rcm_freelink;
-    result->hashcode = hash;
     result->is_identity = false;
     rcm_link = (rcm_link_t *) gs_alloc_bytes(mem, sizeof(rcm_link_t),
                                                "gsicc_rcm_get_link");
@@ -390,10 +389,6 @@ gsicc_rcm_get_link(const gs_gstate *pgs, gx_device *dev,
     result->num_input = rcm_link->num_in;
     result->num_output = rcm_link->num_out;
     result->link_handle = rcm_link;
-    result->hashcode.link_hashcode = hash.link_hashcode;
-    result->hashcode.des_hash = hash.des_hash;
-    result->hashcode.src_hash = hash.src_hash;
-    result->hashcode.rend_hash = hash.rend_hash;
     result->includes_softproof = false;
     result->includes_devlink = false;
     result->is_identity = false;  /* Always do replacement for demo */
@@ -402,9 +397,8 @@ gsicc_rcm_get_link(const gs_gstate *pgs, gx_device *dev,
     if (pageneutralcolor && data_cs != gsGRAY)
         gsicc_mcm_set_link(result);
 
-    result->valid = true;
-    /* Now release any tasks/threads waiting for these contents by unlocking it */
-    gx_monitor_leave(result->lock);	/* done with updating, let everyone run */
+    /* Now release any tasks/threads waiting for these contents */
+    gsicc_link_validate(result, hash);
 
     return result;
 }
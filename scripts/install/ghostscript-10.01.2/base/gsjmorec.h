@@ -34,7 +34,9 @@
  */
 
 #undef BLOCK_SMOOTHING_SUPPORTED
-#undef IDCT_SCALING_SUPPORTED
+/* IDCT_SCALING_SUPPORTED is kept, for DCTDecode to decode images at
+ * reduced size (see dctd_set_scale in sdctd.c).
+ */
 #undef UPSAMPLE_SCALING_SUPPORTED
 #undef UPSAMPLE_MERGING_SUPPORTED
 #undef QUANT_1PASS_SUPPORTED
@@ -191,6 +191,10 @@ typedef struct gs_lib_ctx_s
     char *default_device_list;
     int gcsignal;
     void *sjpxd_private; /* optional for use of jpx codec */
+    /* optional for use of the ocr veneer (its idle engines), and how to
+     * free it when the library is finalised */
+    void *ocr_private;
+    void (*ocr_private_fin)(gs_memory_t *mem);
 } gs_lib_ctx_t;
 
 enum {
@@ -160,12 +160,14 @@ gx_lookup_cached_char(const gs_font * pfont, const cached_fm_pair * pair,
             if_debug4m('K', pfont->memory,
                        "[K]found "PRI_INTPTR" (depth=%d) for glyph=0x%lx, wmode=%d\n",
                        (intptr_t)cc, cc_depth(cc), (ulong)glyph, wmode);
+            dir->ccache.hits++;
             return cc;
         }
         chi++;
     }
     if_debug3m('K', pfont->memory, "[K]not found: glyph=0x%lx, wmode=%d, depth=%d\n",
               (ulong) glyph, wmode, depth);
+    dir->ccache.misses++;
     return 0;
 }
 
@@ -504,6 +504,7 @@ gx_alloc_char_bits(gs_font_dir * dir, gx_device_memory * pdev,
         if_debug5m('k', pdev->memory, "[k]no cache bits: scale=%dx%d, raster/scale=%u, height/scale=%u, upper=%u\n",
                    1 << log2_xscale, 1 << log2_yscale,
                    iraster, iheight, dir->ccache.upper);
+        dir->ccache.oversize++;
         return 0;		/* too big */
     }
     /* Compute the actual bitmap size(s) and allocate the bits. */
@@ -874,6 +875,7 @@ alloc_char(gs_font_dir * dir, ulong icdsize, cached_char **pcc)
                            "[k]no cache bits: cdsize+head=%lu, cksize=%u\n",
                            icdsize + sizeof(cached_char_head),
                            cksize);
+                dir->ccache.oversize++;
                 return 0;	/* wouldn't fit */
             }
             cck = (char_cache_chunk *)
@@ -90,11 +90,15 @@ DECOMPRESSION.
    decompression buffer list in order to keep the tail of the list as the
    "least recently used".
 
-   There are some DEBUG global static variables used to count the number of
-   cache hits "tot_cache_hits" and the number of times a logical block is
-   decompressed "tot_cache_miss". Note that the actual number of cache miss
-   events is 'f->log_length/MEMFILE_DATA_SIZE - tot_cache_miss' since we
-   assume that every logical block must be decmpressed at least once.
+   Each MEMFILE counts the bytes written to it, the number of logical
+   blocks compressed and what they compressed to, and each instance that
+   reads it counts the cache hits "cache_hits" and the number of times a
+   logical block is decompressed "cache_misses", and the number of raw
+   buffers that had to be reused "swap_outs". These are printed with -Z:
+   when the file (or reader instance) is done with. Note that the actual
+   number of cache miss events is
+   'cache_misses - f->log_length/MEMFILE_DATA_SIZE' since we assume that
+   every logical block must be decompressed at least once.
 
    Empirical results so far indicate that if one cache raw buffer for every
    32 logical blocks, then the hit/miss ratio exceeds 99%. Of course, the
@@ -147,6 +151,12 @@ static const int64_t COMPRESSION_THRESHOLD =
     500000000;  /* 0.5 Gb for host machines */
 #endif
 
+/*
+   More than any of the compressors add to a block of data that doesn't
+   compress (a few bytes for zlib, 4 for lz4): see compress_log_blk.
+ */
+#define COMPRESSION_SLACK 64
+
 #define NEED_TO_COMPRESS(f)\
   ((f)->ok_to_compress && (f)->total_space > COMPRESSION_THRESHOLD)
 
@@ -169,18 +179,13 @@ static int memfile_init_empty(MEMFILE * f);
 static int memfile_set_memory_warning(clist_file_ptr cf, int bytes_left);
 static int memfile_fclose(clist_file_ptr cf, const char *fname, bool delete);
 static int memfile_get_pdata(MEMFILE * f);
+static void memfile_print_stats(MEMFILE * f);
 
 /************************************************/
 /*   #define DEBUG      /- force statistics -/  */
 /************************************************/
 
 #ifdef DEBUG
-int64_t tot_compressed;
-int64_t tot_raw;
-int64_t tot_cache_miss;
-int64_t tot_cache_hits;
-int64_t tot_swap_out;
-
 /*
    The following pointers are here only for helping with a dumb debugger
    that can't inspect local variables!
@@ -289,6 +294,7 @@ memfile_fopen(char fname[gp_file_name_sizeof], const char *fmode,
             f->log_curr_pos = 0;
             f->raw_head = NULL;
             f->error_code = 0;
+            f->cache_hits = f->cache_misses = f->swap_outs = 0;
 
             if (f->log_head->phys_blk->data_limit != NULL) {
                 /* The file is compressed, so we need to copy the logical block */
@@ -402,14 +408,6 @@ memfile_fopen(char fname[gp_file_name_sizeof], const char *fmode,
     fname[0] = 0xff;        /* a flag that this is a memfile name */
     gs_snprintf(fname+1, gp_file_name_sizeof-1, "%p", f);
 
-#ifdef DEBUG
-        tot_compressed = 0;
-        tot_raw = 0;
-        tot_cache_miss = 0;
-        tot_cache_hits = 0;
-        tot_swap_out = 0;
-#endif
-
 finish:
     /* 'f' shouldn't be NULL unless code < 0, but be careful */
     if (code < 0 || f == NULL) {
@@ -449,28 +447,26 @@ memfile_fclose(clist_file_ptr cf, const char *fname, bool delete)
                 return_error(gs_error_invalidfileaccess);
             }
             prev_f->openlist = f->openlist;     /* link around the one being fclosed */
+            memfile_print_stats(f);
             /* Now delete this MEMFILE reader instance */
             /* NB: we don't delete 'base' instances until we delete */
             /* If the file is compressed, free the logical blocks, but not */
             /* the phys_blk info (that is still used by the base memfile   */
             if (f->log_head->phys_blk->data_limit != NULL) {
-                LOG_MEMFILE_BLK *tmpbp, *bp = f->log_head;
-
-                while (bp != NULL) {
-                    tmpbp = bp->link;
-                    FREE(f, bp, "memfile_free_mem(log_blk)");
-                    bp = tmpbp;
-                }
+                /* memfile_fopen copied the logical blocks into one array */
+                FREE(f, f->log_head, "memfile_free_mem(log_blk)");
                 f->log_head = NULL;
 
-                /* Free any internal compressor state. */
-                if (f->compressor_initialized) {
-                    if (f->decompress_state->templat->release != 0)
-                        (*f->decompress_state->templat->release) (f->decompress_state);
-                    if (f->compress_state->templat->release != 0)
-                        (*f->compress_state->templat->release) (f->compress_state);
-                    f->compressor_initialized = false;
-                }
+                /* Free any internal decompressor state; the compress */
+                /* state belongs to the base memfile. The decompressor */
+                /* is only initialized along with the raw buffers.     */
+                if (f->raw_head != NULL &&
+                    f->decompress_state->templat->release != 0)
+                    (*f->decompress_state->templat->release) (f->decompress_state);
+                gs_free_object(f->memory, f->decompress_state,
+                               "memfile_fclose(decompress_state)");
+                f->decompress_state = NULL;
+                f->compressor_initialized = false;
                 /* free the raw buffers                                           */
                 while (f->raw_head != NULL) {
                     RAW_BUFFER *tmpraw = f->raw_head->fwd;
@@ -549,14 +545,14 @@ memfile_set_memory_warning(clist_file_ptr cf, int bytes_left)
     /*
      * Determine req'd memory block count from bytes_left.
      * Allocate enough phys & log blocks to hold bytes_left
-     * + 1 phys blk for compress_log_blk + 1 phys blk for decompress.
+     * + 2 phys blks for compress_log_blk + 1 phys blk for decompress.
      */
     int logNeeded =
         (bytes_left + MEMFILE_DATA_SIZE - 1) / MEMFILE_DATA_SIZE;
     int physNeeded = logNeeded;
 
     if (bytes_left > 0)
-        ++physNeeded;
+        physNeeded += 2;
     if (f->raw_head == NULL)
         ++physNeeded;   /* have yet to allocate read buffers */
 
@@ -620,6 +616,24 @@ compress_log_blk(MEMFILE * f, LOG_MEMFILE_BLK * bp)
     f->rd.ptr = (const byte *)(bp->phys_blk->data) - 1;
     f->rd.limit = f->rd.ptr + MEMFILE_DATA_SIZE;
 
+    /*
+     * A block that doesn't compress comes out a little bigger than it
+     * went in, which must still fit in what's left of this physical
+     * block and one more, so start a new one if there's very little left.
+     */
+    if (f->wt.limit - f->wt.ptr < COMPRESSION_SLACK) {
+        newphys =
+            allocateWithReserve(f, sizeof(*newphys), &code, "memfile newphys",
+                        "compress_log_blk : MALLOC for 'newphys' failed\n");
+        if (code < 0)
+            return code;
+        ecode |= code;  /* accumulate any low-memory warnings */
+        newphys->link = NULL;
+        f->phys_curr->link = newphys;
+        f->phys_curr = newphys;
+        f->wt.ptr = (byte *) (newphys->data) - 1;
+        f->wt.limit = f->wt.ptr + MEMFILE_DATA_SIZE;
+    }
     bp->phys_blk = f->phys_curr;
     bp->phys_pdata = (char *)(f->wt.ptr) + 1;
     if (f->compress_state->templat->reinit != 0)
@@ -652,8 +666,9 @@ compress_log_blk(MEMFILE * f, LOG_MEMFILE_BLK * bp)
                                                    &(f->rd), &(f->wt), true);
         if (status != 0) {
             /*
-             * You'd think the above line is a bug, but in real life 1 src
-             * block never ends up getting split across 3 dest blocks.
+             * You'd think the above line is a bug, but 1 src block never
+             * ends up getting split across 3 dest blocks, given the
+             * COMPRESSION_SLACK above.
              */
             /* CHANGE memfile_set_memory_warning if this assumption changes. */
             emprintf(f->memory,
@@ -664,14 +679,13 @@ compress_log_blk(MEMFILE * f, LOG_MEMFILE_BLK * bp)
     }
     compressed_size += f->wt.ptr - start_ptr;
     if (compressed_size > MEMFILE_DATA_SIZE) {
-        emprintf2(f->memory,
-                  "\nCompression didn't - raw=%d, compressed=%ld\n",
-                  MEMFILE_DATA_SIZE,
-                  compressed_size);
+        if_debug2m(':', f->memory,
+                   "[:]Compression didn't - raw=%d, compressed=%ld\n",
+                   MEMFILE_DATA_SIZE,
+                   compressed_size);
     }
-#ifdef DEBUG
-    tot_compressed += compressed_size;
-#endif
+    f->compressed_bytes += compressed_size;
+    f->compressed_blocks++;
     return (status < 0 ? gs_note_error(gs_error_ioerror) : ecode);
 }                               /* end "compress_log_blk()"                                     */
 
@@ -824,9 +838,7 @@ memfile_fwrite_chars(const void *data, uint len, clist_file_ptr cf)
     }
     f->log_curr_pos += len;
     f->log_length = f->log_curr_pos;    /* truncate length to here      */
-#ifdef DEBUG
-    tot_raw += len;
-#endif
+    f->raw_bytes += len;
     return (len);
 }
 
@@ -903,15 +915,11 @@ memfile_get_pdata(MEMFILE * f)
 
         }                       /* end allocating the raw buffer pool (first time only)           */
         if (bp->raw_block == NULL) {
-#ifdef DEBUG
-            tot_cache_miss++;   /* count every decompress       */
-#endif
+            f->cache_misses++;  /* count every decompress       */
             /* find a raw buffer and decompress                            */
             if (f->raw_tail->log_blk != NULL) {
                 /* This block was in use, grab it                           */
-#ifdef DEBUG
-                tot_swap_out++;
-#endif
+                f->swap_outs++;
                 f->raw_tail->log_blk->raw_block = NULL;         /* data no longer here */
                 f->raw_tail->log_blk = NULL;
             }
@@ -985,10 +993,8 @@ memfile_get_pdata(MEMFILE * f)
                 bp->raw_block->fwd = f->raw_head;       /* this.fwd = orig head */
                 f->raw_head = bp->raw_block;    /* head = this          */
                 f->raw_head->back = NULL;       /* this.back = NULL     */
-#ifdef DEBUG
-                tot_cache_hits++;       /* counting here prevents repeats since */
+                f->cache_hits++;        /* counting here prevents repeats since */
                 /* won't count if already at head       */
-#endif
             }
         }
         f->pdata = bp->raw_block->data;
@@ -1121,34 +1127,30 @@ memfile_fseek(clist_file_ptr cf, int64_t offset, int mode, const char *ignore_fn
 
 /* ---------------- Internal routines ---------------- */
 
+/* Output some diagnostics about the effectiveness of the compression. */
+static void
+memfile_print_stats(MEMFILE * f)
+{
+    if (f->compressed_blocks != 0)
+        if_debug5m(':', f->memory,
+                   "[:]memfile "PRI_INTPTR": raw=%"PRId64", %ld blocks compressed to %"PRId64" (%d%%)\n",
+                   (intptr_t)f, f->raw_bytes, f->compressed_blocks, f->compressed_bytes,
+                   (int)(f->compressed_bytes * 100 /
+                         ((int64_t)f->compressed_blocks * MEMFILE_DATA_SIZE)));
+    if (f->cache_misses != 0)
+        if_debug4m(':', f->memory,
+                   "[:]memfile "PRI_INTPTR": cache hits=%ld, cache misses=%ld, swapouts=%ld\n",
+                   (intptr_t)f, f->cache_hits,
+                   (long)(f->cache_misses - (f->log_length / MEMFILE_DATA_SIZE)),
+                   f->swap_outs);
+}
+
 static void
 memfile_free_mem(MEMFILE * f)
 {
     LOG_MEMFILE_BLK *bp, *tmpbp;
 
-#ifdef DEBUG
-    /* output some diagnostics about the effectiveness                   */
-    if (tot_raw > 100) {
-        if (tot_raw > 0xFFFFFFFF)
-            if_debug4m(':', f->memory, "[:]tot_raw=%lu%0lu, tot_compressed=%lu%0lu\n",
-                       tot_raw >> 32, tot_raw & 0xFFFFFFFF,
-                       tot_compressed >> 32, tot_compressed & 0xFFFFFFFF);
-         else
-            if_debug2m(':', f->memory, "[:]tot_raw=%lu, tot_compressed=%lu\n",
-                       tot_raw, tot_compressed);
-    }
-    if (tot_cache_hits != 0) {
-        if_debug3m(':', f->memory, "[:]Cache hits=%lu, cache misses=%lu, swapouts=%lu\n",
-                   tot_cache_hits,
-                   (long)(tot_cache_miss - (f->log_length / MEMFILE_DATA_SIZE)),
-                   tot_swap_out);
-    }
-    tot_raw = 0;
-    tot_compressed = 0;
-    tot_cache_hits = 0;
-    tot_cache_miss = 0;
-    tot_swap_out = 0;
-#endif
+    memfile_print_stats(f);
 
     /* Free up memory that was allocated for the memfile              */
     bp = f->log_head;
@@ -1185,10 +1187,11 @@ memfile_free_mem(MEMFILE * f)
 
     f->log_head = NULL;
 
-    /* Free any internal compressor state. */
+    /* Free any internal compressor state. The decompressor is only */
+    /* initialized along with the raw buffers.                      */
+    if (f->raw_head != NULL && f->decompress_state->templat->release != 0)
+        (*f->decompress_state->templat->release) (f->decompress_state);
     if (f->compressor_initialized) {
-        if (f->decompress_state->templat->release != 0)
-            (*f->decompress_state->templat->release) (f->decompress_state);
         if (f->compress_state->templat->release != 0)
             (*f->compress_state->templat->release) (f->compress_state);
         f->compressor_initialized = false;
@@ -1217,6 +1220,9 @@ memfile_init_empty(MEMFILE * f)
     f->raw_head = NULL;
     f->compressor_initialized = false;
     f->total_space = 0;
+    f->raw_bytes = f->compressed_bytes = 0;
+    f->compressed_blocks = 0;
+    f->cache_hits = f->cache_misses = f->swap_outs = 0;
 
     /* File empty - get a physical mem block (includes the buffer area)  */
     pphys = MALLOC(f, sizeof(*pphys), "memfile pphys");
@@ -120,6 +120,13 @@ struct MEMFILE_s {
     bool compressor_initialized;
     stream_state *compress_state;
     stream_state *decompress_state;					/******* READER INSTANCE *******/
+    /* statistics, printed with -Z: */
+    int64_t raw_bytes;		/* total written */
+    int64_t compressed_bytes;	/* what the compressed blocks came to */
+    long compressed_blocks;
+    long cache_hits;		/* raw buffers found already decompressed */	/******* READER INSTANCE *******/
+    long cache_misses;		/* blocks decompressed */			/******* READER INSTANCE *******/
+    long swap_outs;		/* raw buffers reused */			/******* READER INSTANCE *******/
 };
 typedef struct MEMFILE_s MEMFILE;
 
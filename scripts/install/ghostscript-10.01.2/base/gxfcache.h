@@ -217,6 +217,10 @@ typedef struct char_cache_s {
     uint lower;			/* min size at which cached chars */
     /* should be stored compressed */
     uint upper;			/* max size of a single cached char */
+    /* Statistics, reported by the FontCache... system parameters. */
+    long hits;			/* lookups that found the char */
+    long misses;		/* lookups that didn't */
+    long oversize;		/* chars too big to be cached */
     gs_glyph_mark_proc_t mark_glyph;
     void *mark_glyph_data;	/* closure data */
 } char_cache;
@@ -595,6 +595,7 @@ shc_h=$(GLSRC)shc.h
 sisparam_h=$(GLSRC)sisparam.h
 sjpeg_h=$(GLSRC)sjpeg.h
 slzwx_h=$(GLSRC)slzwx.h
+slz4x_h=$(GLSRC)slz4x.h
 smd5_h=$(GLSRC)smd5.h
 sarc4_h=$(GLSRC)sarc4.h
 saes_h=$(GLSRC)saes.h
@@ -1789,6 +1790,25 @@ $(GLOBJ)slzwd.$(OBJ) : $(GLSRC)slzwd.c $(AK) $(stdio__h) $(gdebug_h)\
  $(slzwx_h) $(strimpl_h) $(LIB_MAK) $(MAKEDIRS)
 	$(GLCC) $(GLO_)slzwd.$(OBJ) $(C_) $(GLSRC)slzwd.c
 
+# ---------------- LZ4 filters ---------------- #
+# These are only used for band lists in memory (BAND_LIST_COMPRESSOR=lz4).
+
+slz4e_=$(GLOBJ)slz4e.$(OBJ)
+$(GLD)slz4e.dev : $(LIB_MAK) $(ECHOGS_XE) $(slz4e_) $(LIB_MAK) $(MAKEDIRS)
+	$(SETMOD) $(GLD)slz4e $(slz4e_)
+
+$(GLOBJ)slz4e.$(OBJ) : $(GLSRC)slz4e.c $(AK) $(stdio__h) $(memory__h)\
+ $(slz4x_h) $(strimpl_h) $(LIB_MAK) $(MAKEDIRS)
+	$(GLCC) $(GLO_)slz4e.$(OBJ) $(C_) $(GLSRC)slz4e.c
+
+slz4d_=$(GLOBJ)slz4d.$(OBJ)
+$(GLD)slz4d.dev : $(LIB_MAK) $(ECHOGS_XE) $(slz4d_) $(LIB_MAK) $(MAKEDIRS)
+	$(SETMOD) $(GLD)slz4d $(slz4d_)
+
+$(GLOBJ)slz4d.$(OBJ) : $(GLSRC)slz4d.c $(AK) $(stdio__h) $(memory__h)\
+ $(slz4x_h) $(strimpl_h) $(LIB_MAK) $(MAKEDIRS)
+	$(GLCC) $(GLO_)slz4d.$(OBJ) $(C_) $(GLSRC)slz4d.c
+
 # ---------------- MD5 digest filter ---------------- #
 
 smd5_=$(GLOBJ)smd5.$(OBJ)
@@ -2298,6 +2318,10 @@ $(GLOBJ)gxcllzw.$(OBJ) : $(GLSRC)gxcllzw.c $(std_h) $(AK)\
  $(gsmemory_h) $(gstypes_h) $(gxclmem_h) $(slzwx_h) $(LIB_MAK) $(MAKEDIRS)
 	$(GLCC) $(GLO_)gxcllzw.$(OBJ) $(C_) $(GLSRC)gxcllzw.c
 
+$(GLOBJ)gxcllz4.$(OBJ) : $(GLSRC)gxcllz4.c $(std_h) $(AK)\
+ $(gsmemory_h) $(gstypes_h) $(gxclmem_h) $(slz4x_h) $(LIB_MAK) $(MAKEDIRS)
+	$(GLCC) $(GLO_)gxcllz4.$(OBJ) $(C_) $(GLSRC)gxcllz4.c
+
 $(GLOBJ)gxclzlib.$(OBJ) : $(GLSRC)gxclzlib.c $(std_h) $(AK)\
  $(gsmemory_h) $(gstypes_h) $(gxclmem_h) $(szlibx_h) $(LIB_MAK) $(MAKEDIRS)
 	$(GLCC) $(GLO_)gxclzlib.$(OBJ) $(C_) $(GLSRC)gxclzlib.c
@@ -9227,6 +9251,18 @@ $(GLSRC)slzwx.h:$(GLSRC)std.h
 $(GLSRC)slzwx.h:$(GLSRC)stdpre.h
 $(GLSRC)slzwx.h:$(GLGEN)arch.h
 $(GLSRC)slzwx.h:$(GLSRC)gs_dll_call.h
+$(GLSRC)slz4x.h:$(GLSRC)scommon.h
+$(GLSRC)slz4x.h:$(GLSRC)gsstype.h
+$(GLSRC)slz4x.h:$(GLSRC)gsmemory.h
+$(GLSRC)slz4x.h:$(GLSRC)gslibctx.h
+$(GLSRC)slz4x.h:$(GLSRC)stdio_.h
+$(GLSRC)slz4x.h:$(GLSRC)stdint_.h
+$(GLSRC)slz4x.h:$(GLSRC)gssprintf.h
+$(GLSRC)slz4x.h:$(GLSRC)gstypes.h
+$(GLSRC)slz4x.h:$(GLSRC)std.h
+$(GLSRC)slz4x.h:$(GLSRC)stdpre.h
+$(GLSRC)slz4x.h:$(GLGEN)arch.h
+$(GLSRC)slz4x.h:$(GLSRC)gs_dll_call.h
 $(GLSRC)smd5.h:$(GLSRC)gsmd5.h
 $(GLSRC)smd5.h:$(GLSRC)memory_.h
 $(GLSRC)smd5.h:$(GLSRC)scommon.h
@@ -258,7 +258,7 @@ COMPILE_INITS=0
 BAND_LIST_STORAGE=file
 
 # Choose which compression method to use when storing band lists in memory.
-# The choices are 'lzw' or 'zlib'.
+# The choices are 'zlib' or 'lz4': lz4 is much faster, but compresses less.
 
 BAND_LIST_COMPRESSOR=zlib
 
@@ -123,6 +123,12 @@ typedef struct stream_DCT_state_s {
     float QFactor;
     int ColorTransform;		/* -1 if not specified */
     bool NoMarker;		/* DCTEncode only */
+    /* DCTDecode only: if the image turns out to be FullWidth x FullHeight,
+     * have the IDCT scale it down to the smallest size it can that is at
+     * least ReduceWidth x ReduceHeight.  0 (the default) decodes at full
+     * size.  These may be set at any time before the first read. */
+    int FullWidth, FullHeight;
+    int ReduceWidth, ReduceHeight;
     gs_memory_t *jpeg_memory;	/* heap for library allocations */
     /* This is a pointer to immovable storage. */
     union _jd {
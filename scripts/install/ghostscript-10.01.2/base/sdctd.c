@@ -171,6 +171,35 @@ update_jpeg_header_height(JOCTET *d, size_t len, int height)
     }
 }
 
+/*
+ * If a reduced size decode was asked for, and the image is the size the
+ * client expected, choose the IDCT scaling for it.  We ask for the
+ * smallest number of eighths that gives at least the size wanted; older
+ * libraries that only scale by 1/2, 1/4 and 1/8 round that up to the
+ * next one they have, so the output is never smaller than asked for.
+ */
+static void
+dctd_set_scale(stream_DCT_state *ss, jpeg_decompress_data *jddp)
+{
+    long width = jddp->dinfo.image_width;
+    long height = jddp->dinfo.image_height;
+    long num, vnum;
+
+    if (ss->ReduceWidth <= 0 || ss->ReduceHeight <= 0 || jddp->PassThrough ||
+        width != ss->FullWidth || height != ss->FullHeight)
+        return;
+    num = (DCTSIZE * (long)ss->ReduceWidth + width - 1) / width;
+    vnum = (DCTSIZE * (long)ss->ReduceHeight + height - 1) / height;
+    if (vnum > num)
+        num = vnum;
+    if (num < 1)
+        num = 1;
+    if (num < DCTSIZE) {
+        jddp->dinfo.scale_num = num;
+        jddp->dinfo.scale_denom = DCTSIZE;
+    }
+}
+
 /* Process a buffer */
 static int
 s_DCTD_process(stream_state * st, stream_cursor_read * pr,
@@ -280,6 +309,7 @@ s_DCTD_process(stream_state * st, stream_cursor_read * pr,
                 /* out_color_space will default to JCS_CMYK */
                 break;
             }
+            dctd_set_scale(ss, jddp);
             ss->phase = 2;
             /* falls through */
         case 2:		/* start_decompress */
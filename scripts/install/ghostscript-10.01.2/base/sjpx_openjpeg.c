@@ -55,26 +55,31 @@ void sjpxd_destroy(gs_memory_t *mem)
 #endif
 }
 
-static int opj_lock(gs_memory_t *mem)
+static int opj_lock(stream_jpxd_state *state)
 {
 #if !defined(SHARE_JPX) || (SHARE_JPX == 0)
     int ret;
 
+    gs_memory_t *mem = state->memory;
     gs_lib_ctx_t *ctx = mem->gs_lib_ctx;
 
     ret = gx_monitor_enter((gx_monitor_t *)ctx->sjpxd_private);
     assert(opj_memory == NULL);
-    opj_memory = mem->non_gc_memory;
+    /* OpenJPEG's worker threads allocate too, while we hold the lock */
+    if (state->threads > 1)
+        opj_memory = mem->thread_safe_memory;
+    else
+        opj_memory = mem->non_gc_memory;
     return ret;
 #else
     return 0;
 #endif
 }
 
-static int opj_unlock(gs_memory_t *mem)
+static int opj_unlock(stream_jpxd_state *state)
 {
 #if !defined(SHARE_JPX) || (SHARE_JPX == 0)
-    gs_lib_ctx_t *ctx = mem->gs_lib_ctx;
+    gs_lib_ctx_t *ctx = state->memory->gs_lib_ctx;
 
     assert(opj_memory != NULL);
     opj_memory = NULL;
@@ -259,10 +264,27 @@ s_opjd_init(stream_state * ss)
     state->sign_comps = NULL;
     state->stream = NULL;
     state->row_data = NULL;
+    state->reduce = 0;
+    state->band = NULL;
+    state->band_comp_size = 0;
+    state->band_y0 = state->band_h = 0;
+    state->tile_row = state->tiles_across = state->tiles_down = 0;
+    state->tile_h = 0;
 
     return 0;
 }
 
+/* the codec format of the accumulated input */
+static OPJ_CODEC_FORMAT
+s_opjd_codec_format(stream_jpxd_state *const state)
+{
+    /* state->sb.size is non-zero after successful
+       accumulate_input(); 1 is probably extremely rare */
+    if (state->sb.data[0] == 0xFF && ((state->sb.size == 1) || (state->sb.data[1] == 0x4F)))
+        return OPJ_CODEC_J2K;
+    return OPJ_CODEC_JP2;
+}
+
 /* setting the codec format,
    allocating the stream and image structures, and
    initializing the decoder.
@@ -297,6 +319,12 @@ s_opjd_set_codec_format(stream_state * ss, OPJ_CODEC_FORMAT format)
         return ERRC;
     }
 
+#if OPJ_VERSION_MAJOR >= 2 && OPJ_VERSION_MINOR >= 2
+    /* decode code blocks in parallel, if the library was built to */
+    if (state->threads > 1 && opj_has_thread_support())
+        (void)opj_codec_set_threads(state->codec, state->threads);
+#endif
+
     /* open a byte stream */
     state->stream = opj_stream_default_create(OPJ_TRUE);
     if (state->stream == NULL)
@@ -385,9 +413,218 @@ ycc_to_rgb_16(unsigned char *row, unsigned long row_size)
     while (row_size);
 }
 
+/* Work out the resolution factor for a reduced size decode, if one was
+   asked for and the image is the size the client expected.  Each factor
+   halves the size, rounding up, and can't go below the number of
+   resolution levels the code stream has. */
+static int jpx_reduce_factor(stream_jpxd_state * const state)
+{
+    opj_image_t *image = state->image;
+    opj_codestream_info_v2_t *info;
+    int compno, r, maxr = 31;
+
+    if (state->ReduceWidth <= 0 || state->ReduceHeight <= 0 || state->PassThrough ||
+        image->x0 != 0 || image->y0 != 0 ||
+        image->x1 != state->FullWidth || image->y1 != state->FullHeight)
+        return 0;
+    for (compno = 0; compno < image->numcomps; compno++)
+        if (image->comps[compno].dx != 1 || image->comps[compno].dy != 1)
+            return 0;
+
+    info = opj_get_cstr_info(state->codec);
+    if (info == NULL)
+        return 0;
+    for (compno = 0; compno < info->nbcomps; compno++)
+        if (maxr > (int)info->m_default_tile_info.tccp_info[compno].numresolutions - 1)
+            maxr = info->m_default_tile_info.tccp_info[compno].numresolutions - 1;
+    opj_destroy_cstr_info(&info);
+
+    for (r = 0; r < maxr; r++)
+    {
+        int shift = r + 1;
+
+        if (((state->FullWidth + (1 << shift) - 1) >> shift) < state->ReduceWidth ||
+            ((state->FullHeight + (1 << shift) - 1) >> shift) < state->ReduceHeight)
+            break;
+    }
+    return r;
+}
+
+static unsigned long
+jp2_box_u32(const unsigned char *p)
+{
+    return ((unsigned long)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+/* Whether a JP2 file has a palette or channel definition box in its
+   header.  OpenJPEG applies these to the first tile it is asked for and
+   then throws them away, so such a file can't be decoded a tile at a time.
+   A file we can't find our way around counts as having them. */
+static bool
+jp2_has_channel_boxes(const unsigned char *data, unsigned long size)
+{
+    unsigned long pos = 0, end = size, len, hdr;
+    bool in_jp2h = false;
+
+    while (end - pos >= 8)
+    {
+        const unsigned char *type = data + pos + 4;
+
+        len = jp2_box_u32(data + pos);
+        hdr = 8;
+        if (len == 1)
+        {
+            /* 64 bit length, of which we only want to see the low half */
+            if (end - pos < 16 || jp2_box_u32(data + pos + 8) != 0)
+                return true;
+            len = jp2_box_u32(data + pos + 12);
+            hdr = 16;
+        }
+        else if (len == 0)
+            len = end - pos;
+        if (len < hdr || len > end - pos)
+            return true;
+
+        if (in_jp2h)
+        {
+            if (memcmp(type, "pclr", 4) == 0 || memcmp(type, "cdef", 4) == 0)
+                return true;
+        }
+        else if (memcmp(type, "jp2h", 4) == 0)
+        {
+            /* look through the header box, and no further */
+            in_jp2h = true;
+            end = pos + len;
+            pos += hdr;
+            continue;
+        }
+        else if (memcmp(type, "jp2c", 4) == 0)
+            break;
+        pos += len;
+    }
+    return !in_jp2h;
+}
+
+/* The first row, in the image as decoded, of a row of tiles */
+static unsigned int
+jpx_tile_row_y(stream_jpxd_state * const state, unsigned int tile_row)
+{
+    unsigned long y = (unsigned long)tile_row * state->tile_h;
+
+    y = (y + (1UL << state->reduce) - 1) >> state->reduce;
+    return y < state->height ? y : state->height;
+}
+
+/* Set up to decode the image a row of tiles at a time, if it has more than
+   one row of tiles, and the tiles lie on the image as it is decoded the
+   same way they do in the code stream.  Returns 1 if so, having set the
+   image size, 0 to decode the image all at once. */
+static int
+jpx_setup_tile_rows(stream_jpxd_state * const state)
+{
+    opj_image_t *image = state->image;
+    opj_codestream_info_v2_t *info;
+    unsigned int tile_row, h, max_h = 0;
+    int compno;
+
+    if (image->numcomps == 0 || image->x0 != 0 || image->y0 != 0)
+        return 0;
+    for (compno = 0; compno < image->numcomps; compno++)
+        if (image->comps[compno].dx != 1 || image->comps[compno].dy != 1)
+            return 0;
+    if (s_opjd_codec_format(state) == OPJ_CODEC_JP2 &&
+        jp2_has_channel_boxes(state->sb.data, state->sb.fill))
+        return 0;
+
+    info = opj_get_cstr_info(state->codec);
+    if (info == NULL)
+        return 0;
+    state->tiles_across = info->tw;
+    state->tiles_down = info->th;
+    state->tile_h = info->tdy;
+    opj_destroy_cstr_info(&info);
+    if (state->tiles_down < 2 || state->tiles_across == 0 || state->tile_h == 0)
+        return 0;
+
+    /* the size of the image at our resolution, as opj_decode would give */
+    state->width = ((unsigned long)image->x1 + (1UL << state->reduce) - 1) >> state->reduce;
+    state->height = ((unsigned long)image->y1 + (1UL << state->reduce) - 1) >> state->reduce;
+    for (tile_row = 0; tile_row < state->tiles_down; tile_row++)
+    {
+        h = jpx_tile_row_y(state, tile_row + 1) - jpx_tile_row_y(state, tile_row);
+        if (h == 0)
+            return 0; /* tiles smaller than a sample at this resolution */
+        if (max_h < h)
+            max_h = h;
+    }
+
+    state->band_comp_size = (unsigned long)state->width * max_h;
+    if (state->band_comp_size / max_h != state->width ||
+        state->band_comp_size > ARCH_MAX_UINT / sizeof(int) / image->numcomps)
+        return 0;
+    state->band = (int *)gs_alloc_byte_array(state->memory->non_gc_memory,
+                                             state->band_comp_size * image->numcomps, sizeof(int),
+                                             "jpx_setup_tile_rows(band)");
+    if (state->band == NULL)
+        return_error(gs_error_VMerror);
+    state->tile_row = 0;
+    state->band_y0 = state->band_h = 0;
+    return 1;
+}
+
+/* Decode the next row of tiles into the band. Called with the lock held. */
+static int
+jpx_decode_tile_row(stream_jpxd_state * const state)
+{
+    opj_image_t *image = state->image;
+    unsigned int tx, tile, x, y, row;
+    int compno;
+
+    if (state->tile_row >= state->tiles_down)
+        return ERRC;
+    state->band_y0 = jpx_tile_row_y(state, state->tile_row);
+    state->band_h = jpx_tile_row_y(state, state->tile_row + 1) - state->band_y0;
+
+    for (tx = 0; tx < state->tiles_across; tx++)
+    {
+        tile = state->tile_row * state->tiles_across + tx;
+        if (!opj_get_decoded_tile(state->codec, state->stream, image, tile))
+        {
+            dlprintf1("openjpeg: failed to decode tile %u\n", tile);
+            return ERRC;
+        }
+        /* the image is now just the tile */
+        x = ((unsigned long)image->x0 + (1UL << state->reduce) - 1) >> state->reduce;
+        y = (((unsigned long)image->y0 + (1UL << state->reduce) - 1) >> state->reduce) - state->band_y0;
+        for (compno = 0; compno < image->numcomps; compno++)
+        {
+            opj_image_comp_t *comp = &image->comps[compno];
+            int *dest = state->band + compno * state->band_comp_size;
+
+            if (comp->data == NULL || x + comp->w > state->width || y + comp->h > state->band_h)
+                return ERRC;
+            for (row = 0; row < comp->h; row++)
+                memcpy(&dest[(unsigned long)(y + row) * state->width + x],
+                       &comp->data[(unsigned long)row * comp->w], comp->w * sizeof(int));
+        }
+    }
+    state->tile_row++;
+    return 0;
+}
+
+/* The samples of one row of one component of the image */
+static inline int *
+jpx_comp_row(stream_jpxd_state * const state, int compno, unsigned int y)
+{
+    if (state->band != NULL)
+        return &state->band[compno * state->band_comp_size +
+                            (unsigned long)(y - state->band_y0) * state->width];
+    return &(state->image->comps[compno].data[(unsigned long)y * state->width]);
+}
+
 static int decode_image(stream_jpxd_state * const state)
 {
-    int numprimcomp = 0, alpha_comp = -1, compno, rowbytes;
+    int numprimcomp = 0, alpha_comp = -1, compno, rowbytes, code;
 
     /* read header */
     if (!opj_read_header(state->stream, state->codec, &(state->image)))
@@ -396,8 +633,26 @@ static int decode_image(stream_jpxd_state * const state)
     	return ERRC;
     }
 
-    /* decode the stream and fill the image structure */
-    if (!opj_decode(state->codec, state->stream, state->image))
+    state->reduce = jpx_reduce_factor(state);
+    if (state->reduce > 0 &&
+        !opj_set_decoded_resolution_factor(state->codec, state->reduce))
+    {
+        state->reduce = 0;
+        (void)opj_set_decoded_resolution_factor(state->codec, 0);
+    }
+
+    /* decode the stream, or its first row of tiles, and fill the image
+       structure */
+    code = jpx_setup_tile_rows(state);
+    if (code < 0)
+        return code;
+    if (code > 0)
+    {
+        code = jpx_decode_tile_row(state);
+        if (code < 0)
+            return code;
+    }
+    else if (!opj_decode(state->codec, state->stream, state->image))
     {
         dlprintf("openjpeg: failed to decode image!\n");
         return ERRC;
@@ -407,14 +662,19 @@ static int decode_image(stream_jpxd_state * const state)
     if (state->image->numcomps == 0)
         return ERRC;
 
-    state->width = state->image->comps[0].w;
-    state->height = state->image->comps[0].h;
+    if (state->band == NULL)
+    {
+        state->width = state->image->comps[0].w;
+        state->height = state->image->comps[0].h;
+    }
     state->bpp = state->image->comps[0].prec;
     state->samescale = true;
     for(compno = 1; compno < state->image->numcomps; compno++)
     {
         if (state->bpp != state->image->comps[compno].prec)
             return ERRC; /* Not supported. */
+        if (state->band != NULL)
+            continue; /* all the same size, from jpx_setup_tile_rows() */
         if (state->width < state->image->comps[compno].w)
             state->width = state->image->comps[compno].w;
         if (state->height < state->image->comps[compno].h)
@@ -550,6 +810,19 @@ static int process_one_trunk(stream_jpxd_state * const state, stream_cursor_writ
 
         if (x_offset == 0)
         {
+            if (state->band != NULL && y_offset >= state->band_y0 + state->band_h)
+            {
+                /* on to the next row of tiles */
+                int code = opj_lock(state);
+
+                if (code < 0)
+                    return code;
+                code = jpx_decode_tile_row(state);
+                (void)opj_unlock(state);
+                if (code < 0)
+                    return code;
+            }
+
             /* Decode another rows worth */
             row = state->row_data;
             if (state->alpha && state->alpha_comp == -1)
@@ -560,11 +833,11 @@ static int process_one_trunk(stream_jpxd_state * const state, stream_cursor_writ
             else if (state->samescale)
             {
                 if (state->alpha)
-                    state->pdata[0] = &(state->image->comps[state->alpha_comp].data[y_offset * state->width]);
+                    state->pdata[0] = jpx_comp_row(state, state->alpha_comp, y_offset);
                 else
                 {
                     for (compno=0; compno<img_numcomps; compno++)
-                        state->pdata[compno] = &(state->image->comps[compno].data[y_offset * state->width]);
+                        state->pdata[compno] = jpx_comp_row(state, compno, y_offset);
                 }
                 if (shift_bit == 0 && state->bpp == 8) /* optimized for the most common case */
                 {
@@ -687,6 +960,48 @@ static int process_one_trunk(stream_jpxd_state * const state, stream_cursor_writ
         return 1; /* need more calls */
 }
 
+/* Throw away a failed decode, and set up to decode the image again from
+   the start, at full size. Called with the lock held. */
+static int
+s_opjd_restart(stream_state * ss)
+{
+    stream_jpxd_state *const state = (stream_jpxd_state *) ss;
+    int code;
+
+    if (state->image)
+        opj_image_destroy(state->image);
+    state->image = NULL;
+    if (state->stream)
+        opj_stream_destroy(state->stream);
+    state->stream = NULL;
+    if (state->codec)
+        opj_destroy_codec(state->codec);
+    state->codec = NULL;
+    if (state->pdata)
+        gs_free_object(state->memory->non_gc_memory, state->pdata, "s_opjd_restart(pdata)");
+    state->pdata = NULL;
+    if (state->sign_comps)
+        gs_free_object(state->memory->non_gc_memory, state->sign_comps, "s_opjd_restart(sign_comps)");
+    state->sign_comps = NULL;
+    if (state->band)
+        gs_free_object(state->memory->non_gc_memory, state->band, "s_opjd_restart(band)");
+    state->band = NULL;
+
+    state->ReduceWidth = state->ReduceHeight = 0;
+    state->reduce = 0;
+    state->sb.pos = 0;
+    code = s_opjd_set_codec_format(ss, s_opjd_codec_format(state));
+    if (code < 0)
+        return code;
+#if OPJ_VERSION_MAJOR >= 2 && OPJ_VERSION_MINOR >= 1
+    opj_stream_set_user_data(state->stream, &(state->sb), NULL);
+#else
+    opj_stream_set_user_data(state->stream, &(state->sb));
+#endif
+    opj_stream_set_user_data_length(state->stream, state->sb.size);
+    return 0;
+}
+
 /* process a section of the input and return any decoded data.
    see strimpl.h for return codes.
  */
@@ -710,26 +1025,21 @@ s_opjd_process(stream_state * ss, stream_cursor_read * pr,
         }
 
         /* buffer available data */
-        code = opj_lock(ss->memory);
+        code = opj_lock(state);
         if (code < 0) return code;
         locked = 1;
 
         code = s_opjd_accumulate_input(state, pr);
         if (code < 0) {
-            (void)opj_unlock(ss->memory);
+            (void)opj_unlock(state);
             return code;
         }
 
         if (state->codec == NULL) {
-            /* state->sb.size is non-zero after successful
-               accumulate_input(); 1 is probably extremely rare */
-            if (state->sb.data[0] == 0xFF && ((state->sb.size == 1) || (state->sb.data[1] == 0x4F)))
-                code = s_opjd_set_codec_format(ss, OPJ_CODEC_J2K);
-            else
-                code = s_opjd_set_codec_format(ss, OPJ_CODEC_JP2);
+            code = s_opjd_set_codec_format(ss, s_opjd_codec_format(state));
             if (code < 0)
             {
-                (void)opj_unlock(ss->memory);
+                (void)opj_unlock(state);
                 return code;
             }
         }
@@ -743,7 +1053,7 @@ s_opjd_process(stream_state * ss, stream_cursor_read * pr,
 
             if (locked == 0)
             {
-                ret = opj_lock(ss->memory);
+                ret = opj_lock(state);
                 if (ret < 0) return ret;
                 locked = 1;
             }
@@ -755,16 +1065,25 @@ s_opjd_process(stream_state * ss, stream_cursor_read * pr,
 #endif
             opj_stream_set_user_data_length(state->stream, state->sb.size);
             ret = decode_image(state);
+            if (ret != 0 && state->reduce > 0)
+            {
+                /* Not every code stream decodes at a reduced resolution
+                   (tiles can have fewer levels than the default), so
+                   start again at full size. */
+                ret = s_opjd_restart(ss);
+                if (ret == 0)
+                    ret = decode_image(state);
+            }
             if (ret != 0)
             {
-                (void)opj_unlock(ss->memory);
+                (void)opj_unlock(state);
                 return ret;
             }
         }
 
         if (locked)
         {
-            code = opj_unlock(ss->memory);
+            code = opj_unlock(state);
             if (code < 0) return code;
         }
 
@@ -774,7 +1093,7 @@ s_opjd_process(stream_state * ss, stream_cursor_read * pr,
     }
 
     if (locked)
-        return opj_unlock(ss->memory);
+        return opj_unlock(state);
 
     /* ask for more data */
     return 0;
@@ -785,6 +1104,9 @@ static void
 s_opjd_set_defaults(stream_state * ss) {
     stream_jpxd_state *const state = (stream_jpxd_state *) ss;
 
+    state->FullWidth = state->FullHeight = 0;
+    state->ReduceWidth = state->ReduceHeight = 0;
+    state->threads = 0;
     state->alpha = false;
     state->colorspace = gs_jpx_cs_rgb;
     state->StartedPassThrough = 0;
@@ -809,7 +1131,7 @@ s_opjd_release(stream_state *ss)
     if (state->codec == NULL)
         return;
 
-    (void)opj_lock(ss->memory);
+    (void)opj_lock(state);
 
     /* free image data structure */
     if (state->image)
@@ -823,7 +1145,7 @@ s_opjd_release(stream_state *ss)
     if (state->codec)
 	opj_destroy_codec(state->codec);
 
-    (void)opj_unlock(ss->memory);
+    (void)opj_unlock(state);
 
     /* free input buffer */
     if (state->sb.data)
@@ -837,6 +1159,9 @@ s_opjd_release(stream_state *ss)
 
     if (state->row_data)
         gs_free_object(state->memory->non_gc_memory, state->row_data, "s_opjd_release(row_data)");
+
+    if (state->band)
+        gs_free_object(state->memory->non_gc_memory, state->band, "s_opjd_release(band)");
 }
 
 
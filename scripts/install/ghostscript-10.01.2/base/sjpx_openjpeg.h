@@ -79,6 +79,30 @@ typedef struct stream_jpxd_state_s
                                          * so we use a function at the interpreter level
                                          */
     void *device;                       /* The device we need to send PassThrough data to */
+
+    /* If the image turns out to be FullWidth x FullHeight, decode it at
+     * the lowest resolution level that is at least ReduceWidth x
+     * ReduceHeight.  0 (the default) decodes at full size.  These may be
+     * set at any time before the first read. */
+    int FullWidth, FullHeight;
+    int ReduceWidth, ReduceHeight;
+    int reduce;                         /* the resolution factor we decoded at */
+
+    /* The number of threads OpenJPEG may decode with; 0 or 1 (the default)
+     * decodes on the calling thread.  May be set before the first read. */
+    int threads;
+
+    /* An image with more than one row of tiles is decoded a row of tiles
+     * at a time into band, rather than all at once, so that only a band's
+     * worth of samples need be held.  band_comp_size is the number of
+     * samples for each component, which are band_h rows of the image
+     * starting at band_y0.  tile_row is the next row of tiles to decode,
+     * of the tiles_across x tiles_down grid of tiles, which are tile_h
+     * rows high in the full size image. */
+    int *band;
+    unsigned long band_comp_size;
+    unsigned int band_y0, band_h;
+    unsigned int tile_row, tiles_across, tiles_down, tile_h;
 } stream_jpxd_state;
 
 extern const stream_template s_jpxd_template;
@@ -0,0 +1,222 @@
+/* Copyright (C) 2001-2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  1305 Grant Avenue - Suite 200, Novato,
+   CA 94945, U.S.A., +1(415)492-9861, for further information.
+*/
+
+
+/* LZ4 fast decompression filter */
+#include "stdio_.h"		/* includes std.h */
+#include "memory_.h"
+#include "strimpl.h"
+#include "slz4x.h"
+
+/* ------ LZ4Decode ------ */
+
+private_st_LZ4D_state();
+
+#define MIN_MATCH 4
+
+/* Read the part of a length that doesn't fit in its 4 bits of the token. */
+#define get_length(len, ip, iend)\
+  BEGIN\
+    uint b_;\
+    do {\
+        if (ip == iend)\
+            return ERRC;\
+        b_ = *ip++;\
+        len += b_;\
+    } while (b_ == 255);\
+  END
+
+/*
+ * Decompress a block of size bytes from src into exactly raw_size bytes
+ * at dst.  The block comes from memory that we don't trust, so check
+ * everything.
+ */
+static int
+decompress_block(const byte *src, uint size, byte *dst, uint raw_size)
+{
+    const byte *ip = src;
+    const byte *iend = src + size;
+    byte *op = dst;
+    byte *oend = dst + raw_size;
+
+    for (;;) {
+        uint token, len, offset;
+        const byte *ref;
+
+        if (ip == iend)
+            return ERRC;
+        token = *ip++;
+        len = token >> 4;
+        if (len == 15)
+            get_length(len, ip, iend);
+        if (len > iend - ip || len > oend - op)
+            return ERRC;
+        if (len >= 32) {
+            memcpy(op, ip, len);
+            op += len, ip += len;
+        } else
+            while (len--)
+                *op++ = *ip++;
+        if (ip == iend)
+            break;		/* the last sequence has no match */
+        if (iend - ip < 2)
+            return ERRC;
+        offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op - dst)
+            return ERRC;
+        len = token & 15;
+        if (len == 15)
+            get_length(len, ip, iend);
+        len += MIN_MATCH;
+        if (len > oend - op)
+            return ERRC;
+        ref = op - offset;
+        if (offset >= len && len >= 32) {
+            memcpy(op, ref, len);
+            op += len;
+        } else
+            /* Overlapping matches repeat the data, so copy forwards. */
+            while (len--)
+                *op++ = *ref++;
+    }
+    return (op == oend ? 0 : ERRC);
+}
+
+/* Set up the state, keeping any buffers we already have. */
+static int
+s_LZ4D_reinit(stream_state * st)
+{
+    stream_LZ4D_state *const ss = (stream_LZ4D_state *) st;
+
+    ss->hold_count = 0;
+    ss->out_count = ss->out_pos = 0;
+    return 0;
+}
+
+/* Set defaults */
+static void
+s_LZ4D_set_defaults(stream_state * st)
+{
+    stream_LZ4D_state *const ss = (stream_LZ4D_state *) st;
+
+    /* The buffers are only allocated if they turn out to be needed. */
+    ss->hold = ss->out = NULL;
+    s_LZ4D_reinit(st);
+}
+
+/* Release the buffers */
+static void
+s_LZ4D_release(stream_state * st)
+{
+    stream_LZ4D_state *const ss = (stream_LZ4D_state *) st;
+    gs_memory_t *mem = ss->memory->non_gc_memory;
+
+    gs_free_object(mem, ss->hold, "s_LZ4D_release(hold)");
+    gs_free_object(mem, ss->out, "s_LZ4D_release(out)");
+    ss->hold = ss->out = NULL;
+}
+
+/* Process a buffer */
+static int
+s_LZ4D_process(stream_state * st, stream_cursor_read * pr,
+               stream_cursor_write * pw, bool ignore_last)
+{
+    stream_LZ4D_state *const ss = (stream_LZ4D_state *) st;
+    gs_memory_t *mem = ss->memory->non_gc_memory;
+
+    for (;;) {
+        uint avail = pr->limit - pr->ptr;
+        uint wcount = pw->limit - pw->ptr;
+        const byte *src;
+        byte *dst;
+
+        if (ss->out_pos < ss->out_count) {
+            uint count = min(ss->out_count - ss->out_pos, wcount);
+
+            memcpy(pw->ptr + 1, ss->out + ss->out_pos, count);
+            pw->ptr += count;
+            ss->out_pos += count;
+            if (ss->out_pos < ss->out_count)
+                return 1;
+            wcount -= count;
+        }
+        /* Don't read ahead into the next block if there's no room for it. */
+        if (wcount == 0)
+            return 1;
+        if (ss->hold_count == 0) {
+            const byte *p = pr->ptr + 1;
+
+            /* Leave a partial header where it is, for next time. */
+            if (avail < LZ4_HEADER_SIZE)
+                return 0;
+            ss->block_size = p[0] | (p[1] << 8);
+            ss->raw_size = p[2] | (p[3] << 8);
+            if (ss->raw_size == 0 || ss->raw_size > LZ4_BLOCK_SIZE ||
+                ss->block_size == 0 || ss->block_size > ss->raw_size)
+                return ERRC;
+            if (avail < LZ4_HEADER_SIZE + ss->block_size) {
+                /* The block is split; put it together in hold. */
+                if (ss->hold == NULL) {
+                    ss->hold = gs_alloc_bytes(mem, LZ4_HEADER_SIZE + LZ4_BLOCK_SIZE,
+                                              "s_LZ4D_process(hold)");
+                    if (ss->hold == NULL)
+                        return ERRC;
+                }
+                memcpy(ss->hold, p, avail);
+                pr->ptr += avail;
+                ss->hold_count = avail;
+                return 0;
+            }
+            src = p + LZ4_HEADER_SIZE;
+            pr->ptr += LZ4_HEADER_SIZE + ss->block_size;
+        } else {
+            uint count = min(LZ4_HEADER_SIZE + ss->block_size - ss->hold_count, avail);
+
+            memcpy(ss->hold + ss->hold_count, pr->ptr + 1, count);
+            pr->ptr += count;
+            ss->hold_count += count;
+            if (ss->hold_count < LZ4_HEADER_SIZE + ss->block_size)
+                return 0;
+            src = ss->hold + LZ4_HEADER_SIZE;
+            ss->hold_count = 0;
+        }
+        if (wcount >= ss->raw_size)
+            dst = pw->ptr + 1;
+        else {
+            if (ss->out == NULL) {
+                ss->out = gs_alloc_bytes(mem, LZ4_BLOCK_SIZE, "s_LZ4D_process(out)");
+                if (ss->out == NULL)
+                    return ERRC;
+            }
+            dst = ss->out;
+        }
+        if (ss->block_size == ss->raw_size)
+            memcpy(dst, src, ss->raw_size);
+        else if (decompress_block(src, ss->block_size, dst, ss->raw_size) < 0)
+            return ERRC;
+        if (dst == ss->out) {
+            ss->out_count = ss->raw_size;
+            ss->out_pos = 0;
+        } else
+            pw->ptr += ss->raw_size;
+    }
+}
+
+/* Stream template */
+const stream_template s_LZ4D_template = {
+    &st_LZ4D_state, s_LZ4D_reinit, s_LZ4D_process, 1, 1, s_LZ4D_release,
+    s_LZ4D_set_defaults, s_LZ4D_reinit
+};
@@ -0,0 +1,257 @@
+/* Copyright (C) 2001-2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  1305 Grant Avenue - Suite 200, Novato,
+   CA 94945, U.S.A., +1(415)492-9861, for further information.
+*/
+
+
+/* LZ4 fast compression filter */
+#include "stdio_.h"		/* includes std.h */
+#include "memory_.h"
+#include "strimpl.h"
+#include "slz4x.h"
+
+/* ------ LZ4Encode ------ */
+
+private_st_LZ4E_state();
+
+#define MIN_MATCH 4
+/* The last 5 bytes of a block are always literals, and the last match */
+/* must start at least 12 bytes before the end of the block. */
+#define LAST_LITERALS 5
+#define MF_LIMIT 12
+#define MAX_OFFSET 65535
+
+static inline bits32
+read32(const byte *p)
+{
+    return p[0] | (p[1] << 8) | ((bits32)p[2] << 16) | ((bits32)p[3] << 24);
+}
+
+#define hash32(v) ((bits32)((v) * 2654435761U) >> (32 - LZ4_HASH_BITS))
+
+/* Copy a literal run; most are short, so don't call memcpy for them. */
+static inline byte *
+copy_literals(byte *op, const byte *ip, uint len)
+{
+    if (len >= 32) {
+        memcpy(op, ip, len);
+        return op + len;
+    }
+    while (len--)
+        *op++ = *ip++;
+    return op;
+}
+
+/* Write the part of a length that doesn't fit in its 4 bits of the token. */
+static inline byte *
+put_length(byte *op, uint len)
+{
+    for (; len >= 255; len -= 255)
+        *op++ = 255;
+    *op++ = (byte)len;
+    return op;
+}
+
+/* Write a sequence: a literal run, and a match unless offset is 0. */
+static byte *
+put_sequence(byte *op, const byte *lit, uint lit_len, uint offset,
+             uint match_len)
+{
+    byte *token = op++;
+
+    if (lit_len >= 15) {
+        *token = 15 << 4;
+        op = put_length(op, lit_len - 15);
+    } else
+        *token = lit_len << 4;
+    op = copy_literals(op, lit, lit_len);
+    if (offset == 0)
+        return op;
+    *op++ = (byte)offset;
+    *op++ = (byte)(offset >> 8);
+    match_len -= MIN_MATCH;
+    if (match_len >= 15) {
+        *token |= 15;
+        op = put_length(op, match_len - 15);
+    } else
+        *token |= match_len;
+    return op;
+}
+
+/*
+ * Compress a block of len (<= LZ4_BLOCK_SIZE) bytes from src into dst,
+ * which must have room for LZ4_COMPRESS_BOUND(len) bytes.  Return the
+ * compressed size, or len if the block doesn't get any smaller.
+ */
+static uint
+compress_block(stream_LZ4E_state *ss, const byte *src, uint len, byte *dst)
+{
+    ushort *table = ss->table;
+    byte *op = dst;
+    uint anchor = 0, ip = 1;
+    uint mf_limit = len - MF_LIMIT;
+    uint match_limit = len - LAST_LITERALS;
+
+    if (len > MF_LIMIT) {
+        memset(table, 0, sizeof(ss->table));
+        /* table[hash32(read32(src))] = 0 by the memset. */
+        while (ip < mf_limit) {
+            bits32 v = read32(src + ip);
+            uint h = hash32(v);
+            uint ref = table[h];
+            uint match_len;
+
+            table[h] = ip;
+            if (read32(src + ref) != v || ip - ref > MAX_OFFSET) {
+                /* Step faster through data that doesn't compress. */
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+            while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1])
+                ip--, ref--;
+            match_len = MIN_MATCH;
+            while (ip + match_len + 4 <= match_limit &&
+                   read32(src + ip + match_len) == read32(src + ref + match_len))
+                match_len += 4;
+            while (ip + match_len < match_limit &&
+                   src[ip + match_len] == src[ref + match_len])
+                match_len++;
+            op = put_sequence(op, src + anchor, ip - anchor, ip - ref,
+                              match_len);
+            if (op - dst >= len)
+                return len;
+            ip += match_len;
+            anchor = ip;
+            if (ip < mf_limit)
+                table[hash32(read32(src + ip - 2))] = ip - 2;
+        }
+    }
+    op = put_sequence(op, src + anchor, len - anchor, 0, 0);
+    return (op - dst >= len ? len : op - dst);
+}
+
+/* Set up the state, keeping any buffers we already have. */
+static int
+s_LZ4E_reinit(stream_state * st)
+{
+    stream_LZ4E_state *const ss = (stream_LZ4E_state *) st;
+
+    ss->hold_count = 0;
+    ss->out_count = ss->out_pos = 0;
+    return 0;
+}
+
+/* Set defaults */
+static void
+s_LZ4E_set_defaults(stream_state * st)
+{
+    stream_LZ4E_state *const ss = (stream_LZ4E_state *) st;
+
+    /* The buffers are only allocated if they turn out to be needed. */
+    ss->hold = ss->out = NULL;
+    s_LZ4E_reinit(st);
+}
+
+/* Release the buffers */
+static void
+s_LZ4E_release(stream_state * st)
+{
+    stream_LZ4E_state *const ss = (stream_LZ4E_state *) st;
+    gs_memory_t *mem = ss->memory->non_gc_memory;
+
+    gs_free_object(mem, ss->hold, "s_LZ4E_release(hold)");
+    gs_free_object(mem, ss->out, "s_LZ4E_release(out)");
+    ss->hold = ss->out = NULL;
+}
+
+/* Process a buffer */
+static int
+s_LZ4E_process(stream_state * st, stream_cursor_read * pr,
+               stream_cursor_write * pw, bool last)
+{
+    stream_LZ4E_state *const ss = (stream_LZ4E_state *) st;
+    gs_memory_t *mem = ss->memory->non_gc_memory;
+
+    for (;;) {
+        uint avail = pr->limit - pr->ptr;
+        uint wcount = pw->limit - pw->ptr;
+        const byte *src;
+        uint len, size;
+        byte *dst;
+
+        if (ss->out_pos < ss->out_count) {
+            uint count = min(ss->out_count - ss->out_pos, wcount);
+
+            memcpy(pw->ptr + 1, ss->out + ss->out_pos, count);
+            pw->ptr += count;
+            ss->out_pos += count;
+            if (ss->out_pos < ss->out_count)
+                return 1;
+            wcount -= count;
+        }
+        if (ss->hold_count > 0 || (avail < LZ4_BLOCK_SIZE && !last)) {
+            /* Save the input until we have a whole block, or the end. */
+            uint count = min(LZ4_BLOCK_SIZE - ss->hold_count, avail);
+
+            if (ss->hold == NULL) {
+                ss->hold = gs_alloc_bytes(mem, LZ4_BLOCK_SIZE, "s_LZ4E_process(hold)");
+                if (ss->hold == NULL)
+                    return ERRC;
+            }
+            memcpy(ss->hold + ss->hold_count, pr->ptr + 1, count);
+            pr->ptr += count;
+            ss->hold_count += count;
+            if (ss->hold_count < LZ4_BLOCK_SIZE && !(last && pr->ptr == pr->limit))
+                return 0;
+            src = ss->hold;
+            len = ss->hold_count;
+            ss->hold_count = 0;
+        } else {
+            if (avail == 0)
+                return 0;
+            src = pr->ptr + 1;
+            len = min(avail, LZ4_BLOCK_SIZE);
+            pr->ptr += len;
+        }
+        if (wcount >= LZ4_HEADER_SIZE + LZ4_COMPRESS_BOUND(len))
+            dst = pw->ptr + 1;
+        else {
+            if (ss->out == NULL) {
+                ss->out = gs_alloc_bytes(mem, LZ4_HEADER_SIZE +
+                                         LZ4_COMPRESS_BOUND(LZ4_BLOCK_SIZE),
+                                         "s_LZ4E_process(out)");
+                if (ss->out == NULL)
+                    return ERRC;
+            }
+            dst = ss->out;
+        }
+        size = compress_block(ss, src, len, dst + LZ4_HEADER_SIZE);
+        if (size == len)
+            memcpy(dst + LZ4_HEADER_SIZE, src, len);
+        dst[0] = (byte)size;
+        dst[1] = (byte)(size >> 8);
+        dst[2] = (byte)len;
+        dst[3] = (byte)(len >> 8);
+        if (dst == ss->out) {
+            ss->out_count = LZ4_HEADER_SIZE + size;
+            ss->out_pos = 0;
+        } else
+            pw->ptr += LZ4_HEADER_SIZE + size;
+    }
+}
+
+/* Stream template */
+const stream_template s_LZ4E_template = {
+    &st_LZ4E_state, s_LZ4E_reinit, s_LZ4E_process, 1, 1, s_LZ4E_release,
+    s_LZ4E_set_defaults, s_LZ4E_reinit
+};
@@ -0,0 +1,75 @@
+/* Copyright (C) 2001-2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  1305 Grant Avenue - Suite 200, Novato,
+   CA 94945, U.S.A., +1(415)492-9861, for further information.
+*/
+
+
+/* Definitions for the LZ4 fast compression filters */
+/* Requires scommon.h; strimpl.h if any templates are referenced */
+
+#ifndef slz4x_INCLUDED
+#  define slz4x_INCLUDED
+
+#include "scommon.h"
+
+/*
+ * These filters trade compression for speed: they are meant for data that
+ * is written and read back by Ghostscript itself, such as band lists kept
+ * in memory, rather than for output files.  The data is cut into blocks of
+ * up to LZ4_BLOCK_SIZE bytes, each compressed on its own in the LZ4 block
+ * format (literal runs and matches of 4 or more bytes within the block,
+ * found with a single hash probe).  Each block is preceded by a 4 byte
+ * header giving the size of the block as stored and its decompressed size,
+ * each as 2 bytes, least significant first.  A block that doesn't get any
+ * smaller is stored as it is, with the two sizes equal.
+ */
+#define LZ4_BLOCK_SIZE 32768
+#define LZ4_HEADER_SIZE 4
+/* The most that a block of n bytes can take up, compressed. */
+#define LZ4_COMPRESS_BOUND(n) ((n) + (n) / 255 + 16)
+#define LZ4_HASH_BITS 12
+
+/* LZ4 compressor */
+typedef struct stream_LZ4E_state_s {
+    stream_state_common;
+    /* The following are updated dynamically. */
+    byte *hold;			/* input saved until there is a block's worth */
+    uint hold_count;
+    byte *out;			/* a block that didn't fit in the output */
+    uint out_count;
+    uint out_pos;		/* amount of out already written */
+    ushort table[1 << LZ4_HASH_BITS];	/* hash of 4 bytes => position */
+} stream_LZ4E_state;
+
+#define private_st_LZ4E_state()	/* in slz4e.c */\
+  gs_private_st_simple(st_LZ4E_state, stream_LZ4E_state, "LZ4Encode state")
+extern const stream_template s_LZ4E_template;
+
+/* LZ4 decompressor */
+typedef struct stream_LZ4D_state_s {
+    stream_state_common;
+    /* The following are updated dynamically. */
+    byte *hold;			/* a block that is split across input buffers */
+    uint hold_count;
+    uint block_size;		/* size of the block being read, as stored */
+    uint raw_size;		/* and decompressed */
+    byte *out;			/* a block that didn't fit in the output */
+    uint out_count;
+    uint out_pos;		/* amount of out already written */
+} stream_LZ4D_state;
+
+#define private_st_LZ4D_state()	/* in slz4d.c */\
+  gs_private_st_simple(st_LZ4D_state, stream_LZ4D_state, "LZ4Decode state")
+extern const stream_template s_LZ4D_template;
+
+#endif /* slz4x_INCLUDED */
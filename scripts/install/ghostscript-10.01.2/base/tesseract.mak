@@ -27,7 +27,7 @@ TESSINCLUDES=\
 # this conflicts with Tesseract's use of a CLUSTER type. We work around this
 # here by undefining CLUSTER for the tesseract portion of the build.
 
-TESSCXX = $(CXX) $(TESSINCLUDES) $(TESSCXXFLAGS) $(CCFLAGS) -DTESSERACT_IMAGEDATA_AS_PIX -DTESSERACT_DISABLE_DEBUG_FONTS -DGRAPHICS_DISABLED -UCLUSTER
+TESSCXX = $(CXX) $(TESSINCLUDES) $(TESSCXXFLAGS) $(CCFLAGS) -DTESSERACT_IMAGEDATA_AS_PIX -DTESSERACT_DISABLE_DEBUG_FONTS -DGRAPHICS_DISABLED -DTESSERACT_PAGE_ARENA -UCLUSTER
 #-DDISABLED_LEGACY_ENGINE
 TESSOBJ = $(GLOBJDIR)$(D)tesseract_
 TESSO_ = $(O_)$(TESSOBJ)
@@ -47,6 +47,7 @@ TESSDEPS=\
 	$(TESSERACTDIR)/include/tesseract/resultiterator.h\
 	$(TESSERACTDIR)/include/tesseract/thresholder.h\
 	$(TESSERACTDIR)/include/tesseract/unichar.h\
+	$(TESSERACTDIR)/src/arch/activation.h\
 	$(TESSERACTDIR)/src/arch/dotproduct.h\
 	$(TESSERACTDIR)/src/arch/intsimdmatrix.h\
 	$(TESSERACTDIR)/src/arch/simddetect.h\
@@ -116,12 +117,14 @@ TESSDEPS=\
 	$(TESSERACTDIR)/src/ccutil/kdpair.h\
 	$(TESSERACTDIR)/src/ccutil/lsterr.h\
 	$(TESSERACTDIR)/src/ccutil/object_cache.h\
+	$(TESSERACTDIR)/src/ccutil/pagearena.h\
 	$(TESSERACTDIR)/src/ccutil/params.h\
 	$(TESSERACTDIR)/src/ccutil/qrsequence.h\
 	$(TESSERACTDIR)/src/ccutil/scanutils.h\
 	$(TESSERACTDIR)/src/ccutil/sorthelper.h\
 	$(TESSERACTDIR)/src/ccutil/tessdatamanager.h\
 	$(TESSERACTDIR)/src/ccutil/tprintf.h\
+	$(TESSERACTDIR)/src/ccutil/threadpool.h\
 	$(TESSERACTDIR)/src/ccutil/unicharcompress.h\
 	$(TESSERACTDIR)/src/ccutil/unicharmap.h\
 	$(TESSERACTDIR)/src/ccutil/unicharset.h\
@@ -171,6 +174,7 @@ TESSDEPS=\
 	$(TESSERACTDIR)/src/lstm/maxpool.h\
 	$(TESSERACTDIR)/src/lstm/network.h\
 	$(TESSERACTDIR)/src/lstm/networkio.h\
+	$(TESSERACTDIR)/src/lstm/networkcache.h\
 	$(TESSERACTDIR)/src/lstm/networkscratch.h\
 	$(TESSERACTDIR)/src/lstm/parallel.h\
 	$(TESSERACTDIR)/src/lstm/plumbing.h\
@@ -814,9 +818,15 @@ $(TESSOBJ)ccutil_scanutils.$(OBJ) : $(TESSERACTDIR)/src/ccutil/scanutils.cpp $(T
 $(TESSOBJ)ccutil_tessdatamanager.$(OBJ) : $(TESSERACTDIR)/src/ccutil/tessdatamanager.cpp $(TESSDEPS)
 	$(TESSCXX) $(TESSO_)ccutil_tessdatamanager.$(OBJ) $(C_) $(TESSERACTDIR)/src/ccutil/tessdatamanager.cpp
 
+$(TESSOBJ)ccutil_pagearena.$(OBJ) : $(TESSERACTDIR)/src/ccutil/pagearena.cpp $(TESSDEPS)
+	$(TESSCXX) $(TESSO_)ccutil_pagearena.$(OBJ) $(C_) $(TESSERACTDIR)/src/ccutil/pagearena.cpp
+
 $(TESSOBJ)ccutil_tprintf.$(OBJ) : $(TESSERACTDIR)/src/ccutil/tprintf.cpp $(TESSDEPS)
 	$(TESSCXX) $(TESSO_)ccutil_tprintf.$(OBJ) $(C_) $(TESSERACTDIR)/src/ccutil/tprintf.cpp
 
+$(TESSOBJ)ccutil_threadpool.$(OBJ) : $(TESSERACTDIR)/src/ccutil/threadpool.cpp $(TESSDEPS)
+	$(TESSCXX) $(TESSO_)ccutil_threadpool.$(OBJ) $(C_) $(TESSERACTDIR)/src/ccutil/threadpool.cpp
+
 $(TESSOBJ)ccutil_unichar.$(OBJ) : $(TESSERACTDIR)/src/ccutil/unichar.cpp $(TESSDEPS)
 	$(TESSCXX) $(TESSO_)ccutil_unichar.$(OBJ) $(C_) $(TESSERACTDIR)/src/ccutil/unichar.cpp
 
@@ -868,6 +878,9 @@ $(TESSOBJ)lstm_network.$(OBJ) : $(TESSERACTDIR)/src/lstm/network.cpp $(TESSDEPS)
 $(TESSOBJ)lstm_networkio.$(OBJ) : $(TESSERACTDIR)/src/lstm/networkio.cpp $(TESSDEPS)
 	$(TESSCXX) $(TESSO_)lstm_networkio.$(OBJ) $(C_) $(TESSERACTDIR)/src/lstm/networkio.cpp
 
+$(TESSOBJ)lstm_networkcache.$(OBJ) : $(TESSERACTDIR)/src/lstm/networkcache.cpp $(TESSDEPS)
+	$(TESSCXX) $(TESSO_)lstm_networkcache.$(OBJ) $(C_) $(TESSERACTDIR)/src/lstm/networkcache.cpp
+
 $(TESSOBJ)lstm_parallel.$(OBJ) : $(TESSERACTDIR)/src/lstm/parallel.cpp $(TESSDEPS)
 	$(TESSCXX) $(TESSO_)lstm_parallel.$(OBJ) $(C_) $(TESSERACTDIR)/src/lstm/parallel.cpp
 
@@ -895,12 +908,21 @@ $(TESSOBJ)lstm_tfnetwork.$(OBJ) : $(TESSERACTDIR)/src/lstm/tfnetwork.cpp $(TESSD
 $(TESSOBJ)lstm_weightmatrix.$(OBJ) : $(TESSERACTDIR)/src/lstm/weightmatrix.cpp $(TESSDEPS)
 	$(TESSCXX) $(TESSO_)lstm_weightmatrix.$(OBJ) $(C_) $(TESSERACTDIR)/src/lstm/weightmatrix.cpp
 
+$(TESSOBJ)arch_activationavx2.$(OBJ): $(TESSERACTDIR)/src/arch/activationavx2.cpp $(TESSDEPS)
+	$(TESSCXX) $(TESSAVX2) $(TESSO_)arch_activationavx2.$(OBJ) $(C_) $(TESSERACTDIR)/src/arch/activationavx2.cpp
+
+$(TESSOBJ)arch_activationavx512.$(OBJ): $(TESSERACTDIR)/src/arch/activationavx512.cpp $(TESSDEPS)
+	$(TESSCXX) $(TESSAVX512F) $(TESSO_)arch_activationavx512.$(OBJ) $(C_) $(TESSERACTDIR)/src/arch/activationavx512.cpp
+
 $(TESSOBJ)arch_dotproduct.$(OBJ) : $(TESSERACTDIR)/src/arch/dotproduct.cpp $(TESSDEPS)
 	$(TESSCXX) $(TESSO_)arch_dotproduct.$(OBJ) $(C_) $(TESSERACTDIR)/src/arch/dotproduct.cpp
 
 $(TESSOBJ)arch_dotproductavx.$(OBJ): $(TESSERACTDIR)/src/arch/dotproductavx.cpp $(TESSDEPS)
 	$(TESSCXX) $(TESSAVX) $(TESSO_)arch_dotproductavx.$(OBJ) $(C_) $(TESSERACTDIR)/src/arch/dotproductavx.cpp
 
+$(TESSOBJ)arch_dotproductavx512.$(OBJ): $(TESSERACTDIR)/src/arch/dotproductavx512.cpp $(TESSDEPS)
+	$(TESSCXX) $(TESSAVX512F) $(TESSO_)arch_dotproductavx512.$(OBJ) $(C_) $(TESSERACTDIR)/src/arch/dotproductavx512.cpp
+
 $(TESSOBJ)arch_dotproductfma.$(OBJ): $(TESSERACTDIR)/src/arch/dotproductfma.cpp $(TESSDEPS)
 	$(TESSCXX) $(TESSFMA) $(TESSO_)arch_dotproductfma.$(OBJ) $(C_) $(TESSERACTDIR)/src/arch/dotproductfma.cpp
 
@@ -910,6 +932,12 @@ $(TESSOBJ)arch_dotproductsse.$(OBJ): $(TESSERACTDIR)/src/arch/dotproductsse.cpp
 $(TESSOBJ)arch_intsimdmatrixavx2.$(OBJ): $(TESSERACTDIR)/src/arch/intsimdmatrixavx2.cpp $(TESSDEPS)
 	$(TESSCXX) $(TESSAVX2) $(TESSO_)arch_intsimdmatrixavx2.$(OBJ) $(C_) $(TESSERACTDIR)/src/arch/intsimdmatrixavx2.cpp
 
+$(TESSOBJ)arch_intsimdmatrixavx512vnni.$(OBJ): $(TESSERACTDIR)/src/arch/intsimdmatrixavx512vnni.cpp $(TESSDEPS)
+	$(TESSCXX) $(TESSAVX512VNNI) $(TESSO_)arch_intsimdmatrixavx512vnni.$(OBJ) $(C_) $(TESSERACTDIR)/src/arch/intsimdmatrixavx512vnni.cpp
+
+$(TESSOBJ)arch_intsimdmatrixavxvnni.$(OBJ): $(TESSERACTDIR)/src/arch/intsimdmatrixavxvnni.cpp $(TESSDEPS)
+	$(TESSCXX) $(TESSAVXVNNI) $(TESSO_)arch_intsimdmatrixavxvnni.$(OBJ) $(C_) $(TESSERACTDIR)/src/arch/intsimdmatrixavxvnni.cpp
+
 $(TESSOBJ)arch_intsimdmatrixsse.$(OBJ): $(TESSERACTDIR)/src/arch/intsimdmatrixsse.cpp $(TESSDEPS)
 	$(TESSCXX) $(TESSSSE41) $(TESSO_)arch_intsimdmatrixsse.$(OBJ) $(C_) $(TESSERACTDIR)/src/arch/intsimdmatrixsse.cpp
 
@@ -1050,7 +1078,9 @@ TESSERACT_OBJS_4=\
 	$(TESSOBJ)ccutil_strngs.$(OBJ)\
 	$(TESSOBJ)ccutil_scanutils.$(OBJ)\
 	$(TESSOBJ)ccutil_tessdatamanager.$(OBJ)\
+	$(TESSOBJ)ccutil_pagearena.$(OBJ)\
 	$(TESSOBJ)ccutil_tprintf.$(OBJ)\
+	$(TESSOBJ)ccutil_threadpool.$(OBJ)\
 	$(TESSOBJ)ccutil_unichar.$(OBJ)\
 	$(TESSOBJ)ccutil_unicharcompress.$(OBJ)\
 	$(TESSOBJ)ccutil_unicharmap.$(OBJ)\
@@ -1065,6 +1095,7 @@ TESSERACT_OBJS_4=\
 	$(TESSOBJ)lstm_maxpool.$(OBJ)\
 	$(TESSOBJ)lstm_network.$(OBJ)\
 	$(TESSOBJ)lstm_networkio.$(OBJ)\
+	$(TESSOBJ)lstm_networkcache.$(OBJ)\
 	$(TESSOBJ)lstm_parallel.$(OBJ)\
 	$(TESSOBJ)lstm_plumbing.$(OBJ)\
 	$(TESSOBJ)lstm_recodebeam.$(OBJ)\
@@ -1077,6 +1108,11 @@ TESSERACT_OBJS_4=\
 	$(TESSOBJ)arch_dotproduct.$(OBJ)\
 	$(TESSOBJ)arch_dotproductavx.$(OBJ)\
 	$(TESSOBJ)arch_intsimdmatrixavx2.$(OBJ)\
+	$(TESSOBJ)arch_activationavx2.$(OBJ)\
+	$(TESSOBJ)arch_dotproductavx512.$(OBJ)\
+	$(TESSOBJ)arch_activationavx512.$(OBJ)\
+	$(TESSOBJ)arch_intsimdmatrixavx512vnni.$(OBJ)\
+	$(TESSOBJ)arch_intsimdmatrixavxvnni.$(OBJ)\
 	$(TESSOBJ)arch_dotproductfma.$(OBJ)\
 	$(TESSOBJ)arch_dotproductsse.$(OBJ)\
 	$(TESSOBJ)arch_intsimdmatrixsse.$(OBJ)\
@@ -21,7 +21,10 @@
  * only makes calls when we're calling it, hence we use a leptonica_mem
  * global to store the current memory pointer in. This will clearly not
  * play nicely with multi-threaded use of Ghostscript, but that seems
- * unlikely with OCR.
+ * unlikely with OCR. Several APIs may be live at once (the pdfocr devices
+ * can run one per OCR thread), in which case they must all be given the
+ * same, non-gc (and hence thread safe), allocator; leptonica_users counts
+ * them, so the memory pointer is only reset when the last one finishes.
  *
  * Tesseract is trickier. For a start it uses new/delete/new[]/delete[]
  * rather than malloc free. That's OK, cos we can intercept this - see
@@ -38,6 +41,24 @@
  * that really needs to avoid malloc/free, then the section of code enclosed
  * in #ifdef TESSERACT_CUSTOM_ALLOCATOR at the end of this file can be used,
  * and tesseract_malloc/tesseract_free can be changed as required.
+ *
+ * Starting an engine means loading its traineddata, which can take longer
+ * than recognising a page, and the devices start one each time they are
+ * opened (the pdfwrite text OCR even starts one per glyph strip). So when
+ * ocr_fin_api is done with an engine we keep it, up to OCR_IDLE_MAX of
+ * them, on an idle list in the library context, and ocr_init_api hands it
+ * out again to the next caller that wants the same language and engine
+ * mode. What an engine learns from the pages it sees (the adaptive
+ * classifier, and the document dictionary) is cleared when it goes idle,
+ * so a reused engine gives the same results as a new one. The idle
+ * engines are ended when the library context is finalised.
+ *
+ * What does cost us is the churn of small objects within each page: the
+ * blobs, outlines, words and choices, and the list links that hold them,
+ * number in the millions. We build tesseract with TESSERACT_PAGE_ARENA and
+ * turn on tessedit_page_arena, so that those come from a per-page arena
+ * (see tesseract/src/ccutil/pagearena.h), which is reset when the page is
+ * cleared, rather than from malloc.
  */
 
 
@@ -52,6 +73,7 @@ extern "C"
 #include "gserrors.h"
 #include "gp.h"
 #include "gssprintf.h"
+#include "gslibctx.h"
 #include "gxiodev.h"
 #include "stream.h"
 #include <climits>
@@ -72,14 +94,19 @@ extern "C" void *leptonica_calloc(size_t numelm, size_t elemsize);
 extern "C" void *leptonica_realloc(void *ptr, size_t blocksize);
 extern "C" void leptonica_free(void *ptr);
 
-typedef struct
+typedef struct wrapped_api_s wrapped_api;
+struct wrapped_api_s
 {
     gs_memory_t *mem;
     tesseract::TessBaseAPI *api;
-} wrapped_api;
+    char *language;
+    int engine;
+    wrapped_api *next; /* on the idle list */
+};
 
 
 static gs_memory_t *leptonica_mem;
+static int leptonica_users = 0;
 
 void *leptonica_malloc(size_t size)
 {
@@ -282,6 +309,62 @@ tess_file_reader(const char *fname, std::vector<char> *out)
     return load_file(file, out);
 }
 
+/* The most engines we keep idle for reuse. */
+#define OCR_IDLE_MAX 4
+
+/* Ends an engine, and frees its wrapper. */
+static void
+ocr_end_api(wrapped_api *wrapped)
+{
+    if (wrapped->api) {
+        wrapped->api->End();
+        delete wrapped->api;
+    }
+    gs_free_object(wrapped->mem, wrapped->language, "ocr_end_api");
+    gs_free_object(wrapped->mem, wrapped, "ocr_end_api");
+    if (--leptonica_users == 0) {
+        leptonica_mem = NULL;
+        setPixMemoryManager(malloc, free);
+    }
+}
+
+/* Ends the idle engines, when the library context is finalised. */
+static void
+ocr_idle_fin(gs_memory_t *mem)
+{
+    gs_lib_ctx_t *ctx = mem->gs_lib_ctx;
+    wrapped_api *wrapped;
+
+    while ((wrapped = (wrapped_api *)ctx->ocr_private) != NULL) {
+        ctx->ocr_private = wrapped->next;
+        ocr_end_api(wrapped);
+    }
+    ctx->ocr_private_fin = NULL;
+}
+
+/* Takes an idle engine for language and engine off the idle list, if
+ * there is one. */
+static wrapped_api *
+ocr_take_idle(gs_memory_t *mem, const char *language, int engine)
+{
+    gs_lib_ctx_t *ctx = mem->gs_lib_ctx;
+    wrapped_api *wrapped, *prev = NULL;
+
+    for (wrapped = (wrapped_api *)ctx->ocr_private; wrapped != NULL;
+         prev = wrapped, wrapped = wrapped->next) {
+        if (wrapped->mem == mem && wrapped->engine == engine &&
+            strcmp(wrapped->language, language) == 0) {
+            if (prev)
+                prev->next = wrapped->next;
+            else
+                ctx->ocr_private = wrapped->next;
+            wrapped->next = NULL;
+            return wrapped;
+        }
+    }
+    return NULL;
+}
+
 int
 ocr_init_api(gs_memory_t *mem, const char *language, int engine, void **state)
 {
@@ -294,26 +377,38 @@ ocr_init_api(gs_memory_t *mem, const char *language, int engine, void **state)
         return_error(gs_error_unknownerror);
     }
 
+    *state = NULL;
+
+    if (language == NULL || language[0] == 0) {
+        language = "eng";
+    }
+
+    wrapped = ocr_take_idle(mem, language, engine);
+    if (wrapped != NULL) {
+        *state = (void *)wrapped;
+        return 0;
+    }
+
     wrapped = (wrapped_api *)(void *)gs_alloc_bytes(mem, sizeof(*wrapped), "ocr_init_api");
     if (wrapped == NULL)
         return gs_error_VMerror;
 
-    leptonica_mem = mem;
-    setPixMemoryManager(leptonica_malloc, leptonica_free);
+    if (leptonica_users++ == 0) {
+        leptonica_mem = mem;
+        setPixMemoryManager(leptonica_malloc, leptonica_free);
+    }
 
     wrapped->mem = mem;
+    wrapped->engine = engine;
+    wrapped->next = NULL;
+    wrapped->language = (char *)gs_alloc_bytes(mem, strlen(language) + 1, "ocr_init_api");
     wrapped->api = new tesseract::TessBaseAPI();
 
-    *state = NULL;
-
-    if (wrapped->api == NULL) {
+    if (wrapped->language == NULL || wrapped->api == NULL) {
         code = gs_error_VMerror;
         goto fail;
     }
-
-    if (language == NULL || language[0] == 0) {
-        language = "eng";
-    }
+    strcpy(wrapped->language, language);
 
     switch (engine)
     {
@@ -345,17 +440,13 @@ ocr_init_api(gs_memory_t *mem, const char *language, int engine, void **state)
         code = gs_error_unknownerror;
         goto fail;
     }
+    wrapped->api->SetVariable("tessedit_page_arena", "1");
 
     *state = (void *)wrapped;
 
     return 0;
 fail:
-    if (wrapped->api) {
-        delete wrapped->api;
-    }
-    leptonica_mem = NULL;
-    setPixMemoryManager(malloc, free);
-    gs_free_object(wrapped->mem, wrapped, "ocr_init_api");
+    ocr_end_api(wrapped);
     return_error(code);
 }
 
@@ -363,19 +454,58 @@ void
 ocr_fin_api(gs_memory_t *mem, void *api_)
 {
     wrapped_api *wrapped = (wrapped_api *)api_;
+    gs_lib_ctx_t *ctx;
+    wrapped_api *idle;
+    int count = 0;
 
     if (wrapped == NULL)
         return;
 
-    if (wrapped->api) {
-        wrapped->api->End();
-        delete wrapped->api;
+    /* Keep the engine for reuse, unless we have enough of them. */
+    ctx = wrapped->mem->gs_lib_ctx;
+    for (idle = (wrapped_api *)ctx->ocr_private; idle != NULL; idle = idle->next)
+        count++;
+    if (count < OCR_IDLE_MAX) {
+#ifndef DISABLED_LEGACY_ENGINE
+        if (wrapped->engine != OCR_ENGINE_LSTM)
+            wrapped->api->ClearAdaptiveClassifier();
+#endif
+        wrapped->api->Clear();
+        wrapped->next = (wrapped_api *)ctx->ocr_private;
+        ctx->ocr_private = wrapped;
+        ctx->ocr_private_fin = ocr_idle_fin;
+        return;
+    }
+    ocr_end_api(wrapped);
+}
+
+/* Convert a row of 8 bit grey from gs byte order to leptonica's word order,
+ * in place. The row must have room for w rounded up to a multiple of 4
+ * bytes; the pixels after the first w are set to white. */
+void
+ocr_pix_row(void *row, int w)
+{
+    byte *b = (byte *)row;
+    int w4 = (w+3)&~3;
+    int x;
+
+    for (x = w; x < w4; x++)
+        b[x] = 0xFF;
+#ifdef L_LITTLE_ENDIAN
+    for (x = 0; x < w4; x += 4) {
+        byte t = b[x];
+        b[x] = b[x+3];
+        b[x+3] = t;
+        t = b[x+1];
+        b[x+1] = b[x+2];
+        b[x+2] = t;
     }
-    gs_free_object(wrapped->mem, wrapped, "ocr_fin_api");
-    leptonica_mem = NULL;
-    setPixMemoryManager(malloc, free);
+#endif
 }
 
+/* Give Tesseract a Pix header around data, which it reads where it is
+ * rather than taking its own copy; the data must be left alone until
+ * ocr_clear_image. */
 static Pix *
 ocr_set_image(tesseract::TessBaseAPI *api,
               int w, int h, void *data, int xres, int yres)
@@ -388,15 +518,18 @@ ocr_set_image(tesseract::TessBaseAPI *api,
     pixSetPadBits(image, 1);
     pixSetXRes(image, xres);
     pixSetYRes(image, yres);
-    api->SetImage(image);
+    api->SetImageBorrowed(image);
     //pixWrite("test.pnm", image, IFF_PNM);
 
     return image;
 }
 
+/* Make Tesseract let go of the image, and free the header (but not the
+ * data) given to it by ocr_set_image. */
 static void
-ocr_clear_image(Pix *image)
+ocr_clear_image(tesseract::TessBaseAPI *api, Pix *image)
 {
+    api->Clear();
     pixSetData(image, NULL);
     pixDestroy(&image);
 }
@@ -414,12 +547,12 @@ do_ocr_image(wrapped_api *wrapped,
 
     *out = NULL;
 
-    if (bpp == 8)
+    if (bpp == OCR_IMAGE_GREY)
         w = convert2pix((l_uint32 *)data, w, h, raster);
 
     image = ocr_set_image(wrapped->api, w, h, data, xres, yres);
     if (image == NULL) {
-        if (restore && bpp == 8)
+        if (restore && bpp == OCR_IMAGE_GREY)
             convert2pix((l_uint32 *)data, w, h, raster);
         return_error(gs_error_VMerror);
     }
@@ -434,10 +567,10 @@ do_ocr_image(wrapped_api *wrapped,
     else
         outText = wrapped->api->GetUTF8Text();
 
-    ocr_clear_image(image);
+    ocr_clear_image(wrapped->api, image);
 
     /* Convert the image back. */
-    if (restore && bpp == 8)
+    if (restore && bpp == OCR_IMAGE_GREY)
         w = convert2pix((l_uint32 *)data, w, h, raster);
 
     // Copy the results into a gs controlled block.
@@ -543,7 +676,7 @@ ocr_recognise(void *api_, int w, int h, void *data,
         code = code;
     }
 
-    ocr_clear_image(image);
+    ocr_clear_image(wrapped->api, image);
 
     return code;
 }
@@ -595,7 +728,7 @@ ocr_set_bitmap(wrapped_api *wrapped,
         d += r;
     }
 
-    wrapped->api->SetImage(image);
+    wrapped->api->SetImageBorrowed(image);
 //    pixWrite("test.pnm", image, IFF_PNM);
 
     return image;
@@ -604,6 +737,7 @@ ocr_set_bitmap(wrapped_api *wrapped,
 static void
 ocr_clear_bitmap(wrapped_api *wrapped, Pix *image)
 {
+    wrapped->api->Clear();
     gs_free_object(wrapped->mem, pixGetData(image), "ocr_clear_bitmap");
     pixSetData(image, NULL);
     pixDestroy(&image);
@@ -29,6 +29,22 @@ enum
     OCR_ENGINE_BOTH = 3
 };
 
+/* The format of the data given to ocr_image_to_utf8 and ocr_image_to_hocr,
+ * passed as bpp. OCR_IMAGE_GREY is 8 bit grey in ghostscript's byte order,
+ * which is converted to leptonica's in place (and back again afterwards if
+ * restore is set). OCR_IMAGE_PIX_GREY is 8 bit grey with rows of w rounded
+ * up to a multiple of 4 bytes, each made with ocr_pix_row, which Tesseract
+ * reads where it is. ocr_recognise always takes OCR_IMAGE_PIX_GREY data. */
+enum
+{
+    OCR_IMAGE_GREY = 8,
+    OCR_IMAGE_PIX_GREY = 9
+};
+
+/* Converts a row of w 8 bit grey pixels to the layout of OCR_IMAGE_PIX_GREY,
+ * in place. The row must have room for w rounded up to a multiple of 4. */
+void ocr_pix_row(void *row, int w);
+
 int ocr_init_api(gs_memory_t  *mem,
            const char         *language,
 		 int           engine,
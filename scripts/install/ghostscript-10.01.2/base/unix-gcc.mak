@@ -534,7 +534,7 @@ RESOURCE_LIST=Resource/CMap/ Resource/ColorSpace/ Resource/Decoding/ Resource/Fo
 BAND_LIST_STORAGE=file
 
 # Choose which compression method to use when storing band lists in memory.
-# The choices are 'lzw' or 'zlib'.
+# The choices are 'zlib' or 'lz4': lz4 is much faster, but compresses less.
 
 BAND_LIST_COMPRESSOR=zlib
 
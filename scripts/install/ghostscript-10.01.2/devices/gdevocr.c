@@ -237,7 +237,7 @@ do_ocr_print_page(gx_device_ocr * pdev, gp_file * file, int hocr)
     int factor = pdev->downscale.downscale_factor;
     int height = gx_downscaler_scale(pdev->height, factor);
     int width = gx_downscaler_scale(pdev->width, factor);
-    int raster = bitmap_raster(width*8);
+    int raster = (width+3)&~3;
     gx_downscaler_t ds;
     int code;
 
@@ -260,8 +260,12 @@ do_ocr_print_page(gx_device_ocr * pdev, gp_file * file, int hocr)
         goto done;
     }
 
+    /* Put each row into Tesseract's layout while it is still in the cache,
+     * so that the page can be handed over as it is. */
     for (row = 0; row < height && code >= 0; row++) {
         code = gx_downscaler_getbits(&ds, data + row * raster, row);
+        if (code >= 0)
+            ocr_pix_row(data + row * raster, width);
     }
     gx_downscaler_fin(&ds);
     if (code < 0)
@@ -270,7 +274,7 @@ do_ocr_print_page(gx_device_ocr * pdev, gp_file * file, int hocr)
     if (hocr)
         code = ocr_image_to_hocr(pdev->api,
                                  width, height,
-                                 8, raster,
+                                 OCR_IMAGE_PIX_GREY, raster,
                                  (int)pdev->HWResolution[0],
                                  (int)pdev->HWResolution[1],
                                  data, 0, pdev->page_count,
@@ -278,7 +282,7 @@ do_ocr_print_page(gx_device_ocr * pdev, gp_file * file, int hocr)
     else
         code = ocr_image_to_utf8(pdev->api,
                                  width, height,
-                                 8, raster,
+                                 OCR_IMAGE_PIX_GREY, raster,
                                  (int)pdev->HWResolution[0],
                                  (int)pdev->HWResolution[1],
                                  data, 0, &out);
@@ -398,6 +398,51 @@ encode(gx_device *pdev, stream **s, const stream_template *t, gs_memory_t *mem)
     return 0;
 }
 
+/* Writes the page content stream, its length and the page dictionary, for
+ * a page whose image has already been written.
+ */
+int
+pdf_image_write_page_contents(gx_device_pdf_image *pdf_dev, pdfimage_page *page)
+{
+    char Buffer[1024];
+    stream *s = pdf_dev->strm;
+    gs_offset_t stream_pos = 0;
+    gs_offset_t len;
+    int code = 0;
+
+    page->PageStreamOffset = stell(pdf_dev->strm);
+    pprintd1(pdf_dev->strm, "%d 0 obj\n", page->PageStreamObjectNumber);
+    pprintd1(pdf_dev->strm, "<<\n/Filter/FlateDecode/Length %d 0 R\n>>\nstream\n", page->PageLengthObjectNumber);
+    stream_pos = stell(pdf_dev->strm);
+    encode((gx_device *)pdf_dev, &pdf_dev->strm, &s_zlibE_template, pdf_dev->memory->non_gc_memory);
+    if (pdf_dev->ocr.end_page)
+        stream_puts(pdf_dev->strm, "q\n");
+    pprintd2(pdf_dev->strm, "%d 0 0 %d 0 0 cm\n/Im1 Do", page->ScaledWidth, page->ScaledHeight);
+    if (pdf_dev->ocr.end_page) {
+        stream_puts(pdf_dev->strm, "\nQ");
+        code = pdf_dev->ocr.end_page(pdf_dev);
+    }
+    s_close_filters(&pdf_dev->strm, s);
+    len = stell(pdf_dev->strm) - stream_pos;
+    stream_puts(pdf_dev->strm, "\nendstream\nendobj\n");
+
+    page->PageLengthOffset = stell(pdf_dev->strm);
+    pprintd2(pdf_dev->strm, "%d 0 obj\n%d\nendobj\n", page->PageLengthObjectNumber, len);
+
+    page->PageDictOffset = stell(pdf_dev->strm);
+    pprintd1(pdf_dev->strm, "%d 0 obj\n", page->PageDictObjectNumber);
+    pprintd1(pdf_dev->strm, "<<\n/Contents %d 0 R\n", page->PageStreamObjectNumber);
+    stream_puts(pdf_dev->strm, "/Type /Page\n/Parent 2 0 R\n");
+    gs_snprintf(Buffer, sizeof(Buffer), "/MediaBox [0 0 %f %f]\n", page->MediaWidth, page->MediaHeight);
+    stream_puts(pdf_dev->strm, Buffer);
+    pprintd1(pdf_dev->strm, "/Resources <<\n/XObject <<\n/Im1 %d 0 R\n>>\n", page->ImageObjectNumber);
+    if (pdf_dev->ocr.file_init)
+        pprintd1(pdf_dev->strm, "/Font <<\n/Ft0 %d 0 R\n>>\n", PDFIMG_STATIC_OBJS);
+    stream_puts(pdf_dev->strm, ">>\n>>\nendobj\n");
+
+    return code;
+}
+
 static int
 pdf_image_downscale_and_print_page(gx_device_printer *dev,
                                    gx_downscaler_params *params,
@@ -415,9 +460,7 @@ pdf_image_downscale_and_print_page(gx_device_printer *dev,
     gx_downscaler_t ds;
     gs_offset_t stream_pos = 0;
     pdfimage_page *page = pdf_dev->Pages;
-    char Buffer[1024];
     stream *s = pdf_dev->strm;
-    gs_offset_t len;
 
     if (page == NULL)
         return_error(gs_error_undefined);
@@ -548,37 +591,14 @@ pdf_image_downscale_and_print_page(gx_device_printer *dev,
     pprintd1(pdf_dev->strm, "%d\n", page->LengthOffset - stream_pos - 18); /* 18 is the length of \nendstream\nendobj\n we need to take that off for the stream length */
     stream_puts(pdf_dev->strm, "endobj\n");
 
-    page->PageStreamOffset = stell(pdf_dev->strm);
-    pprintd1(pdf_dev->strm, "%d 0 obj\n", page->PageStreamObjectNumber);
-    pprintd1(pdf_dev->strm, "<<\n/Filter/FlateDecode/Length %d 0 R\n>>\nstream\n", page->PageLengthObjectNumber);
-    stream_pos = stell(pdf_dev->strm);
-    encode((gx_device *)pdf_dev, &pdf_dev->strm, &s_zlibE_template, pdf_dev->memory->non_gc_memory);
-    if (pdf_dev->ocr.end_page)
-        stream_puts(pdf_dev->strm, "q\n");
-    pprintd2(pdf_dev->strm, "%d 0 0 %d 0 0 cm\n/Im1 Do",
-             (int)((width / (pdf_dev->HWResolution[0] / 72)) * factor),
-             (int)((height / (pdf_dev->HWResolution[1] / 72)) * factor));
-    if (pdf_dev->ocr.end_page) {
-        stream_puts(pdf_dev->strm, "\nQ");
-        pdf_dev->ocr.end_page(pdf_dev);
-    }
-    s_close_filters(&pdf_dev->strm, s);
-    len = stell(pdf_dev->strm) - stream_pos;
-    stream_puts(pdf_dev->strm, "\nendstream\nendobj\n");
-
-    page->PageLengthOffset = stell(pdf_dev->strm);
-    pprintd2(pdf_dev->strm, "%d 0 obj\n%d\nendobj\n", page->PageLengthObjectNumber, len);
-
-    page->PageDictOffset = stell(pdf_dev->strm);
-    pprintd1(pdf_dev->strm, "%d 0 obj\n", page->PageDictObjectNumber);
-    pprintd1(pdf_dev->strm, "<<\n/Contents %d 0 R\n", page->PageStreamObjectNumber);
-    stream_puts(pdf_dev->strm, "/Type /Page\n/Parent 2 0 R\n");
-    gs_snprintf(Buffer, sizeof(Buffer), "/MediaBox [0 0 %f %f]\n", ((double)pdf_dev->width / pdf_dev->HWResolution[0]) * 72, ((double)pdf_dev->height / pdf_dev->HWResolution[1]) * 72);
-    stream_puts(pdf_dev->strm, Buffer);
-    pprintd1(pdf_dev->strm, "/Resources <<\n/XObject <<\n/Im1 %d 0 R\n>>\n", page->ImageObjectNumber);
-    if (pdf_dev->ocr.file_init)
-        pprintd1(pdf_dev->strm, "/Font <<\n/Ft0 %d 0 R\n>>\n", PDFIMG_STATIC_OBJS);
-    stream_puts(pdf_dev->strm, ">>\n>>\nendobj\n");
+    page->ScaledWidth = (int)((width / (pdf_dev->HWResolution[0] / 72)) * factor);
+    page->ScaledHeight = (int)((height / (pdf_dev->HWResolution[1] / 72)) * factor);
+    page->MediaWidth = ((double)pdf_dev->width / pdf_dev->HWResolution[0]) * 72;
+    page->MediaHeight = ((double)pdf_dev->height / pdf_dev->HWResolution[1]) * 72;
+    if (pdf_dev->ocr.defer_page)
+        code = pdf_dev->ocr.defer_page(pdf_dev, page);
+    else
+        code = pdf_image_write_page_contents(pdf_dev, page);
 
     gx_downscaler_fin(&ds);
     gs_free_object(dev->memory, data, "pdf_image_print_page(data)");
@@ -698,6 +718,12 @@ static int pdf_image_finish_file(gx_device_pdf_image *pdf_dev, int PCLm)
     if (pdf_dev->strm != NULL) {
         byte fileID[16];
 
+        if (pdf_dev->ocr.flush) {
+            int code = pdf_dev->ocr.flush(pdf_dev);
+            if (code < 0)
+                return code;
+        }
+
         pdf_store_default_Producer(Producer);
 
         pdf_dev->RootOffset = stell(pdf_dev->strm);
@@ -42,6 +42,12 @@ typedef struct pdfimage_page_s {
     gs_offset_t PageDictOffset;
     int PageLengthObjectNumber;
     gs_offset_t PageLengthOffset;
+    /* Recorded with the image, for writing the page contents (which
+     * may happen later, see ocr.defer_page below). */
+    int ScaledWidth;
+    int ScaledHeight;
+    double MediaWidth;
+    double MediaHeight;
     void *next;
 } pdfimage_page;
 
@@ -92,20 +98,21 @@ typedef struct gx_device_pdf_image_s {
         int y;
         int xres;
         int yres;
-        float cur_x;
-        float cur_y;
-        float cur_size;
-        float cur_scale;
-        float wordbox[4];
-        int *word_chars;
-        int word_len;
-        int word_max;
         void *data;
+        /* Number of threads to run the OCR in the background, 0 to run
+         * it as each page is printed. */
+        int threads;
+        void *pipeline;
         /* Write the font definition. */
         int (*file_init)(struct gx_device_pdf_image_s *dev);
         int (*begin_page)(struct gx_device_pdf_image_s *dev, int w, int h, int bpp);
         void (*line)(struct gx_device_pdf_image_s *dev, void *row);
         int (*end_page)(struct gx_device_pdf_image_s *dev);
+        /* If set, takes the page once its image has been written, and
+         * writes its contents later, once the OCR is done. */
+        int (*defer_page)(struct gx_device_pdf_image_s *dev, pdfimage_page *page);
+        /* Write the contents of any deferred pages. */
+        int (*flush)(struct gx_device_pdf_image_s *dev);
     } ocr;
 } gx_device_pdf_image;
 
@@ -118,5 +125,6 @@ int pdf_image_get_params_downscale(gx_device * dev, gs_param_list * plist);
 int pdf_image_get_params_downscale_cmyk(gx_device * dev, gs_param_list * plist);
 int pdf_image_get_params_downscale_cmyk_ets(gx_device * dev, gs_param_list * plist);
 dev_proc_print_page(pdf_image_print_page);
+int pdf_image_write_page_contents(gx_device_pdf_image *pdf_dev, pdfimage_page *page);
 
 #endif
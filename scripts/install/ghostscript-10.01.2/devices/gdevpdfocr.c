@@ -29,6 +29,7 @@
 #include "srlx.h"
 #include "gsicc_cache.h"
 #include "sjpeg.h"
+#include "gxsync.h"
 
 #include "gdevpdfimg.h"
 #include "tessocr.h"
@@ -46,7 +47,7 @@ pdfocr_put_some_params(gx_device * dev, gs_param_list * plist)
     gs_param_string langstr;
     const char *param_name;
     size_t len;
-    int engine;
+    int engine, threads;
 
     switch (code = param_read_string(plist, (param_name = "OCRLanguage"), &langstr)) {
         case 0:
@@ -74,6 +75,22 @@ pdfocr_put_some_params(gx_device * dev, gs_param_list * plist)
             param_signal_error(plist, param_name, ecode);
     }
 
+    switch (code = param_read_int(plist, (param_name = "OCRThreads"), &threads)) {
+        case 0:
+            if (threads < 0) {
+                ecode = gs_note_error(gs_error_rangecheck);
+                param_signal_error(plist, param_name, ecode);
+                break;
+            }
+            pdf_dev->ocr.threads = threads;
+            break;
+        case 1:
+            break;
+        default:
+            ecode = code;
+            param_signal_error(plist, param_name, ecode);
+    }
+
     return code;
 }
 
@@ -118,6 +135,9 @@ pdfocr_get_some_params(gx_device * dev, gs_param_list * plist)
     if ((code = param_write_int(plist, "OCREngine", &pdf_dev->ocr.engine)) < 0)
         ecode = code;
 
+    if ((code = param_write_int(plist, "OCRThreads", &pdf_dev->ocr.threads)) < 0)
+        ecode = code;
+
     return ecode;
 }
 
@@ -408,10 +428,13 @@ static const char funky_font6a[] =
 static const char funky_font6b[] =
 "endstream\nendobj\n";
 
+static int ocr_start_pipeline(gx_device_pdf_image *dev, const char *language);
+
 static int
 ocr_file_init(gx_device_pdf_image *dev)
 {
     const char *language = dev->ocr.language;
+    int code;
     if (language == NULL || language[0] == 0)
         language = "eng";
 
@@ -432,7 +455,14 @@ ocr_file_init(gx_device_pdf_image *dev)
     stream_write(dev->strm, funky_font6a, sizeof(funky_font6a));
     stream_write(dev->strm, funky_font6b, sizeof(funky_font6b)-1);
 
-    return ocr_init_api(dev->memory->non_gc_memory, language, dev->ocr.engine, &dev->ocr.state);
+    code = ocr_init_api(dev->memory->non_gc_memory, language, dev->ocr.engine, &dev->ocr.state);
+    if (code < 0)
+        return code;
+
+    if (dev->ocr.threads > 0 && dev->ocr.pipeline == NULL)
+        code = ocr_start_pipeline(dev, language);
+
+    return code;
 }
 
 static void
@@ -508,14 +538,133 @@ ocr_line32(gx_device_pdf_image *dev, void *row)
 #endif
 }
 
+/* The state for recognising one page, and turning the results into the
+ * invisible text for its content stream. When the OCR runs as each page is
+ * printed, the text goes straight into the page stream, otherwise it is
+ * collected in buf until the page contents are written.
+ */
+typedef struct ocr_page_s ocr_page_t;
+struct ocr_page_s {
+    gs_memory_t *memory;
+    int w;
+    int h;
+    int xres;
+    int yres;
+    int factor;
+    void *data;
+    float cur_size;
+    float cur_scale;
+    float wordbox[4];
+    int *word_chars;
+    int word_len;
+    int word_max;
+    stream *strm;
+    char *buf;
+    size_t buf_len;
+    size_t buf_max;
+    int code;
+    /* The rest is only used by the pipeline */
+    pdfimage_page *page;
+    bool done;
+    ocr_page_t *next_queued;
+    ocr_page_t *next_output;
+};
+
+/* When OCRThreads is set, each page's raster is handed to a queue, and the
+ * worker threads (each with its own Tesseract instance) recognise them while
+ * the following pages are interpreted and rendered. The page images are
+ * written as normal, but the content streams are written in page order as
+ * the OCR for each page completes, and at the latest at the end of the file.
+ * The queue is bounded, so that we don't hold the rasters of more than
+ * OCR_PAGES_PER_THREAD pages per thread.
+ */
+#define OCR_PAGES_PER_THREAD 2
+
+typedef struct ocr_pipeline_s ocr_pipeline_t;
+
+typedef struct ocr_worker_s {
+    ocr_pipeline_t *pipe;
+    void *state;
+    gp_thread_id thread;
+} ocr_worker_t;
+
+struct ocr_pipeline_s {
+    gs_memory_t *memory;        /* non-gc, so can be used from the workers */
+    gx_monitor_t *lock;         /* protects the queue and the done flags */
+    gx_semaphore_t *work;       /* signalled for each page queued, and to quit */
+    gx_semaphore_t *done;       /* signalled for each page recognised */
+    ocr_page_t *queue_head;     /* pages waiting for a worker */
+    ocr_page_t *queue_tail;
+    ocr_page_t *output_head;    /* pages waiting to be written, in page order */
+    ocr_page_t *output_tail;
+    ocr_page_t *filling;        /* the page currently being printed */
+    ocr_page_t *writing;        /* the page whose contents are being written */
+    int outstanding;            /* length of the output list */
+    int num_workers;
+    ocr_worker_t *workers;
+};
+
+static void
+ocr_puts(ocr_page_t *page, const char *str)
+{
+    size_t len = strlen(str);
+
+    if (page->strm) {
+        stream_puts(page->strm, str);
+        return;
+    }
+    if (page->buf_len + len > page->buf_max) {
+        size_t newmax = page->buf_max * 2;
+        char *newbuf;
+
+        if (newmax < page->buf_len + len)
+            newmax = page->buf_len + len + 1024;
+        newbuf = (char *)gs_alloc_bytes(page->memory, newmax, "ocr_puts");
+        if (newbuf == NULL) {
+            page->code = gs_note_error(gs_error_VMerror);
+            return;
+        }
+        if (page->buf_len > 0)
+            memcpy(newbuf, page->buf, page->buf_len);
+        gs_free_object(page->memory, page->buf, "ocr_puts");
+        page->buf = newbuf;
+        page->buf_max = newmax;
+    }
+    memcpy(page->buf + page->buf_len, str, len);
+    page->buf_len += len;
+}
+
 static int
 ocr_begin_page(gx_device_pdf_image *dev, int w, int h, int bpp)
 {
     int raster = (w+3)&~3;
+    ocr_pipeline_t *pipe = (ocr_pipeline_t *)dev->ocr.pipeline;
 
-    dev->ocr.data = gs_alloc_bytes(dev->memory, raster * h, "ocr_begin_page");
-    if (dev->ocr.data == NULL)
-        return_error(gs_error_VMerror);
+    if (pipe) {
+        ocr_page_t *page;
+
+        page = (ocr_page_t *)gs_alloc_bytes(pipe->memory, sizeof(*page), "ocr_begin_page");
+        if (page == NULL)
+            return_error(gs_error_VMerror);
+        memset(page, 0, sizeof(*page));
+        page->memory = pipe->memory;
+        page->data = gs_alloc_bytes(pipe->memory, raster * h, "ocr_begin_page");
+        if (page->data == NULL) {
+            gs_free_object(pipe->memory, page, "ocr_begin_page");
+            return_error(gs_error_VMerror);
+        }
+        page->w = w;
+        page->h = h;
+        page->xres = dev->ocr.xres;
+        page->yres = dev->ocr.yres;
+        page->factor = dev->downscale.downscale_factor;
+        pipe->filling = page;
+        dev->ocr.data = page->data;
+    } else {
+        dev->ocr.data = gs_alloc_bytes(dev->memory, raster * h, "ocr_begin_page");
+        if (dev->ocr.data == NULL)
+            return_error(gs_error_VMerror);
+    }
     dev->ocr.w = w;
     dev->ocr.h = h;
     dev->ocr.y = 0;
@@ -531,38 +680,38 @@ ocr_begin_page(gx_device_pdf_image *dev, int w, int h, int bpp)
 }
 
 static void
-flush_word(gx_device_pdf_image *dev)
+flush_word(ocr_page_t *page)
 {
     char buffer[1024];
     float size, scale;
-    float *bbox = dev->ocr.wordbox;
+    float *bbox = page->wordbox;
     int i, len;
 
-    len = dev->ocr.word_len;
+    len = page->word_len;
     if (len == 0)
         return;
 
     size = bbox[3]-bbox[1];
-    if (dev->ocr.cur_size != size) {
+    if (page->cur_size != size) {
         gs_snprintf(buffer, sizeof(buffer), "/Ft0 %.3f Tf", size);
-        stream_puts(dev->strm, buffer);
-        dev->ocr.cur_size = size;
+        ocr_puts(page, buffer);
+        page->cur_size = size;
     }
     scale = (bbox[2]-bbox[0]) / size / len * 200;
-    if (dev->ocr.cur_scale != scale) {
+    if (page->cur_scale != scale) {
         gs_snprintf(buffer, sizeof(buffer), " %.3f Tz", scale);
-        stream_puts(dev->strm, buffer);
-        dev->ocr.cur_scale = scale;
+        ocr_puts(page, buffer);
+        page->cur_scale = scale;
     }
     gs_snprintf(buffer, sizeof(buffer), " 1 0 0 1 %.3f %.3f Tm[<", bbox[0], bbox[1]);
-    stream_puts(dev->strm, buffer);
+    ocr_puts(page, buffer);
     for (i = 0; i < len; i++) {
-        gs_snprintf(buffer, sizeof(buffer), "%04x", dev->ocr.word_chars[i]);
-        stream_puts(dev->strm, buffer);
+        gs_snprintf(buffer, sizeof(buffer), "%04x", page->word_chars[i]);
+        ocr_puts(page, buffer);
     }
-    stream_puts(dev->strm, ">]TJ\n");
+    ocr_puts(page, ">]TJ\n");
 
-    dev->ocr.word_len = 0;
+    page->word_len = 0;
 }
 
 static int
@@ -570,12 +719,11 @@ ocr_callback(void *arg, const char *rune_,
              const int *line_bbox, const int *word_bbox,
              const int *char_bbox, int pointsize)
 {
-    gx_device_pdf_image *ppdev = (gx_device_pdf_image *)arg;
+    ocr_page_t *page = (ocr_page_t *)arg;
     int unicode;
     const unsigned char *rune = (const unsigned char *)rune_;
     float bbox[4];
-    int factor = ppdev->downscale.downscale_factor;
-    float scale = 72000000.0f / gx_downscaler_scale(1000000, factor);
+    float scale = 72000000.0f / gx_downscaler_scale(1000000, page->factor);
 
     if (rune[0] >= 0xF8)
         return 0; /* Illegal */
@@ -594,110 +742,332 @@ ocr_callback(void *arg, const char *rune_,
         }
     }
 
-#if 0
-    // First attempt; match char bboxes exactly. This is bad, as the
-    // bboxes given back from tesseract are 'untrustworthy' to say the
-    // least (they overlap one another in strange ways). Trying to
-    // match those causes the font height to change repeatedly, and
-    // gives output that's hard to identify words in.
-    bbox[0] = char_bbox[0] * 72.0 / ppdev->ocr.xres;
-    bbox[1] = (ppdev->ocr.h-1 - char_bbox[3]) * 72.0 / ppdev->ocr.yres;
-    bbox[2] = char_bbox[2] * 72.0 / ppdev->ocr.xres;
-    bbox[3] = (ppdev->ocr.h-1 - char_bbox[1]) * 72.0 / ppdev->ocr.yres;
-
-    size = bbox[3]-bbox[1];
-    if (ppdev->ocr.cur_size != size) {
-        gs_snprintf(buffer, sizeof(buffer), "/Ft0 %f Tf ", size);
-        stream_puts(ppdev->strm, buffer);
-        ppdev->ocr.cur_size = size;
-    }
-    scale = (bbox[2]-bbox[0]) / size * 200;
-    if (ppdev->ocr.cur_scale != scale) {
-        gs_snprintf(buffer, sizeof(buffer), " %f Tz ", scale);
-        stream_puts(ppdev->strm, buffer);
-        ppdev->ocr.cur_scale = scale;
-    }
-    gs_snprintf(buffer, sizeof(buffer), "1 0 0 1 %f %f Tm ", bbox[0], bbox[1]);
-    stream_puts(ppdev->strm, buffer);
-    gs_snprintf(buffer, sizeof(buffer), "<%04x>Tj\n", unicode);
-    stream_puts(ppdev->strm, buffer);
-#else
-    bbox[0] = word_bbox[0] * scale / ppdev->ocr.xres;
-    bbox[1] = (ppdev->ocr.h-1 - line_bbox[3]) * scale / ppdev->ocr.yres;
-    bbox[2] = word_bbox[2] * scale / ppdev->ocr.xres;
-    bbox[3] = (ppdev->ocr.h-1 - line_bbox[1]) * scale / ppdev->ocr.yres;
+    /* Matching the char bboxes exactly gives bad results, as the bboxes
+     * given back from tesseract are 'untrustworthy' to say the least (they
+     * overlap one another in strange ways). Trying to match those causes
+     * the font height to change repeatedly, and gives output that's hard
+     * to identify words in. So we use the word bboxes instead. */
+    bbox[0] = word_bbox[0] * scale / page->xres;
+    bbox[1] = (page->h-1 - line_bbox[3]) * scale / page->yres;
+    bbox[2] = word_bbox[2] * scale / page->xres;
+    bbox[3] = (page->h-1 - line_bbox[1]) * scale / page->yres;
 
     /* If the word bbox differs, flush the word. */
-    if (bbox[0] != ppdev->ocr.wordbox[0] ||
-        bbox[1] != ppdev->ocr.wordbox[1] ||
-        bbox[2] != ppdev->ocr.wordbox[2] ||
-        bbox[3] != ppdev->ocr.wordbox[3]) {
-        flush_word(ppdev);
-        ppdev->ocr.wordbox[0] = bbox[0];
-        ppdev->ocr.wordbox[1] = bbox[1];
-        ppdev->ocr.wordbox[2] = bbox[2];
-        ppdev->ocr.wordbox[3] = bbox[3];
+    if (bbox[0] != page->wordbox[0] ||
+        bbox[1] != page->wordbox[1] ||
+        bbox[2] != page->wordbox[2] ||
+        bbox[3] != page->wordbox[3]) {
+        flush_word(page);
+        page->wordbox[0] = bbox[0];
+        page->wordbox[1] = bbox[1];
+        page->wordbox[2] = bbox[2];
+        page->wordbox[3] = bbox[3];
     }
 
     /* Add the char to the current word. */
-    if (ppdev->ocr.word_len == ppdev->ocr.word_max) {
+    if (page->word_len == page->word_max) {
         int *newblock;
-        int newmax = ppdev->ocr.word_max * 2;
+        int newmax = page->word_max * 2;
         if (newmax == 0)
             newmax = 16;
-        newblock = (int *)gs_alloc_bytes(ppdev->memory, sizeof(int)*newmax,
+        newblock = (int *)gs_alloc_bytes(page->memory, sizeof(int)*newmax,
                                          "ocr_callback(word)");
         if (newblock == NULL)
             return_error(gs_error_VMerror);
-        if (ppdev->ocr.word_len > 0)
-            memcpy(newblock, ppdev->ocr.word_chars,
-                   sizeof(int) * ppdev->ocr.word_len);
-        gs_free_object(ppdev->memory, ppdev->ocr.word_chars,
+        if (page->word_len > 0)
+            memcpy(newblock, page->word_chars,
+                   sizeof(int) * page->word_len);
+        gs_free_object(page->memory, page->word_chars,
                        "ocr_callback(word)");
-        ppdev->ocr.word_chars = newblock;
-        ppdev->ocr.word_max = newmax;
+        page->word_chars = newblock;
+        page->word_max = newmax;
     }
-    ppdev->ocr.word_chars[ppdev->ocr.word_len++] = unicode;
-#endif
+    page->word_chars[page->word_len++] = unicode;
 
     return 0;
 }
 
-static int
-ocr_end_page(gx_device_pdf_image *dev)
+/* Runs the OCR on the page's raster, and produces the text for it. This is
+ * called from the OCR worker threads, so must only use the page (and its
+ * non-gc memory), not the device. */
+static void
+ocr_recognise_page(void *state, ocr_page_t *page)
 {
-    stream_puts(dev->strm, "\nBT 3 Tr\n");
-    dev->ocr.cur_x = 0;
-    dev->ocr.cur_y = 0;
-    dev->ocr.cur_size = -1;
-    dev->ocr.cur_scale = 0;
-    dev->ocr.wordbox[0] = 0;
-    dev->ocr.wordbox[1] = 0;
-    dev->ocr.wordbox[2] = -1;
-    dev->ocr.wordbox[3] = -1;
-    dev->ocr.word_len = 0;
-    dev->ocr.word_max = 0;
-    dev->ocr.word_chars = NULL;
-    ocr_recognise(dev->ocr.state,
-                  dev->ocr.w,
-                  dev->ocr.h,
-                  dev->ocr.data,
-                  dev->ocr.xres,
-                  dev->ocr.yres,
+    ocr_puts(page, "\nBT 3 Tr\n");
+    page->cur_size = -1;
+    page->cur_scale = 0;
+    page->wordbox[0] = 0;
+    page->wordbox[1] = 0;
+    page->wordbox[2] = -1;
+    page->wordbox[3] = -1;
+    page->word_len = 0;
+    page->word_max = 0;
+    page->word_chars = NULL;
+    ocr_recognise(state,
+                  page->w,
+                  page->h,
+                  page->data,
+                  page->xres,
+                  page->yres,
                   ocr_callback,
-                  dev);
-    if (dev->ocr.word_len)
-        flush_word(dev);
-    stream_puts(dev->strm, "\nET");
+                  page);
+    if (page->word_len)
+        flush_word(page);
+    ocr_puts(page, "\nET");
 
-    gs_free_object(dev->memory, dev->ocr.word_chars,
+    gs_free_object(page->memory, page->word_chars,
                    "ocr_callback(word)");
+    page->word_chars = NULL;
+}
+
+static int
+ocr_end_page(gx_device_pdf_image *dev)
+{
+    ocr_pipeline_t *pipe = (ocr_pipeline_t *)dev->ocr.pipeline;
+    ocr_page_t page;
+
+    if (pipe && pipe->writing) {
+        /* Writing the contents of a page from the pipeline, the text is
+         * already done. */
+        if (pipe->writing->buf_len)
+            stream_write(dev->strm, pipe->writing->buf, pipe->writing->buf_len);
+        return pipe->writing->code;
+    }
+
+    memset(&page, 0, sizeof(page));
+    page.memory = dev->memory;
+    page.w = dev->ocr.w;
+    page.h = dev->ocr.h;
+    page.xres = dev->ocr.xres;
+    page.yres = dev->ocr.yres;
+    page.factor = dev->downscale.downscale_factor;
+    page.data = dev->ocr.data;
+    page.strm = dev->strm;
+    ocr_recognise_page(dev->ocr.state, &page);
+
     gs_free_object(dev->memory, dev->ocr.data, "ocr_end_page");
     dev->ocr.data = NULL;
 
     return 0;
 }
 
+static void
+ocr_free_page(ocr_page_t *page)
+{
+    gs_free_object(page->memory, page->data, "ocr_begin_page");
+    gs_free_object(page->memory, page->buf, "ocr_puts");
+    gs_free_object(page->memory, page, "ocr_begin_page");
+}
+
+static void
+ocr_worker(void *arg)
+{
+    ocr_worker_t *worker = (ocr_worker_t *)arg;
+    ocr_pipeline_t *pipe = worker->pipe;
+    ocr_page_t *page;
+
+    for (;;) {
+        gx_semaphore_wait(pipe->work);
+        gx_monitor_enter(pipe->lock);
+        page = pipe->queue_head;
+        if (page) {
+            pipe->queue_head = page->next_queued;
+            if (pipe->queue_head == NULL)
+                pipe->queue_tail = NULL;
+        }
+        gx_monitor_leave(pipe->lock);
+        /* We are only woken with nothing queued when it's time to stop. */
+        if (page == NULL)
+            break;
+
+        ocr_recognise_page(worker->state, page);
+        gs_free_object(page->memory, page->data, "ocr_begin_page");
+        page->data = NULL;
+
+        gx_monitor_enter(pipe->lock);
+        page->done = true;
+        gx_monitor_leave(pipe->lock);
+        gx_semaphore_signal(pipe->done);
+    }
+}
+
+/* Writes the contents of the finished pages at the head of the output list,
+ * waiting for the OCR until no more than keep pages are outstanding. */
+static int
+ocr_write_pages(gx_device_pdf_image *dev, int keep)
+{
+    ocr_pipeline_t *pipe = (ocr_pipeline_t *)dev->ocr.pipeline;
+    ocr_page_t *page;
+    bool done;
+    int code;
+
+    if (pipe == NULL)
+        return 0;
+
+    while (pipe->output_head) {
+        page = pipe->output_head;
+        gx_monitor_enter(pipe->lock);
+        done = page->done;
+        gx_monitor_leave(pipe->lock);
+        if (!done) {
+            if (pipe->outstanding <= keep)
+                break;
+            gx_semaphore_wait(pipe->done);
+            continue;
+        }
+
+        pipe->output_head = page->next_output;
+        if (pipe->output_head == NULL)
+            pipe->output_tail = NULL;
+        pipe->outstanding--;
+        pipe->writing = page;
+        code = pdf_image_write_page_contents(dev, page->page);
+        pipe->writing = NULL;
+        ocr_free_page(page);
+        if (code < 0)
+            return code;
+    }
+    return 0;
+}
+
+static int
+ocr_defer_page(gx_device_pdf_image *dev, pdfimage_page *pdf_page)
+{
+    ocr_pipeline_t *pipe = (ocr_pipeline_t *)dev->ocr.pipeline;
+    ocr_page_t *page = pipe->filling;
+
+    if (page == NULL)
+        return_error(gs_error_unknownerror);
+    pipe->filling = NULL;
+    dev->ocr.data = NULL;
+    page->page = pdf_page;
+
+    if (pipe->output_tail)
+        pipe->output_tail->next_output = page;
+    else
+        pipe->output_head = page;
+    pipe->output_tail = page;
+    pipe->outstanding++;
+
+    gx_monitor_enter(pipe->lock);
+    if (pipe->queue_tail)
+        pipe->queue_tail->next_queued = page;
+    else
+        pipe->queue_head = page;
+    pipe->queue_tail = page;
+    gx_monitor_leave(pipe->lock);
+    gx_semaphore_signal(pipe->work);
+
+    return ocr_write_pages(dev, pipe->num_workers * OCR_PAGES_PER_THREAD);
+}
+
+static int
+ocr_flush(gx_device_pdf_image *dev)
+{
+    return ocr_write_pages(dev, 0);
+}
+
+/* Stops the worker threads, once they have finished any queued pages, and
+ * frees the pipeline. The first worker's Tesseract instance is the device's
+ * own, which is left for pdf_ocr_close to free. */
+static void
+ocr_stop_pipeline(gx_device_pdf_image *dev)
+{
+    ocr_pipeline_t *pipe = (ocr_pipeline_t *)dev->ocr.pipeline;
+    ocr_page_t *page;
+    int i;
+
+    if (pipe == NULL)
+        return;
+
+    for (i = 0; i < pipe->num_workers; i++)
+        gx_semaphore_signal(pipe->work);
+    for (i = 0; i < pipe->num_workers; i++)
+        gp_thread_finish(pipe->workers[i].thread);
+    for (i = 1; i < pipe->num_workers; i++)
+        ocr_fin_api(pipe->memory, pipe->workers[i].state);
+
+    while (pipe->output_head) {
+        page = pipe->output_head;
+        pipe->output_head = page->next_output;
+        ocr_free_page(page);
+    }
+    if (pipe->filling)
+        ocr_free_page(pipe->filling);
+
+    gx_semaphore_free(pipe->done);
+    gx_semaphore_free(pipe->work);
+    gx_monitor_free(pipe->lock);
+    gs_free_object(pipe->memory, pipe->workers, "ocr_stop_pipeline");
+    gs_free_object(pipe->memory, pipe, "ocr_stop_pipeline");
+    dev->ocr.pipeline = NULL;
+    dev->ocr.defer_page = NULL;
+}
+
+/* Starts OCRThreads worker threads. If we can't, for instance because this
+ * build has no thread support, we quietly carry on running the OCR as each
+ * page is printed. */
+static int
+ocr_start_pipeline(gx_device_pdf_image *dev, const char *language)
+{
+    gs_memory_t *mem = dev->memory->non_gc_memory;
+    ocr_pipeline_t *pipe;
+    int i, code = 0;
+
+    pipe = (ocr_pipeline_t *)gs_alloc_bytes(mem, sizeof(*pipe), "ocr_start_pipeline");
+    if (pipe == NULL)
+        return_error(gs_error_VMerror);
+    memset(pipe, 0, sizeof(*pipe));
+    pipe->memory = mem;
+    pipe->workers = (ocr_worker_t *)gs_alloc_bytes(mem, sizeof(ocr_worker_t) * dev->ocr.threads,
+                                                   "ocr_start_pipeline");
+    pipe->lock = gx_monitor_label(gx_monitor_alloc(mem), "ocr_pipeline");
+    pipe->work = gx_semaphore_label(gx_semaphore_alloc(mem), "ocr_pipeline work");
+    pipe->done = gx_semaphore_label(gx_semaphore_alloc(mem), "ocr_pipeline done");
+    if (pipe->workers == NULL || pipe->lock == NULL || pipe->work == NULL || pipe->done == NULL) {
+        code = gs_note_error(gs_error_VMerror);
+        goto fail;
+    }
+
+    for (i = 0; i < dev->ocr.threads; i++) {
+        ocr_worker_t *worker = &pipe->workers[i];
+
+        worker->pipe = pipe;
+        if (i == 0)
+            worker->state = dev->ocr.state;
+        else {
+            code = ocr_init_api(mem, language, dev->ocr.engine, &worker->state);
+            if (code < 0)
+                break;
+        }
+        code = gp_thread_start(ocr_worker, worker, &worker->thread);
+        if (code < 0) {
+            if (i > 0)
+                ocr_fin_api(mem, worker->state);
+            break;
+        }
+        pipe->num_workers++;
+    }
+    dev->ocr.pipeline = pipe;
+    if (code < 0) {
+        ocr_stop_pipeline(dev);
+        return 0;
+    }
+    dev->ocr.defer_page = ocr_defer_page;
+    return 0;
+
+fail:
+    if (pipe->done)
+        gx_semaphore_free(pipe->done);
+    if (pipe->work)
+        gx_semaphore_free(pipe->work);
+    if (pipe->lock)
+        gx_monitor_free(pipe->lock);
+    gs_free_object(mem, pipe->workers, "ocr_start_pipeline");
+    gs_free_object(mem, pipe, "ocr_start_pipeline");
+    return code;
+}
+
 int
 pdf_ocr_open(gx_device *pdev)
 {
@@ -715,6 +1085,7 @@ pdf_ocr_open(gx_device *pdev)
     ppdev->ocr.file_init  = ocr_file_init;
     ppdev->ocr.begin_page = ocr_begin_page;
     ppdev->ocr.end_page   = ocr_end_page;
+    ppdev->ocr.flush      = ocr_flush;
     ppdev->ocr.xres = (int)pdev->HWResolution[0];
     ppdev->ocr.yres = (int)pdev->HWResolution[1];
 
@@ -736,6 +1107,7 @@ pdf_ocr_close(gx_device *pdev)
         pdev = pdev->child;
     pdf_dev = (gx_device_pdf_image *)pdev;
 
+    ocr_stop_pipeline(pdf_dev);
     ocr_fin_api(pdf_dev->memory, pdf_dev->ocr.state);
     pdf_dev->ocr.state = NULL;
 
@@ -83,11 +83,17 @@ typedef struct page_text_list_s {
 /* A simple structure to maintain the lists of text fragments, it is also
  * a convenient place to record the page number and anything else we may
  * want to record that is relevant to the page rather than the text.
+ * Fragments are collected in the pending list, in the order they arrive,
+ * and only sorted into the Y-ordered list when the page is output.
  */
 typedef struct page_text_s {
     int PageNum;
     page_text_list_t *y_ordered_list;
     text_list_entry_t *unsorted_text_list;
+    text_list_entry_t *unsorted_text_tail;
+    text_list_entry_t *pending_text_list;
+    text_list_entry_t *pending_text_tail;
+    int pending_text_count;
 } page_text_t;
 
 /* The custom sub-classed device structure */
@@ -202,6 +208,9 @@ txtwrite_open_device(gx_device * dev)
 
     tdev->PageData.PageNum = 0;
     tdev->PageData.y_ordered_list = NULL;
+    tdev->PageData.unsorted_text_list = tdev->PageData.unsorted_text_tail = NULL;
+    tdev->PageData.pending_text_list = tdev->PageData.pending_text_tail = NULL;
+    tdev->PageData.pending_text_count = 0;
     tdev->file = NULL;
 #ifdef TRACE_TXTWRITE
     tdev->DebugFile = gp_fopen(dev->memory,"/temp/txtw_dbg.txt", "wb+");
@@ -232,6 +241,137 @@ txtwrite_close_device(gx_device * dev)
     return code;
 }
 
+/* A pending fragment, and the order in which it arrived, for sorting */
+typedef struct txt_sort_entry_s {
+    text_list_entry_t *entry;
+    int order;
+} txt_sort_entry_t;
+
+static int
+txt_sort_compare(const void *a, const void *b)
+{
+    const txt_sort_entry_t *e1 = (const txt_sort_entry_t *)a, *e2 = (const txt_sort_entry_t *)b;
+
+    if (e1->entry->start.y != e2->entry->start.y)
+        return e1->entry->start.y < e2->entry->start.y ? -1 : 1;
+    if (e1->entry->start.x != e2->entry->start.x)
+        return e1->entry->start.x < e2->entry->start.x ? -1 : 1;
+    return e1->order - e2->order;
+}
+
+/* Builds the Y-ordered list from the pending fragments. The lines are sorted
+ * by Y co-ordinate and the fragments in each line by X co-ordinate, with
+ * fragments at the same position kept in the order they arrived. The result
+ * is the same as inserting the fragments into the lists one at a time,
+ * including the line extents, and the quirk that the line holding the first
+ * fragment on the page does not include that fragment's FontBBox.
+ */
+static int
+txt_sort_fragments(gx_device_txtwrite_t *tdev)
+{
+    int count = tdev->PageData.pending_text_count, i, j, k;
+    txt_sort_entry_t *sorted;
+    text_list_entry_t *entry, *first_on_page = tdev->PageData.pending_text_list;
+    page_text_list_t *last_line = tdev->PageData.y_ordered_list;
+
+    if (count == 0)
+        return 0;
+
+    sorted = (txt_sort_entry_t *)gs_malloc(tdev->memory->stable_memory, count,
+        sizeof(txt_sort_entry_t), "txtwrite alloc sort array");
+    if (!sorted)
+        return gs_note_error(gs_error_VMerror);
+    for (entry = tdev->PageData.pending_text_list, i = 0; entry; entry = entry->next, i++) {
+        sorted[i].entry = entry;
+        sorted[i].order = i;
+    }
+    qsort(sorted, count, sizeof(txt_sort_entry_t), txt_sort_compare);
+
+    /* Fragments are only added at output time, so there are no lines yet
+     * except after a failed attempt. In that case carry on after them.
+     */
+    if (last_line) {
+        first_on_page = NULL;
+        while (last_line->next)
+            last_line = last_line->next;
+    }
+
+    for (i = 0; i < count; i = j) {
+        page_text_list_t *Y_Entry;
+        text_list_entry_t *first = sorted[i].entry;
+        int first_order = sorted[i].order;
+
+        for (j = i + 1; j < count && sorted[j].entry->start.y == first->start.y; j++) {
+            if (sorted[j].order < first_order) {
+                first = sorted[j].entry;
+                first_order = sorted[j].order;
+            }
+        }
+
+        Y_Entry = (page_text_list_t *)gs_malloc(tdev->memory->stable_memory, 1,
+            sizeof(page_text_list_t), "txtwrite alloc Y-list");
+        if (!Y_Entry) {
+            /* Put the fragments we haven't dealt with back on the pending list */
+            tdev->PageData.pending_text_list = tdev->PageData.pending_text_tail = NULL;
+            tdev->PageData.pending_text_count = 0;
+            for (k = i; k < count; k++) {
+                entry = sorted[k].entry;
+                entry->next = NULL;
+                entry->previous = tdev->PageData.pending_text_tail;
+                if (tdev->PageData.pending_text_tail)
+                    tdev->PageData.pending_text_tail->next = entry;
+                else
+                    tdev->PageData.pending_text_list = entry;
+                tdev->PageData.pending_text_tail = entry;
+                tdev->PageData.pending_text_count++;
+            }
+            gs_free(tdev->memory, sorted, count, sizeof(txt_sort_entry_t), "txtwrite free sort array");
+            return gs_note_error(gs_error_VMerror);
+        }
+
+        Y_Entry->start = first->start;
+        if (first == first_on_page) {
+            Y_Entry->MinY = Y_Entry->MaxY = 0;
+        } else if (first->FontBBox_bottomleft.y > first->FontBBox_topright.y) {
+            Y_Entry->MinY = first->FontBBox_topright.y;
+            Y_Entry->MaxY = first->FontBBox_bottomleft.y;
+        } else {
+            Y_Entry->MaxY = first->FontBBox_topright.y;
+            Y_Entry->MinY = first->FontBBox_bottomleft.y;
+        }
+
+        Y_Entry->x_ordered_list = sorted[i].entry;
+        for (k = i; k < j; k++) {
+            entry = sorted[k].entry;
+            entry->previous = k > i ? sorted[k - 1].entry : NULL;
+            entry->next = k + 1 < j ? sorted[k + 1].entry : NULL;
+            if (entry == first)
+                continue;
+            if (entry->FontBBox_bottomleft.y < Y_Entry->MinY)
+                Y_Entry->MinY = entry->FontBBox_bottomleft.y;
+            if (entry->FontBBox_bottomleft.y > Y_Entry->MaxY)
+                Y_Entry->MaxY = entry->FontBBox_bottomleft.y;
+            if (entry->FontBBox_topright.y < Y_Entry->MinY)
+                Y_Entry->MinY = entry->FontBBox_topright.y;
+            if (entry->FontBBox_topright.y > Y_Entry->MaxY)
+                Y_Entry->MaxY = entry->FontBBox_topright.y;
+        }
+
+        Y_Entry->next = NULL;
+        Y_Entry->previous = last_line;
+        if (last_line)
+            last_line->next = Y_Entry;
+        else
+            tdev->PageData.y_ordered_list = Y_Entry;
+        last_line = Y_Entry;
+    }
+    gs_free(tdev->memory, sorted, count, sizeof(txt_sort_entry_t), "txtwrite free sort array");
+
+    tdev->PageData.pending_text_list = tdev->PageData.pending_text_tail = NULL;
+    tdev->PageData.pending_text_count = 0;
+    return 0;
+}
+
 /* Routine inspects horizontal lines of text to see if they can be collapsed
  * into a single line. This essentially detects superscripts and subscripts
  * as well as lines which are slightly mis-aligned.
@@ -249,26 +389,30 @@ static int merge_vertically(gx_device_txtwrite_t *tdev)
         float overlap = (y_list->start.y + y_list->MaxY) - (next->start.y + next->MinY);
 
         if (overlap >= (y_list->MaxY - y_list->MinY) / 4) {
-            /* At least a 25% overlap, lets test for x collisions */
-            text_list_entry_t *upper = y_list->x_ordered_list, *lower;
+            /* At least a 25% overlap, lets test for x collisions. An upper
+             * fragment collides with a lower one if it starts within the lower
+             * one, or if the lower one starts strictly within it. Both lists
+             * are ordered by start.x, so we can sweep them together, keeping
+             * lower at the first fragment starting after upper, and the
+             * furthest end.x of the lower fragments before that.
+             */
+            text_list_entry_t *upper = y_list->x_ordered_list, *lower = next->x_ordered_list;
+            double max_end = 0;
+            bool have_end = false;
+
             while (upper && !collision) {
-                lower = next->x_ordered_list;
-                while (lower && !collision) {
-                    if (upper->start.x >= lower->start.x) {
-                        if (upper->start.x <= lower->end.x) {
-                            /* Collision */
-                            collision = true;
-                            break;
-                        }
-                    } else {
-                        if (upper->end.x > lower->start.x) {
-                            /* Collision */
-                            collision = true;
-                            break;
-                        }
+                while (lower && lower->start.x <= upper->start.x) {
+                    /* A NaN end.x never collides, so don't let it become max_end */
+                    if (lower->end.x > max_end || (!have_end && lower->end.x == lower->end.x)) {
+                        max_end = lower->end.x;
+                        have_end = true;
                     }
                     lower = lower->next;
                 }
+                if (have_end && max_end >= upper->start.x)
+                    collision = true;
+                else if (lower && lower->start.x < upper->end.x)
+                    collision = true;
                 upper = upper->next;
             }
             if (!collision) {
@@ -347,176 +491,141 @@ static int merge_vertically(gx_device_txtwrite_t *tdev)
  * between two horizontal fragments is small, then they are treated as one
  * frament of text, if its larger then we insert a space (and set the Width
  * entry appropriately). Otherwise we leave them as separate.
+ * Whether a fragment is merged depends on the average width of everything
+ * merged before it, but not on the text itself, so we first find the whole
+ * run of fragments which will be merged, and then build the new arrays once,
+ * rather than copying them again for every fragment we add.
  */
 static int merge_horizontally(gx_device_txtwrite_t *tdev)
 {
-#ifdef TRACE_TXTWRITE
-    text_list_entry_t *debug_x;
-#endif
     unsigned short UnicodeSpace = 0x20;
     page_text_list_t *y_list = tdev->PageData.y_ordered_list;
 
     while (y_list) {
         float average_width;
-        text_list_entry_t *from, *to;
+        text_list_entry_t *from, *to, *last, *next;
         from = y_list->x_ordered_list;
-        to = from->next;
-
-        while (from && to) {
-            average_width = (from->end.x - from->start.x) / from->Unicode_Text_Size;
-
-            if (to->start.x - from->end.x < average_width / 2) {
-                /* consolidate fragments */
-                unsigned short *NewText = NULL;
-                float *NewWidths = NULL, *NewAdvs = NULL, *NewGlyphWidths = NULL, *NewSpanDeltaX = NULL;
-
-                NewText = (unsigned short *)gs_malloc(tdev->memory->stable_memory,
-                    (from->Unicode_Text_Size + to->Unicode_Text_Size), sizeof(unsigned short), "txtwrite alloc working text buffer");
-                NewWidths = (float *)gs_malloc(tdev->memory->stable_memory,
-                    (from->Unicode_Text_Size + to->Unicode_Text_Size), sizeof(float), "txtwrite alloc Widths array");
-                NewAdvs = (float *)gs_malloc(tdev->memory->stable_memory,
-                    (from->Unicode_Text_Size + to->Unicode_Text_Size), sizeof(float), "txtwrite alloc Advs array");
-                NewGlyphWidths = (float *)gs_malloc(tdev->memory->stable_memory,
-                    (from->Unicode_Text_Size + to->Unicode_Text_Size), sizeof(float), "txtwrite alloc GlyphWidths array");
-                NewSpanDeltaX = (float *)gs_malloc(tdev->memory->stable_memory,
-                    (from->Unicode_Text_Size + to->Unicode_Text_Size), sizeof(float), "txtwrite alloc SpanDeltaX array");
-                if (!NewText || !NewWidths || !NewAdvs || !NewGlyphWidths || !NewSpanDeltaX) {
-                    if (NewText)
-                        gs_free(tdev->memory, NewText, from->Unicode_Text_Size + to->Unicode_Text_Size, sizeof (unsigned short), "free working text fragment");
-                    if (NewWidths)
-                        gs_free(tdev->memory, NewWidths, from->Unicode_Text_Size + to->Unicode_Text_Size, sizeof (unsigned short), "free working text fragment");
-                    if (NewAdvs)
-                        gs_free(tdev->memory, NewAdvs, from->Unicode_Text_Size + to->Unicode_Text_Size, sizeof (unsigned short), "free working text fragment");
-                    if (NewGlyphWidths)
-                        gs_free(tdev->memory, NewGlyphWidths, from->Unicode_Text_Size + to->Unicode_Text_Size, sizeof (unsigned short), "free working text fragment");
-                    if (NewSpanDeltaX)
-                        gs_free(tdev->memory, NewSpanDeltaX, from->Unicode_Text_Size + to->Unicode_Text_Size, sizeof (unsigned short), "free working text fragment");
-                    /* ran out of memory, don't consolidate */
-                    from = from->next;
-                    to = to->next;
-                } else {
+
+        while (from && from->next) {
+            unsigned short *NewText = NULL;
+            float *NewWidths = NULL, *NewAdvs = NULL, *NewGlyphWidths = NULL, *NewSpanDeltaX = NULL;
+            gs_point end = from->end;
+            int size = from->Unicode_Text_Size, count;
+            bool done;
+
+            last = from;
+            for (to = from->next; to; to = to->next) {
+                average_width = (end.x - from->start.x) / size;
+                if (to->start.x - end.x < average_width / 2)
+                    size += to->Unicode_Text_Size;
+                else if (to->start.x - end.x < average_width * 2)
+                    size += to->Unicode_Text_Size + 1;
+                else
+                    break;
+                end = to->end;
+                last = to;
+            }
+            if (last == from) {
+                from = from->next;
+                continue;
+            }
+
+            NewText = (unsigned short *)gs_malloc(tdev->memory->stable_memory,
+                size, sizeof(unsigned short), "txtwrite alloc working text buffer");
+            NewWidths = (float *)gs_malloc(tdev->memory->stable_memory,
+                size, sizeof(float), "txtwrite alloc Widths array");
+            NewAdvs = (float *)gs_malloc(tdev->memory->stable_memory,
+                size, sizeof(float), "txtwrite alloc Advs array");
+            NewGlyphWidths = (float *)gs_malloc(tdev->memory->stable_memory,
+                size, sizeof(float), "txtwrite alloc GlyphWidths array");
+            NewSpanDeltaX = (float *)gs_malloc(tdev->memory->stable_memory,
+                size, sizeof(float), "txtwrite alloc SpanDeltaX array");
+            if (!NewText || !NewWidths || !NewAdvs || !NewGlyphWidths || !NewSpanDeltaX) {
+                if (NewText)
+                    gs_free(tdev->memory, NewText, size, sizeof (unsigned short), "free working text fragment");
+                if (NewWidths)
+                    gs_free(tdev->memory, NewWidths, size, sizeof (float), "free working text fragment");
+                if (NewAdvs)
+                    gs_free(tdev->memory, NewAdvs, size, sizeof (float), "free working text fragment");
+                if (NewGlyphWidths)
+                    gs_free(tdev->memory, NewGlyphWidths, size, sizeof (float), "free working text fragment");
+                if (NewSpanDeltaX)
+                    gs_free(tdev->memory, NewSpanDeltaX, size, sizeof (float), "free working text fragment");
+                /* ran out of memory, don't consolidate */
+                from = from->next;
+                continue;
+            }
+
+            count = from->Unicode_Text_Size;
+            memcpy(NewText, from->Unicode_Text, count * sizeof(unsigned short));
+            memcpy(NewWidths, from->Widths, count * sizeof(float));
+            memcpy(NewAdvs, from->Advs, count * sizeof(float));
+            memcpy(NewGlyphWidths, from->GlyphWidths, count * sizeof(float));
+            memcpy(NewSpanDeltaX, from->SpanDeltaX, count * sizeof(float));
+            end = from->end;
+
+            to = from->next;
+            do {
 #ifdef TRACE_TXTWRITE
-                    gp_fprintf(tdev->DebugFile, "Consolidating two horizontal fragments in one line, before:\n\t");
-                    gp_fwrite(from->Unicode_Text, sizeof(unsigned short), from->Unicode_Text_Size, tdev->DebugFile);
-                    gp_fprintf(tdev->DebugFile, "\n\t");
-                    gp_fwrite(to->Unicode_Text, sizeof(unsigned short), to->Unicode_Text_Size, tdev->DebugFile);
+                gp_fprintf(tdev->DebugFile, "Consolidating two horizontal fragments in one line, before:\n\t");
+                gp_fwrite(NewText, sizeof(unsigned short), count, tdev->DebugFile);
+                gp_fprintf(tdev->DebugFile, "\n\t");
+                gp_fwrite(to->Unicode_Text, sizeof(unsigned short), to->Unicode_Text_Size, tdev->DebugFile);
+                gp_fprintf(tdev->DebugFile, "\n");
 #endif
-                    memcpy(NewText, from->Unicode_Text, from->Unicode_Text_Size * sizeof(unsigned short));
-                    memcpy(&NewText[from->Unicode_Text_Size], to->Unicode_Text, to->Unicode_Text_Size * sizeof(unsigned short));
-                    memcpy(NewWidths, from->Widths, from->Unicode_Text_Size * sizeof(float));
-                    memcpy(&NewWidths[from->Unicode_Text_Size], to->Widths, to->Unicode_Text_Size * sizeof(float));
-                    memcpy(NewAdvs, from->Advs, from->Unicode_Text_Size * sizeof(float));
-                    memcpy(&NewAdvs[from->Unicode_Text_Size], to->Advs, to->Unicode_Text_Size * sizeof(float));
-                    memcpy(NewGlyphWidths, from->GlyphWidths, from->Unicode_Text_Size * sizeof(float));
-                    memcpy(&NewGlyphWidths[from->Unicode_Text_Size], to->GlyphWidths, to->Unicode_Text_Size * sizeof(float));
-                    memcpy(NewSpanDeltaX, from->SpanDeltaX, from->Unicode_Text_Size * sizeof(float));
-                    memcpy(&NewSpanDeltaX[from->Unicode_Text_Size], to->SpanDeltaX, to->Unicode_Text_Size * sizeof(float));
-
-                    gs_free(tdev->memory, from->Unicode_Text, from->Unicode_Text_Size, sizeof (unsigned short), "free consolidated text fragment");
-                    gs_free(tdev->memory, to->Unicode_Text, to->Unicode_Text_Size, sizeof (unsigned short), "free consolidated text fragment");
-                    gs_free(tdev->memory, from->Widths, from->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                    gs_free(tdev->memory, to->Widths, to->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                    gs_free(tdev->memory, from->Advs, from->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                    gs_free(tdev->memory, to->Advs, to->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                    gs_free(tdev->memory, from->GlyphWidths, from->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                    gs_free(tdev->memory, to->GlyphWidths, to->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                    gs_free(tdev->memory, from->SpanDeltaX, from->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                    gs_free(tdev->memory, to->SpanDeltaX, to->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                    gs_free(tdev->memory, to->FontName, 1, strlen(from->FontName) + 1, "free FontName");
-
-                    from->Unicode_Text = NewText;
-                    from->Unicode_Text_Size += to->Unicode_Text_Size;
-                    from->Widths = NewWidths;
-                    from->Advs = NewAdvs;
-                    from->GlyphWidths = NewGlyphWidths;
-                    from->SpanDeltaX = NewSpanDeltaX;
+                /* Same test as above, so we know this one will be merged */
+                average_width = (end.x - from->start.x) / count;
+                if (!(to->start.x - end.x < average_width / 2)) {
+                    /* Too far apart to be the same word, insert a space */
+                    NewText[count] = UnicodeSpace;
+                    NewWidths[count] = to->start.x - end.x;
+                    NewAdvs[count] = to->start.x - end.x;
+                    NewGlyphWidths[count] = 0.0;
+                    NewSpanDeltaX[count] = 0;
+                    count++;
+                }
+                memcpy(&NewText[count], to->Unicode_Text, to->Unicode_Text_Size * sizeof(unsigned short));
+                memcpy(&NewWidths[count], to->Widths, to->Unicode_Text_Size * sizeof(float));
+                memcpy(&NewAdvs[count], to->Advs, to->Unicode_Text_Size * sizeof(float));
+                memcpy(&NewGlyphWidths[count], to->GlyphWidths, to->Unicode_Text_Size * sizeof(float));
+                memcpy(&NewSpanDeltaX[count], to->SpanDeltaX, to->Unicode_Text_Size * sizeof(float));
+                count += to->Unicode_Text_Size;
+                end = to->end;
+
+                gs_free(tdev->memory, to->Unicode_Text, to->Unicode_Text_Size, sizeof (unsigned short), "free consolidated text fragment");
+                gs_free(tdev->memory, to->Widths, to->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
+                gs_free(tdev->memory, to->Advs, to->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
+                gs_free(tdev->memory, to->GlyphWidths, to->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
+                gs_free(tdev->memory, to->SpanDeltaX, to->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
+                gs_free(tdev->memory, to->FontName, 1, strlen(to->FontName) + 1, "free FontName");
+                next = to->next;
+                done = (to == last);
+                gs_free(tdev->memory, to, 1, sizeof(text_list_entry_t), "free consolidated fragment");
+                to = next;
+            } while (!done);
+
+            gs_free(tdev->memory, from->Unicode_Text, from->Unicode_Text_Size, sizeof (unsigned short), "free consolidated text fragment");
+            gs_free(tdev->memory, from->Widths, from->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
+            gs_free(tdev->memory, from->Advs, from->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
+            gs_free(tdev->memory, from->GlyphWidths, from->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
+            gs_free(tdev->memory, from->SpanDeltaX, from->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
+
+            from->Unicode_Text = NewText;
+            from->Unicode_Text_Size = count;
+            from->Widths = NewWidths;
+            from->Advs = NewAdvs;
+            from->GlyphWidths = NewGlyphWidths;
+            from->SpanDeltaX = NewSpanDeltaX;
 #ifdef TRACE_TXTWRITE
-                    gp_fprintf(tdev->DebugFile, "After:\n\t");
-                    gp_fwrite(from->Unicode_Text, sizeof(unsigned short), from->Unicode_Text_Size, tdev->DebugFile);
+            gp_fprintf(tdev->DebugFile, "After:\n\t");
+            gp_fwrite(from->Unicode_Text, sizeof(unsigned short), from->Unicode_Text_Size, tdev->DebugFile);
 #endif
-                    from->end = to->end;
-                    from->next = to->next;
-                    if (from->next)
-                        from->next->previous = from;
-                    gs_free(tdev->memory, to, 1, sizeof(text_list_entry_t), "free consolidated fragment");
-                    to = from->next;
-                }
-            } else {
-                if (to->start.x - from->end.x < average_width *2){
-                    unsigned short *NewText = NULL;
-                    float *NewWidths = NULL, *NewAdvs = NULL, *NewGlyphWidths = NULL, *NewSpanDeltaX = NULL;
-
-                    NewText = (unsigned short *)gs_malloc(tdev->memory->stable_memory,
-                        (from->Unicode_Text_Size + to->Unicode_Text_Size + 1), sizeof(unsigned short), "txtwrite alloc text state");
-                    NewWidths = (float *)gs_malloc(tdev->memory->stable_memory,
-                        (from->Unicode_Text_Size + to->Unicode_Text_Size + 1), sizeof(float), "txtwrite alloc Widths array");
-                    NewAdvs = (float *)gs_malloc(tdev->memory->stable_memory,
-                        (from->Unicode_Text_Size + to->Unicode_Text_Size + 1), sizeof(float), "txtwrite alloc Advs array");
-                    NewGlyphWidths = (float *)gs_malloc(tdev->memory->stable_memory,
-                        (from->Unicode_Text_Size + to->Unicode_Text_Size + 1), sizeof(float), "txtwrite alloc GlyphWidths array");
-                    NewSpanDeltaX = (float *)gs_malloc(tdev->memory->stable_memory,
-                        (from->Unicode_Text_Size + to->Unicode_Text_Size + 1), sizeof(float), "txtwrite alloc SpanDeltaX array");
-                    if (!NewText || !NewWidths || !NewAdvs || !NewGlyphWidths || !NewSpanDeltaX) {
-                        if (NewText)
-                            gs_free(tdev->memory, NewText, from->Unicode_Text_Size + to->Unicode_Text_Size, sizeof (unsigned short), "free working text fragment");
-                        if (NewWidths)
-                            gs_free(tdev->memory, NewWidths, from->Unicode_Text_Size + to->Unicode_Text_Size, sizeof (unsigned short), "free working text fragment");
-                        if (NewAdvs)
-                            gs_free(tdev->memory, NewAdvs, from->Unicode_Text_Size + to->Unicode_Text_Size, sizeof (unsigned short), "free working text fragment");
-                        if (NewGlyphWidths)
-                            gs_free(tdev->memory, NewGlyphWidths, from->Unicode_Text_Size + to->Unicode_Text_Size, sizeof (unsigned short), "free working text fragment");
-                        if (NewSpanDeltaX)
-                            gs_free(tdev->memory, NewSpanDeltaX, from->Unicode_Text_Size + to->Unicode_Text_Size, sizeof (unsigned short), "free working text fragment");
-                        /* ran out of memory, don't consolidate */
-                        from = from->next;
-                        to = to->next;
-                    } else {
-                        memcpy(NewText, from->Unicode_Text, from->Unicode_Text_Size * sizeof(unsigned short));
-                        memcpy(&NewText[from->Unicode_Text_Size], &UnicodeSpace, sizeof(unsigned short));
-                        memcpy(&NewText[from->Unicode_Text_Size + 1], to->Unicode_Text, to->Unicode_Text_Size * sizeof(unsigned short));
-                        memcpy(NewWidths, from->Widths, from->Unicode_Text_Size * sizeof(float));
-                        NewWidths[from->Unicode_Text_Size] = to->start.x - from->end.x;
-                        memcpy(&NewWidths[from->Unicode_Text_Size + 1], to->Widths, to->Unicode_Text_Size * sizeof(float));
-                        memcpy(NewAdvs, from->Advs, from->Unicode_Text_Size * sizeof(float));
-                        NewAdvs[from->Unicode_Text_Size] = to->start.x - from->end.x;
-                        memcpy(&NewAdvs[from->Unicode_Text_Size + 1], to->Advs, to->Unicode_Text_Size * sizeof(float));
-                        memcpy(NewGlyphWidths, from->GlyphWidths, from->Unicode_Text_Size * sizeof(float));
-                        NewGlyphWidths[from->Unicode_Text_Size] = 0.0;
-                        memcpy(&NewGlyphWidths[from->Unicode_Text_Size + 1], to->GlyphWidths, to->Unicode_Text_Size * sizeof(float));
-                        memcpy(NewSpanDeltaX, from->SpanDeltaX, from->Unicode_Text_Size * sizeof(float));
-                        NewSpanDeltaX[from->Unicode_Text_Size] = 0;
-                        memcpy(&NewSpanDeltaX[from->Unicode_Text_Size + 1], to->SpanDeltaX, to->Unicode_Text_Size * sizeof(float));
-
-                        gs_free(tdev->memory, from->Unicode_Text, from->Unicode_Text_Size, sizeof (unsigned short), "free consolidated text fragment");
-                        gs_free(tdev->memory, to->Unicode_Text, to->Unicode_Text_Size, sizeof (unsigned short), "free consolidated text fragment");
-                        gs_free(tdev->memory, from->Widths, from->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                        gs_free(tdev->memory, to->Widths, to->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                        gs_free(tdev->memory, from->Advs, from->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                        gs_free(tdev->memory, to->Advs, to->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                        gs_free(tdev->memory, from->GlyphWidths, from->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                        gs_free(tdev->memory, to->GlyphWidths, to->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                        gs_free(tdev->memory, from->SpanDeltaX, from->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                        gs_free(tdev->memory, to->SpanDeltaX, to->Unicode_Text_Size, sizeof (float), "free consolidated Widths array");
-                        gs_free(tdev->memory, to->FontName, 1, strlen(from->FontName) + 1, "free FontName");
-
-                        from->Unicode_Text = NewText;
-                        from->Unicode_Text_Size += to->Unicode_Text_Size + 1;
-                        from->Widths = NewWidths;
-                        from->Advs = NewAdvs;
-                        from->GlyphWidths = NewGlyphWidths;
-                        from->SpanDeltaX = NewSpanDeltaX;
-                        from->end = to->end;
-                        from->next = to->next;
-                        if (from->next)
-                            from->next->previous = from;
-                        gs_free(tdev->memory, to, 1, sizeof(text_list_entry_t), "free consolidated fragment");
-                        to = from->next;
-                    }
-                } else {
-                    from = from->next;
-                    to = to->next;
-                }
-            }
+            from->end = end;
+            from->next = next;
+            if (next)
+                next->previous = from;
+            /* The fragment after the run is too far away, move on to it */
+            from = next;
         }
         y_list = y_list->next;
     }
@@ -912,6 +1021,10 @@ txtwrite_output_page(gx_device * dev, int num_copies, int flush)
             return code;
     }
 
+    code = txt_sort_fragments(tdev);
+    if (code < 0)
+        return code;
+
     switch(tdev->TextFormat) {
         case 0:
         case 1:
@@ -986,7 +1099,7 @@ txtwrite_output_page(gx_device * dev, int num_copies, int flush)
         gs_free(tdev->memory, x_entry, 1, sizeof(text_list_entry_t), "txtwrite free unsorted text fragment");
         x_entry = next_x;
     }
-    tdev->PageData.unsorted_text_list = NULL;
+    tdev->PageData.unsorted_text_list = tdev->PageData.unsorted_text_tail = NULL;
 
     code = gx_parse_output_file_name(&parsed, &fmt, tdev->fname,
                                          strlen(tdev->fname), tdev->memory);
@@ -1598,96 +1711,22 @@ txtwrite_process_plain_text(gs_text_enum_t *pte)
  * Eventually we will want to merge 'adjacent' fragments with the same
  * properties, at least when outputting a simple representation. We won't
  * do this for languages which don't read left/right or right/left though.
+ * Inserting each fragment into the sorted lists as it arrives means walking
+ * them every time, which is quadratic when every glyph is positioned
+ * individually, so here we only append the fragment to the pending list, and
+ * txt_sort_fragments() sorts them all in one go when the page is output.
  */
 static int
 txt_add_sorted_fragment(gx_device_txtwrite_t *tdev, textw_text_enum_t *penum)
 {
-    if (!tdev->PageData.y_ordered_list) {
-        /* first entry, no need to sort, just store it */
-        tdev->PageData.y_ordered_list = (page_text_list_t *)gs_malloc(tdev->memory->stable_memory, 1,
-            sizeof(page_text_list_t), "txtwrite alloc Y list entry");
-        if (!tdev->PageData.y_ordered_list)
-            return gs_note_error(gs_error_VMerror);
-        memset(tdev->PageData.y_ordered_list, 0x00, sizeof(page_text_list_t));
-        tdev->PageData.y_ordered_list->x_ordered_list = penum->text_state;
-        tdev->PageData.y_ordered_list->next = tdev->PageData.y_ordered_list->previous = NULL;
-        tdev->PageData.y_ordered_list->start = penum->text_state->start;
-    } else {
-        page_text_list_t *Y_List = tdev->PageData.y_ordered_list;
-
-        while (Y_List->next && Y_List->start.y < penum->text_state->start.y)
-            Y_List = Y_List->next;
-
-        if (Y_List->start.y == penum->text_state->start.y) {
-            /* Already have text at this y-position */
-            text_list_entry_t *X_List = Y_List->x_ordered_list;
-
-            while (X_List->next && X_List->start.x <= penum->text_state->start.x)
-                X_List = X_List->next;
-
-            if (X_List->start.x > penum->text_state->start.x) {
-                /* Insert before */
-                penum->text_state->next = X_List;
-                penum->text_state->previous = X_List->previous;
-                X_List->previous = penum->text_state;
-                if (!penum->text_state->previous)
-                    /* New head of list */
-                    Y_List->x_ordered_list = penum->text_state;
-                else
-                    penum->text_state->previous->next = penum->text_state;
-            } else {
-                /* Insert after */
-                penum->text_state->previous = X_List;
-                penum->text_state->next = X_List->next;
-                X_List->next = penum->text_state;
-                if (penum->text_state->next)
-                    penum->text_state->next->previous = penum->text_state;
-            }
-            if (penum->text_state->FontBBox_bottomleft.y < Y_List->MinY)
-                Y_List->MinY = penum->text_state->FontBBox_bottomleft.y;
-            if (penum->text_state->FontBBox_bottomleft.y > Y_List->MaxY)
-                Y_List->MaxY = penum->text_state->FontBBox_bottomleft.y;
-            if (penum->text_state->FontBBox_topright.y < Y_List->MinY)
-                Y_List->MinY = penum->text_state->FontBBox_topright.y;
-            if (penum->text_state->FontBBox_topright.y > Y_List->MaxY)
-                Y_List->MaxY = penum->text_state->FontBBox_topright.y;
-        } else {
-            /* New y-position, make a Y list new record */
-            page_text_list_t *Y_Entry = (page_text_list_t *)gs_malloc(tdev->memory->stable_memory, 1,
-                sizeof(page_text_list_t), "txtwrite alloc Y-list");
-            if (!Y_Entry)
-                return gs_note_error(gs_error_VMerror);
-
-            Y_Entry->x_ordered_list = penum->text_state;
-            Y_Entry->start = penum->text_state->start;
-            if (penum->text_state->FontBBox_bottomleft.y > penum->text_state->FontBBox_topright.y) {
-                Y_Entry->MinY = penum->text_state->FontBBox_topright.y;
-                Y_Entry->MaxY = penum->text_state->FontBBox_bottomleft.y;
-            } else {
-                Y_Entry->MaxY = penum->text_state->FontBBox_topright.y;
-                Y_Entry->MinY = penum->text_state->FontBBox_bottomleft.y;
-            }
-
-            if (Y_List->start.y > penum->text_state->start.y) {
-                /* Insert before */
-                Y_Entry->next = Y_List;
-                Y_Entry->previous = Y_List->previous;
-                Y_List->previous = Y_Entry;
-                if (!Y_Entry->previous)
-                    /* New head of list */
-                    tdev->PageData.y_ordered_list = Y_Entry;
-                else
-                    ((page_text_list_t *)Y_Entry->previous)->next = Y_Entry;
-            } else {
-                /* Insert after */
-                Y_Entry->next = Y_List->next;
-                Y_Entry->previous = Y_List;
-                Y_List->next = Y_Entry;
-                if (Y_Entry->next)
-                    ((page_text_list_t *)(Y_Entry->next))->previous = Y_Entry;
-            }
-        }
-    }
+    penum->text_state->next = NULL;
+    penum->text_state->previous = tdev->PageData.pending_text_tail;
+    if (tdev->PageData.pending_text_tail)
+        tdev->PageData.pending_text_tail->next = penum->text_state;
+    else
+        tdev->PageData.pending_text_list = penum->text_state;
+    tdev->PageData.pending_text_tail = penum->text_state;
+    tdev->PageData.pending_text_count++;
     penum->text_state = NULL;
     return 0;
 }
@@ -1809,13 +1848,12 @@ txt_add_fragment(gx_device_txtwrite_t *tdev, textw_text_enum_t *penum)
         tdev->PageData.unsorted_text_list = unsorted_entry;
         unsorted_entry->next = unsorted_entry->previous = NULL;
     } else {
-        t = tdev->PageData.unsorted_text_list;
-        while (t->next)
-            t = t->next;
+        t = tdev->PageData.unsorted_text_tail;
         t->next = unsorted_entry;
         unsorted_entry->next = NULL;
         unsorted_entry->previous = t;
     }
+    tdev->PageData.unsorted_text_tail = unsorted_entry;
 
     /* Then add the other entry to the sorted list */
     return txt_add_sorted_fragment(tdev, penum);
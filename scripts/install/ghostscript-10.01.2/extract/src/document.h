@@ -661,6 +661,11 @@ typedef struct
 /* This does all the work of finding paragraphs and tables. */
 int extract_document_join(extract_alloc_t *alloc, document_t *document, int layout_analysis);
 
+/* If zero, extract_document_join() compares every line or paragraph with
+every other one, instead of using a spatial index to find the nearby ones.
+The results are the same; this is for testing. */
+extern int extract_join_spatial_index;
+
 double extract_font_size(matrix4_t *ctm);
 
 /* Things below here are used when generating output. */
@@ -0,0 +1,190 @@
+/* Checks that joining spans into lines and paragraphs gives identical
+output with and without the spatial index in join.c, on dense synthetic
+pages, and reports the time taken by each. */
+
+#include "extract/extract.h"
+#include "extract/buffer.h"
+
+#include "document.h"
+#include "memento.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+static int s_num_fails = 0;
+
+static int rand_int(int max)
+/* Returns random int from 0..max-1. */
+{
+	return (int) (rand() / (RAND_MAX+1.0) * max);
+}
+
+static int s_word(extract_t *extract, double x, double y, double size, int wmode, int rotate, int len, unsigned last)
+/* Adds a span of <len> random letters starting at (x, y), with the last one
+replaced by <last> if that is not zero. If <rotate> is true, the text slopes
+at 1 in 4. Returns -1 on error. */
+{
+	double  adv = 0.5;
+	double  a = size, b = 0, c = 0, d = size;
+	int     i;
+
+	if (rotate)
+	{
+		/* A rotation by atan(1/4), scaled by size. */
+		a = size * 4 / sqrt(17);
+		b = size / sqrt(17);
+		c = -b;
+		d = a;
+	}
+	if (extract_span_begin(extract, "Times-Roman", 0, 0, wmode, a, b, c, d, 0, -0.2, 1, 0.8)) return -1;
+	for (i = 0; i < len; ++i)
+	{
+		unsigned ucs = (i == len - 1 && last) ? last : 'a' + (unsigned) rand_int(26);
+		/* Some chars have no advance, e.g. accents. */
+		double   char_adv = (rand_int(50) == 0) ? 0 : adv;
+		if (extract_add_char(extract, x, y, ucs, char_adv, x, y - size, x + size * adv, y)) return -1;
+		if (wmode)
+		{
+			x += char_adv * c;
+			y += char_adv * d;
+		}
+		else
+		{
+			x += char_adv * a;
+			y += char_adv * b;
+		}
+	}
+	if (extract_span_end(extract)) return -1;
+	return 0;
+}
+
+static int s_page_table(extract_t *extract, int rows, int cols)
+/* A regular grid of short words, like a table without lines, where many
+candidates have the same score. */
+{
+	int row, col;
+
+	if (extract_page_begin(extract, 0, 0, cols * 40 + 20, rows * 12 + 20)) return -1;
+	for (row = 0; row < rows; ++row)
+		for (col = 0; col < cols; ++col)
+			if (s_word(extract, 10 + col * 40, 20 + row * 12, 10, 0, 0, 2 + rand_int(5), 0)) return -1;
+	if (extract_page_end(extract)) return -1;
+	return 0;
+}
+
+static int s_page_index(extract_t *extract, int lines)
+/* Lines of words with jitter and mixed sizes, hyphenated line ends, and a
+few vertical and sloping spans, in random order. */
+{
+	int i;
+
+	if (extract_page_begin(extract, 0, 0, 600, lines * 14 + 20)) return -1;
+	for (i = 0; i < lines * 8; ++i)
+	{
+		int     line = rand_int(lines);
+		int     column = rand_int(8);
+		double  size = 8 + rand_int(5);
+		double  x = 10 + column * 70 + rand_int(3);
+		double  y = 20 + line * 14 + rand_int(2) * 0.5;
+		int     kind = rand_int(40);
+		unsigned last = (rand_int(10) == 0) ? '-' : 0;
+		int     len = 1 + rand_int(8);
+
+		if (kind == 0)
+		{
+			if (s_word(extract, x, y, size, 1, 0, len, 0)) return -1;
+		}
+		else if (kind == 1)
+		{
+			if (s_word(extract, x, y, size, 0, 1, len, 0)) return -1;
+		}
+		else if (kind == 2)
+		{
+			/* A lone hyphen as a line of its own. */
+			if (s_word(extract, x, y, size, 0, 0, 1, '-')) return -1;
+		}
+		else if (s_word(extract, x, y, size, 0, 0, len, last)) return -1;
+	}
+	if (extract_page_end(extract)) return -1;
+	return 0;
+}
+
+static int s_run(extract_format_t format, int seed, int spatial_index, extract_buffer_expanding_t *out, double *seconds)
+/* Processes the test pages with extract_join_spatial_index set to
+<spatial_index>, writing output to <out>. */
+{
+	int                 e = -1;
+	extract_t          *extract = NULL;
+	clock_t             t0;
+
+	srand((unsigned) seed);
+	extract_join_spatial_index = spatial_index;
+	if (extract_buffer_expanding_create(NULL, out)) goto end;
+	if (extract_begin(NULL, format, &extract)) goto end;
+	if (s_page_table(extract, 60, 40)) goto end;
+	if (s_page_index(extract, 50)) goto end;
+	if (s_page_table(extract, 3, 3)) goto end;
+	if (s_page_index(extract, 2)) goto end;
+	t0 = clock();
+	if (extract_process(extract, 0, 0, 0)) goto end;
+	*seconds += (double) (clock() - t0) / CLOCKS_PER_SEC;
+	if (extract_write(extract, out->buffer)) goto end;
+	if (extract_buffer_close(&out->buffer)) goto end;
+	e = 0;
+
+	end:
+	extract_end(&extract);
+	extract_join_spatial_index = 1;
+	return e;
+}
+
+int main(void)
+{
+	extract_format_t formats[] = { extract_format_HTML, extract_format_TEXT };
+	double           seconds[2] = { 0, 0 };
+	int              f, seed;
+
+	for (f = 0; f < 2; ++f)
+	{
+		for (seed = 1; seed <= 5; ++seed)
+		{
+			extract_buffer_expanding_t  out[2];
+			int                         i;
+			for (i = 0; i < 2; ++i)
+			{
+				if (s_run(formats[f], seed, i, &out[i], &seconds[i]))
+				{
+					printf("Error: format=%i seed=%i spatial_index=%i\n", f, seed, i);
+					s_num_fails += 1;
+					out[i].data = NULL;
+					out[i].data_size = 0;
+				}
+			}
+			if (out[0].data_size != out[1].data_size
+					|| (out[0].data_size && memcmp(out[0].data, out[1].data, out[0].data_size)))
+			{
+				printf("Error: output differs: format=%i seed=%i sizes=%zi,%zi\n",
+						f, seed, out[0].data_size, out[1].data_size);
+				s_num_fails += 1;
+			}
+			for (i = 0; i < 2; ++i)
+				extract_free(NULL, &out[i].data);
+		}
+	}
+
+	printf("Processing took %.3fs with the spatial index, %.3fs without.\n", seconds[1], seconds[0]);
+	printf("s_num_fails=%i\n", s_num_fails);
+
+	if (s_num_fails) {
+		printf("Failed\n");
+		return 1;
+	}
+	else {
+		printf("Succeeded\n");
+		return 0;
+	}
+}
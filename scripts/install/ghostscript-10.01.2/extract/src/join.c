@@ -116,6 +116,281 @@ lines_are_compatible(line_t *a,
 }
 
 
+/* A uniform grid over the start positions of lines or paragraphs, so that
+make_lines() and make_paragraphs() only need to score the ones near where they
+are looking, rather than every one on the subpage.
+
+Entries are kept in content order, and an entry's index is used as the
+tie-breaker, so that the same line or paragraph is picked as when scanning the
+whole list. If any position is unusable (huge, infinite or NaN), the
+arithmetic in the scoring code could produce NaN, whose effect depends on
+the order in which candidates are seen, so we fall back to returning every
+entry in order. */
+
+int extract_join_spatial_index = 1;
+
+typedef struct
+{
+	void   *item;   /* line_t or paragraph_t, or NULL once it has been removed. */
+	double  x;
+	double  y;
+	int     next;   /* Next entry in the same cell, or -1. */
+} grid_entry_t;
+
+typedef struct
+{
+	grid_entry_t *entries;
+	int           entries_num;
+	rect_t        bounds;       /* Of all entries, including moved ones. */
+	point_t       origin;       /* Of cell (0, 0). */
+	double        cell_size;
+	double        slack;        /* Allowance for rounding errors in queries. */
+	int           nx;
+	int           ny;
+	int          *cells;        /* Index of first entry in each cell, or -1. */
+	int           all;          /* If true, queries return every entry. */
+	int          *candidates;   /* Results of the last query, as indices. */
+	int           candidates_num;
+} grid_t;
+
+/* Returns true if v is small enough that scoring arithmetic on it cannot
+overflow, and is not NaN. */
+static int coord_ok(double v)
+{
+	return fabs(v) < 1e30;
+}
+
+static void grid_init(grid_t *grid)
+{
+	grid->entries = NULL;
+	grid->entries_num = 0;
+	grid->cells = NULL;
+	grid->candidates = NULL;
+	grid->candidates_num = 0;
+	grid->slack = 0;
+	grid->all = 0;
+}
+
+static void grid_free(extract_alloc_t *alloc, grid_t *grid)
+{
+	extract_free(alloc, &grid->entries);
+	extract_free(alloc, &grid->cells);
+	extract_free(alloc, &grid->candidates);
+}
+
+/* Allocates space for <num> entries, to be filled in with grid_set(). */
+static int grid_alloc(extract_alloc_t *alloc, grid_t *grid, int num)
+{
+	if (extract_malloc(alloc, &grid->entries, sizeof(*grid->entries) * (num + 1))) return -1;
+	if (extract_malloc(alloc, &grid->candidates, sizeof(*grid->candidates) * (num + 1))) return -1;
+	grid->entries_num = num;
+	return 0;
+}
+
+static void grid_set(grid_t *grid, int i, void *item, double x, double y)
+{
+	grid->entries[i].item = item;
+	grid->entries[i].x = x;
+	grid->entries[i].y = y;
+	grid->entries[i].next = -1;
+}
+
+/* Returns the cell column or row containing v, clamped to the grid. Clamping
+keeps everything outside the grid in the border cells, so a point inside a
+query box is always in a cell overlapping the box. */
+static int grid_cell(double v, double min, double cell_size, int n)
+{
+	double i = floor((v - min) / cell_size);
+
+	if (!(i >= 0))
+		return 0;
+	if (i >= n)
+		return n - 1;
+	return (int) i;
+}
+
+static void grid_insert(grid_t *grid, int i)
+{
+	grid_entry_t *entry = &grid->entries[i];
+	int          *cell = &grid->cells[
+			grid_cell(entry->y, grid->origin.y, grid->cell_size, grid->ny) * grid->nx +
+			grid_cell(entry->x, grid->origin.x, grid->cell_size, grid->nx)];
+
+	entry->next = *cell;
+	*cell = i;
+}
+
+static void grid_remove(grid_t *grid, int i)
+{
+	grid_entry_t *entry = &grid->entries[i];
+
+	if (!grid->all)
+	{
+		int *p = &grid->cells[
+				grid_cell(entry->y, grid->origin.y, grid->cell_size, grid->ny) * grid->nx +
+				grid_cell(entry->x, grid->origin.x, grid->cell_size, grid->nx)];
+		while (*p != i)
+			p = &grid->entries[*p].next;
+		*p = entry->next;
+	}
+	entry->item = NULL;
+}
+
+/* Moves entry <i> to (x, y), e.g. because its first line has changed. */
+static void grid_move(grid_t *grid, int i, double x, double y)
+{
+	void *item = grid->entries[i].item;
+
+	grid_remove(grid, i);
+	grid_set(grid, i, item, x, y);
+	if (!grid->all)
+	{
+		if (coord_ok(x) && coord_ok(y))
+		{
+			point_t p = { x, y };
+			grid->bounds = extract_rect_union_point(grid->bounds, p);
+			grid_insert(grid, i);
+		}
+		else
+		{
+			/* Rebuilding would be pointless; use the full scan from now on. */
+			grid->all = 1;
+		}
+	}
+}
+
+/* Builds the cells once all entries have been set. The cell size is chosen
+from the density of the entries, with a limit of roughly three cells per
+entry. */
+static int grid_build(extract_alloc_t *alloc, grid_t *grid)
+{
+	int     i;
+	int     n = grid->entries_num;
+	double  w, h;
+
+	if (!extract_join_spatial_index || n == 0)
+		grid->all = 1;
+	grid->bounds = extract_rect_empty;
+	for (i = 0; i < n; ++i)
+	{
+		point_t p = { grid->entries[i].x, grid->entries[i].y };
+		if (!coord_ok(p.x) || !coord_ok(p.y))
+			grid->all = 1;
+		grid->bounds = extract_rect_union_point(grid->bounds, p);
+	}
+	if (grid->all)
+		return 0;
+
+	grid->origin = grid->bounds.min;
+	w = grid->bounds.max.x - grid->bounds.min.x;
+	h = grid->bounds.max.y - grid->bounds.min.y;
+	grid->cell_size = sqrt(w * h / n);
+	if (grid->cell_size < w / n)
+		grid->cell_size = w / n;
+	if (grid->cell_size < h / n)
+		grid->cell_size = h / n;
+	if (!(grid->cell_size > 0))
+		grid->cell_size = 1;
+	grid->slack = 1e-6 * (w + h + fabs(grid->bounds.min.x) + fabs(grid->bounds.min.y) + grid->cell_size);
+	grid->nx = (int) (w / grid->cell_size) + 1;
+	grid->ny = (int) (h / grid->cell_size) + 1;
+
+	if (extract_malloc(alloc, &grid->cells, sizeof(*grid->cells) * grid->nx * grid->ny)) return -1;
+	for (i = 0; i < grid->nx * grid->ny; ++i)
+		grid->cells[i] = -1;
+	/* Insert in reverse, so each cell lists its entries in content order. */
+	for (i = n - 1; i >= 0; --i)
+		grid_insert(grid, i);
+
+	return 0;
+}
+
+/* Sets grid->candidates to the entries that are in cells overlapping <box>,
+or to all remaining entries in order if <all> is true or the grid is not
+usable. */
+static void grid_find(grid_t *grid, int all, rect_t box)
+{
+	grid->candidates_num = 0;
+	if (all || grid->all)
+	{
+		int i;
+		for (i = 0; i < grid->entries_num; ++i)
+			if (grid->entries[i].item)
+				grid->candidates[grid->candidates_num++] = i;
+		return;
+	}
+	if (!extract_rect_valid(box))
+		return;
+	{
+		int x0 = grid_cell(box.min.x - grid->slack, grid->origin.x, grid->cell_size, grid->nx);
+		int x1 = grid_cell(box.max.x + grid->slack, grid->origin.x, grid->cell_size, grid->nx);
+		int y0 = grid_cell(box.min.y - grid->slack, grid->origin.y, grid->cell_size, grid->ny);
+		int y1 = grid_cell(box.max.y + grid->slack, grid->origin.y, grid->cell_size, grid->ny);
+		int x, y;
+
+		for (y = y0; y <= y1; ++y)
+		{
+			for (x = x0; x <= x1; ++x)
+			{
+				int i;
+				for (i = grid->cells[y * grid->nx + x]; i != -1; i = grid->entries[i].next)
+					grid->candidates[grid->candidates_num++] = i;
+			}
+		}
+	}
+}
+
+/* Returns the bounding box of the part of the grid's bounds where
+c0 <= n.x*x + n.y*y <= c1, i.e. of a band between two parallel lines. The
+extremes are at corners of the bounds inside the band, or where the edges
+of the band cross the edges of the bounds. The bounds are expanded by the
+slack, so that rounding cannot lose an entry on their edge. */
+static rect_t grid_band_box(const grid_t *grid, point_t n, double c0, double c1)
+{
+	rect_t       box = extract_rect_empty;
+	const rect_t b = {
+			{ grid->bounds.min.x - grid->slack, grid->bounds.min.y - grid->slack },
+			{ grid->bounds.max.x + grid->slack, grid->bounds.max.y + grid->slack }
+			};
+	double       xs[2] = { b.min.x, b.max.x };
+	double       ys[2] = { b.min.y, b.max.y };
+	double       cs[2] = { c0, c1 };
+	int          i, j;
+
+	for (i = 0; i < 2; ++i)
+	{
+		for (j = 0; j < 2; ++j)
+		{
+			point_t corner = { xs[i], ys[j] };
+			double  c = n.x * corner.x + n.y * corner.y;
+			if (c >= c0 && c <= c1)
+				box = extract_rect_union_point(box, corner);
+		}
+	}
+	for (i = 0; i < 2; ++i)
+	{
+		for (j = 0; j < 2; ++j)
+		{
+			if (n.y != 0)
+			{
+				/* Crossing of the vertical edge x=xs[j]. */
+				point_t p = { xs[j], (cs[i] - n.x * xs[j]) / n.y };
+				if (p.y >= b.min.y && p.y <= b.max.y)
+					box = extract_rect_union_point(box, p);
+			}
+			if (n.x != 0)
+			{
+				/* Crossing of the horizontal edge y=ys[j]. */
+				point_t p = { (cs[i] - n.y * ys[j]) / n.x, ys[j] };
+				if (p.x >= b.min.x && p.x <= b.max.x)
+					box = extract_rect_union_point(box, p);
+			}
+		}
+	}
+	return box;
+}
+
+
 static const unsigned ucs_NONE = ((unsigned) -1);
 
 /* Returns with <o_span> containing char_t's from <span> that are inside
@@ -198,26 +473,41 @@ make_lines(
 	int                    ret = -1;
 	int                    a;
 	content_line_iterator  lit;
-	line_t                *line_a;
+	line_t                *line;
 	content_span_iterator  sit;
 	span_t                *span;
+	grid_t                 grid;
+	double                 max_adv = 0;
+
+	grid_init(&grid);
 
 	/* On entry <lines> contains spans. Make each span part of a <line>. */
 	for (a = 0, span = content_span_iterator_init(&sit, lines); span != NULL; span = content_span_iterator_next(&sit), a++)
 	{
-		line_t *line;
-
 		if (content_replace_new_line(alloc, &span->base, &line)) goto end;
 		content_append_span(&line->content, span);
 		outfx("initial line a=%i: %s", a, line_string(line));
 	}
 
+	/* Index the lines by the position of their first char, which is where
+	line_a's end is compared with. Appending to a line doesn't change this. */
+	if (grid_alloc(alloc, &grid, content_count_lines(lines))) goto end;
+	for (a = 0, line = content_line_iterator_init(&lit, lines); line != NULL; a++, line = content_line_iterator_next(&lit))
+	{
+		char_t *first = span_char_first(extract_line_span_first(line));
+		grid_set(&grid, a, line, first->x, first->y);
+		if (!coord_ok(first->adv))
+			grid.all = 1;
+		else if (fabs(first->adv) > max_adv)
+			max_adv = fabs(first->adv);
+	}
+	if (grid_build(alloc, &grid)) goto end;
+
 	/* For each line, look for nearest aligned line, and append if found. */
-	for (a=0, line_a = content_line_iterator_init(&lit, lines); line_a != NULL; a++, line_a = content_line_iterator_next(&lit))
+	for (a = 0; a < grid.entries_num; a++)
 	{
-		content_line_iterator  lit2;
-		line_t                *line_b;
-		int                    b;
+		line_t                *line_a = grid.entries[a].item;
+		int                    c;
 		int                    nearest_line_b = -1;
 		double                 nearest_score = 0;
 		line_t                *nearest_line = NULL;
@@ -225,12 +515,37 @@ make_lines(
 		double                 nearest_space_guess = 0;
 		span_t                *span_a;
 
+		if (line_a == NULL)
+			continue;
 		span_a = extract_line_span_last(line_a);
 
-		for (b = 0, line_b = content_line_iterator_init(&lit2, lines); line_b != NULL; b++, line_b = content_line_iterator_next(&lit2))
+		/* Only lines starting within the largest distance accepted below
+		can be candidates. colinear and perp are the components of the
+		distance between span_a's end and line_b's start, divided by
+		sqrt(scale_squared), and space_guess is at most
+		(|adv| + max_adv) / 4, so the distance is at most
+		sqrt(8*8 + 1.5*1.5) < 8.14 times that. */
 		{
-			if (line_a == line_b)
-				continue;
+			char_t *last_a = extract_span_char_last(span_a);
+			double  scale_squared = ((span_a->flags.wmode) ?
+									(span_a->ctm.c * span_a->ctm.c + span_a->ctm.d * span_a->ctm.d) :
+									(span_a->ctm.a * span_a->ctm.a + span_a->ctm.b * span_a->ctm.b));
+			point_t dir = { last_a->adv * (1 - span_a->flags.wmode), last_a->adv * span_a->flags.wmode };
+			point_t tdir = extract_matrix4_transform_point(span_a->ctm, dir);
+			point_t span_a_end = { last_a->x + tdir.x, last_a->y + tdir.y };
+			double  r = sqrt(scale_squared) * (fabs(last_a->adv) + max_adv) / 4 * 8.14;
+			rect_t  box = { { span_a_end.x - r, span_a_end.y - r }, { span_a_end.x + r, span_a_end.y + r } };
+			int     all = (!coord_ok(r) || !coord_ok(tdir.x) || !coord_ok(tdir.y) ||
+							!coord_ok(span_a_end.x) || !coord_ok(span_a_end.y) ||
+							!(fabs(last_a->adv) > 1e-30) || !(scale_squared > 1e-30));
+
+			grid_find(&grid, all, box);
+		}
+
+		for (c = 0; c < grid.candidates_num; c++)
+		{
+			int     b = grid.candidates[c];
+			line_t *line_b = grid.entries[b].item;
 
 			if (!lines_are_compatible(line_a, line_b))
 				continue;
@@ -266,7 +581,7 @@ make_lines(
 				if (score < fabs(perp) * 10) /* perpendicular distance matters much more. */
 					score = fabs(perp) * 10;
 
-				if (!nearest_line || score < nearest_score)
+				if (!nearest_line || score < nearest_score || (score == nearest_score && b < nearest_line_b))
 				{
 					nearest_line = line_b;
 					nearest_score = score;
@@ -282,7 +597,6 @@ make_lines(
 			/* line_a and nearest_line are aligned so we can move line_b's
 			spans on to the end of line_a. */
 			span_t *span_b = extract_line_span_first(nearest_line);
-			b = nearest_line_b;
 
 			if (extract_span_char_last(span_a)->ucs != ' ' &&
 				span_char_first(span_b)->ucs != ' ')
@@ -313,17 +627,13 @@ make_lines(
 			content_concat(&line_a->content, &nearest_line->content);
 
 			/* Ensure that we ignore nearest_line from now on. */
-			if (lit.next == &nearest_line->base)
-				lit.next = lit.next->next;
+			grid_remove(&grid, nearest_line_b);
 			extract_line_free(alloc, &nearest_line);
 
-			if (b > a) {
+			if (nearest_line_b > a) {
 				/* We haven't yet tried appending any spans to nearest_line, so
 				the new extended line_a needs checking again. */
-				lit.next = &line_a->base;
 				a--;
-			} else {
-				a--; /* b is before a, so a's number needs to move back one. */
 			}
 		}
 	}
@@ -331,6 +641,7 @@ make_lines(
 	ret = 0;
 
 end:
+	grid_free(alloc, &grid);
 	if (ret) {
 		/* Free everything. */
 		extract_span_free(alloc, &span);
@@ -454,39 +765,82 @@ make_paragraphs(
 	content_line_iterator       lit;
 	line_t                     *line;
 	content_paragraph_iterator  pit;
-	paragraph_t                *paragraph_a;
+	paragraph_t                *paragraph;
+	grid_t                      grid;
+	double                      max_height = 0;
+	int                         lines_removed = 0;
+
+	grid_init(&grid);
 
 	/* Convert every line_t to be a paragraph_t containing that line_t. */
 	for (line = content_line_iterator_init(&lit, content); line != NULL; line = content_line_iterator_next(&lit))
 	{
-		paragraph_t *paragraph;
 		if (content_replace_new_paragraph(alloc, &line->base, &paragraph))
 			goto end;
 		content_append_line(&paragraph->content, line);
 		calculate_line_height(line);
+		if (line->ascender - line->descender > max_height)
+			max_height = line->ascender - line->descender;
+	}
+
+	/* Index the paragraphs by the position of the first char of their first
+	line. */
+	if (grid_alloc(alloc, &grid, content_count_paragraphs(content))) goto end;
+	for (a = 0, paragraph = content_paragraph_iterator_init(&pit, content); paragraph != NULL; a++, paragraph = content_paragraph_iterator_next(&pit))
+	{
+		char_t *first = span_char_first(extract_line_span_first(paragraph_line_first(paragraph)));
+		grid_set(&grid, a, paragraph, first->x, first->y);
 	}
+	if (grid_build(alloc, &grid)) goto end;
 
 	/* Now join paragraphs together where possible. */
-	for (a=0, paragraph_a = content_paragraph_iterator_init(&pit, content); paragraph_a != NULL; a++, paragraph_a = content_paragraph_iterator_next(&pit)) {
+	for (a = 0; a < grid.entries_num; a++) {
+		paragraph_t                *paragraph_a = grid.entries[a].item;
 		paragraph_t                *nearest_paragraph = NULL;
 		int                         nearest_paragraph_b = -1;
 		double                      nearest_score = 0;
 		line_t                     *line_a;
-		paragraph_t                *paragraph_b;
-		content_paragraph_iterator  pit2;
-		int b;
+		int                         c;
+		int                         reprocess;
 		span_t                     *span_a;
 
+		if (paragraph_a == NULL)
+			continue;
 		line_a = paragraph_line_last(paragraph_a);
 		assert(line_a != NULL);
 		span_a = extract_line_span_last(line_a);
 		assert(span_a != NULL);
 
+		/* We only join with the nearest paragraph if its score is less than
+		the sum of the two line heights, so if there is nothing with a score
+		in [0, line_a's height + max_height], the nearest paragraph doesn't
+		matter. The score is the distance of line_b's start below the
+		baseline through line_a's start, so such paragraphs start in a band
+		parallel to the baseline. */
+		{
+			char_t *first_a = span_char_first(extract_line_span_first(line_a));
+			point_t dir = { 1 - span_a->flags.wmode, span_a->flags.wmode };
+			point_t tdir_a = extract_matrix4_transform_point(span_a->ctm, dir);
+			double  scale = sqrt((span_a->flags.wmode) ?
+										(span_a->ctm.c * span_a->ctm.c + span_a->ctm.d * span_a->ctm.d) :
+										(span_a->ctm.a * span_a->ctm.a + span_a->ctm.b * span_a->ctm.b));
+			double  height = line_a->ascender - line_a->descender + max_height;
+			point_t n = { tdir_a.y, -tdir_a.x };
+			double  c0 = n.x * first_a->x + n.y * first_a->y;
+			double  margin = 1e-6 * (fabs(c0) + height * scale) + grid.slack * (fabs(n.x) + fabs(n.y));
+			int     all = (!coord_ok(first_a->x) || !coord_ok(first_a->y) || !coord_ok(height) ||
+							!coord_ok(n.x) || !coord_ok(n.y) || !(scale > 1e-30));
+
+			grid_find(&grid, all, all ? extract_rect_empty : grid_band_box(&grid, n, c0 - height * scale - margin, c0 + margin));
+		}
+
 		/* Look for nearest paragraph_t that could be appended to
 		paragraph_a. */
-		for (b=0, paragraph_b = content_paragraph_iterator_init(&pit2, content); paragraph_b != NULL; b++, paragraph_b = content_paragraph_iterator_next(&pit2))
+		for (c = 0; c < grid.candidates_num; c++)
 		{
-			line_t *line_b;
+			int          b = grid.candidates[c];
+			paragraph_t *paragraph_b = grid.entries[b].item;
+			line_t      *line_b;
 
 			if (paragraph_a == paragraph_b)
 				continue;
@@ -548,7 +902,7 @@ make_paragraphs(
 				if (dot_saeb < 0)
 					continue;
 
-				if (score >= 0 && (!nearest_paragraph || score < nearest_score))
+				if (score >= 0 && (!nearest_paragraph || score < nearest_score || (score == nearest_score && b < nearest_paragraph_b)))
 				{
 					nearest_paragraph = paragraph_b;
 					nearest_score = score;
@@ -588,7 +942,7 @@ make_paragraphs(
 						if (line_a->content.base.next == &line_a->content.base)
 						{
 							extract_line_free(alloc, &line_a);
-							a--; /* Keep the index correct. */
+							lines_removed++;
 						}
 					}
 				}
@@ -618,17 +972,35 @@ make_paragraphs(
 #endif
 
 				/* Ensure that we skip nearest_paragraph in future. */
-				if (pit.next == &nearest_paragraph->base)
-					pit.next = pit.next->next;
+				grid_remove(&grid, nearest_paragraph_b);
 				extract_paragraph_free(alloc, &nearest_paragraph);
 
-				if (nearest_paragraph_b > a) {
+				/* If line_a was removed, paragraph_a starts somewhere else. */
+				{
+					char_t *first = span_char_first(extract_line_span_first(paragraph_line_first(paragraph_a)));
+					if (first->x != grid.entries[a].x || first->y != grid.entries[a].y)
+						grid_move(&grid, a, first->x, first->y);
+				}
+
+				/* This loop used to count paragraphs in the list, and its count
+				dropped one behind for each line_a removed above. That made a
+				nearest paragraph up to that many places before paragraph_a
+				count as after it, and we keep doing that so that the output
+				doesn't change. */
+				reprocess = nearest_paragraph_b > a;
+				if (!reprocess && lines_removed > 0)
+				{
+					int i;
+					int places = 1;
+					for (i = nearest_paragraph_b + 1; i < a && places < lines_removed; ++i)
+						if (grid.entries[i].item)
+							places++;
+					reprocess = places < lines_removed;
+				}
+				if (reprocess) {
 					/* We haven't yet tried appending any paragraphs to
 					nearest_paragraph_b, so the new extended paragraph_a needs
 					checking again. */
-					pit.next = &paragraph_a->base;
-					a -= 1;
-				} else {
 					a -= 1;
 				}
 			}
@@ -642,6 +1014,7 @@ make_paragraphs(
 	ret = 0;
 
 end:
+	grid_free(alloc, &grid);
 
 	return ret;
 }
@@ -5,6 +5,7 @@
 #include "astring.h"
 #include "document.h"
 #include "html.h"
+#include "json.h"
 #include "mem.h"
 #include "memento.h"
 #include "outf.h"
@@ -579,6 +579,11 @@ typedef struct {
     opj_thread_pool_t   *tp;
     opj_thread_t        *thread;
     int                  marked_as_waiting;
+    /* Ghostscript: the entry for this thread in the list of waiting
+     * threads, allocated up front, as the thread puts itself on the list
+     * after the jobs it was waited for are finished, by when the caller's
+     * allocator may not be available. */
+    struct opj_worker_thread_list_t *waiting_item;
 
     opj_mutex_t         *mutex;
     opj_cond_t          *cond;
@@ -718,11 +723,22 @@ static OPJ_BOOL opj_thread_pool_setup(opj_thread_pool_t* tp, int num_threads)
             break;
         }
 
+        tp->worker_threads[i].waiting_item = (opj_worker_thread_list_t*) opj_malloc(
+                sizeof(opj_worker_thread_list_t));
+        if (tp->worker_threads[i].waiting_item == NULL) {
+            opj_cond_destroy(tp->worker_threads[i].cond);
+            opj_mutex_destroy(tp->worker_threads[i].mutex);
+            tp->worker_threads_count = i;
+            bRet = OPJ_FALSE;
+            break;
+        }
+
         tp->worker_threads[i].marked_as_waiting = OPJ_FALSE;
 
         tp->worker_threads[i].thread = opj_thread_create(opj_worker_thread_function,
                                        &(tp->worker_threads[i]));
         if (tp->worker_threads[i].thread == NULL) {
+            opj_free(tp->worker_threads[i].waiting_item);
             opj_mutex_destroy(tp->worker_threads[i].mutex);
             opj_cond_destroy(tp->worker_threads[i].cond);
             tp->worker_threads_count = i;
@@ -796,15 +812,7 @@ static opj_worker_thread_job_t* opj_thread_pool_get_next_job(
             tp->waiting_worker_thread_count ++;
             assert(tp->waiting_worker_thread_count <= tp->worker_threads_count);
 
-            item = (opj_worker_thread_list_t*) opj_malloc(sizeof(opj_worker_thread_list_t));
-            if (item == NULL) {
-                tp->state = OPJWTS_ERROR;
-                opj_cond_signal(tp->cond);
-
-                opj_mutex_unlock(tp->mutex);
-                return NULL;
-            }
-
+            item = worker_thread->waiting_item;
             item->worker_thread = worker_thread;
             item->next = tp->waiting_worker_thread_list;
             tp->waiting_worker_thread_list = item;
@@ -866,7 +874,6 @@ OPJ_BOOL opj_thread_pool_submit_job(opj_thread_pool_t* tp,
     if (tp->waiting_worker_thread_list) {
         opj_worker_thread_t* worker_thread;
         opj_worker_thread_list_t* next;
-        opj_worker_thread_list_t* to_opj_free;
 
         worker_thread = tp->waiting_worker_thread_list->worker_thread;
 
@@ -874,7 +881,6 @@ OPJ_BOOL opj_thread_pool_submit_job(opj_thread_pool_t* tp,
         worker_thread->marked_as_waiting = OPJ_FALSE;
 
         next = tp->waiting_worker_thread_list->next;
-        to_opj_free = tp->waiting_worker_thread_list;
         tp->waiting_worker_thread_list = next;
         tp->waiting_worker_thread_count --;
 
@@ -882,8 +888,6 @@ OPJ_BOOL opj_thread_pool_submit_job(opj_thread_pool_t* tp,
         opj_mutex_unlock(tp->mutex);
         opj_cond_signal(worker_thread->cond);
         opj_mutex_unlock(worker_thread->mutex);
-
-        opj_free(to_opj_free);
     } else {
         opj_mutex_unlock(tp->mutex);
     }
@@ -936,15 +940,11 @@ void opj_thread_pool_destroy(opj_thread_pool_t* tp)
             opj_thread_join(tp->worker_threads[i].thread);
             opj_cond_destroy(tp->worker_threads[i].cond);
             opj_mutex_destroy(tp->worker_threads[i].mutex);
+            opj_free(tp->worker_threads[i].waiting_item);
         }
 
         opj_free(tp->worker_threads);
-
-        while (tp->waiting_worker_thread_list != NULL) {
-            opj_worker_thread_list_t* next = tp->waiting_worker_thread_list->next;
-            opj_free(tp->waiting_worker_thread_list);
-            tp->waiting_worker_thread_list = next;
-        }
+        tp->waiting_worker_thread_list = NULL;
 
         opj_cond_destroy(tp->cond);
     }
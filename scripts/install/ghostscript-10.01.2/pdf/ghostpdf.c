@@ -39,8 +39,10 @@
 #include "pdf_repair.h"
 #include "pdf_xref.h"
 #include "pdf_device.h"
+#include "pdf_deref.h"
 
 #include "gsstate.h"        /* For gs_gstate */
+#include "gsdevice.h"       /* For gs_currentdevice */
 #include "gsicc_manage.h"  /* For gsicc_init_iccmanager() */
 
 #if PDFI_LEAK_CHECK
@@ -849,7 +851,12 @@ int pdfi_close_pdf_file(pdf_context *ctx)
 
 static int pdfi_process(pdf_context *ctx)
 {
-    int code = 0, i;
+    int code = 0, code1, i;
+    gx_device *dev = gs_currentdevice(ctx->pgs);
+
+    code = pdfi_start_page_workers(ctx, dev);
+    if (code < 0)
+        goto exit;
 
     /* Loop over each page and either render it or output the
      * required information.
@@ -865,13 +872,17 @@ static int pdfi_process(pdf_context *ctx)
         }
         if (ctx->args.pdfinfo)
             code = pdfi_output_page_info(ctx, i);
-        else
+        else if (pdfi_page_worker_selected(ctx, dev))
             code = pdfi_page_render(ctx, i, true);
 
         if (code < 0 && ctx->args.pdfstoponerror)
-            goto exit;
+            break;
         code = 0;
     }
+
+    code1 = pdfi_end_page_workers(ctx, dev, code);
+    if (code >= 0)
+        code = code1;
  exit:
     pdfi_report_errors(ctx);
 
@@ -1847,12 +1858,6 @@ pdf_context *pdfi_create_context(gs_memory_t *mem)
 #if REFCNT_DEBUG
     ctx->UID = 1;
 #endif
-#if CACHE_STATISTICS
-    ctx->hits = 0;
-    ctx->misses = 0;
-    ctx->compressed_hits = 0;
-    ctx->compressed_misses = 0;
-#endif
 #ifdef DEBUG
     ctx->args.verbose_errors = ctx->args.verbose_warnings = 1;
 #endif
@@ -1909,13 +1914,13 @@ pdfi_purge_obj_cache(pdf_context *ctx)
             }
             pdfi_countdown(entry->o);
             ctx->cache_entries--;
-            gs_free_object(ctx->memory, entry, "pdfi_clear_context, free LRU");
+            pdfi_free_cache_entry(ctx, entry);
             entry = next;
 #if REFCNT_DEBUG
             ctx->cache_LRU = entry;
 #endif
         }
-        ctx->cache_LRU = ctx->cache_MRU = NULL;
+        ctx->cache_LRU = ctx->cache_MRU = ctx->cache_frequent = NULL;
         ctx->cache_entries = 0;
     }
 }
@@ -1928,21 +1933,24 @@ pdfi_purge_obj_cache(pdf_context *ctx)
  */
 int pdfi_clear_context(pdf_context *ctx)
 {
-#if CACHE_STATISTICS
-    float compressed_hit_rate = 0.0, hit_rate = 0.0;
-
-    if (ctx->compressed_hits > 0 || ctx->compressed_misses > 0)
-        compressed_hit_rate = (float)ctx->compressed_hits / (float)(ctx->compressed_hits + ctx->compressed_misses);
-    if (ctx->hits > 0 || ctx->misses > 0)
-        hit_rate = (float)ctx->hits / (float)(ctx->hits + ctx->misses);
-
-    dmprintf1(ctx->memory, "Number of normal object cache hits: %"PRIi64"\n", ctx->hits);
-    dmprintf1(ctx->memory, "Number of normal object cache misses: %"PRIi64"\n", ctx->misses);
-    dmprintf1(ctx->memory, "Number of compressed object cache hits: %"PRIi64"\n", ctx->compressed_hits);
-    dmprintf1(ctx->memory, "Number of compressed object cache misses: %"PRIi64"\n", ctx->compressed_misses);
-    dmprintf1(ctx->memory, "Normal object cache hit rate: %f\n", hit_rate);
-    dmprintf1(ctx->memory, "Compressed object cache hit rate: %f\n", compressed_hit_rate);
-#endif
+    if (CACHE_STATISTICS || ctx->args.pdfdebug) {
+        float compressed_hit_rate = 0.0, hit_rate = 0.0;
+
+        if (ctx->compressed_hits > 0 || ctx->compressed_misses > 0)
+            compressed_hit_rate = (float)ctx->compressed_hits / (float)(ctx->compressed_hits + ctx->compressed_misses);
+        if (ctx->hits > 0 || ctx->misses > 0)
+            hit_rate = (float)ctx->hits / (float)(ctx->hits + ctx->misses);
+
+        dmprintf1(ctx->memory, "Number of normal object cache hits: %"PRIi64"\n", ctx->hits);
+        dmprintf1(ctx->memory, "Number of normal object cache misses: %"PRIi64"\n", ctx->misses);
+        dmprintf1(ctx->memory, "Number of compressed object cache hits: %"PRIi64"\n", ctx->compressed_hits);
+        dmprintf1(ctx->memory, "Number of compressed object cache misses: %"PRIi64"\n", ctx->compressed_misses);
+        dmprintf1(ctx->memory, "Normal object cache hit rate: %f\n", hit_rate);
+        dmprintf1(ctx->memory, "Compressed object cache hit rate: %f\n", compressed_hit_rate);
+        dmprintf1(ctx->memory, "Number of object cache evictions: %"PRIi64"\n", ctx->evictions);
+        dmprintf1(ctx->memory, "Number of objects recached after eviction: %"PRIi64"\n", ctx->readmissions);
+        dmprintf2(ctx->memory, "Object cache: %u entries, %"PRIi64" bytes\n", ctx->cache_entries, ctx->cache_bytes);
+    }
     if (ctx->PathSegments != NULL) {
         gs_free_object(ctx->memory, ctx->PathSegments, "pdfi_clear_context");
         ctx->PathSegments = NULL;
@@ -2081,7 +2089,7 @@ int pdfi_clear_context(pdf_context *ctx)
                     if (next)
                         next->previous = prev;
                     ctx->cache_entries--;
-                    gs_free_object(ctx->memory, entry, "pdfi_clear_context, free LRU");
+                    pdfi_free_cache_entry(ctx, entry);
                 }
                 entry = next;
             }
@@ -2101,7 +2109,7 @@ int pdfi_clear_context(pdf_context *ctx)
             next = entry->next;
             pdfi_countdown(entry->o);
             ctx->cache_entries--;
-            gs_free_object(ctx->memory, entry, "pdfi_clear_context, free LRU");
+            pdfi_free_cache_entry(ctx, entry);
             entry = next;
 #if REFCNT_DEBUG
             ctx->cache_LRU = entry;
@@ -2111,6 +2119,7 @@ int pdfi_clear_context(pdf_context *ctx)
         ctx->cache_LRU = ctx->cache_MRU = NULL;
         ctx->cache_entries = 0;
     }
+    pdfi_free_obj_cache(ctx);
 
     /* We can't free the font directory before the graphics library fonts fonts are freed, as they reference the font_dir.
      * graphics library fonts are refrenced from pdf_font objects, and those may be in the cache, which means they
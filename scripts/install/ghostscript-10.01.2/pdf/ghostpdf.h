@@ -89,7 +89,11 @@ typedef enum pdf_type3_d_type_e {
 
 #define INITIAL_STACK_SIZE 32
 #define MAX_STACK_SIZE 524288
-#define MAX_OBJECT_CACHE_SIZE 200
+/* Default size, in bytes, of the object cache. The size of each object is estimated,
+ * see pdfi_obj_cache_size(). The cache used to be limited to 200 objects, so this
+ * leaves room for 200 fonts with 32KB font programs.
+ */
+#define DEFAULT_OBJECT_CACHE_SIZE (8 * 1024 * 1024)
 #define INITIAL_LOOP_TRACKER_SIZE 32
 
 typedef struct pdf_transfer_s {
@@ -156,6 +160,9 @@ typedef struct cmd_args_s {
 
     bool ignoretounicode;
     bool nonativefontmap;
+    int object_cache_size;      /* -dPDFObjectCacheSize=, 0 for the default */
+    int page_workers;           /* -dPDFPageWorkers=, 0 or 1 to render pages one at a time */
+    bool reduceimages;          /* -dPDFReduceImages, decode JPEG images at reduced size */
 } cmd_args_t;
 
 typedef struct encryption_state_s {
@@ -285,6 +292,8 @@ typedef struct device_state_s {
     bool PassUserUnit;
     bool ModifiesPageSize;
     bool ModifiesPageOrder;
+    /* The device's NumRenderingThreads, which JPX decoding uses too */
+    int NumRenderingThreads;
 } device_state_t;
 
 /*
@@ -341,6 +350,17 @@ typedef struct pdf_context_s
      */
     int Pdfmark_InitialPage;
 
+    /* Rendering pages in parallel (-dPDFPageWorkers=), see pdf_page.c. Each
+     * worker renders every page_worker_count'th page, and the original
+     * process waits for the others to finish. page_worker_count is 1 when
+     * pages are rendered one at a time.
+     */
+    int page_worker;
+    int page_worker_count;
+    int page_worker_ordinal;    /* The number of pages selected so far */
+    long page_worker_base;      /* The device PageCount when the workers started */
+    int *page_worker_pids;      /* In the original process, 0 for workers which didn't start */
+
     /* Optional things from Root */
     pdf_dict *OCProperties;
     pdf_dict *Collection;
@@ -438,10 +458,29 @@ typedef struct pdf_context_s
     pdf_obj **stack_top;
     pdf_obj **stack_limit;
 
-    /* The object cache */
+    /* The object cache. The entries form a single list from cache_LRU to cache_MRU,
+     * the entries on probation first, followed by the 'frequent' entries starting
+     * at cache_frequent. See pdf_deref.c.
+     */
     uint32_t cache_entries;
     pdf_obj_cache_entry *cache_LRU;
     pdf_obj_cache_entry *cache_MRU;
+    pdf_obj_cache_entry *cache_frequent;
+    uint64_t cache_bytes;
+    uint64_t cache_probation_bytes;
+    pdf_obj_cache_entry *cache_free_entries;
+    pdf_obj_cache_block *cache_blocks;
+    /* Ring of the object numbers of entries recently evicted from probation */
+    uint64_t *cache_ghosts;
+    uint32_t cache_ghost_size;
+    uint32_t cache_ghost_next;
+    /* Object cache statistics, printed with -dPDFDEBUG */
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t compressed_hits;
+    uint64_t compressed_misses;
+    uint64_t evictions;
+    uint64_t readmissions;
 
     /* The loop detection state */
     uint32_t loop_detection_size;
@@ -486,12 +525,6 @@ typedef struct pdf_context_s
 #if REFCNT_DEBUG
     uint64_t ref_UID;
 #endif
-#if CACHE_STATISTICS
-    uint64_t hits;
-    uint64_t misses;
-    uint64_t compressed_hits;
-    uint64_t compressed_misses;
-#endif
 #if PDFI_LEAK_CHECK
     gs_memory_status_t memstat;
 #endif
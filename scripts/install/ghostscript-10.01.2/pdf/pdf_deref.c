@@ -30,20 +30,323 @@
 #include "pdf_array.h"
 #include "pdf_deref.h"
 #include "pdf_repair.h"
+#include "pdf_font_types.h"
 
 /* Start with the object caching functions */
 
-/* given an object, create a cache entry for it. If we have too many entries
- * then delete the leat-recently-used cache entry. Make the new entry be the
- * most-recently-used entry. The actual entries are attached to the xref table
- * (as well as being a double-linked list), because we detect an existing
- * cache entry by seeing that the xref table for the object number has a non-NULL
- * 'cache' member.
+/* The object cache is a '2Q' cache: objects are first cached 'on probation', in a
+ * FIFO queue which is given a quarter of the cache. Hits on probation don't move
+ * the entry, so a run of references to an object used only once (while walking
+ * the page tree, or reading the objects of an object stream, say) can't push out
+ * the objects which are used on every page. When an entry is evicted from
+ * probation we remember its object number for a while, and if the object is read
+ * again in that time it is cached in the 'frequent' queue, which is a normal LRU.
+ *
+ * The size of the cache is limited by the estimated size of the cached objects
+ * (-dPDFObjectCacheSize=) rather than their number.
+ *
+ * Both queues are kept in a single doubly linked list, from the least recently
+ * cached entry on probation at ctx->cache_LRU, to the most recently used frequent
+ * entry at ctx->cache_MRU. ctx->cache_frequent is the first (least recently used)
+ * frequent entry. The actual entries are attached to the xref table (as well as
+ * being in the list), because we detect an existing cache entry by seeing that the
+ * xref table for the object number has a non-NULL 'cache' member.
  * So we need to update the xref as well if we add or delete cache entries.
  */
+
+/* The estimated size of the pdfi and graphics library structures of a font, which
+ * we can't easily measure. The font program is counted on top of this.
+ */
+#define PDF_FONT_CACHE_SIZE 4096
+
+/* The number of bytes in the strings held by a dictionary or an array, which is how
+ * the glyph descriptions and subroutines of Type 1 and CFF fonts are kept.
+ */
+static uint64_t pdfi_strings_size(pdf_obj *o)
+{
+    uint64_t i, size = 0;
+    pdf_obj *v;
+
+    if (o == NULL)
+        return 0;
+    if (pdfi_type_of(o) == PDF_DICT) {
+        pdf_dict *d = (pdf_dict *)o;
+
+        for (i = 0; i < d->entries; i++) {
+            v = d->list[i].value;
+            if (v != NULL && pdfi_type_of(v) == PDF_STRING)
+                size += ((pdf_string *)v)->length;
+        }
+    } else if (pdfi_type_of(o) == PDF_ARRAY) {
+        pdf_array *a = (pdf_array *)o;
+
+        for (i = 0; i < a->size; i++) {
+            v = a->values[i];
+            if (v != NULL && pdfi_type_of(v) == PDF_STRING)
+                size += ((pdf_string *)v)->length;
+        }
+    }
+    return size;
+}
+
+/* The size of a font is the estimate above, plus its font program, so that a cache
+ * full of small subset fonts holds many more of them than one of large CJK fonts.
+ */
+static uint32_t pdfi_font_cache_size(pdf_font *font)
+{
+    uint64_t size = PDF_FONT_CACHE_SIZE;
+
+    switch (font->pdfi_font_type) {
+        case e_pdf_font_type1:
+            size += pdfi_strings_size((pdf_obj *)((pdf_font_type1 *)font)->CharStrings);
+            size += pdfi_strings_size((pdf_obj *)((pdf_font_type1 *)font)->Subrs);
+            break;
+        case e_pdf_font_cff:
+            size += pdfi_strings_size((pdf_obj *)((pdf_font_cff *)font)->CharStrings);
+            size += pdfi_strings_size((pdf_obj *)((pdf_font_cff *)font)->Subrs);
+            size += pdfi_strings_size((pdf_obj *)((pdf_font_cff *)font)->GlobalSubrs);
+            break;
+        case e_pdf_cidfont_type0:
+            size += pdfi_strings_size((pdf_obj *)((pdf_cidfont_type0 *)font)->CharStrings);
+            size += pdfi_strings_size((pdf_obj *)((pdf_cidfont_type0 *)font)->Subrs);
+            size += pdfi_strings_size((pdf_obj *)((pdf_cidfont_type0 *)font)->GlobalSubrs);
+            break;
+        case e_pdf_font_truetype:
+            if (((pdf_font_truetype *)font)->sfnt != NULL)
+                size += ((pdf_font_truetype *)font)->sfnt->length;
+            break;
+        case e_pdf_cidfont_type2:
+            if (((pdf_cidfont_type2 *)font)->sfnt != NULL)
+                size += ((pdf_cidfont_type2 *)font)->sfnt->length;
+            if (((pdf_cidfont_type2 *)font)->cidtogidmap != NULL)
+                size += ((pdf_cidfont_type2 *)font)->cidtogidmap->length;
+            break;
+        default:
+            /* Type 3 glyphs are streams, which are cached (or not) by themselves,
+             * and a Type 0 font is a wrapper for its descendant CIDFont.
+             */
+            break;
+    }
+    return size > max_uint ? max_uint : (uint32_t)size;
+}
+
+static uint32_t pdfi_obj_cache_size(pdf_obj *o)
+{
+    switch (pdfi_type_of(o)) {
+        case PDF_DICT:
+            return sizeof(pdf_dict) + ((pdf_dict *)o)->size * sizeof(pdf_dict_entry)
+                   + pdfi_dict_hash_bytes((pdf_dict *)o);
+        case PDF_ARRAY:
+            return sizeof(pdf_array) + ((pdf_array *)o)->size * sizeof(pdf_obj *);
+        case PDF_STRING:
+        case PDF_NAME:
+            return sizeof(pdf_string) + ((pdf_string *)o)->length;
+        case PDF_STREAM:
+            if (((pdf_stream *)o)->stream_dict != NULL)
+                return sizeof(pdf_stream) + pdfi_obj_cache_size((pdf_obj *)((pdf_stream *)o)->stream_dict);
+            return sizeof(pdf_stream);
+        case PDF_FONT:
+            return pdfi_font_cache_size((pdf_font *)o);
+        case PDF_INDIRECT:
+            return sizeof(pdf_indirect_ref);
+        default:
+            return sizeof(pdf_num);
+    }
+}
+
+static uint64_t pdfi_obj_cache_budget(pdf_context *ctx)
+{
+    return ctx->args.object_cache_size > 0 ? ctx->args.object_cache_size : DEFAULT_OBJECT_CACHE_SIZE;
+}
+
+static pdf_obj_cache_entry *pdfi_alloc_cache_entry(pdf_context *ctx)
+{
+    pdf_obj_cache_entry *entry;
+
+    if (ctx->cache_free_entries == NULL) {
+        pdf_obj_cache_block *block;
+        int i;
+
+        block = (pdf_obj_cache_block *)gs_alloc_bytes(ctx->memory, sizeof(pdf_obj_cache_block), "pdfi_alloc_cache_entry");
+        if (block == NULL)
+            return NULL;
+        block->next = ctx->cache_blocks;
+        ctx->cache_blocks = block;
+        for (i = 0; i < PDF_OBJ_CACHE_BLOCK_ENTRIES; i++) {
+            block->entries[i].next = ctx->cache_free_entries;
+            ctx->cache_free_entries = &block->entries[i];
+        }
+    }
+    entry = ctx->cache_free_entries;
+    ctx->cache_free_entries = entry->next;
+    memset(entry, 0x00, sizeof(pdf_obj_cache_entry));
+    return entry;
+}
+
+/* Return an entry, which must already have been removed from the cache lists, to the
+ * free list, and remove its size from the total.
+ */
+void pdfi_free_cache_entry(pdf_context *ctx, pdf_obj_cache_entry *entry)
+{
+    ctx->cache_bytes -= entry->size;
+    if (!entry->frequent)
+        ctx->cache_probation_bytes -= entry->size;
+    entry->o = NULL;
+    entry->previous = NULL;
+    entry->next = ctx->cache_free_entries;
+    ctx->cache_free_entries = entry;
+}
+
+/* Free the memory used for the cache entries, once the cache is empty. */
+void pdfi_free_obj_cache(pdf_context *ctx)
+{
+    pdf_obj_cache_block *block = ctx->cache_blocks, *next;
+
+    while (block) {
+        next = block->next;
+        gs_free_object(ctx->memory, block, "pdfi_free_obj_cache");
+        block = next;
+    }
+    ctx->cache_blocks = NULL;
+    ctx->cache_free_entries = NULL;
+    gs_free_object(ctx->memory, ctx->cache_ghosts, "pdfi_free_obj_cache");
+    ctx->cache_ghosts = NULL;
+    ctx->cache_ghost_size = ctx->cache_ghost_next = 0;
+    ctx->cache_LRU = ctx->cache_MRU = ctx->cache_frequent = NULL;
+    ctx->cache_bytes = ctx->cache_probation_bytes = 0;
+}
+
+static void pdfi_unlink_cache_entry(pdf_context *ctx, pdf_obj_cache_entry *entry)
+{
+    pdf_obj_cache_entry *next = (pdf_obj_cache_entry *)entry->next;
+    pdf_obj_cache_entry *previous = (pdf_obj_cache_entry *)entry->previous;
+
+    if (entry == ctx->cache_frequent)
+        ctx->cache_frequent = next;
+    if (next != NULL)
+        next->previous = previous;
+    else
+        ctx->cache_MRU = previous;
+    if (previous != NULL)
+        previous->next = next;
+    else
+        ctx->cache_LRU = next;
+    entry->next = entry->previous = NULL;
+}
+
+/* Add an entry at the most recently used end of the frequent queue, or the most
+ * recently cached end of the probation queue.
+ */
+static void pdfi_link_cache_entry(pdf_context *ctx, pdf_obj_cache_entry *entry, bool frequent)
+{
+    pdf_obj_cache_entry *first_frequent = ctx->cache_frequent;
+
+    entry->frequent = frequent;
+    if (frequent || first_frequent == NULL) {
+        entry->previous = ctx->cache_MRU;
+        entry->next = NULL;
+        if (ctx->cache_MRU != NULL)
+            ctx->cache_MRU->next = entry;
+        else
+            ctx->cache_LRU = entry;
+        ctx->cache_MRU = entry;
+        if (frequent && first_frequent == NULL)
+            ctx->cache_frequent = entry;
+    } else {
+        entry->next = first_frequent;
+        entry->previous = first_frequent->previous;
+        if (first_frequent->previous != NULL)
+            ((pdf_obj_cache_entry *)first_frequent->previous)->next = entry;
+        else
+            ctx->cache_LRU = entry;
+        first_frequent->previous = entry;
+    }
+}
+
+/* Remember the object number of an entry evicted from probation. The ring holds
+ * (roughly) as many object numbers as there are entries in the cache.
+ */
+static void pdfi_remember_evicted(pdf_context *ctx, uint64_t object_num)
+{
+    uint64_t old;
+
+    if (ctx->cache_ghosts == NULL) {
+        uint32_t size = pdfi_obj_cache_budget(ctx) / 256;
+
+        if (size < 64)
+            size = 64;
+        ctx->cache_ghosts = (uint64_t *)gs_alloc_bytes(ctx->memory, size * sizeof(uint64_t), "pdfi_remember_evicted");
+        /* Not being able to remember evicted objects is not fatal */
+        if (ctx->cache_ghosts == NULL)
+            return;
+        memset(ctx->cache_ghosts, 0x00, size * sizeof(uint64_t));
+        ctx->cache_ghost_size = size;
+        ctx->cache_ghost_next = 0;
+    }
+    old = ctx->cache_ghosts[ctx->cache_ghost_next];
+    if (old != 0 && old < ctx->xref_table->xref_size)
+        ctx->xref_table->xref[old].recently_evicted = false;
+    ctx->cache_ghosts[ctx->cache_ghost_next] = object_num;
+    if (++ctx->cache_ghost_next == ctx->cache_ghost_size)
+        ctx->cache_ghost_next = 0;
+    ctx->xref_table->xref[object_num].recently_evicted = true;
+}
+
+static void pdfi_evict_cache_entry(pdf_context *ctx, pdf_obj_cache_entry *entry)
+{
+    uint64_t object_num = entry->o->object_num;
+
+#if DEBUG_CACHE
+    dbgmprintf2(ctx->memory, "Cache full, evicting object %"PRIu64" from the %s queue\n",
+                object_num, entry->frequent ? "frequent" : "probation");
+#endif
+    pdfi_unlink_cache_entry(ctx, entry);
+    ctx->xref_table->xref[object_num].cache = NULL;
+    if (!entry->frequent && object_num < ctx->xref_table->xref_size)
+        pdfi_remember_evicted(ctx, object_num);
+    pdfi_countdown(entry->o);
+    pdfi_free_cache_entry(ctx, entry);
+    ctx->cache_entries--;
+    ctx->evictions++;
+}
+
+/* Evict entries until the cache is within its budget, taking them from probation
+ * if that has more than its share, or from the least recently used end of the
+ * frequent queue otherwise. 'keep' is the entry just added, which we never evict.
+ */
+static void pdfi_trim_cache(pdf_context *ctx, pdf_obj_cache_entry *keep)
+{
+    uint64_t budget = pdfi_obj_cache_budget(ctx);
+    pdf_obj_cache_entry *victim, *probation, *frequent;
+
+    while (ctx->cache_bytes > budget) {
+        probation = ctx->cache_LRU;
+        if (probation == keep)
+            probation = probation->next;
+        if (probation != NULL && probation->frequent)
+            probation = NULL;
+        frequent = ctx->cache_frequent;
+        if (frequent == keep)
+            frequent = frequent->next;
+
+        if (probation != NULL && (ctx->cache_probation_bytes > budget / 4 || frequent == NULL))
+            victim = probation;
+        else
+            victim = frequent != NULL ? frequent : probation;
+        if (victim == NULL)
+            break;
+        pdfi_evict_cache_entry(ctx, victim);
+    }
+}
+
+/* given an object, create a cache entry for it. New entries are on probation,
+ * unless the object was recently evicted from probation, in which case it goes
+ * straight into the frequent queue. If the cache is then too big, evict entries.
+ */
 static int pdfi_add_to_cache(pdf_context *ctx, pdf_obj *o)
 {
     pdf_obj_cache_entry *entry;
+    bool frequent;
 
     if (o < PDF_TOKEN_AS_OBJ(TOKEN__LAST_KEY))
         return 0;
@@ -58,64 +361,38 @@ static int pdfi_add_to_cache(pdf_context *ctx, pdf_obj *o)
     if (o->object_num > ctx->xref_table->xref_size)
         return_error(gs_error_rangecheck);
 
-    if (ctx->cache_entries == MAX_OBJECT_CACHE_SIZE)
-    {
-#if DEBUG_CACHE
-        dbgmprintf(ctx->memory, "Cache full, evicting LRU\n");
-#endif
-        if (ctx->cache_LRU) {
-            entry = ctx->cache_LRU;
-            ctx->cache_LRU = entry->next;
-            if (entry->next)
-                ((pdf_obj_cache_entry *)entry->next)->previous = NULL;
-            ctx->xref_table->xref[entry->o->object_num].cache = NULL;
-            pdfi_countdown(entry->o);
-            ctx->cache_entries--;
-            gs_free_object(ctx->memory, entry, "pdfi_add_to_cache, free LRU");
-        } else
-            return_error(gs_error_unknownerror);
-    }
-    entry = (pdf_obj_cache_entry *)gs_alloc_bytes(ctx->memory, sizeof(pdf_obj_cache_entry), "pdfi_add_to_cache");
+    entry = pdfi_alloc_cache_entry(ctx);
     if (entry == NULL)
         return_error(gs_error_VMerror);
 
-    memset(entry, 0x00, sizeof(pdf_obj_cache_entry));
-
     entry->o = o;
     pdfi_countup(o);
-    if (ctx->cache_MRU) {
-        entry->previous = ctx->cache_MRU;
-        ctx->cache_MRU->next = entry;
-    }
-    ctx->cache_MRU = entry;
-    if (ctx->cache_LRU == NULL)
-        ctx->cache_LRU = entry;
+    entry->size = pdfi_obj_cache_size(o);
+
+    frequent = ctx->xref_table->xref[o->object_num].recently_evicted;
+    if (frequent) {
+        ctx->xref_table->xref[o->object_num].recently_evicted = false;
+        ctx->readmissions++;
+    } else
+        ctx->cache_probation_bytes += entry->size;
+    ctx->cache_bytes += entry->size;
+    pdfi_link_cache_entry(ctx, entry, frequent);
 
     ctx->cache_entries++;
     ctx->xref_table->xref[o->object_num].cache = entry;
+
+    pdfi_trim_cache(ctx, entry);
     return 0;
 }
 
 /* Given an existing cache entry, promote it to be the most-recently-used
- * cache entry.
+ * entry of the frequent queue. Entries on probation stay where they are.
  */
 static void pdfi_promote_cache_entry(pdf_context *ctx, pdf_obj_cache_entry *cache_entry)
 {
-    if (ctx->cache_MRU && cache_entry != ctx->cache_MRU) {
-        if ((pdf_obj_cache_entry *)cache_entry->next != NULL)
-            ((pdf_obj_cache_entry *)cache_entry->next)->previous = cache_entry->previous;
-        if ((pdf_obj_cache_entry *)cache_entry->previous != NULL)
-            ((pdf_obj_cache_entry *)cache_entry->previous)->next = cache_entry->next;
-        else {
-            /* the existing entry is the current least recently used, we need to make the 'next'
-             * cache entry into the LRU.
-             */
-            ctx->cache_LRU = cache_entry->next;
-        }
-        cache_entry->next = NULL;
-        cache_entry->previous = ctx->cache_MRU;
-        ctx->cache_MRU->next = cache_entry;
-        ctx->cache_MRU = cache_entry;
+    if (cache_entry->frequent && cache_entry != ctx->cache_MRU) {
+        pdfi_unlink_cache_entry(ctx, cache_entry);
+        pdfi_link_cache_entry(ctx, cache_entry, true);
     }
     return;
 }
@@ -151,10 +428,19 @@ int replace_cache_entry(pdf_context *ctx, pdf_obj *o)
         /* Put new entry in the cache */
         cache_entry->o = o;
         pdfi_countup(o);
+        ctx->cache_bytes -= cache_entry->size;
+        if (!cache_entry->frequent)
+            ctx->cache_probation_bytes -= cache_entry->size;
+        cache_entry->size = pdfi_obj_cache_size(o);
+        ctx->cache_bytes += cache_entry->size;
+        if (!cache_entry->frequent)
+            ctx->cache_probation_bytes += cache_entry->size;
         pdfi_promote_cache_entry(ctx, cache_entry);
 
         /* Now decrement the old cache entry, if any */
         pdfi_countdown(old_cached_obj);
+
+        pdfi_trim_cache(ctx, cache_entry);
     }
     return 0;
 }
@@ -611,9 +897,7 @@ static int pdfi_deref_compressed(pdf_context *ctx, uint64_t obj, uint64_t gen, p
     }
 
     if (compressed_entry->cache == NULL) {
-#if CACHE_STATISTICS
         ctx->compressed_misses++;
-#endif
         code = pdfi_seek(ctx, ctx->main_stream, compressed_entry->u.uncompressed.offset, SEEK_SET);
         if (code < 0)
             goto exit;
@@ -645,9 +929,7 @@ static int pdfi_deref_compressed(pdf_context *ctx, uint64_t obj, uint64_t gen, p
         if (code < 0)
             goto exit;
     } else {
-#if CACHE_STATISTICS
         ctx->compressed_hits++;
-#endif
         compressed_object = (pdf_stream *)compressed_entry->cache->o;
         pdfi_countup(compressed_object);
         pdfi_promote_cache_entry(ctx, compressed_entry->cache);
@@ -951,9 +1233,7 @@ static int pdfi_dereference_main(pdf_context *ctx, uint64_t obj, uint64_t gen, p
     if (entry->cache != NULL){
         pdf_obj_cache_entry *cache_entry = entry->cache;
 
-#if CACHE_STATISTICS
         ctx->hits++;
-#endif
         *object = cache_entry->o;
         pdfi_countup(*object);
 
@@ -969,9 +1249,7 @@ static int pdfi_dereference_main(pdf_context *ctx, uint64_t obj, uint64_t gen, p
             if (code < 0 || *object == NULL)
                 goto error;
         } else {
-#if CACHE_STATISTICS
             ctx->misses++;
-#endif
             ctx->encryption.decrypt_strings = true;
 
             code = pdfi_seek(ctx, ctx->main_stream, entry->u.uncompressed.offset, SEEK_SET);
@@ -60,6 +60,26 @@ bool pdfi_device_check_param_bool(gx_device *dev, const char *param)
     return (bool)value;
 }
 
+/* Check value of integer device parameter, 0 if the device doesn't have it */
+int pdfi_device_check_param_int(gx_device *dev, const char *param)
+{
+    int code;
+    gs_c_param_list list;
+    int value;
+
+    code = pdfi_device_check_param(dev, param, &list);
+    if (code < 0)
+        return 0;
+    gs_c_param_list_read(&list);
+    code = param_read_int((gs_param_list *)&list,
+                          param,
+                          &value);
+    if (code != 0)
+        value = 0;
+    gs_c_param_list_release(&list);
+    return value;
+}
+
 /* Set value of string device parameter */
 int pdfi_device_set_param_string(gx_device *dev, const char *paramname, const char *value)
 {
@@ -134,6 +154,34 @@ bool pdfi_device_check_param_exists(gx_device *dev, const char *param)
     return true;
 }
 
+/* Check whether the device writes each page to a file of its own, from an
+ * OutputFile with a %d (or similar) format, and only opens it when the page
+ * is output.
+ */
+bool pdfi_device_output_file_per_page(gx_device *dev)
+{
+    int code;
+    gs_c_param_list list;
+    gs_param_string fname;
+    gs_parsed_file_name_t parsed;
+    const char *fmt = NULL;
+
+    if (pdfi_device_check_param_bool(dev, "OpenOutputFile"))
+        return false;
+
+    code = pdfi_device_check_param(dev, "OutputFile", &list);
+    if (code < 0)
+        return false;
+    gs_c_param_list_read(&list);
+    code = param_read_string((gs_param_list *)&list, "OutputFile", &fname);
+    if (code == 0)
+        code = gx_parse_output_file_name(&parsed, &fmt, (const char *)fname.data, fname.size, dev->memory);
+    else
+        code = -1;
+    gs_c_param_list_release(&list);
+    return code >= 0 && fmt != NULL;
+}
+
 /* Config some device-related variables */
 void pdfi_device_set_flags(pdf_context *ctx)
 {
@@ -161,6 +209,7 @@ void pdfi_device_set_flags(pdf_context *ctx)
 
     ctx->device_state.ModifiesPageSize = pdfi_device_check_param_bool(dev, "ModifiesPageSize");
     ctx->device_state.ModifiesPageOrder = pdfi_device_check_param_bool(dev, "ModifiesPageOrder");
+    ctx->device_state.NumRenderingThreads = pdfi_device_check_param_int(dev, "NumRenderingThreads");
 
     /* If multi-page output, can't do certain pdfmarks */
     if (ctx->device_state.writepdfmarks) {
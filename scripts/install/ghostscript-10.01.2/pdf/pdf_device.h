@@ -18,7 +18,9 @@
 
 int pdfi_device_check_param(gx_device *dev, const char *param, gs_c_param_list *list);
 bool pdfi_device_check_param_bool(gx_device *dev, const char *param);
+int pdfi_device_check_param_int(gx_device *dev, const char *param);
 bool pdfi_device_check_param_exists(gx_device *dev, const char *param);
+bool pdfi_device_output_file_per_page(gx_device *dev);
 int pdfi_device_set_param_string(gx_device *dev, const char *paramname, const char *value);
 int pdfi_device_set_param_bool(gx_device *dev, const char *param, bool value);
 int pdfi_device_set_param_float(gx_device *dev, const char *param, float value);
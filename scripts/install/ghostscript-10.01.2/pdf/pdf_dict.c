@@ -24,8 +24,10 @@
 #include "pdf_loop_detect.h"
 #include "pdf_misc.h"
 
-static int pdfi_dict_find(pdf_context *ctx, pdf_dict *d, const char *Key, bool sort);
-static int pdfi_dict_find_key(pdf_context *ctx, pdf_dict *d, const pdf_name *Key, bool sort);
+static int pdfi_dict_find(pdf_context *ctx, pdf_dict *d, const char *Key);
+static int pdfi_dict_find_key(pdf_context *ctx, pdf_dict *d, const pdf_name *Key);
+static void pdfi_dict_hash_insert(pdf_context *ctx, pdf_dict *d, uint32_t index);
+static void pdfi_dict_hash_free(pdf_dict *d);
 
 void pdfi_free_dict(pdf_obj *o)
 {
@@ -44,6 +46,7 @@ void pdfi_free_dict(pdf_obj *o)
         if (d->list[i].key != NULL)
             pdfi_countdown(d->list[i].key);
     }
+    pdfi_dict_hash_free(d);
     gs_free_object(OBJ_MEMORY(d), d->list, "pdf interpreter free dictionary key/values");
     gs_free_object(OBJ_MEMORY(d), d, "pdf interpreter free dictionary");
 }
@@ -58,9 +61,9 @@ static int pdfi_dict_delete_inner(pdf_context *ctx, pdf_dict *d, pdf_name *n, co
 #endif
 
     if (n != NULL)
-        i = pdfi_dict_find_key(ctx, d, (const pdf_name *)n, false);
+        i = pdfi_dict_find_key(ctx, d, (const pdf_name *)n);
     else
-        i = pdfi_dict_find(ctx, d, str, false);
+        i = pdfi_dict_find(ctx, d, str);
 
     if (i < 0)
         return i;
@@ -72,7 +75,10 @@ static int pdfi_dict_delete_inner(pdf_context *ctx, pdf_dict *d, pdf_name *n, co
         memmove(&d->list[i], &d->list[i+1], (d->entries - i) * sizeof(d->list[0]));
     d->list[d->entries].key = NULL;
     d->list[d->entries].value = NULL;
-    d->is_sorted = false;
+    /* The following entries have moved, so the index is out of date. Rather than
+     * fix it up, drop it; it will be rebuilt by the next search if needed.
+     */
+    pdfi_dict_hash_free(d);
     return 0;
 }
 
@@ -211,106 +217,163 @@ pdfi_dict_get2(pdf_context *ctx, pdf_dict *d, const char *Key1,
     return code;
 }
 
-static int pdfi_dict_compare_entry(const void *a, const void *b)
+/* Searching dictionaries.
+ *
+ * Small dictionaries are simply searched from the start. Once a dictionary has
+ * more than PDF_DICT_HASH_MIN_ENTRIES entries, the first search builds an open
+ * addressed hash table (with linear probing) of its keys, which is then kept up
+ * to date as keys are added. Deleting a key moves the following entries, so it
+ * discards the table, which is rebuilt by the next search. Resource dictionaries
+ * can hold hundreds of fonts, images or ExtGStates, and are searched for every
+ * Tf, Do and gs operator. Unlike sorting the entries, this leaves the order of
+ * the keys (as seen by pdfi_dict_next()) alone.
+ *
+ * pdfi names are not unique objects, so we hash the bytes of the names. Each slot
+ * of the table holds the index of a key in d->list, plus 1, or 0 if it is empty.
+ * If a dictionary has duplicate keys, the first one is found, as with a simple
+ * search.
+ */
+#define PDF_DICT_HASH_MIN_ENTRIES 16
+
+static uint32_t pdfi_dict_hash_key(const byte *key, uint32_t len)
 {
-    pdf_name *key_a = (pdf_name *)((pdf_dict_entry *)a)->key, *key_b = (pdf_name *)((pdf_dict_entry *)b)->key;
+    /* FNV-1a */
+    uint32_t h = 2166136261U;
+    uint32_t i;
 
-    if (key_a == NULL) {
-        if (key_b == NULL)
-            return 0;
-        else
-            return 1;
+    for (i = 0; i < len; i++) {
+        h ^= key[i];
+        h *= 16777619U;
     }
+    return h;
+}
 
-    if (key_b == NULL)
-        return -1;
-
-    if (key_a->length != key_b->length)
-        return key_a->length - key_b->length;
+static void pdfi_dict_hash_free(pdf_dict *d)
+{
+    if (d->hash != NULL) {
+        gs_free_object(OBJ_MEMORY(d), d->hash, "pdfi_dict_hash_free");
+        d->hash = NULL;
+        d->hash_size = 0;
+    }
+}
 
-    return strncmp((const char *)key_a->data, (const char *)key_b->data, key_a->length);
+static inline bool pdfi_dict_key_is(pdf_obj *key, const byte *str, uint32_t len)
+{
+    return key != NULL && pdfi_type_of(key) == PDF_NAME &&
+        ((pdf_name *)key)->length == len && memcmp(((pdf_name *)key)->data, str, len) == 0;
 }
 
-static int pdfi_dict_find_sorted(pdf_context *ctx, pdf_dict *d, const char *Key)
+/* Returns the slot where the key is, or the empty slot where it would go */
+static uint32_t pdfi_dict_hash_slot(pdf_dict *d, const byte *key, uint32_t len)
 {
-    int start = 0, end = d->size - 1, middle = 0, keylen = strlen(Key);
-    pdf_name *test_key;
+    uint32_t mask = d->hash_size - 1;
+    uint32_t slot = pdfi_dict_hash_key(key, len) & mask;
 
-    while (start <= end) {
-        middle = start + (end - start) / 2;
-        test_key = (pdf_name *)d->list[middle].key;
+    while (d->hash[slot] != 0 && !pdfi_dict_key_is(d->list[d->hash[slot] - 1].key, key, len))
+        slot = (slot + 1) & mask;
+    return slot;
+}
 
-        /* Sorting pushes unused key/values (NULL) to the end of the dictionary */
-        if (test_key == NULL) {
-            end = middle - 1;
-            continue;
-        }
+/* Add the key at d->list[index] to the hash table, if there is one. If the table
+ * is getting full, make a bigger one instead. If we can't allocate that, we just
+ * don't have a table, and go back to searching the entries.
+ */
+static void pdfi_dict_hash_add(pdf_dict *d, uint32_t index)
+{
+    pdf_name *key = (pdf_name *)d->list[index].key;
+    uint32_t slot;
+
+    if (key == NULL || pdfi_type_of(key) != PDF_NAME)
+        return;
+    slot = pdfi_dict_hash_slot(d, key->data, key->length);
+    /* Don't replace an earlier duplicate of the key */
+    if (d->hash[slot] == 0)
+        d->hash[slot] = index + 1;
+}
 
-        if (test_key->length == keylen) {
-            int result = strncmp((const char *)test_key->data, Key, keylen);
+/* The number of slots in a hash table for d: at least twice as many as entries */
+static uint32_t pdfi_dict_hash_slots(pdf_dict *d)
+{
+    uint32_t size = 32;
 
-            if (result == 0)
-                return middle;
-            if (result < 0)
-                start = middle + 1;
-            else
-                end = middle - 1;
-        } else {
-            if (test_key->length < keylen)
-                start = middle + 1;
-            else
-                end = middle -1;
-        }
-    }
-    return gs_note_error(gs_error_undefined);
+    while (size < d->entries * 2)
+        size *= 2;
+    return size;
 }
 
-static int pdfi_dict_find_unsorted(pdf_context *ctx, pdf_dict *d, const char *Key)
+/* (Re)build the hash table. If we can't allocate it, we just don't have a table,
+ * and go back to searching the entries.
+ */
+static void pdfi_dict_hash_build(pdf_context *ctx, pdf_dict *d)
 {
-    int i;
-    pdf_name *t;
+    uint32_t size, i;
+
+    pdfi_dict_hash_free(d);
+    size = pdfi_dict_hash_slots(d);
+
+    d->hash = (uint32_t *)gs_alloc_bytes(OBJ_MEMORY(d), size * sizeof(uint32_t), "pdfi_dict_hash_build");
+    if (d->hash == NULL)
+        return;
+    memset(d->hash, 0x00, size * sizeof(uint32_t));
+    d->hash_size = size;
+    for (i = 0; i < d->entries; i++)
+        pdfi_dict_hash_add(d, i);
+}
 
-    for (i=0;i< d->entries;i++) {
-        t = (pdf_name *)d->list[i].key;
+/* Add the key just stored at d->list[index] to the hash table, if there is one */
+static void pdfi_dict_hash_insert(pdf_context *ctx, pdf_dict *d, uint32_t index)
+{
+    if (d->hash == NULL)
+        return;
 
-        if (t && pdfi_type_of(t) == PDF_NAME) {
-            if (pdfi_name_is((pdf_name *)t, Key)) {
-                return i;
-            }
-        }
-    }
-    return_error(gs_error_undefined);
+    if (d->entries * 2 > d->hash_size)
+        pdfi_dict_hash_build(ctx, d);
+    else
+        pdfi_dict_hash_add(d, index);
 }
 
-static int pdfi_dict_find(pdf_context *ctx, pdf_dict *d, const char *Key, bool sort)
+/* The size of the hash table of d, or of the one the first search will build, so
+ * that the object cache can count it before it is built.
+ */
+uint32_t pdfi_dict_hash_bytes(pdf_dict *d)
 {
-    if (!d->is_sorted) {
-        if (d->entries > 32 && sort) {
-            qsort(d->list, d->size, sizeof(pdf_dict_entry), pdfi_dict_compare_entry);
-            d->is_sorted = true;
-            return pdfi_dict_find_sorted(ctx, d, Key);
-        } else
-            return pdfi_dict_find_unsorted(ctx, d, Key);
-    } else
-        return pdfi_dict_find_sorted(ctx, d, Key);
+    if (d->hash != NULL)
+        return d->hash_size * sizeof(uint32_t);
+    if (d->entries > PDF_DICT_HASH_MIN_ENTRIES)
+        return pdfi_dict_hash_slots(d) * sizeof(uint32_t);
+    return 0;
 }
 
-static int pdfi_dict_find_key(pdf_context *ctx, pdf_dict *d, const pdf_name *Key, bool sort)
+static int pdfi_dict_find_bytes(pdf_context *ctx, pdf_dict *d, const byte *Key, uint32_t len)
 {
-    char *Test = NULL;
-    int index = 0;
+    int i;
 
-    Test = (char *)gs_alloc_bytes(ctx->memory, Key->length + 1, "pdfi_dict_find_key");
-    if (Test == NULL)
-        return_error(gs_error_VMerror);
+    if (d->hash == NULL && d->entries > PDF_DICT_HASH_MIN_ENTRIES)
+        pdfi_dict_hash_build(ctx, d);
+
+    if (d->hash != NULL) {
+        uint32_t slot = pdfi_dict_hash_slot(d, Key, len);
+
+        if (d->hash[slot] != 0)
+            return d->hash[slot] - 1;
+        return_error(gs_error_undefined);
+    }
 
-    memcpy(Test, Key->data, Key->length);
-    Test[Key->length] = 0x00;
+    for (i=0;i< d->entries;i++) {
+        if (pdfi_dict_key_is(d->list[i].key, Key, len))
+            return i;
+    }
+    return_error(gs_error_undefined);
+}
 
-    index = pdfi_dict_find(ctx, d, Test, sort);
+static int pdfi_dict_find(pdf_context *ctx, pdf_dict *d, const char *Key)
+{
+    return pdfi_dict_find_bytes(ctx, d, (const byte *)Key, strlen(Key));
+}
 
-    gs_free_object(ctx->memory, Test, "pdfi_dict_find_key");
-    return index;
+static int pdfi_dict_find_key(pdf_context *ctx, pdf_dict *d, const pdf_name *Key)
+{
+    return pdfi_dict_find_bytes(ctx, d, Key->data, Key->length);
 }
 
 /* The object returned by pdfi_dict_get has its reference count incremented by 1 to
@@ -325,7 +388,7 @@ int pdfi_dict_get_common(pdf_context *ctx, pdf_dict *d, const char *Key, pdf_obj
     if (pdfi_type_of(d) != PDF_DICT)
         return_error(gs_error_typecheck);
 
-    index = pdfi_dict_find(ctx, d, Key, true);
+    index = pdfi_dict_find(ctx, d, Key);
     if (index < 0)
         return index;
 
@@ -377,7 +440,7 @@ int pdfi_dict_get_no_deref(pdf_context *ctx, pdf_dict *d, const pdf_name *Key, p
     if (pdfi_type_of(d) != PDF_DICT)
         return_error(gs_error_typecheck);
 
-    index = pdfi_dict_find_key(ctx, d, Key, true);
+    index = pdfi_dict_find_key(ctx, d, Key);
     if (index < 0)
         return index;
 
@@ -399,7 +462,7 @@ int pdfi_dict_get_by_key(pdf_context *ctx, pdf_dict *d, const pdf_name *Key, pdf
     if (pdfi_type_of(d) != PDF_DICT)
         return_error(gs_error_typecheck);
 
-    index = pdfi_dict_find_key(ctx, d, Key, true);
+    index = pdfi_dict_find_key(ctx, d, Key);
     if (index < 0)
         return index;
 
@@ -427,7 +490,7 @@ int pdfi_dict_get_ref(pdf_context *ctx, pdf_dict *d, const char *Key, pdf_indire
     if (pdfi_type_of(d) != PDF_DICT)
         return_error(gs_error_typecheck);
 
-    index = pdfi_dict_find(ctx, d, Key, true);
+    index = pdfi_dict_find(ctx, d, Key);
     if (index < 0)
         return index;
 
@@ -458,9 +521,9 @@ static int pdfi_dict_get_no_store_R_inner(pdf_context *ctx, pdf_dict *d, const c
         return_error(gs_error_typecheck);
 
     if (strKey == NULL)
-        index = pdfi_dict_find_key(ctx, d, nameKey, true);
+        index = pdfi_dict_find_key(ctx, d, nameKey);
     else
-        index = pdfi_dict_find(ctx, d, strKey, true);
+        index = pdfi_dict_find(ctx, d, strKey);
 
     if (index < 0)
         return index;
@@ -880,7 +943,7 @@ int pdfi_dict_put_obj(pdf_context *ctx, pdf_dict *d, pdf_obj *Key, pdf_obj *valu
         return_error(gs_error_typecheck);
 
     /* First, do we have a Key/value pair already ? */
-    i = pdfi_dict_find_key(ctx, d, (pdf_name *)Key, false);
+    i = pdfi_dict_find_key(ctx, d, (pdf_name *)Key);
     if (i >= 0) {
         if (d->list[i].value == value || replace == false)
             /* We already have this value stored with this key.... */
@@ -891,8 +954,6 @@ int pdfi_dict_put_obj(pdf_context *ctx, pdf_dict *d, pdf_obj *Key, pdf_obj *valu
         return 0;
     }
 
-    d->is_sorted = false;
-
     /* Nope, its a new Key */
     if (d->size > d->entries) {
         /* We have a hole, find and use it */
@@ -903,6 +964,7 @@ int pdfi_dict_put_obj(pdf_context *ctx, pdf_dict *d, pdf_obj *Key, pdf_obj *valu
                 d->list[i].value = value;
                 pdfi_countup(value);
                 d->entries++;
+                pdfi_dict_hash_insert(ctx, d, i);
                 return 0;
             }
         }
@@ -924,6 +986,7 @@ int pdfi_dict_put_obj(pdf_context *ctx, pdf_dict *d, pdf_obj *Key, pdf_obj *valu
     d->entries++;
     pdfi_countup(Key);
     pdfi_countup(value);
+    pdfi_dict_hash_insert(ctx, d, d->size - 1);
 
     return 0;
 }
@@ -959,6 +1022,7 @@ int pdfi_dict_put_unchecked(pdf_context *ctx, pdf_dict *d, const char *Key, pdf_
                     d->list[i].value = value;
                     pdfi_countup(value);
                     d->entries++;
+                    pdfi_dict_hash_insert(ctx, d, i);
                     return 0;
                 }
             }
@@ -985,6 +1049,7 @@ int pdfi_dict_put_unchecked(pdf_context *ctx, pdf_dict *d, const char *Key, pdf_
     d->size++;
     d->entries++;
     pdfi_countup(value);
+    pdfi_dict_hash_insert(ctx, d, d->size - 1);
 
     return 0;
 }
@@ -1048,7 +1113,6 @@ int pdfi_dict_copy(pdf_context *ctx, pdf_dict *target, pdf_dict *source)
         code = pdfi_dict_put_obj(ctx, target, source->list[i].key, source->list[i].value, true);
         if (code < 0)
             return code;
-        target->is_sorted = source->is_sorted;
     }
     return 0;
 }
@@ -1061,7 +1125,7 @@ int pdfi_dict_known(pdf_context *ctx, pdf_dict *d, const char *Key, bool *known)
         return_error(gs_error_typecheck);
 
     *known = false;
-    i = pdfi_dict_find(ctx, d, Key, true);
+    i = pdfi_dict_find(ctx, d, Key);
     if (i >= 0)
         *known = true;
 
@@ -1076,7 +1140,7 @@ int pdfi_dict_known_by_key(pdf_context *ctx, pdf_dict *d, pdf_name *Key, bool *k
         return_error(gs_error_typecheck);
 
     *known = false;
-    i = pdfi_dict_find_key(ctx, d, Key, true);
+    i = pdfi_dict_find_key(ctx, d, Key);
     if (i >= 0)
         *known = true;
 
@@ -1276,7 +1340,6 @@ int pdfi_merge_dicts(pdf_context *ctx, pdf_dict *target, pdf_dict *source)
                 return code;
         }
     }
-    target->is_sorted = false;
     return 0;
 }
 
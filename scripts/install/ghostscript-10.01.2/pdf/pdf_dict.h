@@ -36,6 +36,7 @@ void pdfi_free_dict(pdf_obj *o);
 int pdfi_dict_delete_pair(pdf_context *ctx, pdf_dict *d, pdf_name *n);
 int pdfi_dict_delete(pdf_context *ctx, pdf_dict *d, const char *str);
 int pdfi_dict_alloc(pdf_context *ctx, uint64_t size, pdf_dict **d);
+uint32_t pdfi_dict_hash_bytes(pdf_dict *d);
 int pdfi_dict_from_stack(pdf_context *ctx, uint32_t indirect_num, uint32_t indirect_gen, bool convert_string_keys);
 int pdfi_dict_known(pdf_context *ctx, pdf_dict *d, const char *Key, bool *known);
 int pdfi_dict_known_by_key(pdf_context *ctx, pdf_dict *d, pdf_name *Key, bool *known);
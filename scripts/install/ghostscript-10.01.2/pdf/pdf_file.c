@@ -318,7 +318,11 @@ int pdfi_apply_imscale_filter(pdf_context *ctx, pdf_string *Key, int width, int
 static int pdfi_Flate_filter(pdf_context *ctx, pdf_dict *d, stream *source, stream **new_stream)
 {
     stream_zlib_state zls;
-    uint min_size = 2048;
+    /* A larger buffer lets zlib decode more of the stream with its fast
+     * loop, which stops 258 bytes short of the end of the output, and in
+     * fewer calls. Large reads bypass the buffer in any case.
+     */
+    uint min_size = 16384;
     int code;
     stream *Flate_source = NULL;
 
@@ -560,6 +564,10 @@ pdfi_JPX_filter(pdf_context *ctx, pdf_dict *dict, pdf_dict *decode,
         state.device = (void *)NULL;
     }
 
+    /* The image is decoded while the page is being interpreted, before the
+     * rendering threads get going, so it can have them. */
+    state.threads = ctx->device_state.NumRenderingThreads;
+
     code = pdfi_filter_open(min_size, &s_filter_read_procs, (const stream_template *)&s_jpxd_template,
                             (const stream_state *)&state, ctx->memory->non_gc_memory, new_stream);
     if (code < 0)
@@ -652,6 +660,66 @@ static int pdfi_DCT_filter(pdf_context *ctx, pdf_dict *stream_dict, pdf_dict *de
     return 0;
 }
 
+/* If the last filter applied to image data is DCTDecode or JPXDecode, ask
+ * it to decode the image, which should be Width x Height, at a reduced size
+ * of at least ReduceWidth x ReduceHeight. This reads from the stream, to
+ * get the filter started, and then returns the size the filter actually
+ * produces in *new_width and *new_height, which is Width x Height if the
+ * filter can't reduce this image.
+ */
+int pdfi_reduce_image_filter(pdf_context *ctx, pdf_c_stream *s, int Width, int Height,
+                             int ReduceWidth, int ReduceHeight, int *new_width, int *new_height)
+{
+    stream *fs = s->s;
+
+    *new_width = Width;
+    *new_height = Height;
+
+    if (fs->procs.process == s_DCTD_template.process) {
+        stream_DCT_state *ss = (stream_DCT_state *)fs->state;
+
+        ss->FullWidth = Width;
+        ss->FullHeight = Height;
+        ss->ReduceWidth = ReduceWidth;
+        ss->ReduceHeight = ReduceHeight;
+    }
+#if defined(USE_OPENJPEG_JP2)
+    else if (fs->procs.process == s_jpxd_template.process) {
+        stream_jpxd_state *ss = (stream_jpxd_state *)fs->state;
+
+        ss->FullWidth = Width;
+        ss->FullHeight = Height;
+        ss->ReduceWidth = ReduceWidth;
+        ss->ReduceHeight = ReduceHeight;
+    }
+#endif
+    else
+        return 0;
+
+    while (sbufavailable(fs) == 0 && fs->end_status == 0)
+        s_process_read_buf(fs);
+
+    if (fs->procs.process == s_DCTD_template.process) {
+        stream_DCT_state *ss = (stream_DCT_state *)fs->state;
+
+        if (ss->phase >= 3) {
+            *new_width = ss->data.decompress->dinfo.output_width;
+            *new_height = ss->data.decompress->dinfo.output_height;
+        }
+    }
+#if defined(USE_OPENJPEG_JP2)
+    else {
+        stream_jpxd_state *ss = (stream_jpxd_state *)fs->state;
+
+        if (ss->image != NULL) {
+            *new_width = ss->width;
+            *new_height = ss->height;
+        }
+    }
+#endif
+    return 0;
+}
+
 static int pdfi_ASCII85_filter(pdf_context *ctx, pdf_dict *d, stream *source, stream **new_stream)
 {
     stream_A85D_state ss;
@@ -1647,6 +1647,42 @@ pdfi_make_smask_dict(pdf_context *ctx, pdf_stream *image_stream, pdfi_image_info
  *  inline_image = TRUE, stream it will point to after the image data.
  *  inline_image = FALSE, stream position undefined.
  */
+/* Work out how many device pixels an image sample covers, along each axis
+ * of the image.
+ */
+static int
+pdfi_image_device_scale(pdf_context *ctx, gs_matrix *ImageMatrix, float *sx, float *sy)
+{
+    gs_matrix inverseIM;
+    gs_point pt, pt1;
+    int code;
+
+    code = gs_matrix_invert(ImageMatrix, &inverseIM);
+    if (code < 0)
+        return code;
+
+    code = gs_distance_transform(1, 0, &inverseIM, &pt);
+    if (code < 0)
+        return code;
+
+    code = gs_distance_transform(pt.x, pt.y, &ctm_only(ctx->pgs), &pt1);
+    if (code < 0)
+        return code;
+
+    *sx = sqrt(pt1.x * pt1.x + pt1.y * pt1.y);
+
+    code = gs_distance_transform(0, 1, &inverseIM, &pt);
+    if (code < 0)
+        return code;
+
+    code = gs_distance_transform(pt.x, pt.y, &ctm_only(ctx->pgs), &pt1);
+    if (code < 0)
+        return code;
+
+    *sy = sqrt(pt1.x * pt1.x + pt1.y * pt1.y);
+    return 0;
+}
+
 static int
 pdfi_do_image(pdf_context *ctx, pdf_dict *page_dict, pdf_dict *stream_dict, pdf_stream *image_stream,
               pdf_c_stream *source, bool inline_image)
@@ -2067,34 +2103,13 @@ pdfi_do_image(pdf_context *ctx, pdf_dict *page_dict, pdf_dict *stream_dict, pdf_
     if (image_info.ImageMask == 1 && image_info.BPC == 1 && image_info.Interpolate == 1 && !ctx->device_state.HighLevelDevice)
     {
         pdf_c_stream *s = new_stream;
-        gs_matrix mat4 = {4, 0, 0, 4, 0, 0}, inverseIM;
-        gs_point pt, pt1;
+        gs_matrix mat4 = {4, 0, 0, 4, 0, 0};
         float s1, s2;
 
-        code = gs_matrix_invert(&pim->ImageMatrix, &inverseIM);
-        if (code < 0)
-            goto cleanupExit;
-
-        code = gs_distance_transform(0, 1, &inverseIM, &pt);
-        if (code < 0)
-            goto cleanupExit;
-
-        code = gs_distance_transform(pt.x, pt.y, &ctm_only(ctx->pgs), &pt1);
+        code = pdfi_image_device_scale(ctx, &pim->ImageMatrix, &s2, &s1);
         if (code < 0)
             goto cleanupExit;
 
-        s1 = sqrt(pt1.x * pt1.x + pt1.y * pt1.y);
-
-        code = gs_distance_transform(1, 0, &inverseIM, &pt);
-        if (code < 0)
-            goto cleanupExit;
-
-        code = gs_distance_transform(pt.x, pt.y, &ctm_only(ctx->pgs), &pt1);
-        if (code < 0)
-            goto cleanupExit;
-
-        s2 = sqrt(pt1.x * pt1.x + pt1.y * pt1.y);
-
         if (s1 > 2.0 || s2 > 2.0) {
             code = pdfi_apply_imscale_filter(ctx, 0, image_info.Width, image_info.Height, s, &new_stream);
             if (code < 0)
@@ -2121,6 +2136,44 @@ pdfi_do_image(pdf_context *ctx, pdf_dict *page_dict, pdf_dict *stream_dict, pdf_
         }
     }
 
+    /* If we are rendering a JPEG or JPEG 2000 image at less than its own
+     * resolution, have the decoder reduce it as near to the device
+     * resolution as it can, rather than decoding every sample only for the
+     * image code to throw most of them away. This changes the rendered
+     * result a little (the decoder averages where the image code samples),
+     * so it's only done if asked for.
+     */
+    if (ctx->args.reduceimages && pim == (gs_pixel_image_t *)&t1image && !image_info.ImageMask &&
+        !image_info.SMaskInData && !ctx->device_state.HighLevelDevice &&
+        gs_color_space_get_index(pcs) != gs_color_space_index_Indexed)
+    {
+        gs_matrix scale = {1, 0, 0, 1, 0, 0};
+        float sx, sy;
+        int reduce_w, reduce_h, new_w, new_h;
+
+        code = pdfi_image_device_scale(ctx, &pim->ImageMatrix, &sx, &sy);
+        if (code < 0)
+            goto cleanupExit;
+
+        if (sx < 1.0 && sy < 1.0) {
+            reduce_w = (int)ceil(sx * image_info.Width);
+            reduce_h = (int)ceil(sy * image_info.Height);
+            code = pdfi_reduce_image_filter(ctx, new_stream, image_info.Width, image_info.Height,
+                                            max(reduce_w, 1), max(reduce_h, 1), &new_w, &new_h);
+            if (code < 0)
+                goto cleanupExit;
+            if (new_w != image_info.Width || new_h != image_info.Height) {
+                scale.xx = (float)new_w / image_info.Width;
+                scale.yy = (float)new_h / image_info.Height;
+                image_info.Width = pim->Width = new_w;
+                image_info.Height = pim->Height = new_h;
+                code = gs_matrix_multiply(&pim->ImageMatrix, &scale, &pim->ImageMatrix);
+                if (code < 0)
+                    goto cleanupExit;
+            }
+        }
+    }
+
     trans_required = pdfi_trans_required(ctx);
 
     if (trans_required) {
@@ -68,6 +68,20 @@ static bool isdelimiter(char c)
         return false;
 }
 
+/* Returns the next byte from the stream. When there is nothing to unread,
+ * this takes it straight from the stream buffer, as sgetc does, rather than
+ * making a call for every byte of the tokens we read.
+ */
+static inline int pdfi_read_byte_inline(pdf_context *ctx, pdf_c_stream *s)
+{
+    stream *st = s->s;
+
+    if (s->unread_size == 0 && !s->eof && st->cursor.r.limit - st->cursor.r.ptr > 1)
+        return *++st->cursor.r.ptr;
+
+    return pdfi_read_byte(ctx, s);
+}
+
 /* The 'read' functions all return the newly created object on the context's stack
  * which means these objects are created with a reference count of 0, and only when
  * pushed onto the stack does the reference count become 1, indicating the stack is
@@ -78,7 +92,7 @@ int pdfi_skip_white(pdf_context *ctx, pdf_c_stream *s)
     int c;
 
     do {
-        c = pdfi_read_byte(ctx, s);
+        c = pdfi_read_byte_inline(ctx, s);
         if (c < 0)
             return 0;
     } while (iswhite(c));
@@ -92,11 +106,11 @@ int pdfi_skip_eol(pdf_context *ctx, pdf_c_stream *s)
     int c;
 
     do {
-        c = pdfi_read_byte(ctx, s);
+        c = pdfi_read_byte_inline(ctx, s);
         if (c < 0 || c == 0x0a)
             return 0;
     } while (c != 0x0d);
-    c = pdfi_read_byte(ctx, s);
+    c = pdfi_read_byte_inline(ctx, s);
     if (c == 0x0a)
         return 0;
     if (c >= 0)
@@ -159,7 +173,7 @@ restart:
     pdfi_skip_white(ctx, s);
 
     do {
-        int c = pdfi_read_byte(ctx, s);
+        int c = pdfi_read_byte_inline(ctx, s);
         if (c == EOFC)
             break;
 
@@ -241,7 +255,7 @@ static int pdfi_read_num(pdf_context *ctx, pdf_c_stream *s, uint32_t indirect_nu
     pdfi_skip_white(ctx, s);
 
     do {
-        int c = pdfi_read_byte(ctx, s);
+        int c = pdfi_read_byte_inline(ctx, s);
         if (c == EOFC) {
             Buffer[index] = 0x00;
             break;
@@ -412,7 +426,7 @@ static int pdfi_read_name(pdf_context *ctx, pdf_c_stream *s, uint32_t indirect_n
         return_error(gs_error_VMerror);
 
     do {
-        int c = pdfi_read_byte(ctx, s);
+        int c = pdfi_read_byte_inline(ctx, s);
         if (c < 0)
             break;
 
@@ -493,7 +507,7 @@ static int pdfi_read_hexstring(pdf_context *ctx, pdf_c_stream *s, uint32_t indir
 
     do {
         do {
-            hex0 = pdfi_read_byte(ctx, s);
+            hex0 = pdfi_read_byte_inline(ctx, s);
             if (hex0 < 0)
                 break;
         } while(iswhite(hex0));
@@ -507,7 +521,7 @@ static int pdfi_read_hexstring(pdf_context *ctx, pdf_c_stream *s, uint32_t indir
             dmprintf1(ctx->memory, "%c", (char)hex0);
 
         do {
-            hex1 = pdfi_read_byte(ctx, s);
+            hex1 = pdfi_read_byte_inline(ctx, s);
             if (hex1 < 0)
                 break;
         } while(iswhite(hex1));
@@ -604,7 +618,7 @@ static int pdfi_read_string(pdf_context *ctx, pdf_c_stream *s, uint32_t indirect
             size += 256;
         }
 
-        c = pdfi_read_byte(ctx, s);
+        c = pdfi_read_byte_inline(ctx, s);
 
         if (c < 0) {
             if (nesting > 0)
@@ -658,7 +672,7 @@ static int pdfi_read_string(pdf_context *ctx, pdf_c_stream *s, uint32_t indirect
                     /* Octal chars can be 1, 2 or 3 chars in length, terminated either
                      * by being 3 chars long, EOFC, or a non-octal char. We do not allow
                      * line breaks in the middle of octal chars. */
-                    int c1 = pdfi_read_byte(ctx, s);
+                    int c1 = pdfi_read_byte_inline(ctx, s);
                     c -= '0';
                     if (c1 < 0) {
                         /* Nothing to do, or unread */
@@ -666,7 +680,7 @@ static int pdfi_read_string(pdf_context *ctx, pdf_c_stream *s, uint32_t indirect
                         pdfi_unread_byte(ctx, s, (char)c1);
                     } else {
                         c = c*8 + c1 - '0';
-                        c1 = pdfi_read_byte(ctx, s);
+                        c1 = pdfi_read_byte_inline(ctx, s);
                         if (c1 < 0) {
                             /* Nothing to do, or unread */
                         } else if (c1 < '0' || c1 > '7') {
@@ -783,7 +797,7 @@ int pdfi_skip_comment(pdf_context *ctx, pdf_c_stream *s)
         dmprintf (ctx->memory, " %%");
 
     do {
-        c = pdfi_read_byte(ctx, s);
+        c = pdfi_read_byte_inline(ctx, s);
         if (c < 0)
             break;
 
@@ -801,21 +815,41 @@ static const char pdf_token_strings[][10] = {
 #include "pdf_tokens.h"
 };
 
-#define nelems(A) (sizeof(A)/sizeof(A[0]))
+#include "pdf_token_hash.h"
+
+/* Maps the length bytes at str to a token, using the perfect hash in
+ * pdf_token_hash.h, or returns TOKEN_NOT_A_KEYWORD. The hash picks the
+ * only token which can match, so we need just one comparison to confirm it.
+ */
+static pdf_key lookup_keyword(const byte *str, int length)
+{
+    uint32_t k;
+    pdf_key key;
+
+    if (length <= 0 || length >= (int)sizeof(pdf_token_strings[0]))
+        return TOKEN_NOT_A_KEYWORD;
 
-typedef int (*bsearch_comparator)(const void *, const void *);
+    k = str[0] | (length > 1 ? str[1] << 8 : 0) | (str[length - 1] << 16) | ((uint32_t)length << 24);
+    key = (pdf_key)pdf_token_hash[(uint32_t)(k * PDF_TOKEN_HASH_MULTIPLIER) >> (32 - PDF_TOKEN_HASH_BITS)];
+
+    if (key == TOKEN_NOT_A_KEYWORD || pdf_token_strings[key][length] != 0 ||
+        memcmp(pdf_token_strings[key], str, length) != 0)
+        return TOKEN_NOT_A_KEYWORD;
+
+    return key;
+}
 
 int pdfi_read_bare_keyword(pdf_context *ctx, pdf_c_stream *s)
 {
     byte Buffer[256];
     int index = 0;
     int c;
-    void *t;
+    pdf_key key;
 
     pdfi_skip_white(ctx, s);
 
     do {
-        c = pdfi_read_byte(ctx, s);
+        c = pdfi_read_byte_inline(ctx, s);
         if (c < 0)
             break;
 
@@ -834,32 +868,14 @@ int pdfi_read_bare_keyword(pdf_context *ctx, pdf_c_stream *s)
     }
 
     Buffer[index] = 0x00;
-    t = bsearch((const void *)Buffer,
-                (const void *)pdf_token_strings[TOKEN_INVALID_KEY+1],
-                nelems(pdf_token_strings)-(TOKEN_INVALID_KEY+1),
-                sizeof(pdf_token_strings[0]),
-                (bsearch_comparator)&strcmp);
-    if (t == NULL)
+    key = lookup_keyword(Buffer, index);
+    if (key == TOKEN_NOT_A_KEYWORD)
         return TOKEN_INVALID_KEY;
 
     if (ctx->args.pdfdebug)
         dmprintf1(ctx->memory, " %s\n", Buffer);
 
-    return (((const char *)t) - pdf_token_strings[0]) / sizeof(pdf_token_strings[0]);
-}
-
-static pdf_key lookup_keyword(const byte *Buffer)
-{
-    void *t = bsearch((const void *)Buffer,
-                      (const void *)pdf_token_strings[TOKEN_INVALID_KEY+1],
-                      nelems(pdf_token_strings)-(TOKEN_INVALID_KEY+1),
-                      sizeof(pdf_token_strings[0]),
-                      (bsearch_comparator)&strcmp);
-    if (t == NULL)
-        return TOKEN_NOT_A_KEYWORD;
-
-    return (pdf_key)((((const char *)t) - pdf_token_strings[0]) /
-                     sizeof(pdf_token_strings[0]));
+    return key;
 }
 
 /* This function is slightly misnamed. We read 'keywords' from
@@ -880,7 +896,7 @@ static int pdfi_read_keyword(pdf_context *ctx, pdf_c_stream *s, uint32_t indirec
     pdfi_skip_white(ctx, s);
 
     do {
-        c = pdfi_read_byte(ctx, s);
+        c = pdfi_read_byte_inline(ctx, s);
         if (c < 0)
             break;
 
@@ -900,7 +916,7 @@ static int pdfi_read_keyword(pdf_context *ctx, pdf_c_stream *s, uint32_t indirec
         Buffer[0] = 0;
     } else {
         Buffer[index] = 0x00;
-        key = lookup_keyword(Buffer);
+        key = lookup_keyword(Buffer, index);
 
         if (ctx->args.pdfdebug)
             dmprintf1(ctx->memory, " %s\n", Buffer);
@@ -990,7 +1006,7 @@ int pdfi_read_token(pdf_context *ctx, pdf_c_stream *s, uint32_t indirect_num, ui
 rescan:
     pdfi_skip_white(ctx, s);
 
-    c = pdfi_read_byte(ctx, s);
+    c = pdfi_read_byte_inline(ctx, s);
     if (c == EOFC)
         return 0;
     if (c < 0)
@@ -1022,14 +1038,14 @@ rescan:
             return 1;
             break;
         case '<':
-            c = pdfi_read_byte(ctx, s);
+            c = pdfi_read_byte_inline(ctx, s);
             if (c < 0)
                 return (gs_error_ioerror);
             if (iswhite(c)) {
                 code = pdfi_skip_white(ctx, s);
                 if (code < 0)
                     return code;
-                c = pdfi_read_byte(ctx, s);
+                c = pdfi_read_byte_inline(ctx, s);
             }
             if (c == '<') {
                 if (ctx->args.pdfdebug)
@@ -1058,7 +1074,7 @@ rescan:
                 return_error(gs_error_syntaxerror);
             break;
         case '>':
-            c = pdfi_read_byte(ctx, s);
+            c = pdfi_read_byte_inline(ctx, s);
             if (c < 0)
                 return (gs_error_ioerror);
             if (c == '>') {
@@ -1157,20 +1173,6 @@ int pdfi_name_alloc(pdf_context *ctx, byte *n, uint32_t size, pdf_obj **o)
     return 0;
 }
 
-static char op_table_3[5][3] = {
-    "BDC", "BMC", "EMC", "SCN", "scn"
-};
-
-static char op_table_2[39][2] = {
-    "b*", "BI", "BT", "BX", "cm", "CS", "cs", "EI", "d0", "d1", "Do", "DP", "ET", "EX", "f*", "gs", "ID", "MP", "re", "RG",
-    "rg", "ri", "SC", "sc", "sh", "T*", "Tc", "Td", "TD", "Tf", "Tj", "TJ", "TL", "Tm", "Tr", "Ts", "Tw", "Tz", "W*",
-};
-
-static char op_table_1[27][1] = {
-    "b", "B", "c", "d", "f", "F", "G", "g", "h", "i", "j", "J", "K", "k", "l", "m", "n", "q", "Q", "s", "S", "v", "w", "W",
-    "y", "'", "\""
-};
-
 /* forward definition for the 'split_bogus_operator' function to use */
 static int pdfi_interpret_stream_operator(pdf_context *ctx, pdf_c_stream *source,
                                           pdf_dict *stream_dict, pdf_dict *page_dict);
@@ -1178,14 +1180,11 @@ static int pdfi_interpret_stream_operator(pdf_context *ctx, pdf_c_stream *source
 static int
 make_keyword_obj(pdf_context *ctx, const byte *data, int length, pdf_keyword **pkey)
 {
-    byte Buffer[256];
     pdf_key key;
     int code;
 
-    memcpy(Buffer, data, length);
-    Buffer[length] = 0;
-    key = lookup_keyword(Buffer);
-    if (key != TOKEN_INVALID_KEY) {
+    key = lookup_keyword(data, length);
+    if (key != TOKEN_NOT_A_KEYWORD) {
         /* The common case. We've found a real key, just cast the token to
          * a pointer, and return that. */
         *pkey = (pdf_keyword *)PDF_TOKEN_AS_OBJ(key);
@@ -1197,43 +1196,30 @@ make_keyword_obj(pdf_context *ctx, const byte *data, int length, pdf_keyword **p
     if (code < 0)
         return code;
     if (length)
-        memcpy((*pkey)->data, Buffer, length);
+        memcpy((*pkey)->data, data, length);
     pdfi_countup(*pkey);
 
     return 1;
 }
 
-static int search_table_3(pdf_context *ctx, unsigned char *str, pdf_keyword **key)
-{
-    int i;
-
-    for (i = 0; i < 5; i++) {
-        if (memcmp(str, op_table_3[i], 3) == 0)
-            return make_keyword_obj(ctx, str, 3, key);
-    }
-    return 0;
-}
-
-static int search_table_2(pdf_context *ctx, unsigned char *str, pdf_keyword **key)
-{
-    int i;
-
-    for (i = 0; i < 39; i++) {
-        if (memcmp(str, op_table_2[i], 2) == 0)
-            return make_keyword_obj(ctx, str, 2, key);
-    }
-    return 0;
-}
-
-static int search_table_1(pdf_context *ctx, unsigned char *str, pdf_keyword **key)
+/* Checks whether the length bytes at str are one of the operators which
+ * split_bogus_operator will separate from its neighbour, and if so returns 1
+ * and the operator in *key. Keywords which are not operators (R and obj),
+ * the non-standard r, and B* and M are not split.
+ */
+static int search_table(pdf_context *ctx, unsigned char *str, int length, pdf_keyword **key)
 {
-    int i;
-
-    for (i = 0; i < 27; i++) {
-        if (memcmp(str, op_table_1[i], 1) == 0)
-            return make_keyword_obj(ctx, str, 1, key);
+    switch (lookup_keyword(str, length)) {
+        case TOKEN_NOT_A_KEYWORD:
+        case TOKEN_R:
+        case TOKEN_OBJ:
+        case TOKEN_r:
+        case TOKEN_Bstar:
+        case TOKEN_M:
+            return 0;
+        default:
+            return make_keyword_obj(ctx, str, length, key);
     }
-    return 0;
 }
 
 static int split_bogus_operator(pdf_context *ctx, pdf_c_stream *source, pdf_dict *stream_dict, pdf_dict *page_dict)
@@ -1284,20 +1270,20 @@ static int split_bogus_operator(pdf_context *ctx, pdf_c_stream *source, pdf_dict
     }
 
     if (keyword->length > 3) {
-        code = search_table_3(ctx, keyword->data, &key1);
+        code = search_table(ctx, keyword->data, 3, &key1);
         if (code < 0)
             goto error_exit;
 
         if (code > 0) {
             switch (keyword->length - 3) {
                 case 1:
-                    code = search_table_1(ctx, &keyword->data[3], &key2);
+                    code = search_table(ctx, &keyword->data[3], 1, &key2);
                     break;
                 case 2:
-                    code = search_table_2(ctx, &keyword->data[3], &key2);
+                    code = search_table(ctx, &keyword->data[3], 2, &key2);
                     break;
                 case 3:
-                    code = search_table_3(ctx, &keyword->data[3], &key2);
+                    code = search_table(ctx, &keyword->data[3], 3, &key2);
                     break;
                 default:
                     goto error_exit;
@@ -1316,20 +1302,20 @@ static int split_bogus_operator(pdf_context *ctx, pdf_c_stream *source, pdf_dict
     if (keyword->length > 5 || keyword->length < 2)
         goto error_exit;
 
-    code = search_table_2(ctx, keyword->data, &key1);
+    code = search_table(ctx, keyword->data, 2, &key1);
     if (code < 0)
         goto error_exit;
 
     if (code > 0) {
         switch(keyword->length - 2) {
             case 1:
-                code = search_table_1(ctx, &keyword->data[2], &key2);
+                code = search_table(ctx, &keyword->data[2], 1, &key2);
                 break;
             case 2:
-                code = search_table_2(ctx, &keyword->data[2], &key2);
+                code = search_table(ctx, &keyword->data[2], 2, &key2);
                 break;
             case 3:
-                code = search_table_3(ctx, &keyword->data[2], &key2);
+                code = search_table(ctx, &keyword->data[2], 3, &key2);
                 break;
             default:
                 goto error_exit;
@@ -1347,19 +1333,19 @@ static int split_bogus_operator(pdf_context *ctx, pdf_c_stream *source, pdf_dict
     if (keyword->length > 4)
         goto error_exit;
 
-    code = search_table_1(ctx, keyword->data, &key1);
+    code = search_table(ctx, keyword->data, 1, &key1);
     if (code <= 0)
         goto error_exit;
 
     switch(keyword->length - 1) {
         case 1:
-            code = search_table_1(ctx, &keyword->data[1], &key2);
+            code = search_table(ctx, &keyword->data[1], 1, &key2);
             break;
         case 2:
-            code = search_table_2(ctx, &keyword->data[1], &key2);
+            code = search_table(ctx, &keyword->data[1], 2, &key2);
             break;
         case 3:
-            code = search_table_3(ctx, &keyword->data[1], &key2);
+            code = search_table(ctx, &keyword->data[1], 3, &key2);
             break;
         default:
             goto error_exit;
@@ -39,6 +39,9 @@
 #include "gspaint.h"        /* For gs_erasepage() */
 #include "gsstate.h"        /* For gs_initgraphics() */
 #include "gspath2.h"        /* For gs_rectclip() */
+#include "gsdevice.h"       /* For gs_closedevice() and gs_opendevice() */
+#include "gp.h"             /* For gp_fork_process() */
+#include "stream.h"         /* For reopening the file in page workers */
 
 static int pdfi_process_page_contents(pdf_context *ctx, pdf_dict *page_dict)
 {
@@ -1064,3 +1067,177 @@ exit3:
             code = ctx->finish_page(ctx);
     return code;
 }
+
+/* Rendering pages in parallel.
+ *
+ * With -dPDFPageWorkers=N, pdfi_start_page_workers starts N-1 copies of the
+ * process once the file has been opened, using gp_fork_process. Each copy
+ * is a worker with its own interpreter context and device, but shares the
+ * xref, the object cache and the fonts read so far with the original, which
+ * is worker 0. All the workers then run the same loop over the pages, and
+ * pdfi_page_worker_selected picks every N'th page for each of them. Before a
+ * worker renders a page it sets the device's PageCount to the number of
+ * pages before it, so the page is written to the same file as it would be
+ * if the pages were rendered one at a time. For this reason we only use
+ * workers when the device writes each page to its own file; otherwise we
+ * render the pages one at a time as usual, as we do when the PDF file is
+ * not a named file which the workers can open again for themselves.
+ *
+ * At the end pdfi_end_page_workers ends the extra workers, and the original
+ * waits for them before going on.
+ */
+static void pdfi_set_page_count(gx_device *dev, long count)
+{
+    while (dev != NULL) {
+        dev->PageCount = count;
+        dev = dev->child;
+    }
+}
+
+/* The operating system keeps a single position for a file which is open in
+ * more than one process, so a worker can't read the PDF file through the
+ * handle it inherited without upsetting the others. Open the file again, and
+ * carry on from the same place in it. We don't close the old handle, because
+ * closing it can move the position the others are using.
+ */
+static bool pdfi_page_worker_can_reopen(pdf_context *ctx)
+{
+    stream *s = ctx->main_stream == NULL ? NULL : ctx->main_stream->s;
+
+    return s != NULL && s->file != NULL && s->file_name.data != NULL &&
+           s->file_name.data[0] != '%' && s_can_seek(s);
+}
+
+static int pdfi_page_worker_reopen(pdf_context *ctx)
+{
+    stream *s = ctx->main_stream->s;
+    gs_offset_t pos = s->file_offset + s->position + (s->cursor.r.limit - s->cbuf + 1);
+    gp_file *file;
+
+    file = gp_fopen(ctx->memory, (const char *)s->file_name.data, "rb");
+    if (file == NULL)
+        return_error(gs_error_invalidfileaccess);
+    if (gp_fseek(file, pos, SEEK_SET) != 0) {
+        gp_fclose(file);
+        return_error(gs_error_ioerror);
+    }
+    /* The stream may be pdfi's copy of a PostScript file's stream, in which
+     * case its state is still the original stream. A file stream's state is
+     * the stream itself. */
+    s->state = (stream_state *)s;
+    s->file = file;
+    return 0;
+}
+
+int pdfi_start_page_workers(pdf_context *ctx, gx_device *dev)
+{
+    int i, pid, code;
+
+    ctx->page_worker = 0;
+    ctx->page_worker_count = 1;
+    ctx->page_worker_ordinal = 0;
+    ctx->page_worker_base = dev->PageCount;
+
+    if (ctx->args.page_workers <= 1 || ctx->args.pdfinfo)
+        return 0;
+
+    if (!pdfi_device_output_file_per_page(dev)) {
+        if (!ctx->args.QUIET)
+            outprintf(ctx->memory, "PDFPageWorkers needs an OutputFile with a page number format (%%d), rendering pages one at a time.\n");
+        return 0;
+    }
+
+    if (!pdfi_page_worker_can_reopen(ctx)) {
+        if (!ctx->args.QUIET)
+            outprintf(ctx->memory, "PDFPageWorkers needs the PDF file to be a named file, rendering pages one at a time.\n");
+        return 0;
+    }
+
+    ctx->page_worker_pids = (int *)gs_alloc_bytes(ctx->memory, ctx->args.page_workers * sizeof(int), "pdfi_start_page_workers");
+    if (ctx->page_worker_pids == NULL)
+        return_error(gs_error_VMerror);
+    memset(ctx->page_worker_pids, 0x00, ctx->args.page_workers * sizeof(int));
+
+    ctx->page_worker_count = ctx->args.page_workers;
+    for (i = 1; i < ctx->page_worker_count; i++) {
+        pid = gp_fork_process();
+        if (pid == 0) {
+            /* We are the new worker. Reopen the PDF file, and the device so
+             * that it has its own band list files rather than sharing the
+             * original's. */
+            gs_free_object(ctx->memory, ctx->page_worker_pids, "pdfi_start_page_workers");
+            ctx->page_worker_pids = NULL;
+            ctx->page_worker = i;
+            code = pdfi_page_worker_reopen(ctx);
+            if (code >= 0)
+                code = gs_closedevice(dev);
+            if (code >= 0)
+                code = gs_opendevice(dev);
+            if (code < 0)
+                gp_exit_process(1);
+            return 0;
+        }
+        if (pid < 0) {
+            /* The original renders the pages of any workers we couldn't start. */
+            if (!ctx->args.QUIET)
+                outprintf(ctx->memory, "Could only start %d of %d PDFPageWorkers.\n", i, ctx->page_worker_count);
+            break;
+        }
+        ctx->page_worker_pids[i] = pid;
+    }
+    return 0;
+}
+
+/* Called for each page the loop would render, in order. Returns true if this
+ * worker should render it, having set up the device's PageCount for it.
+ */
+bool pdfi_page_worker_selected(pdf_context *ctx, gx_device *dev)
+{
+    int worker;
+
+    if (ctx->page_worker_count <= 1)
+        return true;
+
+    worker = ctx->page_worker_ordinal % ctx->page_worker_count;
+    if (worker != ctx->page_worker &&
+        (ctx->page_worker != 0 || ctx->page_worker_pids[worker] != 0)) {
+        ctx->page_worker_ordinal++;
+        return false;
+    }
+
+    pdfi_set_page_count(dev, ctx->page_worker_base + ctx->page_worker_ordinal);
+    ctx->page_worker_ordinal++;
+    return true;
+}
+
+/* Ends the extra workers, which do not return from here, and makes the
+ * original wait for them. status is the result of this worker's loop over
+ * the pages. Returns an error if any of the other workers failed.
+ */
+int pdfi_end_page_workers(pdf_context *ctx, gx_device *dev, int status)
+{
+    int i, code = 0;
+
+    if (ctx->page_worker_count <= 1)
+        return 0;
+
+    if (ctx->page_worker != 0) {
+        pdfi_report_errors(ctx);
+        if (gs_closedevice(dev) < 0)
+            status = -1;
+        gp_exit_process(status < 0 ? 1 : 0);
+    }
+
+    for (i = 1; i < ctx->page_worker_count; i++) {
+        if (ctx->page_worker_pids[i] != 0 && gp_wait_process(ctx->page_worker_pids[i]) != 0) {
+            errprintf(ctx->memory, "   **** Error: PDF page worker %d failed, its pages may be missing from the output.\n", i);
+            code = gs_note_error(gs_error_ioerror);
+        }
+    }
+    gs_free_object(ctx->memory, ctx->page_worker_pids, "pdfi_end_page_workers");
+    ctx->page_worker_pids = NULL;
+
+    pdfi_set_page_count(dev, ctx->page_worker_base + ctx->page_worker_ordinal);
+    ctx->page_worker_count = 1;
+    return code;
+}
@@ -23,5 +23,8 @@ int pdfi_page_info(pdf_context *ctx, uint64_t page_num, pdf_dict **info_dict, bo
 int pdfi_page_graphics_begin(pdf_context *ctx);
 int pdfi_page_get_dict(pdf_context *ctx, uint64_t page_num, pdf_dict **dict);
 int pdfi_page_get_number(pdf_context *ctx, pdf_dict *target_dict, uint64_t *page_num);
+int pdfi_start_page_workers(pdf_context *ctx, gx_device *dev);
+bool pdfi_page_worker_selected(pdf_context *ctx, gx_device *dev);
+int pdfi_end_page_workers(pdf_context *ctx, gx_device *dev, int status);
 
 #endif
@@ -0,0 +1,91 @@
+/* Copyright (C) 2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  1305 Grant Avenue - Suite 200, Novato,
+   CA 94945, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* Generated by toolbin/gen_pdf_token_hash.py from pdf_tokens.h, do not edit. */
+
+#ifndef PDF_TOKEN_HASH_H
+#define PDF_TOKEN_HASH_H
+
+#define PDF_TOKEN_HASH_MULTIPLIER 0x116156bdU
+#define PDF_TOKEN_HASH_BITS 8
+
+static const unsigned char pdf_token_hash[256] = {
+    TOKEN_c,             TOKEN_XREF,          TOKEN_NOT_A_KEYWORD, TOKEN_TRAILER,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_ENDOBJ,        TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_h,             TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_M,             TOKEN_NOT_A_KEYWORD,
+    TOKEN_sh,            TOKEN_m,             TOKEN_NOT_A_KEYWORD, TOKEN_TD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_Td,            TOKEN_R,             TOKEN_NOT_A_KEYWORD,
+    TOKEN_RG,            TOKEN_NOT_A_KEYWORD, TOKEN_r,             TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_STARTXREF,     TOKEN_W,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_w,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_Tr,            TOKEN_NOT_A_KEYWORD,
+    TOKEN_Bstar,         TOKEN_gs,            TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_F,             TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_f,             TOKEN_MP,            TOKEN_BX,
+    TOKEN_NOT_A_KEYWORD, TOKEN_K,             TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_BDC,           TOKEN_k,             TOKEN_ENDSTREAM,     TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_STREAM,        TOKEN_rg,
+    TOKEN_NOT_A_KEYWORD, TOKEN_SC,            TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_ID,
+    TOKEN_bstar,         TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_BT,
+    TOKEN_NOT_A_KEYWORD, TOKEN_Tc,            TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_Tstar,         TOKEN_NOT_A_KEYWORD, TOKEN_TJ,
+    TOKEN_NOT_A_KEYWORD, TOKEN_PDF_TRUE,      TOKEN_Tj,            TOKEN_NOT_A_KEYWORD,
+    TOKEN_d,             TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_EX,            TOKEN_i,             TOKEN_BI,            TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_sc,            TOKEN_NOT_A_KEYWORD, TOKEN_n,             TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_S,             TOKEN_d1,
+    TOKEN_null,          TOKEN_NOT_A_KEYWORD, TOKEN_s,             TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_Tf,            TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_Tm,            TOKEN_ET,
+    TOKEN_NOT_A_KEYWORD, TOKEN_QUOTE,         TOKEN_NOT_A_KEYWORD, TOKEN_cm,
+    TOKEN_B,             TOKEN_Wstar,         TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_b,             TOKEN_APOSTROPHE,    TOKEN_fstar,         TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_G,             TOKEN_DP,            TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_g,             TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_EI,            TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_l,             TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_BMC,           TOKEN_NOT_A_KEYWORD, TOKEN_Q,             TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_q,             TOKEN_NOT_A_KEYWORD,
+    TOKEN_CS,            TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_ri,
+    TOKEN_PDF_FALSE,     TOKEN_NOT_A_KEYWORD, TOKEN_v,             TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_Tw,
+    TOKEN_SCN,           TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_d0,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_TL,
+    TOKEN_NOT_A_KEYWORD, TOKEN_J,             TOKEN_NOT_A_KEYWORD, TOKEN_re,
+    TOKEN_NOT_A_KEYWORD, TOKEN_j,             TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_Ts,            TOKEN_NOT_A_KEYWORD,
+    TOKEN_EMC,           TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_cs,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_Tz,
+    TOKEN_Do,            TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_OBJ,           TOKEN_NOT_A_KEYWORD, TOKEN_scn,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_y,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+    TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD, TOKEN_NOT_A_KEYWORD,
+};
+
+#endif
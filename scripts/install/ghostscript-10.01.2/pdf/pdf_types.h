@@ -181,7 +181,8 @@ typedef struct pdf_dict_s {
     uint64_t entries;
     pdf_dict_entry *list;
     bool dict_written;  /* Has dict been written (for pdfwrite) */
-    bool is_sorted;     /* true if the dictionary has been sorted by Key, for faster searching */
+    uint32_t *hash;     /* Index of the keys for faster searching, or NULL, see pdf_dict.c */
+    uint32_t hash_size; /* Number of slots in 'hash', a power of 2 */
 } pdf_dict;
 
 typedef struct pdf_stream_s {
@@ -215,8 +216,18 @@ typedef struct pdf_obj_cache_entry_s {
     void *next;
     void *previous;
     pdf_obj *o;
+    uint32_t size;                  /* Estimated size of the object, counted against the cache budget */
+    bool frequent;                  /* true if in the 'frequent' queue, false if still on probation */
 }pdf_obj_cache_entry;
 
+/* Cache entries are allocated in blocks of this many, and recycled through a free list */
+#define PDF_OBJ_CACHE_BLOCK_ENTRIES 64
+
+typedef struct pdf_obj_cache_block_s {
+    struct pdf_obj_cache_block_s *next;
+    pdf_obj_cache_entry entries[PDF_OBJ_CACHE_BLOCK_ENTRIES];
+}pdf_obj_cache_block;
+
 /* The compressed and uncompressed xref entries are identical, they only differ
  * in the names used for the variables. Its simply less confusing not to overload
  * the names.
@@ -237,6 +248,7 @@ typedef struct xref_entry_s {
         }compressed;
     }u;
     pdf_obj_cache_entry *cache;     /* Pointer to cache entry if cached, or NULL if not */
+    bool recently_evicted;          /* true if evicted from the cache while on probation, see pdf_deref.c */
 } xref_entry;
 
 typedef struct xref_s {
@@ -719,6 +719,25 @@ pdf_impl_set_param(pl_interp_implementation_t *impl,
             if (code < 0)
                 return code;
         }
+        if (argis(param, "PDFObjectCacheSize")) {
+            code = plist_value_get_int(&pvalue, &ctx->args.object_cache_size);
+            if (code < 0)
+                return code;
+            if (ctx->args.object_cache_size < 0)
+                return_error(gs_error_rangecheck);
+        }
+        if (argis(param, "PDFPageWorkers")) {
+            code = plist_value_get_int(&pvalue, &ctx->args.page_workers);
+            if (code < 0)
+                return code;
+            if (ctx->args.page_workers < 0)
+                return_error(gs_error_rangecheck);
+        }
+        if (argis(param, "PDFReduceImages")) {
+            code = plist_value_get_bool(&pvalue, &ctx->args.reduceimages);
+            if (code < 0)
+                return code;
+        }
     }
 
  exit:
@@ -307,6 +307,26 @@ int gs_main_init2aux(gs_main_instance * minst) {
             return code;
         minst->init_done = 2;
 
+        /* Take the procedures that run the jobs of server mode out of
+         * systemdict, where PostScript (and so the jobs themselves) could
+         * find them. run_server keeps them, if it asked for them. */
+        i_ctx_p = minst->i_ctx_p;
+        {
+            ref *pdict, key;
+
+            if (dict_find_string(systemdict, ".serverjobdict", &pdict) > 0) {
+                if (r_has_type(&minst->server_procs, t_null))
+                    ref_assign(&minst->server_procs, pdict);
+                code = name_ref(imemory, (const byte *)".serverjobdict",
+                                14, &key, 0);
+                if (code < 0)
+                    return code;
+                code = idict_undef(systemdict, &key);
+                if (code < 0)
+                    return code;
+            }
+        }
+
         /* NB this is to be done with device parameters
          * both minst->display and  display_set_callback() are going away
         */
@@ -43,6 +43,7 @@
 #include "ostack.h"             /* must precede iscan.h */
 #include "iscan.h"
 #include "iconf.h"
+#include "idict.h"
 #include "imain.h"
 #include "imainarg.h"
 #include "iapi.h"
@@ -93,6 +94,7 @@ extern int zflushpage(i_ctx_t *);
 static int swproc(gs_main_instance *, const char *, arg_list *);
 static int argproc(gs_main_instance *, const char *);
 static int run_buffered(gs_main_instance *, const char *);
+static int run_server(gs_main_instance *, const char *);
 static int esc_strlen(const char *);
 static void esc_strcat(char *, const char *);
 static int runarg(gs_main_instance *, const char *, const char *, const char *, int, int, int *, ref *);
@@ -453,6 +455,16 @@ run_stdin:
             } else if (strncmp(arg, "saved-pages-test", 16) == 0) {
                 minst->saved_pages_test_mode = true;
                 break;
+            } else if (arg_match(&arg, "server")) {
+                minst->run_start = false;   /* don't run 'start' */
+                /* Set NOPAUSE so showpage won't try to read from stdin. */
+                code = swproc(minst, "-dNOPAUSE", pal);
+                if (code < 0)
+                    return code;
+                code = run_server(minst, arg);
+                if (code < 0)
+                    return code;
+                break;
             /* Now handle the explicitly added paths to the file control lists */
             } else if (arg_match(&arg, "permit-file-read")) {
                 code = gs_add_explicit_control_path(minst->heap, arg, gs_permit_file_reading);
@@ -1096,6 +1108,317 @@ run_buffered(gs_main_instance * minst, const char *arg)
     zflushpage(minst->i_ctx_p);
     return run_finish(minst, code, exit_code, &error_object);
 }
+/* ------ Server mode ------ */
+
+/*
+ * In server mode (--server=<jobs>) we read jobs, one per line, from the
+ * file jobs (typically a named pipe), or from stdin if that is - or
+ * missing, and run them one after the other in this instance, so that the
+ * initialisation, the fonts, the colour management and any OCR engines
+ * (see tessocr.cpp) stay warm from one job to the next. A job is written
+ * as the rest of a command line would be: the switches and the files to
+ * run with them. Only the switches that define names (-d, -s, -o and -r)
+ * may be used. Each job is run on its own copy of its device, inside a
+ * save, and the names that its switches defined get their old values back
+ * afterwards, so what one job does doesn't carry over to the next (see
+ * .serverjobdict in gs_init.ps). The procedures that do this are out of
+ * the reach of PostScript, so the jobs can't run them themselves; we run
+ * them from server_procs. When a job is done, and its output file
+ * closed, we write
+ *      %%[ Job: <n>; Status: ok ]%%
+ * or "failed" in place of "ok", as a line to stdout.
+ */
+
+#define MAX_SERVER_JOB 4096
+#define MAX_SERVER_ARGS 100
+
+static int
+server_getc(gs_main_instance *minst, gp_file *in)
+{
+    gs_lib_ctx_core_t *core = minst->heap->gs_lib_ctx->core;
+    char c;
+    int count;
+
+    if (in != NULL)
+        return gp_fgetc(in);
+    if (core->stdin_fn)
+        count = (*core->stdin_fn)(core->std_caller_handle, &c, 1);
+    else
+        count = gp_stdin_read(&c, 1, 1, core->fstdin);
+    return (count == 1 ? (byte)c : EOF);
+}
+
+/* Read a job line into buf. Return -1 at the end of the input, otherwise
+ * the length of the line, which is size or more if it didn't fit. */
+static int
+server_read_job(gs_main_instance *minst, gp_file *in, char *buf, int size)
+{
+    int c, len = 0;
+
+    while ((c = server_getc(minst, in)) != EOF && c != '\n') {
+        if (len < size - 1)
+            buf[len] = c;
+        len++;
+    }
+    if (c == EOF && len == 0)
+        return -1;
+    if (len < size) {
+        if (len > 0 && buf[len - 1] == '\r')
+            len--;
+        buf[len] = 0;
+    }
+    return len;
+}
+
+/* Append the names that a job switch defines, as strings, to names. */
+static int
+server_job_names(gs_main_instance *minst, const char *arg, char *names)
+{
+    char *name;
+
+    switch (arg[1]) {
+        case 'D':
+        case 'd':
+        case 'S':
+        case 's':
+            name = arg_copy(arg + 2, minst->heap);
+            if (name == NULL)
+                return_error(gs_error_VMerror);
+            name[strcspn(name, "=#")] = 0;
+            esc_strcat(names, name);
+            arg_free(name, minst->heap);
+            return 0;
+        case 'o':
+            strcat(names, "(OutputFile)(NOPAUSE)(BATCH)");
+            return 0;
+        case 'r':
+            strcat(names, "(FIXEDRESOLUTION)(DEVICEXRESOLUTION)(DEVICEYRESOLUTION)");
+            return 0;
+    }
+    outprintf(minst->heap, "   Switch '%s' can't be used in a server job.\n", arg);
+    return_error(gs_error_rangecheck);
+}
+
+/* Run one of the procedures of .serverjobdict on the operand stack. */
+static int
+run_server_proc(gs_main_instance *minst, const char *name, int options)
+{
+    ref *pproc, proc, error_object;
+    int exit_code, code;
+
+    if (!r_has_type(&minst->server_procs, t_dictionary) ||
+        dict_find_string(&minst->server_procs, name, &pproc) <= 0)
+        return_error(gs_error_Fatal);
+    ref_assign(&proc, pproc);
+    code = gs_interpret(&minst->i_ctx_p, &proc, minst->user_errors,
+                        &exit_code, &error_object);
+    if ((options & runFlush) || code != 0) {
+        zflush(minst->i_ctx_p);         /* flush stdout */
+        zflushpage(minst->i_ctx_p);     /* force display update */
+    }
+    return run_finish(minst, code, exit_code, &error_object);
+}
+
+/* Run a job, setting *ok to whether it succeeded. Return an error only if
+ * the server can't carry on. */
+static int
+run_server_job(gs_main_instance *minst, const char *line, bool *ok)
+{
+    arg_list args;
+    const char *arg;
+    char *argv[MAX_SERVER_ARGS];
+    char *names = NULL;
+    int argc = 0, len = 0;
+    int i, code, code1;
+    bool done = false;
+
+    *ok = false;
+    code = arg_init(&args, NULL, 0, gs_main_arg_sopen, (void *)minst,
+                    minst->get_codepoint, minst->heap);
+    if (code >= 0) {
+        char *copy = arg_copy(line, minst->heap);
+
+        if (copy == NULL)
+            return_error(gs_error_VMerror);
+        code = arg_push_decoded_memory_string(&args, copy, false, true, minst->heap);
+    }
+    /* Copy the arguments, joining -o to its file name, as -o<file>. */
+    while (code >= 0 && (code = arg_next(&args, &arg, minst->heap)) > 0) {
+        if (argc == MAX_SERVER_ARGS) {
+            code = gs_note_error(gs_error_limitcheck);
+            break;
+        }
+        if (!strcmp(arg, "-o")) {
+            code = arg_next(&args, &arg, minst->heap);
+            if (code <= 0) {
+                code = gs_note_error(gs_error_undefinedfilename);
+                break;
+            }
+            argv[argc] = (char *)gs_alloc_bytes(minst->heap, strlen(arg) + 3, "run_server_job");
+            if (argv[argc] != NULL) {
+                strcpy(argv[argc], "-o");
+                strcat(argv[argc], arg);
+            }
+        } else
+            argv[argc] = arg_copy(arg, minst->heap);
+        if (argv[argc] == NULL) {
+            code = gs_note_error(gs_error_VMerror);
+            break;
+        }
+        len += esc_strlen(argv[argc]) + 64;
+        argc++;
+    }
+    arg_finit(&args);
+    if (code < 0)
+        goto out;
+
+    /* Make the list of the names that the switches will define. */
+    names = (char *)gs_alloc_bytes(minst->heap, len + 32, "run_server_job");
+    if (names == NULL) {
+        code = gs_note_error(gs_error_VMerror);
+        goto out;
+    }
+    strcpy(names, "[");
+    for (i = 0; i < argc && code >= 0; i++)
+        if (argv[i][0] == '-')
+            code = server_job_names(minst, argv[i], names);
+    strcat(names, "]");
+    if (code < 0)
+        goto out;
+    code = run_string(minst, names, 0, minst->user_errors, NULL, NULL);
+    if (code >= 0)
+        code = run_server_proc(minst, "begin", 0);
+    if (code < 0)
+        goto out;
+
+    for (i = 0; i < argc && code >= 0; i++)
+        if (argv[i][0] == '-') {
+            code = swproc(minst, argv[i], &args);
+            if (code == gs_error_Fatal)
+                code = gs_note_error(gs_error_rangecheck); /* a bad switch */
+        }
+    if (code >= 0)
+        code = run_server_proc(minst, "start", 0);
+    if (code >= 0)
+        code = gs_pop_boolean(minst, &done);
+    for (i = 0; i < argc && code >= 0 && done; i++) {
+        if (argv[i][0] == '-')
+            continue;
+        code = gs_add_control_path(minst->heap, gs_permit_file_reading, argv[i]);
+        if (code >= 0)
+            code = runarg(minst, "", argv[i], "", 0, minst->user_errors, NULL, NULL);
+        if (code >= 0) {
+            minst->i_ctx_p->starting_arg_file = true;
+            code = run_server_proc(minst, "runfile", runFlush);
+            minst->i_ctx_p->starting_arg_file = false;
+        }
+        if (code >= 0)
+            code = gs_pop_boolean(minst, &done);
+        code1 = gs_remove_control_path(minst->heap, gs_permit_file_reading, argv[i]);
+        if (code >= 0 && code1 < 0)
+            code = code1;
+    }
+    *ok = (code >= 0 && done);
+    code1 = run_server_proc(minst, "end", runFlush);
+    if (code1 < 0) {
+        /* We can't tell what the job has left behind for the next one. */
+        outprintf(minst->heap, "   Server job didn't end cleanly, stopping.\n");
+        code = gs_note_error(gs_error_Fatal);
+    }
+    /* The next job may not write to this job's output file. */
+    for (i = 0; i < argc; i++) {
+        const char *fname = NULL;
+
+        if (!strncmp(argv[i], "-o", 2))
+            fname = argv[i] + 2;
+        else if (!strncmp(argv[i], "-sOutputFile=", 13))
+            fname = argv[i] + 13;
+        if (fname != NULL && *fname != 0)
+            (void)gs_remove_outputfile_control_path(minst->heap, fname);
+    }
+
+out:
+    gs_free_object(minst->heap, names, "run_server_job");
+    for (i = 0; i < argc; i++)
+        arg_free(argv[i], minst->heap);
+    if (code == gs_error_Quit || code == gs_error_Fatal ||
+        code == gs_error_InterpreterExit || code == gs_error_VMerror)
+        return code;
+    return 0;
+}
+
+static int
+run_server(gs_main_instance *minst, const char *jobs)
+{
+    gp_file *in = NULL;
+    char *line = NULL;
+    const char *p;
+    int len, code, job = 0;
+    bool ok;
+    i_ctx_t *i_ctx_p;
+    ref *pprocs = &minst->server_procs;
+    gs_gc_root_t procs_root, *r = &procs_root;
+
+    /* gs_main_init2aux hands us the procedures that run the jobs only
+     * when it finishes the initialisation. */
+    if (minst->init_done >= 2) {
+        outprintf(minst->heap, "   --server must come before any file to run.\n");
+        return_error(gs_error_Fatal);
+    }
+    code = gs_main_init1(minst);
+    if (code < 0)
+        return code;
+    i_ctx_p = minst->i_ctx_p;
+    make_null(pprocs);
+    code = gs_register_ref_root(imemory_system, &r, (void **)&pprocs, "run_server");
+    if (code < 0)
+        return code;
+    code = gs_main_init2(minst);
+    if (code < 0)
+        goto out;
+    if (jobs != NULL && strcmp(jobs, "-")) {
+        code = gs_add_control_path(minst->heap, gs_permit_file_reading, jobs);
+        if (code < 0)
+            goto out;
+        in = gp_fopen(minst->heap, jobs, gp_fmode_rb);
+        code = gs_remove_control_path(minst->heap, gs_permit_file_reading, jobs);
+        if (in == NULL) {
+            outprintf(minst->heap, "Unable to open %s for reading\n", jobs);
+            code = gs_note_error(gs_error_invalidfileaccess);
+            goto out;
+        }
+    }
+    line = (char *)gs_alloc_bytes(minst->heap, MAX_SERVER_JOB, "run_server");
+    if (line == NULL) {
+        code = gs_note_error(gs_error_VMerror);
+        goto out;
+    }
+    while ((len = server_read_job(minst, in, line, MAX_SERVER_JOB)) >= 0) {
+        if (len >= MAX_SERVER_JOB) {
+            outprintf(minst->heap, "   Server job longer than %d bytes.\n", MAX_SERVER_JOB - 1);
+            ok = false;
+        } else {
+            for (p = line; isspace((byte)*p); p++)
+                ;
+            if (*p == 0 || *p == '%')
+                continue;       /* blank lines and comments aren't jobs */
+            code = run_server_job(minst, p, &ok);
+            if (code < 0)
+                break;
+        }
+        outprintf(minst->heap, "%%%%[ Job: %d; Status: %s ]%%%%\n",
+                  ++job, ok ? "ok" : "failed");
+    }
+
+out:
+    gs_free_object(minst->heap, line, "run_server");
+    if (in != NULL)
+        gp_fclose(in);
+    i_ctx_p = minst->i_ctx_p;
+    gs_unregister_root(imemory_system, &procs_root, "run_server");
+    make_null(pprocs);
+    return code;
+}
 static int
 runarg(gs_main_instance *minst,
        const char       *pre,
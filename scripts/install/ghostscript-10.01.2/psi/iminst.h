@@ -84,6 +84,8 @@ struct gs_main_instance_s {
     i_ctx_t *i_ctx_p;		/* current interpreter context state */
     char *saved_pages_initial_arg;	/* used to defer processing of --saved-pages=begin... */
     bool saved_pages_test_mode;	/* for regression testing of saved-pages */
+    ref server_procs;		/* .serverjobdict, if run_server asked for */
+                                /* it by making this null (see imainarg.c) */
 
     /* Used for gsapi_set_params in the gs (not gpdl) case. */
     gs_c_param_list *param_list;
@@ -1807,7 +1807,7 @@ $(PSOBJ)zncdummy.$(OBJ) : $(PSSRC)zncdummy.c $(OP) $(GX) $(math_h)\
 zpdfops_=$(PSOBJ)zpdfops.$(OBJ)
 $(PSD)pdfops.dev : $(ECHOGS_XE) $(zpdfops_) $(INT_MAK) $(MAKEDIRS)
 	$(SETMOD) $(PSD)pdfops $(zpdfops_)
-	$(ADDMOD) $(PSD)pdfops -oper zpdfops
+	$(ADDMOD) $(PSD)pdfops -oper zpdfops zpdfops_ext
 
 $(PSOBJ)zpdfops.$(OBJ) : $(PSSRC)zpdfops.c $(OP) $(MAKEFILE)\
  $(ghost_h) $(gsmchunk_h) $(oper_h) \
@@ -1883,7 +1883,7 @@ $(PSOBJ)imainarg.$(OBJ) : $(PSSRC)imainarg.c $(GH)\
  $(gsargs_h) $(gscdefs_h) $(gsdevice_h) $(gsmalloc_h) $(gsmdebug_h)\
  $(gspaint_h) $(gxclpage_h) $(gdevprn_h) $(gxdevice_h) $(gxdevmem_h)\
  $(ierrors_h) $(estack_h) $(files_h)\
- $(iapi_h) $(ialloc_h) $(iconf_h) $(imain_h) $(imainarg_h) $(iminst_h)\
+ $(iapi_h) $(ialloc_h) $(iconf_h) $(idict_h) $(imain_h) $(imainarg_h) $(iminst_h)\
  $(iname_h) $(interp_h) $(iscan_h) $(iutil_h) $(ivmspace_h)\
  $(ostack_h) $(sfilter_h) $(store_h) $(stream_h) $(strimpl_h) \
  $(vdtrace_h) $(INT_MAK) $(MAKEDIRS)
@@ -1171,6 +1171,78 @@ static int zPDFdrawpage(i_ctx_t *i_ctx_p)
     return code;
 }
 
+/* <pdfctx> .PDFStartPageWorkers -
+ * Starts the extra processes for -dPDFPageWorkers, before the loop over the pages.
+ * These three operators do nothing if the interpreter failed to initialise
+ * and the context is null.
+ */
+static int zPDFstartpageworkers(i_ctx_t *i_ctx_p)
+{
+    os_ptr op = osp;
+    int code;
+    pdfctx_t *pdfctx;
+
+    check_op(1);
+    if (r_has_type(op, t_null)) {
+        pop(1);
+        return 0;
+    }
+    check_type(*op, t_pdfctx);
+    pdfctx = r_ptr(op, pdfctx_t);
+
+    code = pdfi_start_page_workers(pdfctx->ctx, gs_currentdevice(igs));
+    if (code < 0)
+        return code;
+    pop(1);
+    return 0;
+}
+
+/* <pdfctx> .PDFPageWorkerSelected <bool>
+ * Called for each page in the loop, returns true if this process should render it.
+ */
+static int zPDFpageworkerselected(i_ctx_t *i_ctx_p)
+{
+    os_ptr op = osp;
+    pdfctx_t *pdfctx;
+
+    check_op(1);
+    if (r_has_type(op, t_null)) {
+        make_true(op);
+        return 0;
+    }
+    check_type(*op, t_pdfctx);
+    pdfctx = r_ptr(op, pdfctx_t);
+
+    make_bool(op, pdfi_page_worker_selected(pdfctx->ctx, gs_currentdevice(igs)));
+    return 0;
+}
+
+/* <pdfctx> <bool> .PDFEndPageWorkers -
+ * Called after the loop over the pages, with true if the loop failed. The
+ * extra processes end here, the original waits for them to finish.
+ */
+static int zPDFendpageworkers(i_ctx_t *i_ctx_p)
+{
+    os_ptr op = osp;
+    int code;
+    pdfctx_t *pdfctx;
+
+    check_op(2);
+    check_type(*op, t_boolean);
+    if (r_has_type(op - 1, t_null)) {
+        pop(2);
+        return 0;
+    }
+    check_type(*(op - 1), t_pdfctx);
+    pdfctx = r_ptr(op - 1, pdfctx_t);
+
+    code = pdfi_end_page_workers(pdfctx->ctx, gs_currentdevice(igs), op->value.boolval ? -1 : 0);
+    if (code < 0)
+        return code;
+    pop(2);
+    return 0;
+}
+
 static int zPDFdrawannots(i_ctx_t *i_ctx_p)
 {
 #if 0
@@ -1524,6 +1596,29 @@ static int zPDFInit(i_ctx_t *i_ctx_p)
                 goto error;
             pdfctx->ctx->args.nonativefontmap = pvalueref->value.boolval;
         }
+        if (dict_find_string(pdictref, "PDFObjectCacheSize", &pvalueref) > 0) {
+            if (!r_has_type(pvalueref, t_integer))
+                goto error;
+            if (pvalueref->value.intval < 0 || pvalueref->value.intval > max_int) {
+                code = gs_note_error(gs_error_rangecheck);
+                goto error;
+            }
+            pdfctx->ctx->args.object_cache_size = pvalueref->value.intval;
+        }
+        if (dict_find_string(pdictref, "PDFPageWorkers", &pvalueref) > 0) {
+            if (!r_has_type(pvalueref, t_integer))
+                goto error;
+            if (pvalueref->value.intval < 0 || pvalueref->value.intval > max_int) {
+                code = gs_note_error(gs_error_rangecheck);
+                goto error;
+            }
+            pdfctx->ctx->args.page_workers = pvalueref->value.intval;
+        }
+        if (dict_find_string(pdictref, "PDFReduceImages", &pvalueref) > 0) {
+            if (!r_has_type(pvalueref, t_boolean))
+                goto error;
+            pdfctx->ctx->args.reduceimages = pvalueref->value.boolval;
+        }
         if (dict_find_string(pdictref, "PageCount", &pvalueref) > 0) {
             if (!r_has_type(pvalueref, t_integer))
                 goto error;
@@ -1646,6 +1741,21 @@ static int zPDFdrawannots(i_ctx_t *i_ctx_p)
     return_error(gs_error_undefined);
 }
 
+static int zPDFstartpageworkers(i_ctx_t *i_ctx_p)
+{
+    return_error(gs_error_undefined);
+}
+
+static int zPDFpageworkerselected(i_ctx_t *i_ctx_p)
+{
+    return_error(gs_error_undefined);
+}
+
+static int zPDFendpageworkers(i_ctx_t *i_ctx_p)
+{
+    return_error(gs_error_undefined);
+}
+
 static int zPDFInit(i_ctx_t *i_ctx_p)
 {
     return_error(gs_error_undefined);
@@ -1694,3 +1804,11 @@ const op_def zpdfops_op_defs[] =
 #endif
     op_def_end(0)
 };
+
+const op_def zpdfops_ext_op_defs[] =
+{
+    {"1.PDFStartPageWorkers", zPDFstartpageworkers},
+    {"1.PDFPageWorkerSelected", zPDFpageworkerselected},
+    {"2.PDFEndPageWorkers", zPDFendpageworkers},
+    op_def_end(0)
+};
@@ -183,6 +183,30 @@ current_CurFontCache(i_ctx_t *i_ctx_p)
     gs_cachestatus(ifont_dir, cstat);
     return cstat[0];
 }
+static long
+current_FontCacheHits(i_ctx_t *i_ctx_p)
+{
+    long cstat[3];
+
+    gs_cachestats(ifont_dir, cstat);
+    return cstat[0];
+}
+static long
+current_FontCacheMisses(i_ctx_t *i_ctx_p)
+{
+    long cstat[3];
+
+    gs_cachestats(ifont_dir, cstat);
+    return cstat[1];
+}
+static long
+current_FontCacheOversize(i_ctx_t *i_ctx_p)
+{
+    long cstat[3];
+
+    gs_cachestats(ifont_dir, cstat);
+    return cstat[2];
+}
 
 /* Even though size_t is unsigned, PostScript limits this to signed range */
 static size_t
@@ -242,6 +266,9 @@ static const long_param_def_t system_long_params[] =
     {"BuildTime", min_long, max_long, current_BuildTime, NULL},
     {"MaxFontCache", 0, MAX_UINT_PARAM, current_MaxFontCache, set_MaxFontCache},
     {"CurFontCache", 0, MAX_UINT_PARAM, current_CurFontCache, NULL},
+    {"FontCacheHits", 0, max_long, current_FontCacheHits, NULL},
+    {"FontCacheMisses", 0, max_long, current_FontCacheMisses, NULL},
+    {"FontCacheOversize", 0, max_long, current_FontCacheOversize, NULL},
     {"Revision", min_long, max_long, current_Revision, NULL},
     {"PageCount", min_long, max_long, current_PageCount, NULL}
 };
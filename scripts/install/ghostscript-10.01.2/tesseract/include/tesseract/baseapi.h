@@ -55,8 +55,10 @@ class PageIterator;
 class LTRResultIterator;
 class ResultIterator;
 class MutableIterator;
+class PageArena;
 class TessResultRenderer;
 class Tesseract;
+class ThreadPool;
 
 // Function to read a std::vector<char> from a whole file.
 // Returns false on failure.
@@ -327,6 +329,15 @@ class TESS_API TessBaseAPI {
    */
   void SetImage(Pix* pix);
 
+  /**
+   * As SetImage, but Tesseract keeps a reference to pix rather than its own
+   * copy when pix is already binary, 8 bit grey or 32 bit color, with no
+   * colormap. This saves copying what may be a very large page image, but
+   * the pixels must not change or go away until after Clear, End or the
+   * next SetImage.
+   */
+  void SetImageBorrowed(Pix* pix);
+
   /**
    * Set the resolution of the source image in pixels per inch so font size
    * information can be calculated in results.  Call this after SetImage().
@@ -674,9 +685,10 @@ class TESS_API TessBaseAPI {
   /**
    * Clear any library-level memory caches.
    * There are a variety of expensive-to-load constant data structures (mostly
-   * language dictionaries) that are cached globally -- surviving the Init()
-   * and End() of individual TessBaseAPI's.  This function allows the clearing
-   * of these caches.
+   * language dictionaries and LSTM networks) that are cached globally --
+   * surviving the Init() and End() of individual TessBaseAPI's, and shared
+   * read-only by all those that use the same language data. This function
+   * allows the clearing of these caches.
    **/
   static void ClearPersistentCache();
 
@@ -753,6 +765,12 @@ class TESS_API TessBaseAPI {
   /** Delete the pageres and block list ready for a new page. */
   void ClearResults();
 
+  /**
+   * Return the arena for the objects of the page, making it if the
+   * tessedit_page_arena parameters ask for one, or nullptr if they don't.
+   */
+  PageArena* GetPageArena();
+
   /**
    * Return an LTR Result Iterator -- used only for training, as we really want
    * to ignore all BiDi smarts at that point.
@@ -779,6 +797,8 @@ class TESS_API TessBaseAPI {
   Tesseract* tesseract_;           ///< The underlying data object.
   Tesseract* osd_tesseract_;       ///< For orientation & script detection.
   EquationDetect* equ_detect_;     ///< The equation detector.
+  ThreadPool* thread_pool_;        ///< Threads for parallel recognition.
+  PageArena* page_arena_;          ///< Memory for the objects of the page.
   FileReader reader_;              ///< Reads files from any filesystem.
   ImageThresholder* thresholder_;  ///< Image thresholding module.
   std::vector<ParagraphModel*>* paragraph_models_;
@@ -113,6 +113,12 @@ class TESS_API ImageThresholder {
   /// finished with it.
   void SetImage(const Pix* pix);
 
+  /// As SetImage, but if pix is already binary, 8 bit grey or 32 bit color
+  /// with no colormap, the Thresholder keeps a clone of it rather than a
+  /// copy. The caller must not change or destroy the pixels until after
+  /// Clear or the next SetImage.
+  void SetImageBorrowed(Pix* pix);
+
   /// Threshold the source image as efficiently as possible to the output Pix.
   /// Creates a Pix and sets pix to point to the resulting pointer.
   /// Caller must use pixDestroy to free the created Pix.
@@ -148,6 +154,9 @@ class TESS_API ImageThresholder {
   /// Common initialization shared between SetImage methods.
   virtual void Init();
 
+  /// Sets up the image description from pix_, for the SetImage methods.
+  void SetImageCommon();
+
   /// Return true if we are processing the full image.
   bool IsFullImage() const {
     return rect_left_ == 0 && rect_top_ == 0 && rect_width_ == image_width_ &&
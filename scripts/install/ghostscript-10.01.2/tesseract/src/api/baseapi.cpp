@@ -43,11 +43,13 @@
 #include "intfx.h"             // for INT_FX_RESULT_STRUCT
 #endif
 #include "mutableiterator.h"   // for MutableIterator
+#include "networkcache.h"      // for NetworkCache
 #include "normalis.h"          // for kBlnBaselineOffset, kBlnXHeight
 #if defined(USE_OPENCL)
 #include "openclwrapper.h"     // for OpenclDevice
 #endif
 #include "pageres.h"           // for PAGE_RES_IT, WERD_RES, PAGE_RES, CR_DE...
+#include "pagearena.h"         // for PageArena
 #include "paragraphs.h"        // for DetectParagraphs
 #include "params.h"            // for BoolParam, IntParam, DoubleParam, Stri...
 #include "pdblock.h"           // for PDBLK
@@ -57,6 +59,7 @@
 #include "stepblob.h"          // for C_BLOB_IT, C_BLOB, C_BLOB_LIST
 #include "tessdatamanager.h"   // for TessdataManager, kTrainedDataSuffix
 #include "tesseractclass.h"    // for Tesseract
+#include "threadpool.h"        // for ThreadPool
 #include "tprintf.h"           // for tprintf
 #include "werd.h"              // for WERD, WERD_IT, W_FUZZY_NON, W_FUZZY_SP
 
@@ -190,6 +193,8 @@ TessBaseAPI::TessBaseAPI()
     : tesseract_(nullptr),
       osd_tesseract_(nullptr),
       equ_detect_(nullptr),
+      thread_pool_(nullptr),
+      page_arena_(nullptr),
       reader_(nullptr),
       // Thresholder is initialized to nullptr here, but will be set before use by:
       // A constructor of a derived API,  SetThresholder(), or
@@ -596,6 +601,18 @@ void TessBaseAPI::SetImage(Pix* pix) {
   }
 }
 
+void TessBaseAPI::SetImageBorrowed(Pix* pix) {
+  if (pixGetSpp(pix) == 4 && pixGetInputFormat(pix) == IFF_PNG) {
+    // The alpha channel has to be removed, so we need our own copy anyway.
+    SetImage(pix);
+    return;
+  }
+  if (InternalSetImage()) {
+    thresholder_->SetImageBorrowed(pix);
+    SetInputImage(thresholder_->GetPixRect());
+  }
+}
+
 /**
  * Restrict recognition to a sub-rectangle of the image. Call after SetImage.
  * Each SetRectangle clears the recogntion results so multiple rectangles
@@ -818,6 +835,7 @@ int TessBaseAPI::Recognize(ETEXT_DESC* monitor) {
     return -1;
   if (FindLines() != 0)
     return -1;
+  PageArena::Scope arena_scope(GetPageArena(), PageArena::kRecognize);
   delete page_res_;
   if (block_list_->empty()) {
     page_res_ = new PAGE_RES(false, block_list_,
@@ -826,6 +844,16 @@ int TessBaseAPI::Recognize(ETEXT_DESC* monitor) {
   }
 
   tesseract_->SetBlackAndWhitelist();
+  // The threads are kept between pages, as long as the count is unchanged.
+  int num_threads = tesseract_->tessedit_num_threads;
+  if (thread_pool_ != nullptr && thread_pool_->num_threads() != num_threads) {
+    delete thread_pool_;
+    thread_pool_ = nullptr;
+  }
+  if (thread_pool_ == nullptr && num_threads > 1) {
+    thread_pool_ = new ThreadPool(num_threads);
+  }
+  tesseract_->set_thread_pool(thread_pool_);
   recognition_done_ = true;
 #ifndef DISABLED_LEGACY_ENGINE
   if (tesseract_->tessedit_resegment_from_line_boxes) {
@@ -1312,6 +1340,7 @@ char* TessBaseAPI::GetUTF8Text() {
   if (tesseract_ == nullptr ||
       (!recognition_done_ && Recognize(nullptr) < 0))
     return nullptr;
+  PageArena::Scope arena_scope(GetPageArena(), PageArena::kOutput);
   std::string text("");
   ResultIterator *it = GetIterator();
   do {
@@ -1854,6 +1883,10 @@ void TessBaseAPI::End() {
   osd_tesseract_ = nullptr;
   delete equ_detect_;
   equ_detect_ = nullptr;
+  delete thread_pool_;
+  thread_pool_ = nullptr;
+  delete page_arena_;
+  page_arena_ = nullptr;
   input_file_.clear();
   output_file_.clear();
   datapath_.clear();
@@ -1867,6 +1900,7 @@ void TessBaseAPI::End() {
 // of these caches.
 void TessBaseAPI::ClearPersistentCache() {
   Dict::GlobalDawgCache()->DeleteUnusedDawgs();
+  NetworkCache::GlobalNetworkCache()->DeleteUnusedNetworks();
 }
 
 /**
@@ -2032,6 +2066,7 @@ int TessBaseAPI::FindLines() {
     tesseract_->InitAdaptiveClassifier(nullptr);
   #endif
   }
+  PageArena::Scope arena_scope(GetPageArena(), PageArena::kLayout);
   if (tesseract_->pix_binary() == nullptr &&
       !Threshold(tesseract_->mutable_pix_binary())) {
     return -1;
@@ -2110,6 +2145,28 @@ void TessBaseAPI::ClearResults() {
     delete paragraph_models_;
     paragraph_models_ = nullptr;
   }
+  if (page_arena_ != nullptr) {
+    if (tesseract_ != nullptr && tesseract_->tessedit_page_arena_stats) {
+      page_arena_->PrintStats();
+    }
+    page_arena_->Reset();
+  }
+}
+
+PageArena* TessBaseAPI::GetPageArena() {
+  if (tesseract_ == nullptr) {
+    return nullptr;
+  }
+  bool bump = tesseract_->tessedit_page_arena;
+  if (!bump && !tesseract_->tessedit_page_arena_stats) {
+    return nullptr;
+  }
+  if (page_arena_ == nullptr) {
+    page_arena_ = new PageArena(bump);
+  } else {
+    page_arena_->set_bump(bump);
+  }
+  return page_arena_;
 }
 
 /**
@@ -25,6 +25,7 @@
 # include "host.h"    // windows.h for MultiByteToWideChar, ...
 #endif
 #include <tesseract/renderer.h>
+#include "pagearena.h"       // for PageArena
 #include "tesseractclass.h"  // for Tesseract
 
 namespace tesseract {
@@ -132,6 +133,7 @@ char* TessBaseAPI::GetHOCRText(int page_number) {
 char* TessBaseAPI::GetHOCRText(ETEXT_DESC* monitor, int page_number) {
   if (tesseract_ == nullptr || (page_res_ == nullptr && Recognize(monitor) < 0))
     return nullptr;
+  PageArena::Scope arena_scope(GetPageArena(), PageArena::kOutput);
 
   int lcnt = 1, bcnt = 1, pcnt = 1, wcnt = 1, scnt = 1, tcnt = 1, ccnt = 1;
   int page_id = page_number + 1;  // hOCR uses 1-based page numbers.
@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////
+// File:        activation.h
+// Description: Lookup-table activation functions and their SIMD versions.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_ARCH_ACTIVATION_H_
+#define TESSERACT_ARCH_ACTIVATION_H_
+
+namespace tesseract {
+
+// Size of static tables.
+constexpr int kTableSize = 4096;
+// Scale factor for float arg to int index.
+constexpr double kScaleFactor = 256.0;
+
+// Generated lookup tables, in lstm/functions.cpp.
+extern const double TanhTable[];
+extern const double LogisticTable[];
+
+// Non-linearity (sigmoid) functions with cache tables and clipping.
+inline double Tanh(double x) {
+  if (x < 0.0) return -Tanh(-x);
+  x *= kScaleFactor;
+  if (x >= kTableSize - 1) return 1.0;
+  unsigned index = static_cast<unsigned>(x);
+  double tanh_i0 = TanhTable[index];
+  double tanh_i1 = TanhTable[index + 1];
+  // Linear interpolation.
+  return tanh_i0 + (tanh_i1 - tanh_i0) * (x - index);
+}
+
+inline double Logistic(double x) {
+  if (x < 0.0) return 1.0 - Logistic(-x);
+  x *= kScaleFactor;
+  if (x >= kTableSize - 1) return 1.0;
+  unsigned index = static_cast<unsigned>(x);
+  double l0 = LogisticTable[index];
+  double l1 = LogisticTable[index + 1];
+  // Linear interpolation.
+  return l0 + (l1 - l0) * (x - index);
+}
+
+// Each of the following applies Tanh or Logistic in place to the n-vector
+// inout, with results identical to the scalar functions above, so they can
+// be exchanged freely, even in training.
+
+// Uses Intel AVX2 gathers from the lookup tables, 4 values at a time.
+void TanhAVX2(int n, double* inout);
+void LogisticAVX2(int n, double* inout);
+
+// Uses Intel AVX512F gathers from the lookup tables, 8 values at a time.
+void TanhAVX512F(int n, double* inout);
+void LogisticAVX512F(int n, double* inout);
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_ARCH_ACTIVATION_H_
@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////
+// File:        activationavx2.cpp
+// Description: Architecture-specific activation functions.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+#include "activation.h"
+
+namespace tesseract {
+
+// Applies the table lookup of Tanh (if kOdd) or Logistic to the 4 values at
+// inout, following the scalar code step by step: negative inputs are
+// reflected, the scaled value is split into an index and a fraction, and the
+// two table entries are interpolated in the same order, so the results are
+// identical.
+// Note that this file is compiled without FMA, so the multiply and add of the
+// interpolation are separately rounded, as they are in the scalar code.
+template <bool kOdd>
+static inline void TableLookup4(const double* table, double* inout) {
+  const __m256d sign_bit = _mm256_set1_pd(-0.0);
+  const __m256d one = _mm256_set1_pd(1.0);
+  __m256d x = _mm256_loadu_pd(inout);
+  __m256d negative = _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_LT_OQ);
+  x = _mm256_andnot_pd(sign_bit, x);
+  x = _mm256_mul_pd(x, _mm256_set1_pd(kScaleFactor));
+  __m256d saturated =
+      _mm256_cmp_pd(x, _mm256_set1_pd(kTableSize - 1), _CMP_GE_OQ);
+  // Clamping keeps the gathers in bounds for saturated and NaN inputs, as
+  // min returns its second operand if the first is NaN.
+  __m128i index =
+      _mm256_cvttpd_epi32(_mm256_min_pd(x, _mm256_set1_pd(kTableSize - 2)));
+  __m256d i0 = _mm256_i32gather_pd(table, index, sizeof(double));
+  __m256d i1 = _mm256_i32gather_pd(table + 1, index, sizeof(double));
+  __m256d fraction = _mm256_sub_pd(x, _mm256_cvtepi32_pd(index));
+  __m256d result =
+      _mm256_add_pd(i0, _mm256_mul_pd(_mm256_sub_pd(i1, i0), fraction));
+  result = _mm256_blendv_pd(result, one, saturated);
+  if (kOdd) {
+    // -Tanh(-x).
+    result = _mm256_xor_pd(result, _mm256_and_pd(negative, sign_bit));
+  } else {
+    // 1 - Logistic(-x).
+    result = _mm256_blendv_pd(result, _mm256_sub_pd(one, result), negative);
+  }
+  _mm256_storeu_pd(inout, result);
+}
+
+// Applies TableLookup4 to the n-vector inout.
+// The tail goes through a padded copy, rather than the inline scalar
+// functions, which must not be compiled for AVX2 here, in case the linker
+// picks this copy for the callers that run on any CPU.
+template <bool kOdd>
+static void TableLookupAVX2(const double* table, int n, double* inout) {
+  int offset = 0;
+  for (; offset + 4 <= n; offset += 4) {
+    TableLookup4<kOdd>(table, inout + offset);
+  }
+  if (offset < n) {
+    double tail[4] = {0.0, 0.0, 0.0, 0.0};
+    for (int i = offset; i < n; ++i) tail[i - offset] = inout[i];
+    TableLookup4<kOdd>(table, tail);
+    for (int i = offset; i < n; ++i) inout[i] = tail[i - offset];
+  }
+}
+
+void TanhAVX2(int n, double* inout) {
+  TableLookupAVX2<true>(TanhTable, n, inout);
+}
+
+void LogisticAVX2(int n, double* inout) {
+  TableLookupAVX2<false>(LogisticTable, n, inout);
+}
+
+}  // namespace tesseract.
+
+#endif
@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////
+// File:        activationavx512.cpp
+// Description: Architecture-specific activation functions.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#if defined(__AVX512F__)
+
+#include <immintrin.h>
+#include <cstdint>
+#include "activation.h"
+
+namespace tesseract {
+
+// AVX512F implies FMA, so the compiler is free to contract a plain multiply
+// and add into a single rounding, which would make the results differ from
+// the scalar code. The explicit rounding versions of the arithmetic are never
+// contracted.
+#define ROUNDING _MM_FROUND_CUR_DIRECTION
+
+// Applies the table lookup of Tanh (if kOdd) or Logistic to the values at
+// inout selected by mask, following the scalar code step by step: negative
+// inputs are reflected, the scaled value is split into an index and a
+// fraction, and the two table entries are interpolated in the same order,
+// so the results are identical.
+template <bool kOdd>
+static inline void TableLookup8(const double* table, __mmask8 mask,
+                                double* inout) {
+  const __m512i sign_bit = _mm512_set1_epi64(INT64_MIN);
+  const __m512d one = _mm512_set1_pd(1.0);
+  __m512d x = _mm512_maskz_loadu_pd(mask, inout);
+  __mmask8 negative = _mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_LT_OQ);
+  x = _mm512_castsi512_pd(
+      _mm512_andnot_si512(sign_bit, _mm512_castpd_si512(x)));
+  x = _mm512_mul_round_pd(x, _mm512_set1_pd(kScaleFactor), ROUNDING);
+  __mmask8 saturated =
+      _mm512_cmp_pd_mask(x, _mm512_set1_pd(kTableSize - 1), _CMP_GE_OQ);
+  // Clamping keeps the gathers in bounds for saturated and NaN inputs, as
+  // min returns its second operand if the first is NaN.
+  __m256i index =
+      _mm512_cvttpd_epi32(_mm512_min_pd(x, _mm512_set1_pd(kTableSize - 2)));
+  __m512d i0 = _mm512_i32gather_pd(index, table, sizeof(double));
+  __m512d i1 = _mm512_i32gather_pd(index, table + 1, sizeof(double));
+  __m512d fraction =
+      _mm512_sub_round_pd(x, _mm512_cvtepi32_pd(index), ROUNDING);
+  __m512d result = _mm512_add_round_pd(
+      i0,
+      _mm512_mul_round_pd(_mm512_sub_round_pd(i1, i0, ROUNDING), fraction,
+                          ROUNDING),
+      ROUNDING);
+  result = _mm512_mask_mov_pd(result, saturated, one);
+  if (kOdd) {
+    // -Tanh(-x).
+    __m512i bits = _mm512_castpd_si512(result);
+    result = _mm512_castsi512_pd(
+        _mm512_mask_xor_epi64(bits, negative, bits, sign_bit));
+  } else {
+    // 1 - Logistic(-x).
+    result = _mm512_mask_sub_round_pd(result, negative, one, result, ROUNDING);
+  }
+  _mm512_mask_storeu_pd(inout, mask, result);
+}
+
+// Applies TableLookup8 to the n-vector inout, with a masked final step.
+template <bool kOdd>
+static void TableLookupAVX512F(const double* table, int n, double* inout) {
+  int offset = 0;
+  for (; offset + 8 <= n; offset += 8) {
+    TableLookup8<kOdd>(table, 0xff, inout + offset);
+  }
+  if (offset < n) {
+    TableLookup8<kOdd>(table, (1u << (n - offset)) - 1, inout + offset);
+  }
+}
+
+void TanhAVX512F(int n, double* inout) {
+  TableLookupAVX512F<true>(TanhTable, n, inout);
+}
+
+void LogisticAVX512F(int n, double* inout) {
+  TableLookupAVX512F<false>(LogisticTable, n, inout);
+}
+
+#undef ROUNDING
+
+}  // namespace tesseract.
+
+#endif
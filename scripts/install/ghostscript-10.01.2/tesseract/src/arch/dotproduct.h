@@ -25,6 +25,9 @@ double DotProductNative(const double* u, const double* v, int n);
 // Uses Intel AVX intrinsics to access the SIMD instruction set.
 double DotProductAVX(const double* u, const double* v, int n);
 
+// Uses Intel AVX512F intrinsics to access the SIMD instruction set.
+double DotProductAVX512F(const double* u, const double* v, int n);
+
 // Use Intel FMA.
 double DotProductFMA(const double* u, const double* v, int n);
 
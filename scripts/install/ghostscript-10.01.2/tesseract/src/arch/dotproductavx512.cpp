@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////
+// File:        dotproductavx512.cpp
+// Description: Architecture-specific dot-product function.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#if defined(__AVX512F__)
+
+#include <immintrin.h>
+#include <cstdint>
+#include "dotproduct.h"
+
+namespace tesseract {
+
+// Computes and returns the dot product of the n-vectors u and v.
+// Uses Intel AVX512F intrinsics to access the SIMD instruction set.
+double DotProductAVX512F(const double* u, const double* v, int n) {
+  const unsigned quot = n / 16;
+  const unsigned rem = n % 16;
+  __m512d t0 = _mm512_setzero_pd();
+  __m512d t1 = _mm512_setzero_pd();
+  for (unsigned k = 0; k < quot; k++) {
+    __m512d f0 = _mm512_loadu_pd(u);
+    __m512d f1 = _mm512_loadu_pd(v);
+    t0 = _mm512_fmadd_pd(f0, f1, t0);
+    u += 8;
+    v += 8;
+    __m512d f2 = _mm512_loadu_pd(u);
+    __m512d f3 = _mm512_loadu_pd(v);
+    t1 = _mm512_fmadd_pd(f2, f3, t1);
+    u += 8;
+    v += 8;
+  }
+  t0 = _mm512_add_pd(t0, t1);
+  alignas(64) double tmp[8];
+  _mm512_store_pd(tmp, t0);
+  double result = tmp[0] + tmp[1] + tmp[2] + tmp[3] +
+                  tmp[4] + tmp[5] + tmp[6] + tmp[7];
+  for (unsigned k = 0; k < rem; k++) {
+    result += *u++ * *v++;
+  }
+  return result;
+}
+
+}  // namespace tesseract.
+
+#endif
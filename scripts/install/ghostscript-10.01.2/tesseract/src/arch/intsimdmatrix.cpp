@@ -16,6 +16,7 @@
 ///////////////////////////////////////////////////////////////////////
 
 #include "intsimdmatrix.h"
+#include <algorithm>            // for std::max, std::min
 #include "matrix.h"             // for GENERIC_2D_ARRAY
 #include "simddetect.h"         // for SIMDDetect
 
@@ -23,6 +24,10 @@ namespace tesseract {
 
 const IntSimdMatrix* IntSimdMatrix::intSimdMatrix = nullptr;
 
+// The size in bytes of the reshaped weights that MatrixDotVectors applies to
+// all its inputs in turn, small enough to stay in the L1 cache.
+constexpr int kMatrixBlockBytes = 16384;
+
 // Computes a reshaped copy of the weight matrix w.
 void IntSimdMatrix::Init(const GENERIC_2D_ARRAY<int8_t>& w,
                          std::vector<int8_t>& shaped_w,
@@ -90,4 +95,48 @@ void IntSimdMatrix::MatrixDotVector(const GENERIC_2D_ARRAY<int8_t>& w,
   }
 }
 
+// Computes v[r] = Wu[r] for each of the num_vectors inputs u[r].
+void IntSimdMatrix::MatrixDotVectors(const GENERIC_2D_ARRAY<int8_t>& w,
+                                     const std::vector<double>& scales,
+                                     int num_vectors, const int8_t* const* u,
+                                     double* const* v) {
+  int num_out = w.dim1();
+  int num_in = w.dim2() - 1;
+  for (int i = 0; i < num_out; ++i) {
+    const int8_t* wi = w[i];
+    for (int r = 0; r < num_vectors; ++r) {
+      const int8_t* ur = u[r];
+      int total = 0;
+      for (int j = 0; j < num_in; ++j) total += wi[j] * ur[j];
+      v[r][i] = (total + wi[num_in] * INT8_MAX) * scales[i];
+    }
+  }
+}
+
+// Computes v[r] = Wu[r] for each of the num_vectors inputs u[r], using the
+// weights reshaped by Init.
+void IntSimdMatrix::MatrixDotVectors(int dim1, int dim2,
+                                     const int8_t* shaped_w,
+                                     const double* scales, int num_vectors,
+                                     const int8_t* const* u,
+                                     double* const* v) const {
+  const int num_in = dim2 - 1;
+  // Init lays out the weights of each register set contiguously, so a block
+  // starting on a register set boundary is laid out as Init would for a
+  // matrix of just the outputs from there on, and can be passed to
+  // matrixDotVectorFunction as such.
+  const int set_size = num_outputs_per_register_ * max_output_registers_;
+  const int set_bytes = (Roundup(num_in, num_inputs_per_group_) + 1) * set_size;
+  const int block_size =
+      std::max(1, kMatrixBlockBytes / set_bytes) * set_size;
+  for (int output = 0; output < dim1; output += block_size) {
+    int block_outputs = std::min(block_size, dim1 - output);
+    const int8_t* wi = shaped_w + output / set_size * set_bytes;
+    for (int r = 0; r < num_vectors; ++r) {
+      matrixDotVectorFunction(block_outputs, dim2, wi, scales + output, u[r],
+                              v[r] + output);
+    }
+  }
+}
+
 }  // namespace tesseract
@@ -82,6 +82,13 @@ struct TESS_API IntSimdMatrix {
   static void MatrixDotVector(const GENERIC_2D_ARRAY<int8_t>& w,
                               const std::vector<double>& scales,
                               const int8_t* u, double* v);
+  // Computes v[r] = Wu[r] for each of the num_vectors inputs u[r], with the
+  // same results as MatrixDotVector of each in turn, but with each row of
+  // the weights used for all the inputs while it is in cache.
+  static void MatrixDotVectors(const GENERIC_2D_ARRAY<int8_t>& w,
+                               const std::vector<double>& scales,
+                               int num_vectors, const int8_t* const* u,
+                               double* const* v);
 
   // Rounds the input up to a multiple of the given factor.
   static int Roundup(int input, int factor) {
@@ -102,6 +109,18 @@ struct TESS_API IntSimdMatrix {
                                            double*);
   MatrixDotVectorFunction matrixDotVectorFunction;
 
+  // Computes v[r] = Wu[r] for each of the num_vectors inputs u[r], with the
+  // same results as matrixDotVectorFunction of each in turn. shaped_w is the
+  // weight matrix of size dim1 x dim2 as reshaped by Init. The weights are
+  // taken a block of whole register sets at a time, and each block is
+  // applied to all the inputs before the next, so the weights are fetched
+  // from memory once for all the inputs instead of once for each.
+  // The inputs must be padded as for matrixDotVectorFunction, and each v[r]
+  // must have room for RoundOutputs(dim1) results.
+  void MatrixDotVectors(int dim1, int dim2, const int8_t* shaped_w,
+                        const double* scales, int num_vectors,
+                        const int8_t* const* u, double* const* v) const;
+
   // Number of 32 bit outputs held in each register.
   int num_outputs_per_register_;
   // Maximum number of registers that we will use to hold outputs.
@@ -119,6 +138,9 @@ struct TESS_API IntSimdMatrix {
   // Only available with AVX2 / SSE.
   static const IntSimdMatrix intSimdMatrixAVX2;
   static const IntSimdMatrix intSimdMatrixSSE;
+  // Only available with AVX512 VNNI / AVX VNNI.
+  static const IntSimdMatrix intSimdMatrixAVX512VNNI;
+  static const IntSimdMatrix intSimdMatrixAVXVNNI;
 };
 
 }  // namespace tesseract
@@ -0,0 +1,321 @@
+///////////////////////////////////////////////////////////////////////
+// File:        intsimdmatrixavx512vnni.cpp
+// Description: matrix-vector product for 8-bit data on avx512 vnni.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+
+#include "intsimdmatrix.h"
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cstdint>
+
+namespace tesseract {
+
+// Number of outputs held in each register. 16 x 32 bit ints.
+constexpr int kNumOutputsPerRegister = 16;
+// Maximum number of registers that we will use.
+constexpr int kMaxOutputRegisters = 8;
+// Number of inputs in the inputs register. Each group of inputs is broadcast
+// straight from memory, so the inputs only need padding to a whole group.
+constexpr int kNumInputsPerRegister = 4;
+// Number of inputs in each weight group.
+constexpr int kNumInputsPerGroup = 4;
+
+// Functions to compute part of a matrix.vector multiplication. The weights
+// are in a very specific order (see above) in w, which is multiplied by
+// u of length num_in, to produce output v after scaling the integer results
+// by the corresponding member of scales.
+// The amount of w and scales consumed is fixed and not available to the
+// caller.
+// vpdpbusd multiplies unsigned bytes by signed bytes, so the inputs are made
+// unsigned by adding 128, and 128 * the sum of the weights (which is
+// accumulated alongside by multiplying the weights by ones) is subtracted
+// again at the end. Everything is exact in 32 bits, so the results are
+// identical to IntSimdMatrix::MatrixDotVector.
+
+// Computes one set of 4x16 products of inputs and weights, adding to result,
+// and adds the sums of the same 4x16 weights to weight_sum.
+// rep_input is assumed to be a 16x replicated set of 4x8-bit inputs, offset
+// to be unsigned.
+// Note: wi is incremented by the amount of data read.
+// This function must be inlined with references in order for the compiler to
+// correctly use the registers declared in the caller.
+static inline void MultiplyGroup(const __m512i& rep_input, const __m512i& ones,
+                                 const int8_t*& wi, __m512i& result,
+                                 __m512i& weight_sum) {
+  // Load a 4x16 block of weights.
+  __m512i weights = _mm512_loadu_si512(wi);
+  wi += kNumOutputsPerRegister * kNumInputsPerGroup;
+  // Multiply 64x8-bit inputs by 64x8-bit weights, adding groups of 4 to make
+  // 16x32-bit results.
+  result = _mm512_dpbusd_epi32(result, rep_input, weights);
+  weight_sum = _mm512_dpbusd_epi32(weight_sum, ones, weights);
+}
+
+// Removes the input offset from result, adds the biases, and writes the first
+// num_out (at most 16) scaled results to v. The scales and biases beyond
+// num_out are not read.
+// Note: wi, scales, num_out and v are all advanced past the 16 results.
+static inline void ExtractResults16(__m512i result, __m512i weight_sum,
+                                    const int8_t*& wi, const double*& scales,
+                                    int& num_out, double*& v) {
+  int count = std::max(std::min(num_out, kNumOutputsPerRegister), 0);
+  __mmask16 mask = static_cast<__mmask16>((1u << count) - 1);
+  __mmask8 mask_lo = static_cast<__mmask8>(mask);
+  __mmask8 mask_hi = static_cast<__mmask8>(mask >> 8);
+  // 16x8bit biases to 16x32bit.
+  __m512i bias = _mm512_maskz_cvtepi8_epi32(
+      mask, _mm_loadu_si128(reinterpret_cast<const __m128i*>(wi)));
+  // result - 128 * sum(weights) + bias * 127.
+  result = _mm512_sub_epi32(
+      result, _mm512_mullo_epi32(weight_sum, _mm512_set1_epi32(128)));
+  result = _mm512_add_epi32(
+      result, _mm512_mullo_epi32(bias, _mm512_set1_epi32(INT8_MAX)));
+  alignas(64) int32_t totals[kNumOutputsPerRegister];
+  _mm512_store_si512(totals, result);
+  __m512d res_lo = _mm512_maskz_cvtepi32_pd(
+      mask_lo, _mm256_load_si256(reinterpret_cast<const __m256i*>(totals)));
+  __m512d res_hi = _mm512_maskz_cvtepi32_pd(
+      mask_hi, _mm256_load_si256(reinterpret_cast<const __m256i*>(totals + 8)));
+  res_lo = _mm512_mul_pd(res_lo, _mm512_maskz_loadu_pd(mask_lo, scales));
+  res_hi = _mm512_mul_pd(res_hi, _mm512_maskz_loadu_pd(mask_hi, scales + 8));
+  _mm512_mask_storeu_pd(v, mask_lo, res_lo);
+  _mm512_mask_storeu_pd(v + 8, mask_hi, res_hi);
+  wi += kNumOutputsPerRegister;
+  scales += kNumOutputsPerRegister;
+  num_out -= kNumOutputsPerRegister;
+  v += kNumOutputsPerRegister;
+}
+
+// Computes part of matrix.vector v = Wu. Computes N=128 results, of which only
+// the first num_out are written to v.
+// The weights *must* be arranged so that consecutive reads from wi
+// provides (num_in/kNumInputsPerGroup groups of (N output dim groups of
+// (kNumInputsPerGroup inputs))). After that there must be N consecutive
+// bias weights, before continuing with any more weights.
+// u must be padded out with zeros to
+// kNumInputsPerGroup*ceil(num_in/kNumInputsPerGroup) elements.
+static void PartialMatrixDotVector128(const int8_t* wi, const double* scales,
+                                      const int8_t* u, int num_in, int num_out,
+                                      double* v) {
+  // Register of ones for summing the weights.
+  __m512i ones = _mm512_set1_epi8(1);
+  // Register to add 128 to the inputs.
+  __m512i offset = _mm512_set1_epi8(-128);
+  // Initialize all the results to 0.
+  __m512i result0 = _mm512_setzero_si512();
+  __m512i result1 = _mm512_setzero_si512();
+  __m512i result2 = _mm512_setzero_si512();
+  __m512i result3 = _mm512_setzero_si512();
+  __m512i result4 = _mm512_setzero_si512();
+  __m512i result5 = _mm512_setzero_si512();
+  __m512i result6 = _mm512_setzero_si512();
+  __m512i result7 = _mm512_setzero_si512();
+  __m512i weight_sum0 = _mm512_setzero_si512();
+  __m512i weight_sum1 = _mm512_setzero_si512();
+  __m512i weight_sum2 = _mm512_setzero_si512();
+  __m512i weight_sum3 = _mm512_setzero_si512();
+  __m512i weight_sum4 = _mm512_setzero_si512();
+  __m512i weight_sum5 = _mm512_setzero_si512();
+  __m512i weight_sum6 = _mm512_setzero_si512();
+  __m512i weight_sum7 = _mm512_setzero_si512();
+  // Iterate over the input (u), one group at a time.
+  for (int j = 0; j < num_in; j += kNumInputsPerGroup) {
+    // Replicate the 4 inputs 16 times.
+    __m512i rep_input =
+        _mm512_set1_epi32(*reinterpret_cast<const int32_t*>(u + j));
+    // Flip the sign bits to make them unsigned.
+    rep_input = _mm512_xor_si512(rep_input, offset);
+    // Mul-add, with horizontal add of the 4 inputs to each of the results.
+    MultiplyGroup(rep_input, ones, wi, result0, weight_sum0);
+    MultiplyGroup(rep_input, ones, wi, result1, weight_sum1);
+    MultiplyGroup(rep_input, ones, wi, result2, weight_sum2);
+    MultiplyGroup(rep_input, ones, wi, result3, weight_sum3);
+    MultiplyGroup(rep_input, ones, wi, result4, weight_sum4);
+    MultiplyGroup(rep_input, ones, wi, result5, weight_sum5);
+    MultiplyGroup(rep_input, ones, wi, result6, weight_sum6);
+    MultiplyGroup(rep_input, ones, wi, result7, weight_sum7);
+  }
+  ExtractResults16(result0, weight_sum0, wi, scales, num_out, v);
+  ExtractResults16(result1, weight_sum1, wi, scales, num_out, v);
+  ExtractResults16(result2, weight_sum2, wi, scales, num_out, v);
+  ExtractResults16(result3, weight_sum3, wi, scales, num_out, v);
+  ExtractResults16(result4, weight_sum4, wi, scales, num_out, v);
+  ExtractResults16(result5, weight_sum5, wi, scales, num_out, v);
+  ExtractResults16(result6, weight_sum6, wi, scales, num_out, v);
+  ExtractResults16(result7, weight_sum7, wi, scales, num_out, v);
+}
+
+// Computes part of matrix.vector v = Wu. Computes N=64 results.
+// For details see PartialMatrixDotVector128 with N=64.
+static void PartialMatrixDotVector64(const int8_t* wi, const double* scales,
+                                     const int8_t* u, int num_in, int num_out,
+                                     double* v) {
+  // Register of ones for summing the weights.
+  __m512i ones = _mm512_set1_epi8(1);
+  // Register to add 128 to the inputs.
+  __m512i offset = _mm512_set1_epi8(-128);
+  // Initialize all the results to 0.
+  __m512i result0 = _mm512_setzero_si512();
+  __m512i result1 = _mm512_setzero_si512();
+  __m512i result2 = _mm512_setzero_si512();
+  __m512i result3 = _mm512_setzero_si512();
+  __m512i weight_sum0 = _mm512_setzero_si512();
+  __m512i weight_sum1 = _mm512_setzero_si512();
+  __m512i weight_sum2 = _mm512_setzero_si512();
+  __m512i weight_sum3 = _mm512_setzero_si512();
+  // Iterate over the input (u), one group at a time.
+  for (int j = 0; j < num_in; j += kNumInputsPerGroup) {
+    // Replicate the 4 inputs 16 times.
+    __m512i rep_input =
+        _mm512_set1_epi32(*reinterpret_cast<const int32_t*>(u + j));
+    // Flip the sign bits to make them unsigned.
+    rep_input = _mm512_xor_si512(rep_input, offset);
+    // Mul-add, with horizontal add of the 4 inputs to each of the results.
+    MultiplyGroup(rep_input, ones, wi, result0, weight_sum0);
+    MultiplyGroup(rep_input, ones, wi, result1, weight_sum1);
+    MultiplyGroup(rep_input, ones, wi, result2, weight_sum2);
+    MultiplyGroup(rep_input, ones, wi, result3, weight_sum3);
+  }
+  ExtractResults16(result0, weight_sum0, wi, scales, num_out, v);
+  ExtractResults16(result1, weight_sum1, wi, scales, num_out, v);
+  ExtractResults16(result2, weight_sum2, wi, scales, num_out, v);
+  ExtractResults16(result3, weight_sum3, wi, scales, num_out, v);
+}
+
+// Computes part of matrix.vector v = Wu. Computes N=32 results.
+// For details see PartialMatrixDotVector128 with N=32.
+static void PartialMatrixDotVector32(const int8_t* wi, const double* scales,
+                                     const int8_t* u, int num_in, int num_out,
+                                     double* v) {
+  // Register of ones for summing the weights.
+  __m512i ones = _mm512_set1_epi8(1);
+  // Register to add 128 to the inputs.
+  __m512i offset = _mm512_set1_epi8(-128);
+  // Initialize all the results to 0.
+  __m512i result0 = _mm512_setzero_si512();
+  __m512i result1 = _mm512_setzero_si512();
+  __m512i weight_sum0 = _mm512_setzero_si512();
+  __m512i weight_sum1 = _mm512_setzero_si512();
+  // Iterate over the input (u), one group at a time.
+  for (int j = 0; j < num_in; j += kNumInputsPerGroup) {
+    // Replicate the 4 inputs 16 times.
+    __m512i rep_input =
+        _mm512_set1_epi32(*reinterpret_cast<const int32_t*>(u + j));
+    // Flip the sign bits to make them unsigned.
+    rep_input = _mm512_xor_si512(rep_input, offset);
+    // Mul-add, with horizontal add of the 4 inputs to each of the results.
+    MultiplyGroup(rep_input, ones, wi, result0, weight_sum0);
+    MultiplyGroup(rep_input, ones, wi, result1, weight_sum1);
+  }
+  ExtractResults16(result0, weight_sum0, wi, scales, num_out, v);
+  ExtractResults16(result1, weight_sum1, wi, scales, num_out, v);
+}
+
+// Computes part of matrix.vector v = Wu. Computes N=16 results.
+// For details see PartialMatrixDotVector128 with N=16.
+static void PartialMatrixDotVector16(const int8_t* wi, const double* scales,
+                                     const int8_t* u, int num_in, int num_out,
+                                     double* v) {
+  // Register of ones for summing the weights.
+  __m512i ones = _mm512_set1_epi8(1);
+  // Register to add 128 to the inputs.
+  __m512i offset = _mm512_set1_epi8(-128);
+  // Initialize all the results to 0.
+  __m512i result0 = _mm512_setzero_si512();
+  __m512i weight_sum0 = _mm512_setzero_si512();
+  // Iterate over the input (u), one group at a time.
+  for (int j = 0; j < num_in; j += kNumInputsPerGroup) {
+    // Replicate the 4 inputs 16 times.
+    __m512i rep_input =
+        _mm512_set1_epi32(*reinterpret_cast<const int32_t*>(u + j));
+    // Flip the sign bits to make them unsigned.
+    rep_input = _mm512_xor_si512(rep_input, offset);
+    // Mul-add, with horizontal add of the 4 inputs to each of the results.
+    MultiplyGroup(rep_input, ones, wi, result0, weight_sum0);
+  }
+  ExtractResults16(result0, weight_sum0, wi, scales, num_out, v);
+}
+
+static void matrixDotVector(int dim1, int dim2, const int8_t* wi,
+                            const double* scales, const int8_t* u, double* v) {
+  const int num_out = dim1;
+  const int num_in = dim2 - 1;
+  // Each call to a partial_func_ produces group_size outputs, except the
+  // last one, which can produce less.
+  const int rounded_num_in =
+    IntSimdMatrix::Roundup(num_in, kNumInputsPerGroup);
+  const int rounded_num_out =
+    IntSimdMatrix::Roundup(num_out, kNumOutputsPerRegister);
+  int group_size = kNumOutputsPerRegister * kMaxOutputRegisters;
+  int output = 0;
+
+  int w_step = (rounded_num_in + 1) * group_size;
+
+  // Run with this group size, until it would produce too much output, then
+  // switch to a smaller size.
+  for (; output + group_size <= rounded_num_out; output += group_size) {
+    PartialMatrixDotVector128(wi, scales, u, rounded_num_in,
+                             num_out - output, v);
+    wi += w_step;
+    scales += group_size;
+    v += group_size;
+  }
+  group_size /= 2;
+  w_step /= 2;
+
+  if (output + group_size <= rounded_num_out) {
+    PartialMatrixDotVector64(wi, scales, u, rounded_num_in,
+                             num_out - output, v);
+    wi += w_step;
+    scales += group_size;
+    v += group_size;
+    output += group_size;
+  }
+  group_size /= 2;
+  w_step /= 2;
+
+  if (output + group_size <= rounded_num_out) {
+    PartialMatrixDotVector32(wi, scales, u, rounded_num_in,
+                             num_out - output, v);
+    wi += w_step;
+    scales += group_size;
+    v += group_size;
+    output += group_size;
+  }
+  group_size /= 2;
+  w_step /= 2;
+
+  if (output + group_size <= rounded_num_out)
+    PartialMatrixDotVector16(wi, scales, u, rounded_num_in,
+                             num_out - output, v);
+}
+
+const IntSimdMatrix IntSimdMatrix::intSimdMatrixAVX512VNNI = {
+  // Function.
+  matrixDotVector,
+  // Number of 32 bit outputs held in each register.
+  kNumOutputsPerRegister,
+  // Maximum number of registers that we will use to hold outputs.
+  kMaxOutputRegisters,
+  // Number of 8 bit inputs in the inputs register.
+  kNumInputsPerRegister,
+  // Number of inputs in each weight group.
+  kNumInputsPerGroup
+};
+
+}  // namespace tesseract.
+
+#endif
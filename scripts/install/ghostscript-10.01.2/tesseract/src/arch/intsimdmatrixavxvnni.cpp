@@ -0,0 +1,262 @@
+///////////////////////////////////////////////////////////////////////
+// File:        intsimdmatrixavxvnni.cpp
+// Description: matrix-vector product for 8-bit data on avx vnni.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#if defined(__AVXVNNI__)
+
+#include "intsimdmatrix.h"
+
+#include <immintrin.h>
+#include <cstdint>
+
+namespace tesseract {
+
+// Number of outputs held in each register. 8 x 32 bit ints.
+constexpr int kNumOutputsPerRegister = 8;
+// Maximum number of registers that we will use.
+constexpr int kMaxOutputRegisters = 8;
+// Number of inputs in the inputs register. Each group of inputs is broadcast
+// straight from memory, so the inputs only need padding to a whole group.
+constexpr int kNumInputsPerRegister = 4;
+// Number of inputs in each weight group.
+constexpr int kNumInputsPerGroup = 4;
+
+// Functions to compute part of a matrix.vector multiplication. The weights
+// are in a very specific order (see above) in w, which is multiplied by
+// u of length num_in, to produce output v after scaling the integer results
+// by the corresponding member of scales.
+// The amount of w and scales consumed is fixed and not available to the
+// caller. The outputs are written a whole register at a time, so v must be
+// rounded up with RoundOutputs.
+
+// Computes one set of 4x8 products of inputs and weights, adding to result.
+// As with AVX2, the signs of the weights are moved onto the inputs, so that
+// the unsigned by signed vpdpbusd can do the 4-way multiply-add in a single
+// instruction where AVX2 needs maddubs, madd and add. (With only 16 ymm
+// registers, there is no room for the extra accumulators that the AVX512
+// version uses instead.) The results are identical to
+// IntSimdMatrix::MatrixDotVector.
+// rep_input is assumed to be an 8x replicated set of 4x8-bit signed integers.
+// Note: wi is incremented by the amount of data read.
+// weights and reps are scratch registers.
+// This function must be inlined with references in order for the compiler to
+// correctly use the registers declared in the caller.
+static inline void MultiplyGroup(const __m256i& rep_input, const int8_t*& wi,
+                                 __m256i& weights, __m256i& reps,
+                                 __m256i& result) {
+  // Load a 4x8 block of weights.
+  weights = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(wi));
+  wi += kNumOutputsPerRegister * kNumInputsPerGroup;
+  // Normalize the signs on rep_input, weights, so weights is always +ve.
+  reps = _mm256_sign_epi8(rep_input, weights);
+  weights = _mm256_abs_epi8(weights);
+  result = _mm256_dpbusd_avx_epi32(result, weights, reps);
+}
+
+// Adds the biases to result, and writes the 8 scaled results to v.
+// Note: wi, scales and v are all advanced past the 8 results.
+static inline void ExtractResults8(__m256i result, const int8_t*& wi,
+                                   const double*& scales, double*& v) {
+  // 8x8bit biases to 8x32bit.
+  __m256i bias = _mm256_cvtepi8_epi32(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(wi)));
+  bias = _mm256_mullo_epi32(bias, _mm256_set1_epi32(INT8_MAX));
+  result = _mm256_add_epi32(result, bias);  // result += bias * 127
+  __m256d res0123 = _mm256_cvtepi32_pd(_mm256_castsi256_si128(result));
+  __m256d res4567 = _mm256_cvtepi32_pd(_mm256_extracti128_si256(result, 1));
+  res0123 = _mm256_mul_pd(res0123, _mm256_loadu_pd(scales));
+  res4567 = _mm256_mul_pd(res4567, _mm256_loadu_pd(scales + 4));
+  _mm256_storeu_pd(v, res0123);
+  _mm256_storeu_pd(v + 4, res4567);
+  wi += kNumOutputsPerRegister;
+  scales += kNumOutputsPerRegister;
+  v += kNumOutputsPerRegister;
+}
+
+// Computes part of matrix.vector v = Wu. Computes N=64 results.
+// The weights *must* be arranged so that consecutive reads from wi
+// provides (num_in/kNumInputsPerGroup groups of (N output dim groups of
+// (kNumInputsPerGroup inputs))). After that there must be N consecutive
+// bias weights, before continuing with any more weights.
+// u must be padded out with zeros to
+// kNumInputsPerGroup*ceil(num_in/kNumInputsPerGroup) elements.
+static void PartialMatrixDotVector64(const int8_t* wi, const double* scales,
+                                     const int8_t* u, int num_in, double* v) {
+  // Initialize all the results to 0.
+  __m256i result0 = _mm256_setzero_si256();
+  __m256i result1 = _mm256_setzero_si256();
+  __m256i result2 = _mm256_setzero_si256();
+  __m256i result3 = _mm256_setzero_si256();
+  __m256i result4 = _mm256_setzero_si256();
+  __m256i result5 = _mm256_setzero_si256();
+  __m256i result6 = _mm256_setzero_si256();
+  __m256i result7 = _mm256_setzero_si256();
+  // Iterate over the input (u), one group at a time.
+  for (int j = 0; j < num_in; j += kNumInputsPerGroup) {
+    // Replicate the 4 inputs 8 times.
+    __m256i rep_input =
+        _mm256_set1_epi32(*reinterpret_cast<const int32_t*>(u + j));
+    __m256i weights, reps;
+    // Mul-add, with horizontal add of the 4 inputs to each of the results.
+    MultiplyGroup(rep_input, wi, weights, reps, result0);
+    MultiplyGroup(rep_input, wi, weights, reps, result1);
+    MultiplyGroup(rep_input, wi, weights, reps, result2);
+    MultiplyGroup(rep_input, wi, weights, reps, result3);
+    MultiplyGroup(rep_input, wi, weights, reps, result4);
+    MultiplyGroup(rep_input, wi, weights, reps, result5);
+    MultiplyGroup(rep_input, wi, weights, reps, result6);
+    MultiplyGroup(rep_input, wi, weights, reps, result7);
+  }
+  ExtractResults8(result0, wi, scales, v);
+  ExtractResults8(result1, wi, scales, v);
+  ExtractResults8(result2, wi, scales, v);
+  ExtractResults8(result3, wi, scales, v);
+  ExtractResults8(result4, wi, scales, v);
+  ExtractResults8(result5, wi, scales, v);
+  ExtractResults8(result6, wi, scales, v);
+  ExtractResults8(result7, wi, scales, v);
+}
+
+// Computes part of matrix.vector v = Wu. Computes N=32 results.
+// For details see PartialMatrixDotVector64 with N=32.
+static void PartialMatrixDotVector32(const int8_t* wi, const double* scales,
+                                     const int8_t* u, int num_in, double* v) {
+  // Initialize all the results to 0.
+  __m256i result0 = _mm256_setzero_si256();
+  __m256i result1 = _mm256_setzero_si256();
+  __m256i result2 = _mm256_setzero_si256();
+  __m256i result3 = _mm256_setzero_si256();
+  // Iterate over the input (u), one group at a time.
+  for (int j = 0; j < num_in; j += kNumInputsPerGroup) {
+    // Replicate the 4 inputs 8 times.
+    __m256i rep_input =
+        _mm256_set1_epi32(*reinterpret_cast<const int32_t*>(u + j));
+    __m256i weights, reps;
+    // Mul-add, with horizontal add of the 4 inputs to each of the results.
+    MultiplyGroup(rep_input, wi, weights, reps, result0);
+    MultiplyGroup(rep_input, wi, weights, reps, result1);
+    MultiplyGroup(rep_input, wi, weights, reps, result2);
+    MultiplyGroup(rep_input, wi, weights, reps, result3);
+  }
+  ExtractResults8(result0, wi, scales, v);
+  ExtractResults8(result1, wi, scales, v);
+  ExtractResults8(result2, wi, scales, v);
+  ExtractResults8(result3, wi, scales, v);
+}
+
+// Computes part of matrix.vector v = Wu. Computes N=16 results.
+// For details see PartialMatrixDotVector64 with N=16.
+static void PartialMatrixDotVector16(const int8_t* wi, const double* scales,
+                                     const int8_t* u, int num_in, double* v) {
+  // Initialize all the results to 0.
+  __m256i result0 = _mm256_setzero_si256();
+  __m256i result1 = _mm256_setzero_si256();
+  // Iterate over the input (u), one group at a time.
+  for (int j = 0; j < num_in; j += kNumInputsPerGroup) {
+    // Replicate the 4 inputs 8 times.
+    __m256i rep_input =
+        _mm256_set1_epi32(*reinterpret_cast<const int32_t*>(u + j));
+    __m256i weights, reps;
+    // Mul-add, with horizontal add of the 4 inputs to each of the results.
+    MultiplyGroup(rep_input, wi, weights, reps, result0);
+    MultiplyGroup(rep_input, wi, weights, reps, result1);
+  }
+  ExtractResults8(result0, wi, scales, v);
+  ExtractResults8(result1, wi, scales, v);
+}
+
+// Computes part of matrix.vector v = Wu. Computes N=8 results.
+// For details see PartialMatrixDotVector64 with N=8.
+static void PartialMatrixDotVector8(const int8_t* wi, const double* scales,
+                                    const int8_t* u, int num_in, double* v) {
+  // Initialize all the results to 0.
+  __m256i result0 = _mm256_setzero_si256();
+  // Iterate over the input (u), one group at a time.
+  for (int j = 0; j < num_in; j += kNumInputsPerGroup) {
+    // Replicate the 4 inputs 8 times.
+    __m256i rep_input =
+        _mm256_set1_epi32(*reinterpret_cast<const int32_t*>(u + j));
+    __m256i weights, reps;
+    // Mul-add, with horizontal add of the 4 inputs to each of the results.
+    MultiplyGroup(rep_input, wi, weights, reps, result0);
+  }
+  ExtractResults8(result0, wi, scales, v);
+}
+
+static void matrixDotVector(int dim1, int dim2, const int8_t* wi,
+                            const double* scales, const int8_t* u, double* v) {
+  const int num_out = dim1;
+  const int num_in = dim2 - 1;
+  // Each call to a partial_func_ produces group_size outputs, except the
+  // last one, which can produce less.
+  const int rounded_num_in =
+    IntSimdMatrix::Roundup(num_in, kNumInputsPerGroup);
+  const int rounded_num_out =
+    IntSimdMatrix::Roundup(num_out, kNumOutputsPerRegister);
+  int group_size = kNumOutputsPerRegister * kMaxOutputRegisters;
+  int output = 0;
+
+  int w_step = (rounded_num_in + 1) * group_size;
+
+  // Run with this group size, until it would produce too much output, then
+  // switch to a smaller size.
+  for (; output + group_size <= rounded_num_out; output += group_size) {
+    PartialMatrixDotVector64(wi, scales, u, rounded_num_in, v);
+    wi += w_step;
+    scales += group_size;
+    v += group_size;
+  }
+  group_size /= 2;
+  w_step /= 2;
+
+  if (output + group_size <= rounded_num_out) {
+    PartialMatrixDotVector32(wi, scales, u, rounded_num_in, v);
+    wi += w_step;
+    scales += group_size;
+    v += group_size;
+    output += group_size;
+  }
+  group_size /= 2;
+  w_step /= 2;
+
+  if (output + group_size <= rounded_num_out) {
+    PartialMatrixDotVector16(wi, scales, u, rounded_num_in, v);
+    wi += w_step;
+    scales += group_size;
+    v += group_size;
+    output += group_size;
+  }
+  group_size /= 2;
+  w_step /= 2;
+
+  if (output + group_size <= rounded_num_out)
+    PartialMatrixDotVector8(wi, scales, u, rounded_num_in, v);
+}
+
+const IntSimdMatrix IntSimdMatrix::intSimdMatrixAVXVNNI = {
+  // Function.
+  matrixDotVector,
+  // Number of 32 bit outputs held in each register.
+  kNumOutputsPerRegister,
+  // Maximum number of registers that we will use to hold outputs.
+  kMaxOutputRegisters,
+  // Number of 8 bit inputs in the inputs register.
+  kNumInputsPerRegister,
+  // Number of inputs in each weight group.
+  kNumInputsPerGroup
+};
+
+}  // namespace tesseract.
+
+#endif
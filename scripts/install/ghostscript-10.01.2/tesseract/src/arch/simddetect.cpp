@@ -20,6 +20,7 @@
 #endif
 #include <numeric>           // for std::inner_product
 #include "simddetect.h"
+#include "activation.h"
 #include "dotproduct.h"
 #include "intsimdmatrix.h"   // for IntSimdMatrix
 #include "params.h"   // for STRING_VAR
@@ -61,6 +62,11 @@ namespace tesseract {
 // in AVX registers.
 DotProductFunction DotProduct;
 
+// The activation functions are chosen separately from the dot product, as
+// they all give the same results.
+ActivationFunction TanhInPlace;
+ActivationFunction LogisticInPlace;
+
 static STRING_VAR(dotproduct, "auto",
                   "Function used for calculation of dot product");
 
@@ -78,6 +84,8 @@ bool SIMDDetect::avx_available_;
 bool SIMDDetect::avx2_available_;
 bool SIMDDetect::avx512F_available_;
 bool SIMDDetect::avx512BW_available_;
+bool SIMDDetect::avx512VNNI_available_;
+bool SIMDDetect::avxVNNI_available_;
 // If true, then FMA has been detected.
 bool SIMDDetect::fma_available_;
 // If true, then SSe4.1 has been detected.
@@ -96,6 +104,16 @@ static double DotProductStdInnerProduct(const double* u, const double* v, int n)
   return std::inner_product(u, u + n, v, 0.0);
 }
 
+// Applies Tanh in place to the n-vector inout.
+static void TanhGeneric(int n, double* inout) {
+  for (int i = 0; i < n; ++i) inout[i] = Tanh(inout[i]);
+}
+
+// Applies Logistic in place to the n-vector inout.
+static void LogisticGeneric(int n, double* inout) {
+  for (int i = 0; i < n; ++i) inout[i] = Logistic(inout[i]);
+}
+
 static void SetDotProduct(DotProductFunction f, const IntSimdMatrix* m = nullptr) {
   DotProduct = f;
   IntSimdMatrix::intSimdMatrix = m;
@@ -137,9 +155,18 @@ SIMDDetect::SIMDDetect() {
         // there is in my cpuid.h. It is a macro for an asm statement and cannot
         // be used inside an if.
         __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        const unsigned int max_subleaf = eax;
         avx2_available_ = (ebx & 0x00000020) != 0;
-        avx512F_available_ = (ebx & 0x00010000) != 0;
-        avx512BW_available_ = (ebx & 0x40000000) != 0;
+        // AVX512 also needs the OS to save the opmask and ZMM state.
+        if ((xgetbv() & 0xe0) == 0xe0) {
+          avx512F_available_ = (ebx & 0x00010000) != 0;
+          avx512BW_available_ = (ebx & 0x40000000) != 0;
+          avx512VNNI_available_ = (ecx & 0x00000800) != 0;
+        }
+        if (max_subleaf >= 1) {
+          __cpuid_count(7, 1, eax, ebx, ecx, edx);
+          avxVNNI_available_ = (eax & 0x00000010) != 0;
+        }
       }
 #endif
     }
@@ -166,10 +193,19 @@ SIMDDetect::SIMDDetect() {
 #endif
 #if defined(HAVE_AVX2)
       if (max_function_id >= 7) {
-        __cpuid(cpuInfo, 7);
+        __cpuidex(cpuInfo, 7, 0);
+        const int max_subleaf = cpuInfo[0];
         avx2_available_ = (cpuInfo[1] & 0x00000020) != 0;
-        avx512F_available_ = (cpuInfo[1] & 0x00010000) != 0;
-        avx512BW_available_ = (cpuInfo[1] & 0x40000000) != 0;
+        // AVX512 also needs the OS to save the opmask and ZMM state.
+        if ((_xgetbv(0) & 0xe0) == 0xe0) {
+          avx512F_available_ = (cpuInfo[1] & 0x00010000) != 0;
+          avx512BW_available_ = (cpuInfo[1] & 0x40000000) != 0;
+          avx512VNNI_available_ = (cpuInfo[2] & 0x00000800) != 0;
+        }
+        if (max_subleaf >= 1) {
+          __cpuidex(cpuInfo, 7, 1);
+          avxVNNI_available_ = (cpuInfo[0] & 0x00000010) != 0;
+        }
       }
 #endif
     }
@@ -197,6 +233,21 @@ SIMDDetect::SIMDDetect() {
   // Select code for calculation of dot product based on autodetection.
   if (false) {
     // This is a dummy to support conditional compilation.
+#if defined(HAVE_AVX512VNNI) && defined(HAVE_AVX512F)
+  } else if (avx512VNNI_available_ && avx512BW_available_) {
+    // AVX512 VNNI detected.
+    SetDotProduct(DotProductAVX512F, &IntSimdMatrix::intSimdMatrixAVX512VNNI);
+#endif
+#if defined(HAVE_AVXVNNI) && defined(HAVE_AVX)
+  } else if (avxVNNI_available_) {
+    // AVX VNNI detected.
+    SetDotProduct(DotProductAVX, &IntSimdMatrix::intSimdMatrixAVXVNNI);
+#endif
+#if defined(HAVE_AVX512F) && defined(HAVE_AVX2)
+  } else if (avx512F_available_) {
+    // AVX512F detected.
+    SetDotProduct(DotProductAVX512F, &IntSimdMatrix::intSimdMatrixAVX2);
+#endif
 #if defined(HAVE_AVX2)
   } else if (avx2_available_) {
     // AVX2 detected.
@@ -216,6 +267,25 @@ SIMDDetect::SIMDDetect() {
   } else if (neon_available_) {
     // NEON detected.
     SetDotProduct(DotProduct, &IntSimdMatrix::intSimdMatrixNEON);
+#endif
+  }
+
+  // Select code for the activation functions based on autodetection.
+  TanhInPlace = TanhGeneric;
+  LogisticInPlace = LogisticGeneric;
+  if (false) {
+    // This is a dummy to support conditional compilation.
+#if defined(HAVE_AVX512F)
+  } else if (avx512F_available_) {
+    // AVX512F detected.
+    TanhInPlace = TanhAVX512F;
+    LogisticInPlace = LogisticAVX512F;
+#endif
+#if defined(HAVE_AVX2)
+  } else if (avx2_available_) {
+    // AVX2 detected.
+    TanhInPlace = TanhAVX2;
+    LogisticInPlace = LogisticAVX2;
 #endif
   }
 }
@@ -234,6 +304,24 @@ void SIMDDetect::Update() {
     // Native optimized code selected by config variable.
     SetDotProduct(DotProductNative);
     dotproduct_method = "native";
+#if defined(HAVE_AVX512VNNI) && defined(HAVE_AVX512F)
+  } else if (!strcmp(dotproduct.c_str(), "avx512vnni")) {
+    // AVX512 VNNI selected by config variable.
+    SetDotProduct(DotProductAVX512F, &IntSimdMatrix::intSimdMatrixAVX512VNNI);
+    dotproduct_method = "avx512vnni";
+#endif
+#if defined(HAVE_AVXVNNI) && defined(HAVE_AVX)
+  } else if (!strcmp(dotproduct.c_str(), "avxvnni")) {
+    // AVX VNNI selected by config variable.
+    SetDotProduct(DotProductAVX, &IntSimdMatrix::intSimdMatrixAVXVNNI);
+    dotproduct_method = "avxvnni";
+#endif
+#if defined(HAVE_AVX512F) && defined(HAVE_AVX2)
+  } else if (!strcmp(dotproduct.c_str(), "avx512")) {
+    // AVX512F selected by config variable.
+    SetDotProduct(DotProductAVX512F, &IntSimdMatrix::intSimdMatrixAVX2);
+    dotproduct_method = "avx512";
+#endif
 #if defined(HAVE_AVX2)
   } else if (!strcmp(dotproduct.c_str(), "avx2")) {
     // AVX2 selected by config variable.
@@ -267,6 +355,15 @@ void SIMDDetect::Update() {
     tprintf("Warning, ignoring unsupported config variable value: dotproduct=%s\n",
             dotproduct.c_str());
     tprintf("Support values for dotproduct: auto generic native"
+#if defined(HAVE_AVX512VNNI) && defined(HAVE_AVX512F)
+            " avx512vnni"
+#endif
+#if defined(HAVE_AVXVNNI) && defined(HAVE_AVX)
+            " avxvnni"
+#endif
+#if defined(HAVE_AVX512F) && defined(HAVE_AVX2)
+            " avx512"
+#endif
 #if defined(HAVE_AVX)
             " avx"
 #endif
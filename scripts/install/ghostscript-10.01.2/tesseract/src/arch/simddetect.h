@@ -25,6 +25,13 @@ namespace tesseract {
 using DotProductFunction = double (*)(const double*, const double*, int);
 extern DotProductFunction DotProduct;
 
+// Function pointers for best calculation of the Tanh and Logistic activation
+// functions, applied in place to an n-vector. All the versions give identical
+// results.
+using ActivationFunction = void (*)(int, double*);
+extern ActivationFunction TanhInPlace;
+extern ActivationFunction LogisticInPlace;
+
 // Architecture detector. Add code here to detect any other architectures for
 // SIMD-based faster dot product functions. Intended to be a single static
 // object, but it does no real harm to have more than one.
@@ -46,6 +53,16 @@ class SIMDDetect {
   static inline bool IsAVX512BWAvailable() {
     return detector.avx512BW_available_;
   }
+  // Returns true if AVX512 VNNI (int8 dot product) is available on this
+  // system.
+  static inline bool IsAVX512VNNIAvailable() {
+    return detector.avx512VNNI_available_;
+  }
+  // Returns true if AVX VNNI (VEX encoded int8 dot product) is available on
+  // this system.
+  static inline bool IsAVXVNNIAvailable() {
+    return detector.avxVNNI_available_;
+  }
   // Returns true if FMA is available on this system.
   static inline bool IsFMAAvailable() {
     return detector.fma_available_;
@@ -74,6 +91,8 @@ class SIMDDetect {
   static TESS_API bool avx2_available_;
   static TESS_API bool avx512F_available_;
   static TESS_API bool avx512BW_available_;
+  static TESS_API bool avx512VNNI_available_;
+  static TESS_API bool avxVNNI_available_;
   // If true, then FMA has been detected.
   static TESS_API bool fma_available_;
   // If true, then SSe4.1 has been detected.
@@ -338,6 +338,9 @@ bool Tesseract::recog_all_words(PAGE_RES* page_res,
     // all the input and output classes are ready to run the classifier.
     std::vector<WordData> words;
     SetupAllWordsPassN(1, target_word_box, word_config, page_res, &words);
+    if (lstm_batch_size > 1 || thread_pool_ != nullptr) {
+      PrerecAllLinesLSTM(&words);
+    }
     #ifndef DISABLED_LEGACY_ENGINE
     if (tessedit_parallelize) {
       PrerecAllWordsPar(words);
@@ -1405,7 +1408,10 @@ void Tesseract::classify_word_pass1(const WordData& word_data,
       tessedit_ocr_engine_mode == OEM_TESSERACT_LSTM_COMBINED) {
 #endif  // def DISABLED_LEGACY_ENGINE
     if (!(*in_word)->odd_size || tessedit_ocr_engine_mode == OEM_LSTM_ONLY) {
-      LSTMRecognizeWord(*block, row, *in_word, out_words);
+      if (word_data.lstm_tess == this)
+        LSTMDecodeWord(word_data, out_words);
+      else
+        LSTMRecognizeWord(*block, row, *in_word, out_words);
       if (!out_words->empty())
         return;  // Successful lstm recognition.
     }
@@ -220,11 +220,12 @@ ImageData* Tesseract::GetRectImage(const TBOX& box, const BLOCK& block,
   return new ImageData(vertical_text, box_pix);
 }
 
-// Recognizes a word or group of words, converting to WERD_RES in *words.
-// Analogous to classify_word_pass1, but can handle a group of words as well.
-void Tesseract::LSTMRecognizeWord(const BLOCK& block, ROW *row, WERD_RES *word,
-                                  PointerVector<WERD_RES>* words) {
-  TBOX word_box = word->word->bounding_box();
+// Returns the image of the line that LSTMRecognizeWord recognizes for the
+// given word, and its box in *line_box, or nullptr if there is no image.
+ImageData* Tesseract::GetLSTMLineImage(const BLOCK& block, ROW* row,
+                                       const WERD_RES& word,
+                                       TBOX* line_box) const {
+  TBOX word_box = word.word->bounding_box();
   // Get the word image - no frills.
   if (tessedit_pageseg_mode == PSM_SINGLE_WORD ||
       tessedit_pageseg_mode == PSM_RAW_LINE) {
@@ -238,10 +239,71 @@ void Tesseract::LSTMRecognizeWord(const BLOCK& block, ROW *row, WERD_RES *word,
     if (baseline + row->x_height() + row->ascenders() > word_box.top())
       word_box.set_top(baseline + row->x_height() + row->ascenders());
   }
-  ImageData* im_data = GetRectImage(word_box, block, kImagePadding, &word_box);
+  return GetRectImage(word_box, block, kImagePadding, line_box);
+}
+
+// Returns false if the line of the given block in line_box, from
+// GetRectImage, is too light in the binary image to be light text on a dark
+// background, so there is no point in LSTMRecognizeWord trying it inverted.
+// Dark text leaves most of its line light, while inverted text leaves most of
+// it dark, so the fraction of dark pixels that Otsu thresholding gave the
+// line tells them apart far more cheaply than running the network again.
+bool Tesseract::LineMayBeInverted(const BLOCK& block, const TBOX& line_box) {
+  if (tessedit_invert_min_dark <= 0.0 || pix_binary_ == nullptr) return true;
+  // GetRectImage clips the box in the image, but then rotates it back into
+  // the coords of the block, so rotate it into the image again.
+  TBOX box = line_box;
+  if (block.re_rotation().y() != 0.0f || block.re_rotation().x() < 0.0f)
+    box.rotate(block.re_rotation());
+  int width = pixGetWidth(pix_binary_);
+  int height = pixGetHeight(pix_binary_);
+  box &= TBOX(0, 0, width, height);
+  if (box.null_box()) return true;
+  Box* clip_box = boxCreate(box.left(), height - box.top(), box.width(),
+                            box.height());
+  l_int32 dark = 0;
+  bool counted = pixCountPixelsInRect(pix_binary_, clip_box, &dark,
+                                      nullptr) == 0;
+  boxDestroy(&clip_box);
+  if (!counted || dark >= tessedit_invert_min_dark * box.area()) return true;
+  ++invert_skips_;
+  return false;
+}
+
+// Prints the counts of the lines tried inverted on the page, for
+// tessedit_invert_stats, and clears them, including those of the
+// sub-languages.
+void Tesseract::ReportInvertStats() {
+  int tries = 0;
+  int wins = 0;
+  int skips = 0;
+  std::vector<Tesseract*> langs(1, this);
+  langs.insert(langs.end(), sub_langs_.begin(), sub_langs_.end());
+  for (auto* lang : langs) {
+    if (lang->lstm_recognizer_ != nullptr) {
+      tries += lang->lstm_recognizer_->inverted_tries();
+      wins += lang->lstm_recognizer_->inverted_wins();
+      lang->lstm_recognizer_->ResetInvertCounts();
+    }
+    skips += lang->invert_skips_;
+    lang->invert_skips_ = 0;
+  }
+  if (tessedit_invert_stats && tries + skips > 0) {
+    tprintf("Inverted lines: %d tried, %d better inverted,"
+            " %d too light to try\n", tries, wins, skips);
+  }
+}
+
+// Recognizes a word or group of words, converting to WERD_RES in *words.
+// Analogous to classify_word_pass1, but can handle a group of words as well.
+void Tesseract::LSTMRecognizeWord(const BLOCK& block, ROW *row, WERD_RES *word,
+                                  PointerVector<WERD_RES>* words) {
+  TBOX word_box;
+  ImageData* im_data = GetLSTMLineImage(block, row, *word, &word_box);
   if (im_data == nullptr) return;
 
-  bool do_invert = tessedit_do_invert;
+  bool do_invert = tessedit_do_invert && LineMayBeInverted(block, word_box);
+  lstm_recognizer_->set_prune_contexts(lstm_prune_contexts);
   lstm_recognizer_->RecognizeLine(*im_data, do_invert, classify_debug_level > 0,
                                   kWorstDictCertainty / kCertaintyScale,
                                   word_box, words, lstm_choice_mode,
@@ -250,6 +312,54 @@ void Tesseract::LSTMRecognizeWord(const BLOCK& block, ROW *row, WERD_RES *word,
   SearchWords(words);
 }
 
+// As LSTMRecognizeWord, but decodes the network outputs that were
+// precomputed for the line of the word by PrerecAllLinesLSTM.
+void Tesseract::LSTMDecodeWord(const WordData& word_data,
+                               PointerVector<WERD_RES>* words) {
+  const LSTMLineOutputs& line = word_data.lstm_line;
+  if (!line.valid) return;
+  lstm_recognizer_->set_prune_contexts(lstm_prune_contexts);
+  lstm_recognizer_->DecodeLine(line.outputs, line.scale_factor, false,
+                               kWorstDictCertainty / kCertaintyScale,
+                               word_data.lstm_line_box, words,
+                               lstm_choice_mode, lstm_choice_iterations);
+  SearchWords(words);
+}
+
+// Runs the LSTM on the lines of all the words together, in batches of up to
+// lstm_batch_size lines, keeping the outputs in each WordData for
+// LSTMDecodeWord to use in place of running the LSTM one line at a time.
+// The batches are spread over the threads of thread_pool_, if set.
+void Tesseract::PrerecAllLinesLSTM(std::vector<WordData>* words) {
+  // Debug output is only available one line at a time.
+  if (lstm_recognizer_ == nullptr || classify_debug_level > 0) return;
+  std::vector<WordData*> line_words;
+  std::vector<const ImageData*> images;
+  std::vector<bool> invert;
+  for (auto& word_data : *words) {
+    // Only the words that classify_word_pass1 gives to LSTMRecognizeWord.
+    if (word_data.word->odd_size &&
+        tessedit_ocr_engine_mode != OEM_LSTM_ONLY) continue;
+    ImageData* im_data = GetLSTMLineImage(*word_data.block, word_data.row,
+                                          *word_data.word,
+                                          &word_data.lstm_line_box);
+    if (im_data == nullptr) continue;
+    line_words.push_back(&word_data);
+    images.push_back(im_data);
+    invert.push_back(tessedit_do_invert &&
+                     LineMayBeInverted(*word_data.block,
+                                       word_data.lstm_line_box));
+  }
+  std::vector<LSTMLineOutputs> results;
+  lstm_recognizer_->RecognizeLines(images, invert, lstm_batch_size,
+                                   thread_pool_, &results);
+  for (size_t i = 0; i < line_words.size(); ++i) {
+    line_words[i]->lstm_tess = this;
+    line_words[i]->lstm_line = results[i];
+    delete images[i];
+  }
+}
+
 // Apply segmentation search to the given set of words, within the constraints
 // of the existing ratings matrix. If there is already a best_choice on a word
 // leaves it untouched and just sets the done/accepted etc flags.
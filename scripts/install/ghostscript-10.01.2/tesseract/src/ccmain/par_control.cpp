@@ -17,6 +17,7 @@
 ///////////////////////////////////////////////////////////////////////
 
 #include "tesseractclass.h"
+#include "threadpool.h"
 #ifdef _OPENMP
 #include <omp.h>
 #endif  // _OPENMP
@@ -51,7 +52,13 @@ void Tesseract::PrerecAllWordsPar(const std::vector<WordData>& words) {
     }
   }
   // Pre-classify all the blobs.
-  if (tessedit_parallelize > 1) {
+  if (thread_pool_ != nullptr) {
+    thread_pool_->ParallelFor(blobs.size(), [&blobs](int b, int thread_id) {
+      *blobs[b].choices =
+          blobs[b].tesseract->classify_blob(blobs[b].blob, "par",
+                                            ScrollView::WHITE, nullptr);
+    });
+  } else if (tessedit_parallelize > 1) {
 #ifdef _OPENMP
 #pragma omp parallel for num_threads(10)
 #endif  // _OPENMP
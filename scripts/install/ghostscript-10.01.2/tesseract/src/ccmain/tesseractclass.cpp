@@ -68,6 +68,13 @@ Tesseract::Tesseract()
                   this->params()),
       BOOL_MEMBER(tessedit_do_invert, true,
                  "Try inverting the image in `LSTMRecognizeWord`", this->params()),
+      double_MEMBER(tessedit_invert_min_dark, 0.4,
+                    "Minimum fraction of the binary image of a text line that "
+                    "must be dark for the line to be tried inverted",
+                    this->params()),
+      BOOL_MEMBER(tessedit_invert_stats, false,
+                  "Print the number of lines tried inverted on each page",
+                  this->params()),
       // The default for pageseg_mode is the old behaviour, so as not to
       // upset anything that relies on that.
       INT_MEMBER(
@@ -501,6 +508,17 @@ Tesseract::Tesseract()
           this->params()),
       INT_MEMBER(tessedit_parallelize, 0, "Run in parallel where possible",
                  this->params()),
+      INT_MEMBER(tessedit_num_threads, 1,
+                 "Number of threads that TessBaseAPI uses to recognize the "
+                 "text lines of a page in parallel. 1 runs serially.",
+                 this->params()),
+      BOOL_MEMBER(tessedit_page_arena, false,
+                  "Allocate the blobs, outlines, words and choices of a page "
+                  "from an arena which is reset when the page is cleared",
+                  this->params()),
+      BOOL_MEMBER(tessedit_page_arena_stats, false,
+                  "Print the allocation counts of each stage of a page",
+                  this->params()),
       BOOL_MEMBER(preserve_interword_spaces, false,
                   "Preserve multiple interword spaces", this->params()),
       STRING_MEMBER(page_separator, "\f",
@@ -514,12 +532,24 @@ Tesseract::Tesseract()
           "process instead of the lattice. The choices are mapped per "
           "character.",
           this->params()),
+      INT_MEMBER(lstm_batch_size, 0,
+                 "Max number of text lines to run through the LSTM together. "
+                 "Values above 1 precompute the LSTM outputs for all the "
+                 "lines of a page in batches of lines of similar width, with "
+                 "the same results as recognizing them one at a time.",
+                 this->params()),
       INT_MEMBER(
           lstm_choice_iterations, 5,
           "Sets the number of cascading iterations for the Beamsearch in "
           "lstm_choice_mode. Note that lstm_choice_mode must be set to a "
           "value greater than 0 to produce results.",
                  this->params()),
+      BOOL_MEMBER(lstm_prune_contexts, false,
+                  "Skip the contexts of the LSTM beam search that can't get "
+                  "into the beam. The result is the same either way. It is "
+                  "faster on noisy lines, whose beams are full of poor "
+                  "contexts, but a little slower on clean ones.",
+                  this->params()),
       double_MEMBER(
           lstm_rating_coefficient, 5,
           "Sets the rating coefficient for the lstm choices. The smaller the "
@@ -545,7 +575,9 @@ Tesseract::Tesseract()
       font_table_size_(0),
       equ_detect_(nullptr),
       lstm_recognizer_(nullptr),
-      train_line_page_num_(0) {
+      thread_pool_(nullptr),
+      train_line_page_num_(0),
+      invert_skips_(0) {
 }
 
 Tesseract::~Tesseract() {
@@ -570,6 +602,7 @@ Dict& Tesseract::getDict() {
 
 
 void Tesseract::Clear() {
+  ReportInvertStats();
   STRING debug_name = imagebasename + "_debug.pdf";
   pixa_debug_.WritePDF(debug_name.c_str());
   pixDestroy(&pix_binary_);
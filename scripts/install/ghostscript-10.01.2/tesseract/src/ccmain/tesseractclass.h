@@ -35,6 +35,7 @@
 #ifndef DISABLED_LEGACY_ENGINE
 #include "docqual.h"                // for GARBAGE_LEVEL
 #endif
+#include "lstmrecognizer.h"         // for LSTMLineOutputs
 #include "pageres.h"                // for WERD_RES (ptr only), PAGE_RES (pt...
 #include "params.h"                 // for BOOL_VAR_H, BoolParam, DoubleParam
 #include "points.h"                 // for FCOORD
@@ -74,6 +75,7 @@ class EquationDetect;
 class ImageData;
 class LSTMRecognizer;
 class Tesseract;
+class ThreadPool;
 
 // Top-level class for all tesseract global instance data.
 // This class either holds or points to all data used by an instance
@@ -149,20 +151,29 @@ struct TesseractStats {
 // Struct to hold all the pointers to relevant data for processing a word.
 struct WordData {
   WordData()
-      : word(nullptr), row(nullptr), block(nullptr), prev_word(nullptr) {}
+      : word(nullptr), row(nullptr), block(nullptr), prev_word(nullptr),
+        lstm_tess(nullptr) {}
   explicit WordData(const PAGE_RES_IT& page_res_it)
       : word(page_res_it.word()),
         row(page_res_it.row()->row),
         block(page_res_it.block()->block),
-        prev_word(nullptr) {}
+        prev_word(nullptr),
+        lstm_tess(nullptr) {}
   WordData(BLOCK* block_in, ROW* row_in, WERD_RES* word_res)
-      : word(word_res), row(row_in), block(block_in), prev_word(nullptr) {}
+      : word(word_res), row(row_in), block(block_in), prev_word(nullptr),
+        lstm_tess(nullptr) {}
 
   WERD_RES* word;
   ROW* row;
   BLOCK* block;
   WordData* prev_word;
   PointerVector<WERD_RES> lang_words;
+  // The Tesseract whose LSTM produced lstm_line, or nullptr if the network
+  // outputs for the line of this word were not precomputed by
+  // PrerecAllLinesLSTM. lstm_line_box is the box of the line image.
+  Tesseract* lstm_tess;
+  LSTMLineOutputs lstm_line;
+  TBOX lstm_line_box;
 };
 
 // Definition of a Tesseract WordRecognizer. The WordData provides the context
@@ -193,6 +204,11 @@ class TESS_API Tesseract : public Wordrec {
 
   // Set the equation detector.
   void SetEquationDetect(EquationDetect* detector);
+  // Set the pool of threads to use for recognition, or nullptr to run
+  // serially. The pool is owned by the caller.
+  void set_thread_pool(ThreadPool* pool) {
+    thread_pool_ = pool;
+  }
 
   // Simple accessors.
   const FCOORD& reskew() const {
@@ -365,10 +381,31 @@ class TESS_API Tesseract : public Wordrec {
   // is also returned to enable calculation of output bounding boxes.
   ImageData* GetRectImage(const TBOX& box, const BLOCK& block, int padding,
                           TBOX* revised_box) const;
+  // Returns false if the line of the given block in line_box, from
+  // GetRectImage, is too light in the binary image to be light text on a
+  // dark background, so there is no point in LSTMRecognizeWord trying it
+  // inverted.
+  bool LineMayBeInverted(const BLOCK& block, const TBOX& line_box);
+  // Prints the counts of the lines tried inverted on the page, for
+  // tessedit_invert_stats, and clears them.
+  void ReportInvertStats();
+  // Returns the image of the line that LSTMRecognizeWord recognizes for the
+  // given word, and its box in *line_box, or nullptr if there is no image.
+  ImageData* GetLSTMLineImage(const BLOCK& block, ROW* row,
+                              const WERD_RES& word, TBOX* line_box) const;
   // Recognizes a word or group of words, converting to WERD_RES in *words.
   // Analogous to classify_word_pass1, but can handle a group of words as well.
   void LSTMRecognizeWord(const BLOCK& block, ROW* row, WERD_RES* word,
                          PointerVector<WERD_RES>* words);
+  // As LSTMRecognizeWord, but decodes the network outputs that were
+  // precomputed for the line of the word by PrerecAllLinesLSTM.
+  void LSTMDecodeWord(const WordData& word_data,
+                      PointerVector<WERD_RES>* words);
+  // Runs the LSTM on the lines of all the words together, in batches of up to
+  // lstm_batch_size lines, keeping the outputs in each WordData for
+  // LSTMDecodeWord to use in place of running the LSTM one line at a time.
+  // The batches are spread over the threads of thread_pool_, if set.
+  void PrerecAllLinesLSTM(std::vector<WordData>* words);
   // Apply segmentation search to the given set of words, within the constraints
   // of the existing ratings matrix. If there is already a best_choice on a word
   // leaves it untouched and just sets the done/accepted etc flags.
@@ -799,6 +836,11 @@ class TESS_API Tesseract : public Wordrec {
              "Dump intermediate images made during page segmentation");
   BOOL_VAR_H(tessedit_do_invert, true,
              "Try inverting the image in `LSTMRecognizeWord`");
+  double_VAR_H(tessedit_invert_min_dark, 0.4,
+               "Minimum fraction of the binary image of a text line that "
+               "must be dark for the line to be tried inverted");
+  BOOL_VAR_H(tessedit_invert_stats, false,
+             "Print the number of lines tried inverted on each page");
   INT_VAR_H(tessedit_pageseg_mode, PSM_SINGLE_BLOCK,
             "Page seg mode: 0=osd only, 1=auto+osd, 2=auto, 3=col, 4=block,"
             " 5=line, 6=word, 7=char"
@@ -1078,6 +1120,14 @@ class TESS_API Tesseract : public Wordrec {
   double_VAR_H(textord_tabfind_aligned_gap_fraction, 0.75,
                "Fraction of height used as a minimum gap for aligned blobs.");
   INT_VAR_H(tessedit_parallelize, 0, "Run in parallel where possible");
+  INT_VAR_H(tessedit_num_threads, 1,
+            "Number of threads that TessBaseAPI uses to recognize the text "
+            "lines of a page in parallel. 1 runs serially.");
+  BOOL_VAR_H(tessedit_page_arena, false,
+             "Allocate the blobs, outlines, words and choices of a page from "
+             "an arena which is reset when the page is cleared");
+  BOOL_VAR_H(tessedit_page_arena_stats, false,
+             "Print the allocation counts of each stage of a page");
   BOOL_VAR_H(preserve_interword_spaces, false,
              "Preserve multiple interword spaces");
   STRING_VAR_H(page_separator, "\f",
@@ -1090,10 +1140,20 @@ class TESS_API Tesseract : public Wordrec {
             "With 2 the alternative symbol choices are extracted from the CTC "
             "process instead of the lattice. The choices are mapped per "
             "character.");
+  INT_VAR_H(lstm_batch_size, 0,
+            "Max number of text lines to run through the LSTM together. "
+            "Values above 1 precompute the LSTM outputs for all the lines of "
+            "a page in batches of lines of similar width, with the same "
+            "results as recognizing them one at a time.");
   INT_VAR_H(lstm_choice_iterations, 5,
             "Sets the number of cascading iterations for the Beamsearch in "
             "lstm_choice_mode. Note that lstm_choice_mode must be set to "
             "a value greater than 0 to produce results.");
+  BOOL_VAR_H(lstm_prune_contexts, false,
+             "Skip the contexts of the LSTM beam search that can't get into "
+             "the beam. The result is the same either way. It is faster on "
+             "noisy lines, whose beams are full of poor contexts, but a "
+             "little slower on clean ones.");
   double_VAR_H(lstm_rating_coefficient, 5,
                "Sets the rating coefficient for the lstm choices. The smaller "
                "the coefficient, the better are the ratings for each choice "
@@ -1154,8 +1214,14 @@ class TESS_API Tesseract : public Wordrec {
   EquationDetect* equ_detect_;
   // LSTM recognizer, if available.
   LSTMRecognizer* lstm_recognizer_;
+  // Threads for parallel recognition. Note: this pointer is NOT owned by the
+  // class.
+  ThreadPool* thread_pool_;
   // Output "page" number (actually line number) using TrainLineRecognizer.
   int train_line_page_num_;
+  // The number of lines on the page that LineMayBeInverted kept from being
+  // tried inverted.
+  int invert_skips_;
 };
 
 }  // namespace tesseract
@@ -170,7 +170,27 @@ void ImageThresholder::SetImage(const Pix* pix) {
   } else {
     pix_ = pixCopy(nullptr, src);
   }
-  depth = pixGetDepth(pix_);
+  SetImageCommon();
+}
+
+// As SetImage, but the Pix is used where it is if it is already in a form
+// we can use, saving a copy of what may be a very large page image.
+void ImageThresholder::SetImageBorrowed(Pix* pix) {
+  int depth = pixGetDepth(pix);
+  if (pixGetColormap(pix) || (depth != 1 && depth != 8 && depth != 32)) {
+    SetImage(pix);
+    return;
+  }
+  if (pix_ != nullptr)
+    pixDestroy(&pix_);
+  pixGetDimensions(pix, &image_width_, &image_height_, nullptr);
+  pix_ = pixClone(pix);
+  SetImageCommon();
+}
+
+// Sets up the members describing pix_, once it is set.
+void ImageThresholder::SetImageCommon() {
+  int depth = pixGetDepth(pix_);
   pix_channels_ = depth / 8;
   pix_wpl_ = pixGetWpl(pix_);
   scale_ = 1;
@@ -181,6 +181,20 @@ class GENERIC_2D_ARRAY {
            fp->DeSerialize(&array_[0], num_elements());
   }
 
+  // Skips over an array written by Serialize in the given file, without
+  // reading its contents, and puts its first dimension in *dim1.
+  // Returns false in case of error.
+  static bool Skip(TFile* fp, int* dim1) {
+    int32_t size1, size2;
+    if (!fp->DeSerialize(&size1)) return false;
+    if (!fp->DeSerialize(&size2)) return false;
+    if (size1 < 0 || size1 > UINT16_MAX) return false;
+    if (size2 < 0 || size2 > UINT16_MAX) return false;
+    *dim1 = size1;
+    // The unused cell, then the elements.
+    return fp->Skip(sizeof(T) * (1 + static_cast<size_t>(size1) * size2));
+  }
+
   // Writes to the given file. Returns false in case of error.
   // Assumes a T::Serialize(FILE*) const function.
   bool SerializeClasses(FILE* fp) const {
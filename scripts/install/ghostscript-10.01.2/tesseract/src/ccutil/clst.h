@@ -20,6 +20,7 @@
 #define CLST_H
 
 #include "lsterr.h"
+#include "pagearena.h"
 
 #include "serialis.h"
 
@@ -48,6 +49,8 @@ class CLIST_LINK
   void *data;
 
   public:
+    TESS_PAGE_ARENA_OPERATORS
+
     CLIST_LINK() {  //constructor
       data = next = nullptr;
     }
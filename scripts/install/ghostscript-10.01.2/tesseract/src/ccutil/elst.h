@@ -20,6 +20,7 @@
 #define ELST_H
 
 #include "lsterr.h"
+#include "pagearena.h"
 
 #include "serialis.h"
 
@@ -86,6 +87,8 @@ class ELIST_LINK
   ELIST_LINK *next;
 
   public:
+    TESS_PAGE_ARENA_OPERATORS
+
     ELIST_LINK() {
       next = nullptr;
     }
@@ -21,6 +21,7 @@
 
 #include <cstdio>
 #include "lsterr.h"
+#include "pagearena.h"
 
 #include "serialis.h"
 
@@ -67,6 +68,8 @@ class ELIST2_LINK
   ELIST2_LINK *next;
 
   public:
+    TESS_PAGE_ARENA_OPERATORS
+
     ELIST2_LINK() {  //constructor
       prev = next = nullptr;
     }
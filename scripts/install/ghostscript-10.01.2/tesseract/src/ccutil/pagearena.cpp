@@ -0,0 +1,257 @@
+///////////////////////////////////////////////////////////////////////
+// File:        pagearena.cpp
+// Description: A per-page arena for the small objects of page recognition.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include "pagearena.h"
+
+#include "tprintf.h"
+
+#include <atomic>   // for std::atomic
+#include <cstdlib>  // for malloc, free
+#include <new>      // for std::bad_alloc
+
+namespace tesseract {
+
+// Every allocation starts with a header holding the Generation it came
+// from, or nullptr if it came from the heap. The header keeps the object
+// aligned as malloc would.
+const size_t kHeaderSize = alignof(std::max_align_t);
+// The size of the blocks we allocate from.
+const size_t kBlockSize = 256 * 1024;
+// Allocations bigger than this get a block of their own.
+const size_t kLargeSize = kBlockSize / 4;
+
+static size_t RoundUp(size_t size) {
+  return (size + kHeaderSize - 1) & ~(kHeaderSize - 1);
+}
+
+struct PageArena::Block {
+  Block* next;
+  // The size of the data, which follows the Block.
+  size_t size;
+
+  char* data() {
+    return reinterpret_cast<char*>(this) + RoundUp(sizeof(Block));
+  }
+  static Block* Create(size_t size) {
+    auto* block = static_cast<Block*>(malloc(RoundUp(sizeof(Block)) + size));
+    if (block == nullptr) {
+      throw std::bad_alloc();
+    }
+    block->next = nullptr;
+    block->size = size;
+    return block;
+  }
+  static void DestroyList(Block* block) {
+    while (block != nullptr) {
+      Block* next = block->next;
+      free(block);
+      block = next;
+    }
+  }
+};
+
+// The blocks of a page, and the count of its objects still to be deleted.
+// The count goes negative as objects are deleted during the page. When the
+// arena is Reset, it adds the number of objects it allocated, so the count
+// is then the number of objects still alive, and whoever takes it to zero
+// is the last user of the blocks.
+struct PageArena::Generation {
+  std::atomic<long> outstanding;
+  // The blocks shared by small objects, in order of use.
+  Block* blocks;
+  // Blocks holding a single large object.
+  Block* large;
+};
+
+// The arena current on each thread.
+static thread_local PageArena* current_arena = nullptr;
+
+PageArena::PageArena(bool bump)
+    : bump_(bump),
+      stage_(kLayout),
+      counts_(),
+      generation_(nullptr),
+      allocated_(0),
+      block_(nullptr),
+      next_(nullptr),
+      limit_(nullptr),
+      retained_(0) {
+  StartGeneration();
+}
+
+PageArena::~PageArena() {
+  if (generation_->outstanding.fetch_add(allocated_) + allocated_ == 0) {
+    DestroyGeneration(generation_);
+  }
+}
+
+PageArena::Scope::Scope(PageArena* arena, Stage stage)
+    : arena_(arena), saved_arena_(current_arena), saved_stage_(kLayout) {
+  if (arena_ != nullptr) {
+    saved_stage_ = arena_->stage_;
+    arena_->stage_ = stage;
+    current_arena = arena_;
+  }
+}
+
+PageArena::Scope::~Scope() {
+  if (arena_ != nullptr) {
+    arena_->stage_ = saved_stage_;
+    current_arena = saved_arena_;
+  }
+}
+
+void PageArena::Reset() {
+  for (auto& counts : counts_) {
+    counts.allocations = 0;
+    counts.bytes = 0;
+  }
+  long outstanding = generation_->outstanding.fetch_add(allocated_) + allocated_;
+  allocated_ = 0;
+  if (outstanding == 0) {
+    // Everything from the page has gone, so we can use the blocks again,
+    // apart from the large ones, which are unlikely to fit the next page.
+    Block::DestroyList(generation_->large);
+    generation_->large = nullptr;
+    block_ = generation_->blocks;
+    next_ = block_ != nullptr ? block_->data() : nullptr;
+    limit_ = block_ != nullptr ? next_ + block_->size : nullptr;
+  } else {
+    // Leave the old blocks to be freed with the last of their objects.
+    ++retained_;
+    StartGeneration();
+  }
+}
+
+void PageArena::PrintStats() const {
+  static const char* const kStageNames[kStageCount] = {"layout", "recognize",
+                                                       "output"};
+  uint64_t total = 0;
+  for (const auto& counts : counts_) {
+    total += counts.allocations;
+  }
+  if (total == 0) {
+    return;
+  }
+  for (int s = 0; s < kStageCount; ++s) {
+    tprintf("Page arena: %s: %llu allocations, %llu bytes\n", kStageNames[s],
+            static_cast<unsigned long long>(counts_[s].allocations),
+            static_cast<unsigned long long>(counts_[s].bytes));
+  }
+  tprintf("Page arena: %llu bytes in blocks, %d pages retained\n",
+          static_cast<unsigned long long>(reserved_bytes()), retained_);
+}
+
+size_t PageArena::reserved_bytes() const {
+  size_t total = 0;
+  for (Block* block = generation_->blocks; block != nullptr;
+       block = block->next) {
+    total += block->size;
+  }
+  for (Block* block = generation_->large; block != nullptr;
+       block = block->next) {
+    total += block->size;
+  }
+  return total;
+}
+
+void* PageArena::Allocate(size_t size) {
+  PageArena* arena = current_arena;
+  if (arena != nullptr) {
+    StageCounts& counts = arena->counts_[arena->stage_];
+    ++counts.allocations;
+    counts.bytes += size;
+    if (arena->bump_) {
+      return arena->AllocateFromBlock(size);
+    }
+  }
+  auto* header = static_cast<char*>(malloc(kHeaderSize + size));
+  if (header == nullptr) {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<Generation**>(header) = nullptr;
+  return header + kHeaderSize;
+}
+
+void PageArena::Free(void* p) {
+  if (p == nullptr) {
+    return;
+  }
+  char* header = static_cast<char*>(p) - kHeaderSize;
+  Generation* generation = *reinterpret_cast<Generation**>(header);
+  if (generation == nullptr) {
+    free(header);
+  } else if (generation->outstanding.fetch_sub(1) == 1) {
+    DestroyGeneration(generation);
+  }
+}
+
+void* PageArena::AllocateFromBlock(size_t size) {
+  size_t needed = kHeaderSize + RoundUp(size);
+  char* header;
+  if (needed > kLargeSize) {
+    Block* block = Block::Create(needed);
+    block->next = generation_->large;
+    generation_->large = block;
+    header = block->data();
+  } else {
+    if (needed > static_cast<size_t>(limit_ - next_)) {
+      NextBlock();
+    }
+    header = next_;
+    next_ += needed;
+  }
+  *reinterpret_cast<Generation**>(header) = generation_;
+  ++allocated_;
+  return header + kHeaderSize;
+}
+
+// Moves on to the next block, reusing one from an earlier page if there is
+// one.
+void PageArena::NextBlock() {
+  if (block_ != nullptr && block_->next != nullptr) {
+    block_ = block_->next;
+  } else {
+    Block* block = Block::Create(kBlockSize);
+    if (block_ != nullptr) {
+      block_->next = block;
+    } else {
+      generation_->blocks = block;
+    }
+    block_ = block;
+  }
+  next_ = block_->data();
+  limit_ = next_ + block_->size;
+}
+
+void PageArena::StartGeneration() {
+  generation_ = new Generation;
+  generation_->outstanding = 0;
+  generation_->blocks = nullptr;
+  generation_->large = nullptr;
+  allocated_ = 0;
+  block_ = nullptr;
+  next_ = nullptr;
+  limit_ = nullptr;
+}
+
+void PageArena::DestroyGeneration(Generation* generation) {
+  Block::DestroyList(generation->blocks);
+  Block::DestroyList(generation->large);
+  delete generation;
+}
+
+} // namespace tesseract
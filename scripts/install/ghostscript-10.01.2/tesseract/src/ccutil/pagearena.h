@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////
+// File:        pagearena.h
+// Description: A per-page arena for the small objects of page recognition.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_CCUTIL_PAGEARENA_H_
+#define TESSERACT_CCUTIL_PAGEARENA_H_
+
+#include <tesseract/export.h>
+
+#include <cstddef>  // for size_t
+#include <cstdint>  // for uint64_t
+
+namespace tesseract {
+
+// Recognizing a page makes millions of small objects: blobs, outlines,
+// words, choices and the links of the lists that hold them, nearly all of
+// which are deleted together when the page is cleared. The classes that
+// declare TESS_PAGE_ARENA_OPERATORS (the list links, and so everything
+// kept in an ELIST, ELIST2 or CLIST) allocate from the PageArena that is
+// current on the calling thread, if any, which hands out memory from large
+// blocks by bumping a pointer, and doesn't reuse memory deleted during the
+// page. Reset, at the end of the page, makes the blocks available again.
+// Objects that outlive the page are safe: each object records the
+// generation of the arena it came from, and a generation that still has
+// objects in it when the arena is Reset is left to be freed by the delete
+// of its last object, while the arena carries on with a new one.
+// Deletes may happen on any thread; the arena itself must only be used for
+// allocation, and Reset, by one thread at a time.
+// The arena also counts the allocations made in each stage of the page,
+// which is all that it does if bumping is turned off.
+// The class operators are only compiled in if TESSERACT_PAGE_ARENA is
+// defined, as they cost a small header on each object even when no arena
+// is in use.
+class TESS_API PageArena {
+ public:
+  // The stages of recognizing a page, for the allocation counts.
+  enum Stage {
+    kLayout,     // Thresholding and page layout analysis.
+    kRecognize,  // Word recognition.
+    kOutput,     // Making the text output.
+    kStageCount
+  };
+
+  // If bump is false, the arena only counts allocations, which come from
+  // the heap as usual.
+  explicit PageArena(bool bump);
+  ~PageArena();
+
+  void set_bump(bool bump) {
+    bump_ = bump;
+  }
+
+  // Makes arena current on this thread, with the given stage, for the
+  // lifetime of the Scope. A null arena makes a Scope that does nothing.
+  // Scopes may be nested.
+  class Scope {
+   public:
+    Scope(PageArena* arena, Stage stage);
+    ~Scope();
+
+   private:
+    PageArena* arena_;
+    PageArena* saved_arena_;
+    Stage saved_stage_;
+  };
+
+  // Ends the page: the blocks are reused for the next page, if none of
+  // the objects allocated from them is still alive. Also clears the counts.
+  void Reset();
+
+  // Prints the counts for the page with tprintf, unless there are none.
+  void PrintStats() const;
+
+  // Returns the number of allocations made in the given stage of the page.
+  uint64_t allocations(Stage stage) const {
+    return counts_[stage].allocations;
+  }
+  // Returns the number of bytes of memory held in blocks for the page.
+  size_t reserved_bytes() const;
+
+  // Allocates size bytes from the arena current on this thread, or from the
+  // heap if there is none, or it isn't bumping. Throws std::bad_alloc on
+  // failure, like operator new.
+  static void* Allocate(size_t size);
+  // Frees memory from Allocate.
+  static void Free(void* p);
+
+ private:
+  struct Block;
+  struct Generation;
+  struct StageCounts {
+    uint64_t allocations;
+    uint64_t bytes;
+  };
+
+  void* AllocateFromBlock(size_t size);
+  void NextBlock();
+  void StartGeneration();
+  static void DestroyGeneration(Generation* generation);
+
+  bool bump_;
+  Stage stage_;
+  StageCounts counts_[kStageCount];
+  Generation* generation_;
+  // The number of objects allocated from generation_ so far.
+  long allocated_;
+  // The block we are allocating from, and the free space in it.
+  Block* block_;
+  char* next_;
+  char* limit_;
+  // The number of generations given up because they still had objects in
+  // them when Reset was called.
+  int retained_;
+};
+
+} // namespace tesseract
+
+// Declares class operators new and delete which use the PageArena.
+#ifdef TESSERACT_PAGE_ARENA
+#define TESS_PAGE_ARENA_OPERATORS                                    \
+  static void* operator new(size_t size) {                           \
+    return tesseract::PageArena::Allocate(size);                     \
+  }                                                                  \
+  static void* operator new(size_t, void* place) {                   \
+    return place;                                                    \
+  }                                                                  \
+  static void operator delete(void* p) {                             \
+    tesseract::PageArena::Free(p);                                   \
+  }                                                                  \
+  static void operator delete(void*, void*) {                        \
+  }
+#else
+#define TESS_PAGE_ARENA_OPERATORS
+#endif
+
+#endif // TESSERACT_CCUTIL_PAGEARENA_H_
@@ -63,6 +63,8 @@ bool SaveDataToFile(const std::vector<char>& data, const char* filename) {
 
 TFile::TFile()
     : data_(nullptr),
+      view_(nullptr),
+      view_size_(0),
       offset_(0),
       data_is_owned_(false),
       is_writing_(false),
@@ -160,6 +162,7 @@ bool TFile::Open(const char* filename, FileReader reader) {
     data_ = new std::vector<char>;
     data_is_owned_ = true;
   }
+  view_ = nullptr;
   offset_ = 0;
   is_writing_ = false;
   swap_ = false;
@@ -170,6 +173,7 @@ bool TFile::Open(const char* filename, FileReader reader) {
 }
 
 bool TFile::Open(const char* data, int size) {
+  view_ = nullptr;
   offset_ = 0;
   if (!data_is_owned_) {
     data_ = new std::vector<char>;
@@ -182,7 +186,17 @@ bool TFile::Open(const char* data, int size) {
   return true;
 }
 
+bool TFile::OpenView(const char* data, size_t size) {
+  view_ = data;
+  view_size_ = size;
+  offset_ = 0;
+  is_writing_ = false;
+  swap_ = false;
+  return true;
+}
+
 bool TFile::Open(FILE* fp, int64_t end_offset) {
+  view_ = nullptr;
   offset_ = 0;
   auto current_pos = std::ftell(fp);
   if (current_pos < 0) {
@@ -209,10 +223,12 @@ bool TFile::Open(FILE* fp, int64_t end_offset) {
 
 char* TFile::FGets(char* buffer, int buffer_size) {
   ASSERT_HOST(!is_writing_);
+  const char* data = view_ != nullptr ? view_ : data_->data();
+  size_t data_size = view_ != nullptr ? view_size_ : data_->size();
   int size = 0;
-  while (size + 1 < buffer_size && offset_ < data_->size()) {
-    buffer[size++] = (*data_)[offset_++];
-    if ((*data_)[offset_ - 1] == '\n') break;
+  while (size + 1 < buffer_size && static_cast<size_t>(offset_) < data_size) {
+    buffer[size++] = data[offset_++];
+    if (data[offset_ - 1] == '\n') break;
   }
   if (size < buffer_size) buffer[size] = '\0';
   return size > 0 ? buffer : nullptr;
@@ -233,18 +249,20 @@ int TFile::FRead(void* buffer, size_t size, int count) {
   ASSERT_HOST(!is_writing_);
   ASSERT_HOST(size > 0);
   ASSERT_HOST(count >= 0);
+  const char* data = view_ != nullptr ? view_ : data_->data();
+  size_t data_size = view_ != nullptr ? view_size_ : data_->size();
   size_t required_size;
   if (SIZE_MAX / size <= count) {
     // Avoid integer overflow.
-    required_size = data_->size() - offset_;
+    required_size = data_size - offset_;
   } else {
     required_size = size * count;
-    if (data_->size() - offset_ < required_size) {
-      required_size = data_->size() - offset_;
+    if (data_size - offset_ < required_size) {
+      required_size = data_size - offset_;
     }
   }
   if (required_size > 0 && buffer != nullptr)
-    memcpy(buffer, &(*data_)[offset_], required_size);
+    memcpy(buffer, data + offset_, required_size);
   offset_ += required_size;
   return required_size / size;
 }
@@ -255,6 +273,7 @@ void TFile::Rewind() {
 }
 
 void TFile::OpenWrite(std::vector<char>* data) {
+  view_ = nullptr;
   offset_ = 0;
   if (data != nullptr) {
     if (data_is_owned_) delete data_;
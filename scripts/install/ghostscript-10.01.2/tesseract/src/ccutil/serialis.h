@@ -77,6 +77,9 @@ class TESS_API TFile {
   bool Open(const char* filename, FileReader reader);
   // From an existing memory buffer.
   bool Open(const char* data, int size);
+  // Reads directly from an existing memory buffer, without copying it, so the
+  // buffer must stay unchanged for as long as the TFile reads from it.
+  bool OpenView(const char* data, size_t size);
   // From an open file and an end offset.
   bool Open(FILE* fp, int64_t end_offset);
   // Sets the value of the swap flag, so that FReadEndian does the right thing.
@@ -132,6 +135,11 @@ class TESS_API TFile {
  private:
   // The buffered data from the file.
   std::vector<char>* data_;
+  // If not nullptr, the external buffer given to OpenView, which is read
+  // instead of data_.
+  const char* view_;
+  // The size of view_.
+  size_t view_size_;
   // The number of bytes used so far.
   int offset_;
   // True if the data_ pointer is owned by *this.
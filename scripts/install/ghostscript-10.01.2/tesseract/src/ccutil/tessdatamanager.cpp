@@ -30,6 +30,16 @@
 #include <archive_entry.h>
 #endif
 
+#if defined(_WIN32)
+#include "host.h"               // windows.h
+#elif defined(__unix__) || defined(__APPLE__)
+#define TESSDATA_USE_MMAP
+#include <fcntl.h>              // open
+#include <sys/mman.h>           // mmap, munmap
+#include <sys/stat.h>           // fstat
+#include <unistd.h>             // close
+#endif
+
 #include "errcode.h"
 #include "helpers.h"
 #include "serialis.h"
@@ -39,14 +49,114 @@
 
 namespace tesseract {
 
-TessdataManager::TessdataManager() : reader_(nullptr), is_loaded_(false), swap_(false) {
+// The whole of a traineddata file in memory, either as a read-only mapping of
+// the file, or as a copy on the heap.
+class TessdataBuffer {
+ public:
+  // Takes the contents of *data, leaving it empty.
+  explicit TessdataBuffer(std::vector<char> *data)
+      : is_mapped_(false), data_(nullptr), size_(0) {
+    heap_.swap(*data);
+    data_ = heap_.data();
+    size_ = heap_.size();
+  }
+  ~TessdataBuffer() {
+    if (!is_mapped_) return;
+#if defined(_WIN32)
+    UnmapViewOfFile(data_);
+#elif defined(TESSDATA_USE_MMAP)
+    munmap(const_cast<char *>(data_), size_);
+#endif
+  }
+  TessdataBuffer(const TessdataBuffer &) = delete;
+  TessdataBuffer &operator=(const TessdataBuffer &) = delete;
+
+  // Maps the given file into memory read-only. Returns nullptr if the file
+  // can't be mapped, for example on a platform without mmap.
+  static std::shared_ptr<const TessdataBuffer> Map(const char *filename) {
+    const char *data = nullptr;
+    size_t size = 0;
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0 &&
+        static_cast<uint64_t>(file_size.QuadPart) <= SIZE_MAX) {
+      HANDLE mapping =
+          CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping != nullptr) {
+        // The view keeps the mapping open after the handle is closed.
+        data = static_cast<const char *>(
+            MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        size = file_size.QuadPart;
+        CloseHandle(mapping);
+      }
+    }
+    CloseHandle(file);
+#elif defined(TESSDATA_USE_MMAP)
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    // Only regular files can be mapped, not pipes or directories.
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+        static_cast<uint64_t>(st.st_size) <= SIZE_MAX) {
+      void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        data = static_cast<const char *>(addr);
+        size = st.st_size;
+      }
+    }
+    close(fd);
+#else
+    (void)filename;
+#endif
+    if (data == nullptr) return nullptr;
+    std::shared_ptr<TessdataBuffer> buffer(new TessdataBuffer);
+    buffer->is_mapped_ = true;
+    buffer->data_ = data;
+    buffer->size_ = size;
+    return buffer;
+  }
+
+  bool is_mapped() const {
+    return is_mapped_;
+  }
+  const char *data() const {
+    return data_;
+  }
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  TessdataBuffer() : is_mapped_(false), data_(nullptr), size_(0) {}
+
+  // The contents of the file, if it isn't mapped.
+  std::vector<char> heap_;
+  // True if data_ is a mapping of the file, rather than heap_.
+  bool is_mapped_;
+  const char *data_;
+  size_t size_;
+};
+
+TessdataManager::TessdataManager()
+  : reader_(nullptr),
+    is_loaded_(false),
+    swap_(false),
+    buffer_offsets_(),
+    buffer_sizes_(),
+    hashes_() {
   SetVersionString(TESSERACT_VERSION_STR);
 }
 
 TessdataManager::TessdataManager(FileReader reader)
   : reader_(reader),
     is_loaded_(false),
-    swap_(false) {
+    swap_(false),
+    buffer_offsets_(),
+    buffer_sizes_(),
+    hashes_() {
   SetVersionString(TESSERACT_VERSION_STR);
 }
 
@@ -73,8 +183,9 @@ bool TessdataManager::LoadArchiveFile(const char *filename) {
           if (TessdataTypeFromFileName(component, &type)) {
             int64_t size = archive_entry_size(ae);
             if (size > 0) {
-              entries_[type].resize(size);
-              if (archive_read_data(a, &entries_[type][0], size) == size) {
+              std::vector<char> &entry = MutableEntry(type);
+              entry.resize(size);
+              if (archive_read_data(a, &entry[0], size) == size) {
                 is_loaded_ = true;
               }
             }
@@ -95,21 +206,38 @@ bool TessdataManager::Init(const char *data_file_name) {
 #if defined(HAVE_LIBARCHIVE)
     if (LoadArchiveFile(data_file_name)) return true;
 #endif
+    std::shared_ptr<const TessdataBuffer> mapping =
+        TessdataBuffer::Map(data_file_name);
+    if (mapping != nullptr) {
+      Clear();
+      data_file_name_ = data_file_name;
+      return LoadBuffer(mapping);
+    }
     if (!LoadDataFromFile(data_file_name, &data)) return false;
   } else {
     if (!(*reader_)(data_file_name, &data)) return false;
   }
-  return LoadMemBuffer(data_file_name, &data[0], data.size());
+  // The components are read in place from the loaded file, which saves
+  // copying each of them.
+  Clear();
+  data_file_name_ = data_file_name;
+  return LoadBuffer(std::make_shared<const TessdataBuffer>(&data));
 }
 
 // Loads from the given memory buffer as if a file.
 bool TessdataManager::LoadMemBuffer(const char *name, const char *data,
                                     int size) {
-  // TODO: This method supports only the proprietary file format.
   Clear();
   data_file_name_ = name;
+  std::vector<char> copy(data, data + size);
+  return LoadBuffer(std::make_shared<const TessdataBuffer>(&copy));
+}
+
+bool TessdataManager::LoadBuffer(std::shared_ptr<const TessdataBuffer> buffer) {
+  // TODO: This method supports only the proprietary file format.
+  int64_t size = buffer->size();
   TFile fp;
-  fp.Open(data, size);
+  fp.OpenView(buffer->data(), buffer->size());
   uint32_t num_entries;
   if (!fp.DeSerialize(&num_entries)) return false;
   swap_ = num_entries > kMaxNumTessdataEntries;
@@ -119,29 +247,57 @@ bool TessdataManager::LoadMemBuffer(const char *name, const char *data,
   GenericVector<int64_t> offset_table;
   offset_table.resize_no_init(num_entries);
   if (!fp.DeSerialize(&offset_table[0], num_entries)) return false;
+  int64_t header_size = sizeof(num_entries) + num_entries * sizeof(int64_t);
   for (unsigned i = 0; i < num_entries && i < TESSDATA_NUM_ENTRIES; ++i) {
     if (offset_table[i] >= 0) {
       int64_t entry_size = size - offset_table[i];
       unsigned j = i + 1;
       while (j < num_entries && offset_table[j] == -1) ++j;
       if (j < num_entries) entry_size = offset_table[j] - offset_table[i];
-      entries_[i].resize(entry_size);
-      if (!fp.DeSerialize(&entries_[i][0], entry_size)) return false;
+      if (offset_table[i] < header_size || entry_size < 0 ||
+          entry_size > size - offset_table[i]) {
+        Clear();
+        return false;
+      }
+      buffer_offsets_[i] = offset_table[i];
+      buffer_sizes_[i] = entry_size;
     }
   }
-  if (entries_[TESSDATA_VERSION].empty()) {
+  buffer_ = std::move(buffer);
+  if (!IsComponentAvailable(TESSDATA_VERSION)) {
     SetVersionString("Pre-4.0.0");
   }
   is_loaded_ = true;
   return true;
 }
 
+// Returns true if the file was loaded by mapping it into memory.
+bool TessdataManager::is_mapped() const {
+  return buffer_ != nullptr && buffer_->is_mapped();
+}
+
+// Returns the start of the contents of the given entry.
+const char *TessdataManager::EntryData(TessdataType type) const {
+  if (buffer_sizes_[type] > 0) {
+    return buffer_->data() + buffer_offsets_[type];
+  }
+  return entries_[type].data();
+}
+
+// Returns the given entry, ready to be replaced, as a vector of its own.
+std::vector<char> &TessdataManager::MutableEntry(TessdataType type) {
+  buffer_sizes_[type] = 0;
+  hashes_[type] = 0;
+  return entries_[type];
+}
+
 // Overwrites a single entry of the given type.
 void TessdataManager::OverwriteEntry(TessdataType type, const char *data,
                                      int size) {
   is_loaded_ = true;
-  entries_[type].resize(size);
-  memcpy(&entries_[type][0], data, size);
+  std::vector<char> &entry = MutableEntry(type);
+  entry.resize(size);
+  memcpy(&entry[0], data, size);
 }
 
 // Saves to the given filename.
@@ -165,11 +321,12 @@ void TessdataManager::Serialize(std::vector<char> *data) const {
   int64_t offset_table[TESSDATA_NUM_ENTRIES];
   int64_t offset = sizeof(int32_t) + sizeof(offset_table);
   for (unsigned i = 0; i < TESSDATA_NUM_ENTRIES; ++i) {
-    if (entries_[i].empty()) {
+    auto type = static_cast<TessdataType>(i);
+    if (!IsComponentAvailable(type)) {
       offset_table[i] = -1;
     } else {
       offset_table[i] = offset;
-      offset += entries_[i].size();
+      offset += EntrySize(type);
     }
   }
   data->resize(offset, 0);
@@ -178,9 +335,10 @@ void TessdataManager::Serialize(std::vector<char> *data) const {
   fp.OpenWrite(data);
   fp.Serialize(&num_entries);
   fp.Serialize(&offset_table[0], countof(offset_table));
-  for (const auto& entry : entries_) {
-    if (!entry.empty()) {
-      fp.Serialize(&entry[0], entry.size());
+  for (unsigned i = 0; i < TESSDATA_NUM_ENTRIES; ++i) {
+    auto type = static_cast<TessdataType>(i);
+    if (IsComponentAvailable(type)) {
+      fp.Serialize(EntryData(type), EntrySize(type));
     }
   }
 }
@@ -190,6 +348,13 @@ void TessdataManager::Clear() {
   for (auto& entry : entries_) {
     entry.clear();
   }
+  for (auto& size : buffer_sizes_) {
+    size = 0;
+  }
+  for (auto& hash : hashes_) {
+    hash = 0;
+  }
+  buffer_.reset();
   is_loaded_ = false;
 }
 
@@ -198,10 +363,11 @@ void TessdataManager::Directory() const {
   tprintf("Version string:%s\n", VersionString().c_str());
   auto offset = TESSDATA_NUM_ENTRIES * sizeof(int64_t);
   for (unsigned i = 0; i < TESSDATA_NUM_ENTRIES; ++i) {
-    if (!entries_[i].empty()) {
+    auto type = static_cast<TessdataType>(i);
+    if (IsComponentAvailable(type)) {
       tprintf("%u:%s:size=%zu, offset=%zu\n", i, kTessdataFileSuffixes[i],
-              entries_[i].size(), offset);
-      offset += entries_[i].size();
+              EntrySize(type), offset);
+      offset += EntrySize(type);
     }
   }
 }
@@ -218,22 +384,39 @@ bool TessdataManager::GetComponent(TessdataType type, TFile *fp) {
 // loaded.
 bool TessdataManager::GetComponent(TessdataType type, TFile *fp) const {
   ASSERT_HOST(is_loaded_);
-  if (entries_[type].empty()) return false;
-  fp->Open(&entries_[type][0], entries_[type].size());
+  if (!IsComponentAvailable(type)) return false;
+  fp->OpenView(EntryData(type), EntrySize(type));
   fp->set_swap(swap_);
   return true;
 }
 
+// Returns a hash of the contents of the given component, or 0 if it isn't
+// available.
+uint64_t TessdataManager::ComponentHash(TessdataType type) {
+  if (!is_loaded_ && !Init(data_file_name_.c_str())) return 0;
+  if (hashes_[type] == 0 && IsComponentAvailable(type)) {
+    // FNV-1a, over the component in place.
+    uint64_t hash = 14695981039346656037ull;
+    const char *data = EntryData(type);
+    for (size_t i = 0, size = EntrySize(type); i < size; ++i) {
+      hash ^= static_cast<unsigned char>(data[i]);
+      hash *= 1099511628211ull;
+    }
+    // 0 means not computed, so it can't be a hash.
+    hashes_[type] = hash != 0 ? hash : 1;
+  }
+  return hashes_[type];
+}
+
 // Returns the current version string.
 std::string TessdataManager::VersionString() const {
-  return std::string(&entries_[TESSDATA_VERSION][0],
-                     entries_[TESSDATA_VERSION].size());
+  return std::string(EntryData(TESSDATA_VERSION), EntrySize(TESSDATA_VERSION));
 }
 
 // Sets the version string to the given v_str.
 void TessdataManager::SetVersionString(const std::string &v_str) {
-  entries_[TESSDATA_VERSION].resize(v_str.size());
-  memcpy(&entries_[TESSDATA_VERSION][0], v_str.data(), v_str.size());
+  std::vector<char> &entry = MutableEntry(TESSDATA_VERSION);
+  entry.assign(v_str.begin(), v_str.end());
 }
 
 bool TessdataManager::CombineDataFiles(
@@ -248,7 +431,7 @@ bool TessdataManager::CombineDataFiles(
     FILE *fp = fopen(filename.c_str(), "rb");
     if (fp != nullptr) {
       fclose(fp);
-      if (!LoadDataFromFile(filename.c_str(), &entries_[type])) {
+      if (!LoadDataFromFile(filename.c_str(), &MutableEntry(type))) {
         tprintf("Load of file %s failed!\n", filename.c_str());
         return false;
       }
@@ -276,7 +459,7 @@ bool TessdataManager::OverwriteComponents(
   for (int i = 0; i < num_new_components; ++i) {
     TessdataType type;
     if (TessdataTypeFromFileName(component_filenames[i], &type)) {
-      if (!LoadDataFromFile(component_filenames[i], &entries_[type])) {
+      if (!LoadDataFromFile(component_filenames[i], &MutableEntry(type))) {
         tprintf("Failed to read component file:%s\n", component_filenames[i]);
         return false;
       }
@@ -291,8 +474,9 @@ bool TessdataManager::ExtractToFile(const char *filename) {
   TessdataType type = TESSDATA_NUM_ENTRIES;
   ASSERT_HOST(
       tesseract::TessdataManager::TessdataTypeFromFileName(filename, &type));
-  if (entries_[type].empty()) return false;
-  return SaveDataToFile(entries_[type], filename);
+  if (!IsComponentAvailable(type)) return false;
+  std::vector<char> data(EntryData(type), EntryData(type) + EntrySize(type));
+  return SaveDataToFile(data, filename);
 }
 
 bool TessdataManager::TessdataTypeFromFileSuffix(const char *suffix,
@@ -21,6 +21,8 @@
 
 #include "serialis.h"          // FileWriter
 #include <tesseract/baseapi.h> // FileReader
+#include <cstdint>             // int64_t
+#include <memory>              // std::shared_ptr
 #include <string>              // std::string
 #include <vector>              // std::vector
 
@@ -124,6 +126,8 @@ static const char *const kTessdataFileSuffixes[] = {
  */
 static const int kMaxNumTessdataEntries = 1000;
 
+class TessdataBuffer;
+
 class TESS_API TessdataManager {
  public:
   TessdataManager();
@@ -139,11 +143,18 @@ class TESS_API TessdataManager {
   void LoadFileLater(const char *data_file_name);
   /**
    * Opens and reads the given data file right now.
+   * Without a reader, the file is mapped into memory read-only if possible,
+   * and the components are read from the mapping. That avoids one read copy
+   * of the file at load time, and nothing more: the consumers deserialize
+   * the components into their own memory, and the mapping is released with
+   * *this (for TessBaseAPI, at the end of Init), so no model memory is
+   * shared between processes. With a reader, as Ghostscript uses, the file
+   * is read into one heap buffer, and the components are read from that.
    * @return true on success.
    */
   bool Init(const char *data_file_name);
   // Loads from the given memory buffer as if a file, remembering name as some
-  // arbitrary source id for caching.
+  // arbitrary source id for caching. The buffer is copied.
   bool LoadMemBuffer(const char *name, const char *data, int size);
   // Overwrites a single entry of the given type.
   void OverwriteEntry(TessdataType type, const char *data, int size);
@@ -160,14 +171,22 @@ class TESS_API TessdataManager {
 
   // Returns true if the component requested is present.
   bool IsComponentAvailable(TessdataType type) const {
-    return !entries_[type].empty();
+    return EntrySize(type) > 0;
   }
+  // Returns true if the file was loaded by mapping it into memory.
+  bool is_mapped() const;
   // Opens the given TFile pointer to the given component type.
+  // The TFile reads the component in place, so it must not be used after
+  // the component is overwritten, or *this is cleared or destroyed.
   // Returns false in case of failure.
   bool GetComponent(TessdataType type, TFile *fp);
   // As non-const version except it can't load the component if not already
   // loaded.
   bool GetComponent(TessdataType type, TFile *fp) const;
+  // Returns a hash of the contents of the given component, or 0 if it isn't
+  // available. It is only computed once, and is kept until the component is
+  // overwritten, or *this is cleared.
+  uint64_t ComponentHash(TessdataType type);
 
   // Returns the current version string.
   std::string VersionString() const;
@@ -176,12 +195,12 @@ class TESS_API TessdataManager {
 
   // Returns true if the base Tesseract components are present.
   bool IsBaseAvailable() const {
-    return !entries_[TESSDATA_UNICHARSET].empty() &&
-           !entries_[TESSDATA_INTTEMP].empty();
+    return IsComponentAvailable(TESSDATA_UNICHARSET) &&
+           IsComponentAvailable(TESSDATA_INTTEMP);
   }
 
   // Returns true if the LSTM components are present.
-  bool IsLSTMAvailable() const { return !entries_[TESSDATA_LSTM].empty(); }
+  bool IsLSTMAvailable() const { return IsComponentAvailable(TESSDATA_LSTM); }
 
   // Return the name of the underlying data file.
   const std::string& GetDataFileName() const { return data_file_name_; }
@@ -219,6 +238,18 @@ class TESS_API TessdataManager {
 
   // Use libarchive.
   bool LoadArchiveFile(const char *filename);
+  // Takes the contents of a traineddata file from the given buffer, without
+  // copying the components out of it.
+  bool LoadBuffer(std::shared_ptr<const TessdataBuffer> buffer);
+  // Returns the start of the contents of the given entry.
+  const char *EntryData(TessdataType type) const;
+  // Returns the size of the contents of the given entry, or 0 if absent.
+  size_t EntrySize(TessdataType type) const {
+    return buffer_sizes_[type] > 0 ? buffer_sizes_[type]
+                                   : entries_[type].size();
+  }
+  // Returns the given entry, ready to be replaced, as a vector of its own.
+  std::vector<char> &MutableEntry(TessdataType type);
 
   /**
    * Fills type with TessdataType of the tessdata component represented by the
@@ -244,8 +275,17 @@ class TESS_API TessdataManager {
   bool is_loaded_;
   // True if the bytes need swapping.
   bool swap_;
-  // Contents of each element of the traineddata file.
+  // Contents of each element of the traineddata file, unless it is in buffer_.
   std::vector<char> entries_[TESSDATA_NUM_ENTRIES];
+  // The traineddata file, if it was loaded whole by Init or LoadMemBuffer.
+  // It is never written, so it may be shared by copies of *this.
+  std::shared_ptr<const TessdataBuffer> buffer_;
+  // Offset and size of each element in buffer_. The size is 0 if the element
+  // is in entries_ instead.
+  int64_t buffer_offsets_[TESSDATA_NUM_ENTRIES];
+  int64_t buffer_sizes_[TESSDATA_NUM_ENTRIES];
+  // Hash of each element computed by ComponentHash, or 0 if not yet computed.
+  uint64_t hashes_[TESSDATA_NUM_ENTRIES];
 };
 
 }  // namespace tesseract
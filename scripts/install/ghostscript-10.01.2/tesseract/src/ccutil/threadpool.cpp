@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////
+// File:        threadpool.cpp
+// Description: A persistent work-stealing pool of worker threads.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include "threadpool.h"
+
+#include <cstdint>              // for int64_t
+
+namespace tesseract {
+
+ThreadPool::ThreadPool(int num_threads)
+    : func_(nullptr), generation_(0), tasks_remaining_(0), shutdown_(false) {
+  if (num_threads < 1) num_threads = 1;
+  for (int i = 0; i < num_threads; ++i) {
+    queues_.emplace_back(new TaskQueue);
+  }
+  // Thread 0 is the caller of ParallelFor, so it needs no worker.
+  for (int i = 1; i < num_threads; ++i) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  work_ready_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::ParallelFor(int count,
+                             const std::function<void(int, int)>& func) {
+  int num_queues = num_threads();
+  if (num_queues <= 1 || count <= 1) {
+    for (int i = 0; i < count; ++i) {
+      func(i, 0);
+    }
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    func_ = &func;
+    tasks_remaining_ = count;
+  }
+  // Deal out contiguous shares, so neighbouring tasks, which are often
+  // similar, tend to run on the same thread.
+  for (int q = 0; q < num_queues; ++q) {
+    int begin = static_cast<int64_t>(count) * q / num_queues;
+    int end = static_cast<int64_t>(count) * (q + 1) / num_queues;
+    std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+    for (int i = begin; i < end; ++i) {
+      queues_[q]->tasks.push_back(i);
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+  }
+  work_ready_.notify_all();
+  while (RunOneTask(0)) {
+  }
+  // Other threads may still be running the last of the stolen tasks.
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this] { return tasks_remaining_ == 0; });
+  func_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop(int thread_id) {
+  int generation = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_ready_.wait(lock, [this, generation] {
+        return shutdown_ || generation_ != generation;
+      });
+      if (shutdown_) return;
+      generation = generation_;
+    }
+    while (RunOneTask(thread_id)) {
+    }
+  }
+}
+
+bool ThreadPool::RunOneTask(int thread_id) {
+  int num_queues = num_threads();
+  int index = -1;
+  for (int offset = 0; offset < num_queues && index < 0; ++offset) {
+    TaskQueue* queue = queues_[(thread_id + offset) % num_queues].get();
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (queue->tasks.empty()) continue;
+    if (offset == 0) {
+      index = queue->tasks.front();
+      queue->tasks.pop_front();
+    } else {
+      index = queue->tasks.back();
+      queue->tasks.pop_back();
+    }
+  }
+  if (index < 0) return false;
+  // func_ was set before the task was queued, and stays valid until all the
+  // tasks are complete, so it can be used without holding mutex_.
+  (*func_)(index, thread_id);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (--tasks_remaining_ == 0) work_done_.notify_all();
+  return true;
+}
+
+}  // namespace tesseract
@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////
+// File:        threadpool.h
+// Description: A persistent work-stealing pool of worker threads.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_CCUTIL_THREADPOOL_H_
+#define TESSERACT_CCUTIL_THREADPOOL_H_
+
+#include <condition_variable>   // for std::condition_variable
+#include <deque>                // for std::deque
+#include <functional>           // for std::function
+#include <memory>               // for std::unique_ptr
+#include <mutex>                // for std::mutex
+#include <thread>               // for std::thread
+#include <vector>               // for std::vector
+
+namespace tesseract {
+
+// A fixed set of worker threads that live as long as the pool, so the cost
+// of creating threads is paid once, not once per page or line.
+// Work is handed out by ParallelFor as a set of integer task indices. Each
+// thread (including the caller) starts with its own contiguous share of the
+// indices in a private deque, and when that runs dry it steals from the far
+// end of another thread's deque, so uneven task costs are balanced out
+// without any central queue.
+// ParallelFor must only be called from one thread at a time, and must not
+// be called from within a task.
+class ThreadPool {
+ public:
+  // Creates a pool that runs tasks on num_threads threads in total, one of
+  // which is always the thread that calls ParallelFor, so num_threads - 1
+  // workers are started. num_threads <= 1 makes a pool that runs everything
+  // serially on the caller.
+  explicit ThreadPool(int num_threads);
+  ~ThreadPool();
+
+  // Returns the total number of threads that may run tasks, including the
+  // caller of ParallelFor.
+  int num_threads() const {
+    return queues_.size();
+  }
+
+  // Calls func(index, thread_id) for every index in [0, count), and returns
+  // when all of them are complete. thread_id is in [0, num_threads()) and
+  // identifies the thread running the task, so func can use it to select
+  // per-thread scratch data. The caller always runs as thread_id 0.
+  void ParallelFor(int count, const std::function<void(int, int)>& func);
+
+ private:
+  // The deque of task indices owned by one thread.
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<int> tasks;
+  };
+
+  // Main loop of each worker thread.
+  void WorkerLoop(int thread_id);
+  // Takes a task, first from the front of the thread's own deque, then from
+  // the back of any other deque, and runs it. Returns false if there was
+  // nothing left to take anywhere.
+  bool RunOneTask(int thread_id);
+
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::vector<std::thread> workers_;
+  // Guards the members below, which control the waking and sleeping of the
+  // workers and the completion of a ParallelFor.
+  std::mutex mutex_;
+  std::condition_variable work_ready_;
+  std::condition_variable work_done_;
+  // The function being run by the current ParallelFor.
+  const std::function<void(int, int)>* func_;
+  // Incremented for each ParallelFor, to wake up the workers.
+  int generation_;
+  // Number of tasks of the current ParallelFor that are not yet complete.
+  int tasks_remaining_;
+  bool shutdown_;
+};
+
+}  // namespace tesseract
+
+#endif  // TESSERACT_CCUTIL_THREADPOOL_H_
@@ -29,6 +29,7 @@
 #include <functional>           // for std::function
 #include <memory>
 #include "elst.h"
+#include "pagearena.h"
 #include "params.h"
 #include "ratngs.h"
 
@@ -370,6 +371,8 @@ struct DawgPosition {
 
 class DawgPositionVector : public GenericVector<DawgPosition> {
  public:
+  TESS_PAGE_ARENA_OPERATORS
+
   /// Adds an entry for the given dawg_index with the given node to the vec.
   /// Returns false if the same entry already exists in the vector,
   /// true otherwise.
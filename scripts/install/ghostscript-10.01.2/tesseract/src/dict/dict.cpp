@@ -415,7 +415,7 @@ int Dict::def_letter_is_okay(void* void_dawg_args, const UNICHARSET& unicharset,
 
   // Initialization.
   PermuterType curr_perm = NO_PERM;
-  dawg_args->updated_dawgs->clear();
+  dawg_args->updated_dawgs->truncate(0);  // Keeps the buffer for reuse.
   dawg_args->valid_end = false;
 
   // Go over the active_dawgs vector and insert DawgPosition records
@@ -55,8 +55,17 @@ void Convolve::Forward(bool debug, const NetworkIO& input,
                        NetworkScratch* scratch, NetworkIO* output) {
   output->Resize(input, no_);
   int y_scale = 2 * half_y_ + 1;
+  // Each image of a batch gets the same noise outside its edges as if it were
+  // run on its own, so batching does not change the results.
+  TRand batch_start_randomizer;
+  if (randomizer_ != nullptr) batch_start_randomizer = *randomizer_;
+  int batch = -1;
   StrideMap::Index dest_index(output->stride_map());
   do {
+    if (randomizer_ != nullptr && dest_index.index(FD_BATCH) != batch) {
+      batch = dest_index.index(FD_BATCH);
+      *randomizer_ = batch_start_randomizer;
+    }
     // Stack x_scale groups of y_scale * ni_ inputs together.
     int t = dest_index.t();
     int out_ix = 0;
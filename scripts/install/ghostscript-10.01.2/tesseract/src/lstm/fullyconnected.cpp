@@ -24,6 +24,7 @@
 #ifdef _OPENMP
 #include <omp.h>
 #endif
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 
@@ -37,6 +38,9 @@ const int kNumThreads = 4;
 const int kNumThreads = 1;
 #endif
 
+// Number of timesteps that Forward runs through the weights together.
+const int kForwardBatch = 16;
+
 namespace tesseract {
 
 FullyConnected::FullyConnected(const std::string& name, int ni, int no,
@@ -100,6 +104,13 @@ void FullyConnected::ConvertToInt() {
   weights_.ConvertToInt();
 }
 
+// Uses the weights of src instead of its own.
+void FullyConnected::ShareWeights(const Network& src) {
+  ASSERT_HOST(src.type() == type_);
+  const auto* fc = static_cast<const FullyConnected*>(&src);
+  weights_.ShareWeights(fc->weights_);
+}
+
 // Provides debug output on the weights.
 void FullyConnected::DebugWeights() {
   weights_.Debug2D(name_.c_str());
@@ -117,6 +128,12 @@ bool FullyConnected::DeSerialize(TFile* fp) {
   return weights_.DeSerialize(IsTraining(), fp);
 }
 
+// As DeSerialize, but uses the weights of src.
+bool FullyConnected::DeSerializeShared(TFile* fp, const Network& src) {
+  const auto* fc = static_cast<const FullyConnected*>(&src);
+  return weights_.DeSerializeShared(IsTraining(), fp, fc->weights_);
+}
+
 // Runs forward propagation of activations on the input line.
 // See NetworkCpp for a detailed discussion of the arguments.
 void FullyConnected::Forward(bool debug, const NetworkIO& input,
@@ -136,29 +153,51 @@ void FullyConnected::Forward(bool debug, const NetworkIO& input,
   if (IntSimdMatrix::intSimdMatrix)
     ro = IntSimdMatrix::intSimdMatrix->RoundOutputs(ro);
   for (int i = 0; i < kNumThreads; ++i) {
-    temp_lines[i].Init(no_, ro, scratch);
-    curr_input[i].Init(ni_, scratch);
+    temp_lines[i].Init(kForwardBatch * ro, scratch);
+    curr_input[i].Init(kForwardBatch * ni_, scratch);
   }
+  // The timesteps are run in batches, so the weights are fetched from memory
+  // once for each batch instead of once for each timestep.
+  int num_batches = (width + kForwardBatch - 1) / kForwardBatch;
 #ifdef _OPENMP
 #pragma omp parallel for num_threads(kNumThreads)
-  for (int t = 0; t < width; ++t) {
+  for (int b = 0; b < num_batches; ++b) {
     // Thread-local pointer to temporary storage.
     int thread_id = omp_get_thread_num();
 #else
-  for (int t = 0; t < width; ++t) {
+  for (int b = 0; b < num_batches; ++b) {
     // Thread-local pointer to temporary storage.
     int thread_id = 0;
 #endif
-    double* temp_line = temp_lines[thread_id];
+    int start = b * kForwardBatch;
+    int num_steps = std::min(kForwardBatch, width - start);
+    int ts[kForwardBatch];
+    const int8_t* i_inputs[kForwardBatch];
+    const double* d_inputs[kForwardBatch];
+    double* temp_line[kForwardBatch];
+    for (int s = 0; s < num_steps; ++s) {
+      int t = start + s;
+      ts[s] = t;
+      temp_line[s] = temp_lines[thread_id] + s * ro;
+      if (input.int_mode()) {
+        i_inputs[s] = input.i(t);
+      } else {
+        double* d_input = curr_input[thread_id] + s * ni_;
+        input.ReadTimeStep(t, d_input);
+        d_inputs[s] = d_input;
+      }
+    }
     if (input.int_mode()) {
-      ForwardTimeStep(input.i(t), t, temp_line);
+      ForwardTimeSteps(num_steps, ts, i_inputs, temp_line);
     } else {
-      input.ReadTimeStep(t, curr_input[thread_id]);
-      ForwardTimeStep(curr_input[thread_id], t, temp_line);
+      ForwardTimeSteps(num_steps, ts, d_inputs, temp_line);
     }
-    output->WriteTimeStep(t, temp_line);
-    if (IsTraining() && type_ != NT_SOFTMAX) {
-      acts_.CopyTimeStepFrom(t, *output, t);
+    for (int s = 0; s < num_steps; ++s) {
+      int t = ts[s];
+      output->WriteTimeStep(t, temp_line[s]);
+      if (IsTraining() && type_ != NT_SOFTMAX) {
+        acts_.CopyTimeStepFrom(t, *output, t);
+      }
     }
   }
   // Zero all the elements that are in the padding around images that allows
@@ -224,6 +263,24 @@ void FullyConnected::ForwardTimeStep(const int8_t* i_input,
   ForwardTimeStep(t, output_line);
 }
 
+void FullyConnected::ForwardTimeSteps(int num_steps, const int* ts,
+                                      const double* const* d_inputs,
+                                      double* const* output_lines) {
+  if (IsTraining() && external_source_ == nullptr) {
+    for (int s = 0; s < num_steps; ++s)
+      source_t_.WriteStrided(ts[s], d_inputs[s]);
+  }
+  weights_.MatrixDotVectors(num_steps, d_inputs, output_lines);
+  for (int s = 0; s < num_steps; ++s) ForwardTimeStep(ts[s], output_lines[s]);
+}
+
+void FullyConnected::ForwardTimeSteps(int num_steps, const int* ts,
+                                      const int8_t* const* i_inputs,
+                                      double* const* output_lines) {
+  weights_.MatrixDotVectors(num_steps, i_inputs, output_lines);
+  for (int s = 0; s < num_steps; ++s) ForwardTimeStep(ts[s], output_lines[s]);
+}
+
 // Runs backward propagation of errors on the deltas line.
 // See NetworkCpp for a detailed discussion of the arguments.
 bool FullyConnected::Backward(bool debug, const NetworkIO& fwd_deltas,
@@ -75,6 +75,9 @@ class FullyConnected : public Network {
   // Converts a float network to an int network.
   void ConvertToInt() override;
 
+  // Uses the weights of src instead of its own. See network.h.
+  void ShareWeights(const Network& src) override;
+
   // Provides debug output on the weights.
   void DebugWeights() override;
 
@@ -82,6 +85,8 @@ class FullyConnected : public Network {
   bool Serialize(TFile* fp) const override;
   // Reads from the given file. Returns false in case of error.
   bool DeSerialize(TFile* fp) override;
+  // As DeSerialize, but uses the weights of src. See network.h.
+  bool DeSerializeShared(TFile* fp, const Network& src) override;
 
   // Runs forward propagation of activations on the input line.
   // See Network for a detailed discussion of the arguments.
@@ -94,6 +99,14 @@ class FullyConnected : public Network {
   void ForwardTimeStep(int t, double* output_line);
   void ForwardTimeStep(const double* d_input, int t, double* output_line);
   void ForwardTimeStep(const int8_t* i_input, int t, double* output_line);
+  // As ForwardTimeStep for each of the num_steps timesteps ts[s], with the
+  // weights applied to all the inputs together.
+  void ForwardTimeSteps(int num_steps, const int* ts,
+                        const double* const* d_inputs,
+                        double* const* output_lines);
+  void ForwardTimeSteps(int num_steps, const int* ts,
+                        const int8_t* const* i_inputs,
+                        double* const* output_lines);
 
   // Runs backward propagation of errors on the deltas line.
   // See Network for a detailed discussion of the arguments.
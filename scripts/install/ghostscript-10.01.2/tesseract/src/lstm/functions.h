@@ -18,7 +18,9 @@
 #ifndef TESSERACT_LSTM_FUNCTIONS_H_
 #define TESSERACT_LSTM_FUNCTIONS_H_
 
+#include "activation.h"
 #include "helpers.h"
+#include "simddetect.h"
 
 // Setting this to 1 or more causes massive dumps of debug data: weights,
 // updates, internal calculations etc, and reduces the number of test iterations
@@ -30,38 +32,6 @@
 
 namespace tesseract {
 
-// Size of static tables.
-constexpr int kTableSize = 4096;
-// Scale factor for float arg to int index.
-constexpr double kScaleFactor = 256.0;
-
-// Generated lookup tables.
-extern const double TanhTable[];
-extern const double LogisticTable[];
-
-// Non-linearity (sigmoid) functions with cache tables and clipping.
-inline double Tanh(double x) {
-  if (x < 0.0) return -Tanh(-x);
-  x *= kScaleFactor;
-  unsigned index = static_cast<unsigned>(x);
-  if (index >= (kTableSize - 1)) return 1.0;
-  double tanh_i0 = TanhTable[index];
-  double tanh_i1 = TanhTable[index + 1];
-  // Linear interpolation.
-  return tanh_i0 + (tanh_i1 - tanh_i0) * (x - index);
-}
-
-inline double Logistic(double x) {
-  if (x < 0.0) return 1.0 - Logistic(-x);
-  x *= kScaleFactor;
-  unsigned index = static_cast<unsigned>(x);
-  if (index >= (kTableSize - 1)) return 1.0;
-  double l0 = LogisticTable[index];
-  double l1 = LogisticTable[index + 1];
-  // Linear interpolation.
-  return l0 + (l1 - l0) * (x - index);
-}
-
 // Non-linearity (sigmoid) functions and their derivatives.
 struct FFunc {
   inline double operator()(double x) const { return Logistic(x); }
@@ -141,6 +111,30 @@ inline void FuncMultiply(const double* u, const double* v, int n, double* out) {
     out[i] = f(u[i]) * v[i];
   }
 }
+// The table-based sigmoid functions have SIMD versions, selected by
+// SIMDDetect, which give identical results to the generic ones above.
+template <>
+inline void FuncInplace<FFunc>(int n, double* inout) {
+  LogisticInPlace(n, inout);
+}
+template <>
+inline void FuncInplace<GFunc>(int n, double* inout) {
+  TanhInPlace(n, inout);
+}
+template <>
+inline void FuncInplace<HFunc>(int n, double* inout) {
+  TanhInPlace(n, inout);
+}
+// Note that out may be u, but not v.
+template <>
+inline void FuncMultiply<HFunc>(const double* u, const double* v, int n,
+                                double* out) {
+  if (out != u) {
+    for (int i = 0; i < n; ++i) out[i] = u[i];
+  }
+  TanhInPlace(n, out);
+  for (int i = 0; i < n; ++i) out[i] *= v[i];
+}
 // Applies the Softmax function in-place to inout, of size n.
 template <typename T>
 inline void SoftmaxInPlace(int n, T* inout) {
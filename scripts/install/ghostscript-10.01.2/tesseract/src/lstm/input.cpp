@@ -110,37 +110,54 @@ Pix* Input::PrepareLSTMInputs(const ImageData& image_data,
 /* static */
 void Input::PreparePixInput(const StaticShape& shape, const Pix* pix,
                             TRand* randomizer, NetworkIO* input) {
+  std::vector<const Pix*> pixes(1, pix);
+  PreparePixInputs(shape, pixes, randomizer, input);
+}
+
+// As PreparePixInput, but converts a whole set of pixes to a single batch
+// in input, with one batch index per pix, in the given order.
+/* static */
+void Input::PreparePixInputs(const StaticShape& shape,
+                             const std::vector<const Pix*>& pixes,
+                             TRand* randomizer, NetworkIO* input) {
   bool color = shape.depth() == 3;
-  Pix* var_pix = const_cast<Pix*>(pix);
-  int depth = pixGetDepth(var_pix);
-  Pix* normed_pix = nullptr;
-  // On input to BaseAPI, an image is forced to be 1, 8 or 24 bit, without
-  // colormap, so we just have to deal with depth conversion here.
-  if (color) {
-    // Force RGB.
-    if (depth == 32)
-      normed_pix = pixClone(var_pix);
-    else
-      normed_pix = pixConvertTo32(var_pix);
-  } else {
-    // Convert non-8-bit images to 8 bit.
-    if (depth == 8)
-      normed_pix = pixClone(var_pix);
-    else
-      normed_pix = pixConvertTo8(var_pix, false);
-  }
-  int height = pixGetHeight(normed_pix);
   int target_height = shape.height();
   if (target_height == 1) target_height = shape.depth();
-  if (target_height != 0 && target_height != height) {
-    // Get the scaled image.
-    float im_factor = static_cast<float>(target_height) / height;
-    Pix* scaled_pix = pixScale(normed_pix, im_factor, im_factor);
-    pixDestroy(&normed_pix);
-    normed_pix = scaled_pix;
+  std::vector<const Pix*> normed_pixes;
+  for (auto pix : pixes) {
+    Pix* var_pix = const_cast<Pix*>(pix);
+    int depth = pixGetDepth(var_pix);
+    Pix* normed_pix = nullptr;
+    // On input to BaseAPI, an image is forced to be 1, 8 or 24 bit, without
+    // colormap, so we just have to deal with depth conversion here.
+    if (color) {
+      // Force RGB.
+      if (depth == 32)
+        normed_pix = pixClone(var_pix);
+      else
+        normed_pix = pixConvertTo32(var_pix);
+    } else {
+      // Convert non-8-bit images to 8 bit.
+      if (depth == 8)
+        normed_pix = pixClone(var_pix);
+      else
+        normed_pix = pixConvertTo8(var_pix, false);
+    }
+    int height = pixGetHeight(normed_pix);
+    if (target_height != 0 && target_height != height) {
+      // Get the scaled image.
+      float im_factor = static_cast<float>(target_height) / height;
+      Pix* scaled_pix = pixScale(normed_pix, im_factor, im_factor);
+      pixDestroy(&normed_pix);
+      normed_pix = scaled_pix;
+    }
+    normed_pixes.push_back(normed_pix);
+  }
+  input->FromPixes(shape, normed_pixes, randomizer);
+  for (auto normed_pix : normed_pixes) {
+    Pix* var_pix = const_cast<Pix*>(normed_pix);
+    pixDestroy(&var_pix);
   }
-  input->FromPix(shape, normed_pix, randomizer);
-  pixDestroy(&normed_pix);
 }
 
 }  // namespace tesseract.
@@ -92,6 +92,11 @@ class Input : public Network {
   // NOTE: It isn't safe for multiple threads to call this on the same pix.
   static void PreparePixInput(const StaticShape& shape, const Pix* pix,
                               TRand* randomizer, NetworkIO* input);
+  // As PreparePixInput, but converts a whole set of pixes to a single batch
+  // in input, with one batch index per pix, in the given order.
+  static void PreparePixInputs(const StaticShape& shape,
+                               const std::vector<const Pix*>& pixes,
+                               TRand* randomizer, NetworkIO* input);
 
  private:
   void DebugWeights() override {
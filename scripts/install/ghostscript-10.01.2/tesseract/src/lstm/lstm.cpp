@@ -24,6 +24,7 @@
 #ifdef _OPENMP
 #include <omp.h>
 #endif
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <sstream>    // for std::ostringstream
@@ -107,6 +108,7 @@ LSTM::LSTM(const std::string& name, int ni, int ns, int no, bool two_dimensional
       ns_(ns),
       nf_(0),
       is_2d_(two_dimensional),
+      fused_stride_(0),
       softmax_(nullptr),
       input_width_(0) {
   if (two_dimensional) na_ += ns_;
@@ -147,6 +149,7 @@ void LSTM::SetEnableTraining(TrainingState state) {
     if (training_ == TS_ENABLED) training_ = state;
   } else {
     if (state == TS_ENABLED && training_ != TS_ENABLED) {
+      UnfuseGateWeights();
       for (int w = 0; w < WT_COUNT; ++w) {
         if (w == GFS && !Is2D()) continue;
         gate_weights_[w].InitBackward();
@@ -189,18 +192,40 @@ void LSTM::ConvertToInt() {
     if (w == GFS && !Is2D()) continue;
     gate_weights_[w].ConvertToInt();
   }
+  FuseGateWeights();
   if (softmax_ != nullptr) {
     softmax_->ConvertToInt();
   }
 }
 
+// Uses the weights of src instead of its own.
+void LSTM::ShareWeights(const Network& src) {
+  ASSERT_HOST(src.type() == type_);
+  const auto* lstm = static_cast<const LSTM*>(&src);
+  for (int w = 0; w < WT_COUNT; ++w) {
+    if (w == GFS && !Is2D()) continue;
+    gate_weights_[w].ShareWeights(lstm->gate_weights_[w]);
+  }
+  if (lstm->fused_stride_ > 0) {
+    fused_stride_ = lstm->fused_stride_;
+    fused_weights_.ShareWeights(lstm->fused_weights_);
+  } else {
+    FuseGateWeights();
+  }
+  if (softmax_ != nullptr) {
+    ASSERT_HOST(lstm->softmax_ != nullptr);
+    softmax_->ShareWeights(*lstm->softmax_);
+  }
+}
+
 // Sets up the network for training using the given weight_range.
 void LSTM::DebugWeights() {
   for (int w = 0; w < WT_COUNT; ++w) {
     if (w == GFS && !Is2D()) continue;
     std::ostringstream msg;
     msg << name_ << " Gate weights " << w;
-    gate_weights_[w].Debug2D(msg.str().c_str());
+    WeightMatrix copy;
+    GateWeights(w, &copy).Debug2D(msg.str().c_str());
   }
   if (softmax_ != nullptr) {
     softmax_->DebugWeights();
@@ -213,7 +238,8 @@ bool LSTM::Serialize(TFile* fp) const {
   if (!fp->Serialize(&na_)) return false;
   for (int w = 0; w < WT_COUNT; ++w) {
     if (w == GFS && !Is2D()) continue;
-    if (!gate_weights_[w].Serialize(IsTraining(), fp)) return false;
+    WeightMatrix copy;
+    if (!GateWeights(w, &copy).Serialize(IsTraining(), fp)) return false;
   }
   if (softmax_ != nullptr && !softmax_->Serialize(fp)) return false;
   return true;
@@ -222,6 +248,17 @@ bool LSTM::Serialize(TFile* fp) const {
 // Reads from the given file. Returns false in case of error.
 
 bool LSTM::DeSerialize(TFile* fp) {
+  return DeSerialize(fp, nullptr);
+}
+
+// As DeSerialize, but uses the weights of src.
+bool LSTM::DeSerializeShared(TFile* fp, const Network& src) {
+  return DeSerialize(fp, static_cast<const LSTM*>(&src));
+}
+
+// Reads from the given file, using the weights of src instead of reading
+// them if it is not null. Returns false in case of error.
+bool LSTM::DeSerialize(TFile* fp, const LSTM* src) {
   if (!fp->DeSerialize(&na_)) return false;
   if (type_ == NT_LSTM_SOFTMAX) {
     nf_ = no_;
@@ -233,15 +270,29 @@ bool LSTM::DeSerialize(TFile* fp) {
   is_2d_ = false;
   for (int w = 0; w < WT_COUNT; ++w) {
     if (w == GFS && !Is2D()) continue;
-    if (!gate_weights_[w].DeSerialize(IsTraining(), fp)) return false;
+    if (src == nullptr) {
+      if (!gate_weights_[w].DeSerialize(IsTraining(), fp)) return false;
+    } else if (!gate_weights_[w].DeSerializeShared(IsTraining(), fp,
+                                                   src->gate_weights_[w])) {
+      return false;
+    }
     if (w == CI) {
-      ns_ = gate_weights_[CI].NumOutputs();
+      // The gates of src may only be kept fused, so it has to supply ns_.
+      ns_ = src != nullptr ? src->ns_ : gate_weights_[CI].NumOutputs();
       is_2d_ = na_ - nf_ == ni_ + 2 * ns_;
     }
   }
+  if (src != nullptr && src->fused_stride_ > 0) {
+    fused_stride_ = src->fused_stride_;
+    fused_weights_.ShareWeights(src->fused_weights_);
+  } else {
+    FuseGateWeights();
+  }
   delete softmax_;
   if (type_ == NT_LSTM_SOFTMAX || type_ == NT_LSTM_SOFTMAX_ENCODED) {
-    softmax_ = static_cast<FullyConnected*>(Network::CreateFromFile(fp));
+    if (src != nullptr && src->softmax_ == nullptr) return false;
+    softmax_ = static_cast<FullyConnected*>(Network::CreateFromFile(
+        fp, src != nullptr ? src->softmax_ : nullptr));
     if (softmax_ == nullptr) return false;
   } else {
     softmax_ = nullptr;
@@ -249,6 +300,138 @@ bool LSTM::DeSerialize(TFile* fp) {
   return true;
 }
 
+// Computes the activated gate values for timestep t of source_ into
+// temp_lines. curr_input must hold timestep t of source_ as floats, and is
+// only used if source_ is not in int mode.
+void LSTM::ForwardGates(int t, const double* curr_input,
+                        NetworkScratch::FloatVec* temp_lines) {
+  PARALLEL_IF_OPENMP(GFS)
+  // It looks inefficient to create the threads on each t iteration, but the
+  // alternative of putting the parallel outside the t loop, a single around
+  // the t-loop and then tasks in place of the sections is a *lot* slower.
+  // Cell inputs.
+  if (source_.int_mode())
+    gate_weights_[CI].MatrixDotVector(source_.i(t), temp_lines[CI]);
+  else
+    gate_weights_[CI].MatrixDotVector(curr_input, temp_lines[CI]);
+  FuncInplace<GFunc>(ns_, temp_lines[CI]);
+
+  SECTION_IF_OPENMP
+  // Input Gates.
+  if (source_.int_mode())
+    gate_weights_[GI].MatrixDotVector(source_.i(t), temp_lines[GI]);
+  else
+    gate_weights_[GI].MatrixDotVector(curr_input, temp_lines[GI]);
+  FuncInplace<FFunc>(ns_, temp_lines[GI]);
+
+  SECTION_IF_OPENMP
+  // 1-D forget gates.
+  if (source_.int_mode())
+    gate_weights_[GF1].MatrixDotVector(source_.i(t), temp_lines[GF1]);
+  else
+    gate_weights_[GF1].MatrixDotVector(curr_input, temp_lines[GF1]);
+  FuncInplace<FFunc>(ns_, temp_lines[GF1]);
+
+  // 2-D forget gates.
+  if (Is2D()) {
+    if (source_.int_mode())
+      gate_weights_[GFS].MatrixDotVector(source_.i(t), temp_lines[GFS]);
+    else
+      gate_weights_[GFS].MatrixDotVector(curr_input, temp_lines[GFS]);
+    FuncInplace<FFunc>(ns_, temp_lines[GFS]);
+  }
+
+  SECTION_IF_OPENMP
+  // Output gates.
+  if (source_.int_mode())
+    gate_weights_[GO].MatrixDotVector(source_.i(t), temp_lines[GO]);
+  else
+    gate_weights_[GO].MatrixDotVector(curr_input, temp_lines[GO]);
+  FuncInplace<FFunc>(ns_, temp_lines[GO]);
+  END_PARALLEL_IF_OPENMP
+}
+
+// Inference-only 1-D timestep. Computes the gates for timestep t of source_,
+// and updates curr_state and curr_output from them. The result is identical
+// to the separate passes used by Forward in training, as the same operations
+// are applied to each element in the same order.
+void LSTM::ForwardCell(int t, const double* curr_input,
+                       NetworkScratch::FloatVec* temp_lines,
+                       double* fused_lines, double* curr_state,
+                       double* curr_output) {
+  if (fused_stride_ == 0) {
+    ForwardGates(t, curr_input, temp_lines);
+    MultiplyVectorsInPlace(ns_, temp_lines[GF1], curr_state);
+    MultiplyAccumulate(ns_, temp_lines[CI], temp_lines[GI], curr_state);
+    ClipVector<double>(ns_, -kStateClip, kStateClip, curr_state);
+    FuncMultiply<HFunc>(curr_state, temp_lines[GO], ns_, curr_output);
+    return;
+  }
+  // A single matrix multiply for all the gates keeps the whole timestep on
+  // one thread, with the input read once, instead of starting a team of
+  // threads for each gate on every timestep.
+  if (source_.int_mode())
+    fused_weights_.MatrixDotVector(source_.i(t), fused_lines);
+  else
+    fused_weights_.MatrixDotVector(curr_input, fused_lines);
+  ForwardFusedCell(fused_lines, curr_state, curr_output);
+}
+
+// Activates the gates computed by fused_weights_ into fused_lines, and
+// updates curr_state and curr_output from them.
+void LSTM::ForwardFusedCell(double* fused_lines, double* curr_state,
+                            double* curr_output) {
+  double* ci = fused_lines + CI * fused_stride_;
+  double* gi = fused_lines + GI * fused_stride_;
+  const double* gf1 = fused_lines + GF1 * fused_stride_;
+  const double* go = fused_lines + GO * fused_stride_;
+  // The sigmoid gates are adjacent, so they are activated together.
+  FuncInplace<GFunc>(ns_, ci);
+  FuncInplace<FFunc>((GO - GI) * fused_stride_ + ns_, gi);
+  for (int i = 0; i < ns_; ++i) {
+    double state = curr_state[i] * gf1[i];
+    state += ci[i] * gi[i];
+    curr_state[i] = ClipToRange<double>(state, -kStateClip, kStateClip);
+  }
+  FuncMultiply<HFunc>(curr_state, go, ns_, curr_output);
+}
+
+// Builds fused_weights_ from the 1-D gate weights, or clears it if the
+// fused path is not applicable.
+void LSTM::FuseGateWeights() {
+  if (Is2D()) {
+    fused_stride_ = 0;
+    return;
+  }
+  if (GatesFused()) return;
+  fused_stride_ = gate_weights_[CI].RoundOutputs(ns_);
+  fused_weights_.StackOutputs({&gate_weights_[CI], &gate_weights_[GI],
+                               &gate_weights_[GF1], &gate_weights_[GO]},
+                              fused_stride_);
+  // An int network is only run by ForwardCell, which doesn't need the
+  // separate gates, so don't keep the weights twice.
+  if (fused_weights_.is_int_mode()) {
+    for (int w = 0; w < GFS; ++w) gate_weights_[w].FreeWeights();
+  }
+}
+
+// Rebuilds the 1-D gate weights from fused_weights_ if they are only kept
+// there.
+void LSTM::UnfuseGateWeights() {
+  if (!GatesFused()) return;
+  for (int w = 0; w < GFS; ++w) {
+    gate_weights_[w].UnstackOutputs(fused_weights_, w, fused_stride_, ns_);
+  }
+}
+
+// Returns gate_weights_[w], or if it is only kept fused, a copy of it made
+// in *copy.
+const WeightMatrix& LSTM::GateWeights(int w, WeightMatrix* copy) const {
+  if (w >= GFS || !GatesFused()) return gate_weights_[w];
+  copy->UnstackOutputs(fused_weights_, w, fused_stride_, ns_);
+  return *copy;
+}
+
 // Runs forward propagation of activations on the input line.
 // See NetworkCpp for a detailed discussion of the arguments.
 void LSTM::Forward(bool debug, const NetworkIO& input,
@@ -263,12 +446,23 @@ void LSTM::Forward(bool debug, const NetworkIO& input,
   else
     output->Resize(input, no_);
   ResizeForward(input);
+  if (!Is2D() && !IsTraining() &&
+      input_map_.Size(FD_BATCH) * input_map_.Size(FD_HEIGHT) > 1) {
+    ForwardRows(input, scratch, output);
+#ifndef GRAPHICS_DISABLED
+    if (debug) DisplayForward(*output);
+#endif
+    return;
+  }
   // Temporary storage of forward computation for each gate.
   NetworkScratch::FloatVec temp_lines[WT_COUNT];
   int ro = ns_;
   if (source_.int_mode() && IntSimdMatrix::intSimdMatrix)
     ro = IntSimdMatrix::intSimdMatrix->RoundOutputs(ro);
   for (auto & temp_line : temp_lines) temp_line.Init(ns_, ro, scratch);
+  // Output of fused_weights_, used only by ForwardCell.
+  NetworkScratch::FloatVec fused_lines;
+  if (fused_stride_ > 0) fused_lines.Init(GFS * fused_stride_, scratch);
   // Single timestep buffers for the current/recurrent output and state.
   NetworkScratch::FloatVec curr_state, curr_output;
   curr_state.Init(ns_, scratch);
@@ -325,80 +519,42 @@ void LSTM::Forward(bool debug, const NetworkIO& input,
     if (Is2D())
       source_.WriteTimeStepPart(t, ni_ + nf_ + ns_, ns_, outputs[mod_t]);
     if (!source_.int_mode()) source_.ReadTimeStep(t, curr_input);
-    // Matrix multiply the inputs with the source.
-    PARALLEL_IF_OPENMP(GFS)
-    // It looks inefficient to create the threads on each t iteration, but the
-    // alternative of putting the parallel outside the t loop, a single around
-    // the t-loop and then tasks in place of the sections is a *lot* slower.
-    // Cell inputs.
-    if (source_.int_mode())
-      gate_weights_[CI].MatrixDotVector(source_.i(t), temp_lines[CI]);
-    else
-      gate_weights_[CI].MatrixDotVector(curr_input, temp_lines[CI]);
-    FuncInplace<GFunc>(ns_, temp_lines[CI]);
-
-    SECTION_IF_OPENMP
-    // Input Gates.
-    if (source_.int_mode())
-      gate_weights_[GI].MatrixDotVector(source_.i(t), temp_lines[GI]);
-    else
-      gate_weights_[GI].MatrixDotVector(curr_input, temp_lines[GI]);
-    FuncInplace<FFunc>(ns_, temp_lines[GI]);
-
-    SECTION_IF_OPENMP
-    // 1-D forget gates.
-    if (source_.int_mode())
-      gate_weights_[GF1].MatrixDotVector(source_.i(t), temp_lines[GF1]);
-    else
-      gate_weights_[GF1].MatrixDotVector(curr_input, temp_lines[GF1]);
-    FuncInplace<FFunc>(ns_, temp_lines[GF1]);
-
-    // 2-D forget gates.
-    if (Is2D()) {
-      if (source_.int_mode())
-        gate_weights_[GFS].MatrixDotVector(source_.i(t), temp_lines[GFS]);
-      else
-        gate_weights_[GFS].MatrixDotVector(curr_input, temp_lines[GFS]);
-      FuncInplace<FFunc>(ns_, temp_lines[GFS]);
-    }
-
-    SECTION_IF_OPENMP
-    // Output gates.
-    if (source_.int_mode())
-      gate_weights_[GO].MatrixDotVector(source_.i(t), temp_lines[GO]);
-    else
-      gate_weights_[GO].MatrixDotVector(curr_input, temp_lines[GO]);
-    FuncInplace<FFunc>(ns_, temp_lines[GO]);
-    END_PARALLEL_IF_OPENMP
+    if (!Is2D() && !IsTraining()) {
+      ForwardCell(t, curr_input, temp_lines, fused_lines, curr_state,
+                  curr_output);
+    } else {
+      // Matrix multiply the inputs with the source.
+      ForwardGates(t, curr_input, temp_lines);
 
-    // Apply forget gate to state.
-    MultiplyVectorsInPlace(ns_, temp_lines[GF1], curr_state);
-    if (Is2D()) {
-      // Max-pool the forget gates (in 2-d) instead of blindly adding.
-      int8_t* which_fg_col = which_fg_[t];
-      memset(which_fg_col, 1, ns_ * sizeof(which_fg_col[0]));
-      if (valid_2d) {
-        const double* stepped_state = states[mod_t];
-        for (int i = 0; i < ns_; ++i) {
-          if (temp_lines[GF1][i] < temp_lines[GFS][i]) {
-            curr_state[i] = temp_lines[GFS][i] * stepped_state[i];
-            which_fg_col[i] = 2;
+      // Apply forget gate to state.
+      MultiplyVectorsInPlace(ns_, temp_lines[GF1], curr_state);
+      if (Is2D()) {
+        // Max-pool the forget gates (in 2-d) instead of blindly adding.
+        int8_t* which_fg_col = which_fg_[t];
+        memset(which_fg_col, 1, ns_ * sizeof(which_fg_col[0]));
+        if (valid_2d) {
+          const double* stepped_state = states[mod_t];
+          for (int i = 0; i < ns_; ++i) {
+            if (temp_lines[GF1][i] < temp_lines[GFS][i]) {
+              curr_state[i] = temp_lines[GFS][i] * stepped_state[i];
+              which_fg_col[i] = 2;
+            }
           }
         }
       }
+      MultiplyAccumulate(ns_, temp_lines[CI], temp_lines[GI], curr_state);
+      // Clip curr_state to a sane range.
+      ClipVector<double>(ns_, -kStateClip, kStateClip, curr_state);
+      if (IsTraining()) {
+        // Save the gate node values.
+        node_values_[CI].WriteTimeStep(t, temp_lines[CI]);
+        node_values_[GI].WriteTimeStep(t, temp_lines[GI]);
+        node_values_[GF1].WriteTimeStep(t, temp_lines[GF1]);
+        node_values_[GO].WriteTimeStep(t, temp_lines[GO]);
+        if (Is2D()) node_values_[GFS].WriteTimeStep(t, temp_lines[GFS]);
+      }
+      FuncMultiply<HFunc>(curr_state, temp_lines[GO], ns_, curr_output);
     }
-    MultiplyAccumulate(ns_, temp_lines[CI], temp_lines[GI], curr_state);
-    // Clip curr_state to a sane range.
-    ClipVector<double>(ns_, -kStateClip, kStateClip, curr_state);
-    if (IsTraining()) {
-      // Save the gate node values.
-      node_values_[CI].WriteTimeStep(t, temp_lines[CI]);
-      node_values_[GI].WriteTimeStep(t, temp_lines[GI]);
-      node_values_[GF1].WriteTimeStep(t, temp_lines[GF1]);
-      node_values_[GO].WriteTimeStep(t, temp_lines[GO]);
-      if (Is2D()) node_values_[GFS].WriteTimeStep(t, temp_lines[GFS]);
-    }
-    FuncMultiply<HFunc>(curr_state, temp_lines[GO], ns_, curr_output);
     if (IsTraining()) state_.WriteTimeStep(t, curr_state);
     if (softmax_ != nullptr) {
       if (input.int_mode()) {
@@ -445,6 +601,159 @@ void LSTM::Forward(bool debug, const NetworkIO& input,
 #endif
 }
 
+// Inference-only Forward of a 1-D LSTM on an input with multiple rows
+// (batch and/or y). The rows are all stepped together one x position at a
+// time, and the fused gate weights, and the softmax weights if any, are
+// applied to all the rows in a single MatrixDotVectors, so they are fetched
+// from memory once for each x instead of once for each row.
+// The result is identical to Forward, as each row has independent state.
+void LSTM::ForwardRows(const NetworkIO& input, NetworkScratch* scratch,
+                       NetworkIO* output) {
+  // Find the start and width of each row of the input, and its destination
+  // in the output if NT_LSTM_SUMMARY.
+  std::vector<int> row_starts, row_widths, row_dests;
+  StrideMap::Index b_index(input_map_);
+  do {
+    StrideMap::Index y_index(b_index);
+    do {
+      row_starts.push_back(y_index.t());
+      row_widths.push_back(y_index.MaxIndexOfDim(FD_WIDTH) + 1);
+      StrideMap::Index dest_index(output->stride_map(),
+                                  y_index.index(FD_BATCH),
+                                  y_index.index(FD_HEIGHT), 0);
+      row_dests.push_back(dest_index.t());
+    } while (y_index.AddOffset(1, FD_HEIGHT));
+  } while (b_index.AddOffset(1, FD_BATCH));
+  int num_rows = row_starts.size();
+  int max_width = 0;
+  for (int width : row_widths) max_width = std::max(max_width, width);
+  // Temporary storage of forward computation for each gate, used only by
+  // ForwardCell if the gates are not fused, and shared by all the rows.
+  NetworkScratch::FloatVec temp_lines[WT_COUNT];
+  int ro = ns_;
+  if (source_.int_mode() && IntSimdMatrix::intSimdMatrix)
+    ro = IntSimdMatrix::intSimdMatrix->RoundOutputs(ro);
+  for (auto & temp_line : temp_lines) temp_line.Init(ns_, ro, scratch);
+  // Output of fused_weights_ for every row.
+  int fused_size = GFS * fused_stride_;
+  NetworkScratch::FloatVec fused_lines;
+  if (fused_stride_ > 0) fused_lines.Init(num_rows * fused_size, scratch);
+  // Recurrent state and output for every row, packed row by row.
+  NetworkScratch::FloatVec states, outputs;
+  states.Init(num_rows * ns_, scratch);
+  ZeroVector<double>(num_rows * ns_, states);
+  outputs.Init(num_rows * ns_, scratch);
+  ZeroVector<double>(num_rows * ns_, outputs);
+  // Used only if a softmax LSTM. The int matrix multiply writes whole
+  // registers, so each row has its outputs rounded up to suit.
+  NetworkScratch::FloatVec softmax_outputs;
+  NetworkScratch::IO int_output;
+  int softmax_stride = no_;
+  if (input.int_mode() && IntSimdMatrix::intSimdMatrix)
+    softmax_stride = IntSimdMatrix::intSimdMatrix->RoundOutputs(no_);
+  if (softmax_ != nullptr) {
+    softmax_outputs.Init(num_rows * softmax_stride, scratch);
+    ZeroVector<double>(num_rows * softmax_stride, softmax_outputs);
+    int rounded_softmax_inputs = gate_weights_[CI].RoundInputs(ns_);
+    if (input.int_mode())
+      int_output.Resize2d(true, num_rows, rounded_softmax_inputs, scratch);
+    softmax_->SetupForward(input, nullptr);
+  }
+  // Float input of every row, used only if source_ is not in int mode.
+  NetworkScratch::FloatVec curr_inputs;
+  curr_inputs.Init(num_rows * na_, scratch);
+  // The rows that are still running at each x, their timesteps, and the
+  // vectors passed to MatrixDotVectors for them.
+  std::vector<int> rows, ts;
+  std::vector<const double*> d_inputs;
+  std::vector<const int8_t*> i_inputs;
+  std::vector<double*> lines, softmax_lines;
+  for (int x = 0; x < max_width; ++x) {
+    rows.clear();
+    for (int r = 0; r < num_rows; ++r) {
+      if (x < row_widths[r]) rows.push_back(r);
+    }
+    int num_active = rows.size();
+    ts.resize(num_active);
+    d_inputs.resize(num_active);
+    i_inputs.resize(num_active);
+    lines.resize(num_active);
+    softmax_lines.resize(num_active);
+    for (int i = 0; i < num_active; ++i) {
+      int r = rows[i];
+      int t = row_starts[r] + x;
+      ts[i] = t;
+      softmax_lines[i] =
+          softmax_ != nullptr ? softmax_outputs + r * softmax_stride : nullptr;
+      // Setup the padded input in source.
+      source_.CopyTimeStepGeneral(t, 0, ni_, input, t, 0);
+      if (softmax_ != nullptr) {
+        source_.WriteTimeStepPart(t, ni_, nf_, softmax_lines[i]);
+      }
+      source_.WriteTimeStepPart(t, ni_ + nf_, ns_, outputs + r * ns_);
+      if (source_.int_mode()) {
+        i_inputs[i] = source_.i(t);
+      } else {
+        double* curr_input = curr_inputs + i * na_;
+        source_.ReadTimeStep(t, curr_input);
+        d_inputs[i] = curr_input;
+      }
+    }
+    if (fused_stride_ > 0) {
+      for (int i = 0; i < num_active; ++i) {
+        lines[i] = fused_lines + i * fused_size;
+      }
+      if (source_.int_mode())
+        fused_weights_.MatrixDotVectors(num_active, &i_inputs[0], &lines[0]);
+      else
+        fused_weights_.MatrixDotVectors(num_active, &d_inputs[0], &lines[0]);
+      for (int i = 0; i < num_active; ++i) {
+        int r = rows[i];
+        ForwardFusedCell(lines[i], states + r * ns_, outputs + r * ns_);
+      }
+    } else {
+      for (int i = 0; i < num_active; ++i) {
+        int r = rows[i];
+        ForwardCell(ts[i], d_inputs[i], temp_lines, nullptr, states + r * ns_,
+                    outputs + r * ns_);
+      }
+    }
+    if (softmax_ != nullptr) {
+      for (int i = 0; i < num_active; ++i) {
+        double* curr_output = outputs + rows[i] * ns_;
+        if (input.int_mode()) {
+          int_output->WriteTimeStepPart(i, 0, ns_, curr_output);
+          i_inputs[i] = int_output->i(i);
+        } else {
+          d_inputs[i] = curr_output;
+        }
+      }
+      if (input.int_mode())
+        softmax_->ForwardTimeSteps(num_active, &ts[0], &i_inputs[0],
+                                   &softmax_lines[0]);
+      else
+        softmax_->ForwardTimeSteps(num_active, &ts[0], &d_inputs[0],
+                                   &softmax_lines[0]);
+    }
+    for (int i = 0; i < num_active; ++i) {
+      int r = rows[i];
+      int t = ts[i];
+      if (softmax_ != nullptr) {
+        output->WriteTimeStep(t, softmax_lines[i]);
+        if (type_ == NT_LSTM_SOFTMAX_ENCODED) {
+          CodeInBinary(no_, nf_, softmax_lines[i]);
+        }
+      } else if (type_ == NT_LSTM_SUMMARY) {
+        // Output only at the end of a row.
+        if (x + 1 == row_widths[r])
+          output->WriteTimeStep(row_dests[r], outputs + r * ns_);
+      } else {
+        output->WriteTimeStep(t, outputs + r * ns_);
+      }
+    }
+  }
+}
+
 // Runs backward propagation of errors on the deltas line.
 // See NetworkCpp for a detailed discussion of the arguments.
 bool LSTM::Backward(bool debug, const NetworkIO& fwd_deltas,
@@ -684,6 +993,8 @@ void LSTM::Update(float learning_rate, float momentum, float adam_beta,
     if (w == GFS && !Is2D()) continue;
     gate_weights_[w].Update(learning_rate, momentum, adam_beta, num_samples);
   }
+  // The fused copy is now out of date.
+  fused_stride_ = 0;
   if (softmax_ != nullptr) {
     softmax_->Update(learning_rate, momentum, adam_beta, num_samples);
   }
@@ -20,6 +20,7 @@
 
 #include "network.h"
 #include "fullyconnected.h"
+#include "networkscratch.h"
 
 namespace tesseract {
 
@@ -83,6 +84,9 @@ class LSTM : public Network {
   // Converts a float network to an int network.
   void ConvertToInt() override;
 
+  // Uses the weights of src instead of its own. See network.h.
+  void ShareWeights(const Network& src) override;
+
   // Provides debug output on the weights.
   void DebugWeights() override;
 
@@ -90,6 +94,8 @@ class LSTM : public Network {
   bool Serialize(TFile* fp) const override;
   // Reads from the given file. Returns false in case of error.
   bool DeSerialize(TFile* fp) override;
+  // As DeSerialize, but uses the weights of src. See network.h.
+  bool DeSerializeShared(TFile* fp, const Network& src) override;
 
   // Runs forward propagation of activations on the input line.
   // See Network for a detailed discussion of the arguments.
@@ -123,8 +129,50 @@ class LSTM : public Network {
  private:
   // Resizes forward data to cope with an input image of the given width.
   void ResizeForward(const NetworkIO& input);
+  // Computes the activated gate values for timestep t of source_ into
+  // temp_lines. curr_input must hold timestep t of source_ as floats, and is
+  // only used if source_ is not in int mode.
+  void ForwardGates(int t, const double* curr_input,
+                    NetworkScratch::FloatVec* temp_lines);
+  // Inference-only 1-D timestep. Computes the gates for timestep t of source_,
+  // and updates curr_state and curr_output from them. With fused_weights_,
+  // all the gates come from a single matrix multiply into fused_lines, and are
+  // activated with as few calls as possible. Otherwise uses ForwardGates and
+  // temp_lines.
+  void ForwardCell(int t, const double* curr_input,
+                   NetworkScratch::FloatVec* temp_lines, double* fused_lines,
+                   double* curr_state, double* curr_output);
+  // Activates the gates computed by fused_weights_ into fused_lines, and
+  // updates curr_state and curr_output from them, as the rest of ForwardCell.
+  void ForwardFusedCell(double* fused_lines, double* curr_state,
+                        double* curr_output);
+  // Builds fused_weights_ from the 1-D gate weights, or clears it if the
+  // fused path is not applicable.
+  void FuseGateWeights();
+  // Returns true if the 1-D gate weights are only kept in fused_weights_.
+  bool GatesFused() const {
+    return fused_stride_ > 0 && gate_weights_[CI].NumOutputs() == 0;
+  }
+  // Rebuilds the 1-D gate weights from fused_weights_ if they are only kept
+  // there, as training needs them separately.
+  void UnfuseGateWeights();
+  // Returns gate_weights_[w], or if it is only kept fused, a copy of it made
+  // in *copy.
+  const WeightMatrix& GateWeights(int w, WeightMatrix* copy) const;
+  // Inference-only Forward of a 1-D LSTM on an input with multiple rows
+  // (batch and/or y). The rows are all stepped together one x position at a
+  // time, and the fused gate weights, and the softmax weights if any, are
+  // applied to all the rows in a single MatrixDotVectors, so they are fetched
+  // from memory once for each x instead of once for each row.
+  // The result is identical to Forward, as each row has independent state.
+  void ForwardRows(const NetworkIO& input, NetworkScratch* scratch,
+                   NetworkIO* output);
 
  private:
+  // Reads from the given file, using the weights of src instead of reading
+  // them if it is not null. Returns false in case of error.
+  bool DeSerialize(TFile* fp, const LSTM* src);
+
   // Size of padded input to weight matrices = ni_ + no_ for 1-D operation
   // and ni_ + 2 * no_ for 2-D operation. Note that there is a phantom 1 input
   // for the bias that makes the weight matrices of size [na + 1][no].
@@ -141,6 +189,15 @@ class LSTM : public Network {
 
   // Gate weight arrays of size [na + 1, no].
   WeightMatrix gate_weights_[WT_COUNT];
+  // Inference-only copy of the 1-D gate weights (CI, GI, GF1, GO, which are
+  // the first GFS WeightTypes) stacked into a single matrix, with each gate
+  // padded to fused_stride_ outputs. Not serialized, but rebuilt from
+  // gate_weights_ on load and discarded by Update. In int mode it is the only
+  // copy, and the 1-D gate_weights_ are freed until training needs them.
+  WeightMatrix fused_weights_;
+  // Offset between the gates in the output of fused_weights_, or 0 if
+  // fused_weights_ is not in use.
+  int fused_stride_;
   // Used only if this is a softmax LSTM.
   FullyConnected* softmax_;
   // Input padded with previous output of size [width, na].
@@ -29,14 +29,17 @@
 #include "imagedata.h"
 #include "input.h"
 #include "lstm.h"
+#include "networkcache.h"
 #include "normalis.h"
 #include "pageres.h"
 #include "ratngs.h"
 #include "recodebeam.h"
 #include "scrollview.h"
 #include "statistc.h"
+#include "threadpool.h"
 #include "tprintf.h"
 
+#include <algorithm>
 #include <unordered_set>
 #include <vector>
 
@@ -54,6 +57,7 @@ LSTMRecognizer::LSTMRecognizer(const char* language_data_path_prefix)
 
 LSTMRecognizer::LSTMRecognizer()
     : network_(nullptr),
+      shared_network_(nullptr),
       training_flags_(0),
       training_iteration_(0),
       sample_iteration_(0),
@@ -63,10 +67,15 @@ LSTMRecognizer::LSTMRecognizer()
       adam_beta_(0.0f),
       dict_(nullptr),
       search_(nullptr),
+      inverted_tries_(0),
+      inverted_wins_(0),
+      prune_contexts_(false),
       debug_win_(nullptr) {}
 
 LSTMRecognizer::~LSTMRecognizer() {
+  replicas_.clear();
   delete network_;
+  ReleaseSharedNetwork();
   delete dict_;
   delete search_;
 }
@@ -76,7 +85,11 @@ bool LSTMRecognizer::Load(const ParamsVectors* params, const char* lang,
                           TessdataManager* mgr) {
   TFile fp;
   if (!mgr->GetComponent(TESSDATA_LSTM, &fp)) return false;
-  if (!DeSerialize(mgr, &fp)) return false;
+  // The weights come from the cache, so network_ only reads its structure.
+  if (!DeSerialize(mgr, &fp,
+                   NetworkCache::GlobalNetworkCache()->GetNetwork(mgr))) {
+    return false;
+  }
   if (lang == nullptr) return true;
   // Allow it to run without a dictionary.
   LoadDictionary(params, lang, mgr);
@@ -104,8 +117,18 @@ bool LSTMRecognizer::Serialize(const TessdataManager* mgr, TFile* fp) const {
 
 // Reads from the given file. Returns false in case of error.
 bool LSTMRecognizer::DeSerialize(const TessdataManager* mgr, TFile* fp) {
+  return DeSerialize(mgr, fp, nullptr);
+}
+
+// As DeSerialize, but network_ uses the weights of shared, if not null, which
+// is a network from the NetworkCache that *this gives back when done with it.
+bool LSTMRecognizer::DeSerialize(const TessdataManager* mgr, TFile* fp,
+                                 const Network* shared) {
+  replicas_.clear();
   delete network_;
-  network_ = Network::CreateFromFile(fp);
+  ReleaseSharedNetwork();
+  shared_network_ = shared;
+  network_ = Network::CreateFromFile(fp, shared);
   if (network_ == nullptr) return false;
   bool include_charsets = mgr == nullptr ||
                           !mgr->IsComponentAvailable(TESSDATA_LSTM_RECODER) ||
@@ -127,6 +150,14 @@ bool LSTMRecognizer::DeSerialize(const TessdataManager* mgr, TFile* fp) {
   return true;
 }
 
+// Gives back shared_network_ to the global NetworkCache.
+void LSTMRecognizer::ReleaseSharedNetwork() {
+  if (shared_network_ != nullptr) {
+    NetworkCache::GlobalNetworkCache()->FreeNetwork(shared_network_);
+    shared_network_ = nullptr;
+  }
+}
+
 // Loads the charsets from mgr.
 bool LSTMRecognizer::LoadCharsets(const TessdataManager* mgr) {
   TFile fp;
@@ -194,10 +225,23 @@ void LSTMRecognizer::RecognizeLine(const ImageData& image_data, bool invert,
   if (!RecognizeLine(image_data, invert, debug, false, false, &scale_factor,
                      &inputs, &outputs))
     return;
+  DecodeLine(outputs, scale_factor, debug, worst_dict_cert, line_box, words,
+             lstm_choice_mode, lstm_choice_amount);
+}
+
+// Decodes the outputs of the network for a single line, from RecognizeLine,
+// or from RecognizeLines, into recognized WERD_RES in words.
+void LSTMRecognizer::DecodeLine(const NetworkIO& outputs, float scale_factor,
+                                bool debug, double worst_dict_cert,
+                                const TBOX& line_box,
+                                PointerVector<WERD_RES>* words,
+                                int lstm_choice_mode,
+                                int lstm_choice_amount) {
   if (search_ == nullptr) {
     search_ =
         new RecodeBeamSearch(recoder_, null_char_, SimpleTextOutput(), dict_);
   }
+  search_->set_prune_contexts(prune_contexts_);
   search_->excludedUnichars.clear();
   search_->Decode(outputs, kDictRatio, kCertOffset, worst_dict_cert,
                   &GetUnicharset(), lstm_choice_mode);
@@ -232,6 +276,154 @@ void LSTMRecognizer::RecognizeLine(const ImageData& image_data, bool invert,
   }
 }
 
+// Runs the network on many line images at once, filling results with the
+// outputs for each of images, in order.
+void LSTMRecognizer::RecognizeLines(const std::vector<const ImageData*>& images,
+                                    const std::vector<bool>& invert,
+                                    int batch_size, ThreadPool* pool,
+                                    std::vector<LSTMLineOutputs>* results) {
+  results->clear();
+  results->resize(images.size());
+  int min_width = network_->XScaleFactor();
+  std::vector<Pix*> pixes(images.size(), nullptr);
+  std::vector<int> lines;
+  for (size_t i = 0; i < images.size(); ++i) {
+    // This ensures consistent recognition results.
+    SetRandomSeed();
+    float scale_factor;
+    pixes[i] = Input::PrepareLSTMInputs(*images[i], network_, min_width,
+                                        &randomizer_, &scale_factor);
+    if (pixes[i] == nullptr) {
+      tprintf("Line cannot be recognized!!\n");
+      continue;
+    }
+    // Reduction factor from image to coords.
+    (*results)[i].scale_factor = min_width / scale_factor;
+    (*results)[i].valid = true;
+    lines.push_back(i);
+  }
+  // Sort by width, so each batch holds lines of similar width, which
+  // minimizes the padding that the network has to process.
+  std::stable_sort(lines.begin(), lines.end(), [&pixes](int a, int b) {
+    return pixGetWidth(pixes[a]) < pixGetWidth(pixes[b]);
+  });
+  std::vector<NetworkIO> outputs(images.size());
+  ForwardBatches(pixes, lines, batch_size, pool, &outputs);
+  // Check for auto inversion, as RecognizeLine, but with all the lines that
+  // need to be tried inverted run together.
+  std::vector<int> inv_lines;
+  std::vector<float> pos_means(images.size(), 0.0f);
+  for (int line : lines) {
+    float pos_min, pos_sd;
+    OutputStats(outputs[line], &pos_min, &pos_means[line], &pos_sd);
+    if (invert[line] && pos_means[line] < 0.5) {
+      pixInvert(pixes[line], pixes[line]);
+      inv_lines.push_back(line);
+    }
+  }
+  std::vector<NetworkIO> inv_outputs(images.size());
+  ForwardBatches(pixes, inv_lines, batch_size, pool, &inv_outputs);
+  inverted_tries_ += inv_lines.size();
+  for (int line : inv_lines) {
+    float inv_min, inv_mean, inv_sd;
+    OutputStats(inv_outputs[line], &inv_min, &inv_mean, &inv_sd);
+    // Use the inverted data only if it did better.
+    if (inv_mean > pos_means[line]) {
+      outputs[line] = inv_outputs[line];
+      ++inverted_wins_;
+    }
+  }
+  for (int line : lines) {
+    (*results)[line].outputs = outputs[line];
+    pixDestroy(&pixes[line]);
+  }
+}
+
+// Helper for RecognizeLines runs the network on the given subset of pixes,
+// identified by index in lines, and stores the outputs of each in outputs.
+void LSTMRecognizer::ForwardBatches(const std::vector<Pix*>& pixes,
+                                    const std::vector<int>& lines,
+                                    int batch_size, ThreadPool* pool,
+                                    std::vector<NetworkIO>* outputs) {
+  // Max ratio of the widest to the narrowest line in a batch. Wider lines
+  // start a new batch, as the padding of the narrow lines is wasted effort.
+  const int kMaxBatchWidthRatio = 2;
+  if (batch_size < 1) batch_size = 1;
+  // Split the lines into batches and prepare the inputs of each up front, so
+  // only the network runs in the threads of the pool.
+  std::vector<int> batch_starts;
+  std::vector<NetworkIO> batch_inputs;
+  batch_inputs.reserve(lines.size());
+  const int num_lines = lines.size();
+  int start = 0;
+  while (start < num_lines) {
+    int end = start + 1;
+    int max_width = kMaxBatchWidthRatio * pixGetWidth(pixes[lines[start]]);
+    while (end < num_lines && end - start < batch_size &&
+           pixGetWidth(pixes[lines[end]]) <= max_width) {
+      ++end;
+    }
+    std::vector<const Pix*> batch_pixes;
+    for (int i = start; i < end; ++i) batch_pixes.push_back(pixes[lines[i]]);
+    batch_inputs.emplace_back();
+    batch_inputs.back().set_int_mode(IsIntMode());
+    Input::PreparePixInputs(network_->InputShape(), batch_pixes, &randomizer_,
+                            &batch_inputs.back());
+    batch_starts.push_back(start);
+    start = end;
+  }
+  batch_starts.push_back(num_lines);
+  int num_batches = batch_inputs.size();
+  SetupReplicas(pool != nullptr ? pool->num_threads() : 1);
+  auto forward_batch = [&](int b, int thread_id) {
+    Network* network = network_;
+    NetworkScratch* scratch = &scratch_space_;
+    TRand* randomizer = &randomizer_;
+    if (thread_id > 0) {
+      NetworkReplica* replica = replicas_[thread_id - 1].get();
+      network = replica->network;
+      scratch = &replica->scratch;
+      randomizer = &replica->randomizer;
+    }
+    // Seed after the noise in the padding of the inputs, so the network sees
+    // the same random sequence for each line as RecognizeLine would give.
+    SetRandomSeed(randomizer);
+    NetworkIO batch_outputs;
+    network->Forward(false, batch_inputs[b], nullptr, scratch, &batch_outputs);
+    for (int i = batch_starts[b]; i < batch_starts[b + 1]; ++i) {
+      (*outputs)[lines[i]].CopyBatchItem(batch_outputs, i - batch_starts[b]);
+    }
+  };
+  if (pool != nullptr) {
+    pool->ParallelFor(num_batches, forward_batch);
+  } else {
+    for (int b = 0; b < num_batches; ++b) forward_batch(b, 0);
+  }
+}
+
+// Makes sure that there are copies of network_ for num_threads - 1 threads
+// in addition to the caller, which uses network_ itself.
+void LSTMRecognizer::SetupReplicas(int num_threads) {
+  int num_replicas = num_threads - 1;
+  if (static_cast<int>(replicas_.size()) >= num_replicas) return;
+  // Copy the structure of the network by serializing it, which also keeps it
+  // in int mode if it has been converted.
+  std::vector<char> data;
+  TFile fp;
+  fp.OpenWrite(&data);
+  ASSERT_HOST(network_->Serialize(&fp));
+  while (static_cast<int>(replicas_.size()) < num_replicas) {
+    std::unique_ptr<NetworkReplica> replica(new NetworkReplica);
+    TFile in;
+    in.Open(&data[0], data.size());
+    // Only the activations need to be separate, not the weights.
+    replica->network = Network::CreateFromFile(&in, network_);
+    ASSERT_HOST(replica->network != nullptr);
+    replica->network->SetRandomizer(&replica->randomizer);
+    replicas_.push_back(std::move(replica));
+  }
+}
+
 // Helper computes min and mean best results in the output.
 void LSTMRecognizer::OutputStats(const NetworkIO& outputs, float* min_output,
                                  float* mean_output, float* sd) {
@@ -292,6 +484,7 @@ bool LSTMRecognizer::RecognizeLine(const ImageData& image_data, bool invert,
   OutputStats(*outputs, &pos_min, &pos_mean, &pos_sd);
   if (invert && pos_mean < 0.5) {
     // Run again inverted and see if it is any better.
+    ++inverted_tries_;
     NetworkIO inv_inputs, inv_outputs;
     inv_inputs.set_int_mode(IsIntMode());
     SetRandomSeed();
@@ -304,6 +497,7 @@ bool LSTMRecognizer::RecognizeLine(const ImageData& image_data, bool invert,
     OutputStats(inv_outputs, &inv_min, &inv_mean, &inv_sd);
     if (inv_mean > pos_mean) {
       // Inverted did better. Use inverted data.
+      ++inverted_wins_;
       if (debug) {
         tprintf("Inverting image: old min=%g, mean=%g, sd=%g, inv %g,%g,%g\n",
                 pos_min, pos_mean, pos_sd, inv_min, inv_mean, inv_sd);
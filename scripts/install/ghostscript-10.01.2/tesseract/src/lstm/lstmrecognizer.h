@@ -30,6 +30,8 @@
 #include "strngs.h"
 #include "unicharcompress.h"
 
+#include <memory>  // for std::unique_ptr
+
 class BLOB_CHOICE_IT;
 struct Pix;
 class ROW_RES;
@@ -41,6 +43,7 @@ namespace tesseract {
 
 class Dict;
 class ImageData;
+class ThreadPool;
 
 // Enum indicating training mode control flags.
 enum TrainingFlags {
@@ -48,6 +51,18 @@ enum TrainingFlags {
   TF_COMPRESS_UNICHARSET = 64,
 };
 
+// Network outputs for a single line, as computed by
+// LSTMRecognizer::RecognizeLines, ready to be decoded with DecodeLine.
+struct LSTMLineOutputs {
+  LSTMLineOutputs() : valid(false), scale_factor(0.0f) {}
+
+  // True if the line could be recognized.
+  bool valid;
+  // Reduction factor between the image and the output coords.
+  float scale_factor;
+  NetworkIO outputs;
+};
+
 // Top-level line recognizer class for LSTM-based networks.
 // Note that a sub-class, LSTMTrainer is used for training.
 class TESS_API LSTMRecognizer {
@@ -170,6 +185,9 @@ class TESS_API LSTMRecognizer {
   int null_char() const { return null_char_; }
 
   // Loads a model from mgr, including the dictionary only if lang is not null.
+  // The weights of the network are shared read-only with every other
+  // recognizer that is loaded with the same model, through the global
+  // NetworkCache, so the model can't then be trained.
   bool Load(const ParamsVectors* params, const char* lang,
             TessdataManager* mgr);
 
@@ -205,6 +223,50 @@ class TESS_API LSTMRecognizer {
                      PointerVector<WERD_RES>* words, int lstm_choice_mode = 0,
                      int lstm_choice_amount = 5);
 
+  // Decodes the outputs of the network for a single line, from RecognizeLine
+  // below, or from RecognizeLines, into recognized WERD_RES in words, exactly
+  // as the RecognizeLine above.
+  void DecodeLine(const NetworkIO& outputs, float scale_factor, bool debug,
+                  double worst_dict_cert, const TBOX& line_box,
+                  PointerVector<WERD_RES>* words, int lstm_choice_mode = 0,
+                  int lstm_choice_amount = 5);
+
+  // Runs the network on many line images at once, filling results with the
+  // outputs for each of images, in order. The lines are sorted by width and
+  // packed into batches of up to batch_size lines of similar width, each of
+  // which goes through the network in a single Forward, so the weights are
+  // shared by all the lines of a batch instead of being read again for every
+  // line. The outputs are those that RecognizeLine below would give with the
+  // same invert, which is given for each of images, and
+  // re_invert = upside_down = false.
+  // If pool is not null, the batches are spread over its threads, each of
+  // which runs its own copy of the network.
+  void RecognizeLines(const std::vector<const ImageData*>& images,
+                      const std::vector<bool>& invert, int batch_size,
+                      ThreadPool* pool,
+                      std::vector<LSTMLineOutputs>* results);
+
+  // Returns the number of lines that were run again inverted, because of the
+  // low confidence of their normal result, since the last
+  // ResetInvertCounts, and the number of those whose inverted result was
+  // better, and used.
+  int inverted_tries() const {
+    return inverted_tries_;
+  }
+  int inverted_wins() const {
+    return inverted_wins_;
+  }
+  void ResetInvertCounts() {
+    inverted_tries_ = 0;
+    inverted_wins_ = 0;
+  }
+
+  // Turns the pruning of hopeless contexts in the beam search on or off.
+  // See RecodeBeamSearch::set_prune_contexts.
+  void set_prune_contexts(bool prune) {
+    prune_contexts_ = prune;
+  }
+
   // Helper computes min and mean best results in the output.
   void OutputStats(const NetworkIO& outputs, float* min_output,
                    float* mean_output, float* sd);
@@ -240,11 +302,30 @@ class TESS_API LSTMRecognizer {
  protected:
   // Sets the random seed from the sample_iteration_;
   void SetRandomSeed() {
+    SetRandomSeed(&randomizer_);
+  }
+  // As SetRandomSeed, but for the given randomizer.
+  void SetRandomSeed(TRand* randomizer) const {
     int64_t seed = static_cast<int64_t>(sample_iteration_) * 0x10000001;
-    randomizer_.set_seed(seed);
-    randomizer_.IntRand();
+    randomizer->set_seed(seed);
+    randomizer->IntRand();
   }
 
+  // Helper for RecognizeLines runs the network on the given subset of pixes,
+  // identified by index in lines, and stores the outputs of each in outputs.
+  void ForwardBatches(const std::vector<Pix*>& pixes,
+                      const std::vector<int>& lines, int batch_size,
+                      ThreadPool* pool, std::vector<NetworkIO>* outputs);
+  // Makes sure that there are copies of network_ for num_threads - 1 threads
+  // in addition to the caller, which uses network_ itself.
+  void SetupReplicas(int num_threads);
+  // As DeSerialize, but network_ uses the weights of shared, if not null,
+  // which becomes shared_network_.
+  bool DeSerialize(const TessdataManager* mgr, TFile* fp,
+                   const Network* shared);
+  // Gives back shared_network_ to the global NetworkCache.
+  void ReleaseSharedNetwork();
+
   // Displays the labels and cuts at the corresponding xcoords.
   // Size of labels should match xcoords.
   void DisplayLSTMOutput(const std::vector<int>& labels,
@@ -284,6 +365,9 @@ class TESS_API LSTMRecognizer {
  protected:
   // The network hierarchy.
   Network* network_;
+  // If not nullptr, the network in the global NetworkCache whose weights are
+  // used by network_.
+  const Network* shared_network_;
   // The unicharset. Only the unicharset element is serialized.
   // Has to be a CCUtil, so Dict can point to it.
   CCUtil ccutil_;
@@ -317,6 +401,24 @@ class TESS_API LSTMRecognizer {
   Dict* dict_;
   // Beam search held between uses to optimize memory allocation/use.
   RecodeBeamSearch* search_;
+  // A copy of network_ with its own scratch space and randomizer, so that
+  // it can run Forward in one thread while network_ runs in another.
+  struct NetworkReplica {
+    ~NetworkReplica() {
+      delete network;
+    }
+    Network* network = nullptr;
+    NetworkScratch scratch;
+    TRand randomizer;
+  };
+  // Copies of network_ for the extra threads of RecognizeLines, held between
+  // uses, as they are expensive to make.
+  std::vector<std::unique_ptr<NetworkReplica>> replicas_;
+  // Counts of the lines tried inverted, and of those that were better so.
+  int inverted_tries_;
+  int inverted_wins_;
+  // Whether search_ prunes hopeless contexts.
+  bool prune_contexts_;
 
   // == Debugging parameters.==
   // Recognition debug display window.
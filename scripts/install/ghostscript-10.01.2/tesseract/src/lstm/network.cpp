@@ -185,7 +185,7 @@ static NetworkType getNetworkType(TFile* fp) {
 // Reads from the given file. Returns nullptr in case of error.
 // Determines the type of the serialized class and calls its DeSerialize
 // on a new object of the appropriate type, which is returned.
-Network* Network::CreateFromFile(TFile* fp) {
+Network* Network::CreateFromFile(TFile* fp, const Network* shared) {
   NetworkType type;          // Type of the derived network class.
   TrainingState training;    // Are we currently training?
   bool needs_to_backprop;    // This network needs to output back_deltas.
@@ -270,7 +270,10 @@ Network* Network::CreateFromFile(TFile* fp) {
     network->needs_to_backprop_ = needs_to_backprop;
     network->network_flags_ = network_flags;
     network->num_weights_ = num_weights;
-    if (!network->DeSerialize(fp)) {
+    bool ok = shared == nullptr ? network->DeSerialize(fp)
+                                : shared->type() == type &&
+                                      network->DeSerializeShared(fp, *shared);
+    if (!ok) {
       delete network;
       network = nullptr;
     }
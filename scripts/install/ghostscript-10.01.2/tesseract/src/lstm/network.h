@@ -189,6 +189,12 @@ class TESS_API Network {
   // Converts a float network to an int network.
   virtual void ConvertToInt() {}
 
+  // Frees the weights of *this, and uses those of src instead. src must have
+  // the same structure as *this, and must outlive it unchanged. Such a network
+  // can only be run Forward, but any number of them can share one set of
+  // weights, each running in a different thread.
+  virtual void ShareWeights(const Network& src) {}
+
   // Provides a pointer to a TRand for any networks that care to use it.
   // Note that randomizer is a borrowed pointer that should outlive the network
   // and should not be deleted by any of the networks.
@@ -222,6 +228,16 @@ class TESS_API Network {
   // Reads from the given file. Returns false in case of error.
   // Should be overridden by subclasses, but NOT called by their DeSerialize.
   virtual bool DeSerialize(TFile* fp) = 0;
+  // As DeSerialize, but *this uses the weights of src, as after ShareWeights,
+  // and skips over the weights in the file instead of reading them, so it
+  // never holds a copy of its own. src must have the same structure as the
+  // network in the file.
+  // Should be overridden by subclasses that have weights.
+  virtual bool DeSerializeShared(TFile* fp, const Network& src) {
+    if (!DeSerialize(fp)) return false;
+    ShareWeights(src);
+    return true;
+  }
 
  public:
   // Updates the weights using the given learning rate, momentum and adam_beta.
@@ -237,7 +253,9 @@ class TESS_API Network {
   // Reads from the given file. Returns nullptr in case of error.
   // Determines the type of the serialized class and calls its DeSerialize
   // on a new object of the appropriate type, which is returned.
-  static Network* CreateFromFile(TFile* fp);
+  // If shared is not null, the new network uses its weights instead of
+  // reading them: see DeSerializeShared.
+  static Network* CreateFromFile(TFile* fp, const Network* shared = nullptr);
 
   // Runs forward propagation of activations on the input line.
   // Note that input and output are both 2-d arrays.
@@ -0,0 +1,49 @@
+///////////////////////////////////////////////////////////////////////
+// File:        networkcache.cpp
+// Description: Process-wide cache of read-only LSTM networks.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include "networkcache.h"
+
+#include <cstdint>              // for uint64_t
+#include <string>               // for std::string, std::to_string
+
+#include "serialis.h"           // for TFile
+
+namespace tesseract {
+
+const Network *NetworkCache::GetNetwork(TessdataManager *data_file) {
+  // The name alone is not a safe id, as LoadMemBuffer only has the language
+  // for a name, so the contents are part of it too. data_file only hashes
+  // them once, however many recognizers it loads.
+  uint64_t hash = data_file->ComponentHash(TESSDATA_LSTM);
+  if (hash == 0) return nullptr;
+  std::string data_id = data_file->GetDataFileName();
+  data_id += kTessdataFileSuffixes[TESSDATA_LSTM];
+  data_id += ":" + std::to_string(hash);
+  return networks_.Get(data_id, [data_file]() -> Network * {
+    TFile fp;
+    if (!data_file->GetComponent(TESSDATA_LSTM, &fp)) return nullptr;
+    return Network::CreateFromFile(&fp);
+  });
+}
+
+NetworkCache *NetworkCache::GlobalNetworkCache() {
+  // Like the global DawgCache, this singleton outlives every Tesseract
+  // instance.
+  static NetworkCache cache;
+  return &cache;
+}
+
+}  // namespace tesseract
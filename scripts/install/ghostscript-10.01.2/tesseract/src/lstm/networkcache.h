@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////
+// File:        networkcache.h
+// Description: Process-wide cache of read-only LSTM networks.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_LSTM_NETWORKCACHE_H_
+#define TESSERACT_LSTM_NETWORKCACHE_H_
+
+#include "network.h"
+#include "object_cache.h"
+#include "tessdatamanager.h"
+
+namespace tesseract {
+
+// Holds one read-only copy of the network of each LSTM model in use, so that
+// every LSTMRecognizer of the same model, in any TessBaseAPI instance or
+// thread, can use the same weights through Network::ShareWeights, instead of
+// holding a copy of its own.
+// The networks in the cache are never run, so they are never modified, and
+// are safe to share between threads.
+class NetworkCache {
+ public:
+  // Returns the network of the TESSDATA_LSTM component of data_file, loading
+  // it if no other caller has it. Returns nullptr if it can't be loaded.
+  // Each network that is returned must be given back with FreeNetwork.
+  const Network *GetNetwork(TessdataManager *data_file);
+
+  // If we manage the given network, decrement its count, and return true.
+  // If network is unknown to us, return false.
+  bool FreeNetwork(const Network *network) {
+    return networks_.Free(const_cast<Network *>(network));
+  }
+
+  // Free up any currently unused networks.
+  void DeleteUnusedNetworks() {
+    networks_.DeleteUnusedObjects();
+  }
+
+  // Returns the global cache, which outlives every LSTMRecognizer.
+  static NetworkCache *GlobalNetworkCache();
+
+ private:
+  ObjectCache<Network> networks_;
+};
+
+}  // namespace tesseract
+
+#endif  // TESSERACT_LSTM_NETWORKCACHE_H_
@@ -911,6 +911,25 @@ void NetworkIO::CopyWithXYTranspose(const NetworkIO& src) {
            dest_b_index.AddOffset(1, FD_BATCH));
 }
 
+// Copies the single image at the given batch index of src to *this, which
+// is resized to hold just that image.
+void NetworkIO::CopyBatchItem(const NetworkIO& src, int batch) {
+  StrideMap::Index src_index(src.stride_map_, batch, 0, 0);
+  std::vector<std::pair<int, int>> h_w_pairs;
+  h_w_pairs.emplace_back(src_index.MaxIndexOfDim(FD_HEIGHT) + 1,
+                         src_index.MaxIndexOfDim(FD_WIDTH) + 1);
+  StrideMap stride_map;
+  stride_map.SetStride(h_w_pairs);
+  ResizeToMap(src.int_mode(), stride_map, src.NumFeatures());
+  StrideMap::Index dest_index(stride_map_);
+  do {
+    StrideMap::Index src_xy(src.stride_map_, batch,
+                            dest_index.index(FD_HEIGHT),
+                            dest_index.index(FD_WIDTH));
+    CopyTimeStepFrom(dest_index.t(), src, src_xy.t());
+  } while (dest_index.Increment());
+}
+
 // Copies src to *this, at the given feature_offset, returning the total
 // feature offset after the copy. Multiple calls will stack outputs from
 // multiple sources in feature space.
@@ -238,6 +238,9 @@ class TESS_API NetworkIO {
   void CopyWithXReversal(const NetworkIO& src);
   // Copies src to *this with independent transpose of the x and y dimensions.
   void CopyWithXYTranspose(const NetworkIO& src);
+  // Copies the single image at the given batch index of src to *this, which
+  // is resized to hold just that image.
+  void CopyBatchItem(const NetworkIO& src, int batch);
   // Copies src to *this, at the given feature_offset, returning the total
   // feature offset after the copy. Multiple calls will stack outputs from
   // multiple sources in feature space.
@@ -70,6 +70,15 @@ void Plumbing::ConvertToInt() {
     stack_[i]->ConvertToInt();
 }
 
+// Shares the weights of each network in the stack with src.
+void Plumbing::ShareWeights(const Network& src) {
+  ASSERT_HOST(src.type() == type_);
+  const auto* plumbing = static_cast<const Plumbing*>(&src);
+  ASSERT_HOST(plumbing->stack_.size() == stack_.size());
+  for (int i = 0; i < stack_.size(); ++i)
+    stack_[i]->ShareWeights(*plumbing->stack_[i]);
+}
+
 // Provides a pointer to a TRand for any networks that care to use it.
 // Note that randomizer is a borrowed pointer that should outlive the network
 // and should not be deleted by any of the networks.
@@ -195,12 +204,27 @@ bool Plumbing::Serialize(TFile* fp) const {
 
 // Reads from the given file. Returns false in case of error.
 bool Plumbing::DeSerialize(TFile* fp) {
+  return DeSerialize(fp, nullptr);
+}
+
+// As DeSerialize, but uses the weights of src.
+bool Plumbing::DeSerializeShared(TFile* fp, const Network& src) {
+  return DeSerialize(fp, static_cast<const Plumbing*>(&src));
+}
+
+// Reads from the given file, using the weights of src for the stack if it
+// is not null. Returns false in case of error.
+bool Plumbing::DeSerialize(TFile* fp, const Plumbing* src) {
   stack_.truncate(0);
   no_ = 0;  // We will be modifying this as we AddToStack.
   uint32_t size;
   if (!fp->DeSerialize(&size)) return false;
+  if (src != nullptr && static_cast<int>(size) != src->stack_.size()) {
+    return false;
+  }
   for (uint32_t i = 0; i < size; ++i) {
-    Network* network = CreateFromFile(fp);
+    Network* network =
+        CreateFromFile(fp, src != nullptr ? src->stack_[i] : nullptr);
     if (network == nullptr) return false;
     AddToStack(network);
   }
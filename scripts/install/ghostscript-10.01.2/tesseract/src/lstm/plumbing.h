@@ -63,6 +63,9 @@ class Plumbing : public Network {
   // Converts a float network to an int network.
   void ConvertToInt() override;
 
+  // Shares the weights of each network in the stack with src.
+  void ShareWeights(const Network& src) override;
+
   // Provides a pointer to a TRand for any networks that care to use it.
   // Note that randomizer is a borrowed pointer that should outlive the network
   // and should not be deleted by any of the networks.
@@ -122,6 +125,8 @@ class Plumbing : public Network {
   bool Serialize(TFile* fp) const override;
   // Reads from the given file. Returns false in case of error.
   bool DeSerialize(TFile* fp) override;
+  // As DeSerialize, but uses the weights of src. See network.h.
+  bool DeSerializeShared(TFile* fp, const Network& src) override;
 
   // Updates the weights using the given learning rate, momentum and adam_beta.
   // num_samples is used in the adam computation iff use_adam_ is true.
@@ -134,6 +139,10 @@ class Plumbing : public Network {
                         double* changed) const override;
 
  protected:
+  // Reads from the given file, using the weights of src for the stack if it
+  // is not null. Returns false in case of error.
+  bool DeSerialize(TFile* fp, const Plumbing* src);
+
   // The networks.
   PointerVector<Network> stack_;
   // Layer-specific learning rate iff network_flags_ & NF_LAYER_SPECIFIC_LR.
@@ -40,6 +40,26 @@ const int RecodeBeamSearch::kBeamWidths[RecodedCharID::kMaxCodeLen + 1] = {
 
 static const char* kNodeContNames[] = {"Anything", "OnlyDup", "NoDup"};
 
+// Number of outputs that ComputeTopN can reject together, when none of them
+// beats the current top-n.
+const int kTopNBlockSize = 16;
+// Number of outputs that are added together for the certainty of a node of
+// each NodeContinuation.
+const int kNumCombinedOutputs[NC_COUNT] = {1, 3, 2};
+// Relative margin on the sums of the top outputs that covers the rounding of
+// the sums in ContinueContext, so that pruning never changes the result.
+const double kProbSumMargin = 1.0 + 1e-6;
+
+// Returns true if any of the n values is greater than threshold.
+// There is no early exit, so the compiler can vectorize the loop.
+static inline bool AnyGreater(const float* values, int n, float threshold) {
+  bool any = false;
+  for (int i = 0; i < n; ++i) {
+    any |= values[i] > threshold;
+  }
+  return any;
+}
+
 // Prints debug details of the node.
 void RecodeNode::Print(int null_char, const UNICHARSET& unicharset,
                        int depth) const {
@@ -67,6 +87,8 @@ RecodeBeamSearch::RecodeBeamSearch(const UnicharCompress& recoder,
       beam_size_(0),
       top_code_(-1),
       second_code_(-1),
+      prune_contexts_(false),
+      dawg_arena_used_(0),
       dict_(dict),
       space_delimited_(true),
       is_simple_text_(simple_text),
@@ -80,6 +102,7 @@ void RecodeBeamSearch::Decode(const NetworkIO& output, double dict_ratio,
                               double cert_offset, double worst_dict_cert,
                               const UNICHARSET* charset, int lstm_choice_mode) {
   beam_size_ = 0;
+  PrepareDawgs();
   int width = output.Width();
   if (lstm_choice_mode) timesteps.clear();
   for (int t = 0; t < width; ++t) {
@@ -96,6 +119,7 @@ void RecodeBeamSearch::Decode(const GENERIC_2D_ARRAY<float>& output,
                               double worst_dict_cert,
                               const UNICHARSET* charset) {
   beam_size_ = 0;
+  PrepareDawgs();
   int width = output.dim1();
   for (int t = 0; t < width; ++t) {
     ComputeTopN(output[t], output.dim2(), kBeamWidths[0]);
@@ -111,6 +135,9 @@ void RecodeBeamSearch::DecodeSecondaryBeams(const NetworkIO& output,
                                             int lstm_choice_mode) {
   secondary_beam_.clear();
   if (character_boundaries_.size() < 2) return;
+  // The nodes of the primary beam are never continued again, so their dawgs
+  // are no longer needed.
+  PrepareDawgs();
   int width = output.Width();
   int bucketNumber = 0;
   for (int t = 0; t < width; ++t) {
@@ -644,17 +671,30 @@ void RecodeBeamSearch::ComputeTopN(const float* outputs, int num_outputs,
   top_n_flags_.resize(num_outputs, TN_ALSO_RAN);
   top_code_ = -1;
   second_code_ = -1;
+  for (auto& top_output : top_outputs_) top_output = 0.0f;
   top_heap_.clear();
-  for (int i = 0; i < num_outputs; ++i) {
-    if (top_heap_.size() < top_n || outputs[i] > top_heap_.PeekTop().key()) {
-      TopPair entry(outputs[i], i);
-      top_heap_.Push(&entry);
-      if (top_heap_.size() > top_n) top_heap_.Pop(&entry);
+  for (int start = 0; start < num_outputs; start += kTopNBlockSize) {
+    int end = std::min(start + kTopNBlockSize, num_outputs);
+    // Once the heap is full, most blocks are rejected without touching it.
+    if (top_heap_.size() >= top_n && end - start == kTopNBlockSize &&
+        !AnyGreater(outputs + start, kTopNBlockSize,
+                    top_heap_.PeekTop().key())) {
+      continue;
+    }
+    for (int i = start; i < end; ++i) {
+      if (top_heap_.size() < top_n || outputs[i] > top_heap_.PeekTop().key()) {
+        TopPair entry(outputs[i], i);
+        top_heap_.Push(&entry);
+        if (top_heap_.size() > top_n) top_heap_.Pop(&entry);
+      }
     }
   }
   while (!top_heap_.empty()) {
-    TopPair entry;
+    TopPair entry(0.0f, 0);
     top_heap_.Pop(&entry);
+    if (top_heap_.size() < kNumTopOutputs) {
+      top_outputs_[top_heap_.size()] = entry.key();
+    }
     if (top_heap_.size() > 1) {
       top_n_flags_[entry.data()] = TN_TOPN;
     } else {
@@ -666,6 +706,8 @@ void RecodeBeamSearch::ComputeTopN(const float* outputs, int num_outputs,
     }
   }
   top_n_flags_[null_char_] = TN_TOP2;
+  final_top_n_codes_.codes = nullptr;
+  next_top_n_codes_.codes = nullptr;
 }
 
 void RecodeBeamSearch::ComputeSecTopN(std::unordered_set<int>* exList,
@@ -675,16 +717,24 @@ void RecodeBeamSearch::ComputeSecTopN(std::unordered_set<int>* exList,
   top_code_ = -1;
   second_code_ = -1;
   top_heap_.clear();
-  for (int i = 0; i < num_outputs; ++i) {
-    if ((top_heap_.size() < top_n || outputs[i] > top_heap_.PeekTop().key())
-        && !exList->count(i)) {
-      TopPair entry(outputs[i], i);
-      top_heap_.Push(&entry);
-      if (top_heap_.size() > top_n) top_heap_.Pop(&entry);
+  for (int start = 0; start < num_outputs; start += kTopNBlockSize) {
+    int end = std::min(start + kTopNBlockSize, num_outputs);
+    if (top_heap_.size() >= top_n && end - start == kTopNBlockSize &&
+        !AnyGreater(outputs + start, kTopNBlockSize,
+                    top_heap_.PeekTop().key())) {
+      continue;
+    }
+    for (int i = start; i < end; ++i) {
+      if ((top_heap_.size() < top_n || outputs[i] > top_heap_.PeekTop().key())
+          && !exList->count(i)) {
+        TopPair entry(outputs[i], i);
+        top_heap_.Push(&entry);
+        if (top_heap_.size() > top_n) top_heap_.Pop(&entry);
+      }
     }
   }
   while (!top_heap_.empty()) {
-    TopPair entry;
+    TopPair entry(0.0f, 0);
     top_heap_.Pop(&entry);
     if (top_heap_.size() > 1) {
       top_n_flags_[entry.data()] = TN_TOPN;
@@ -697,6 +747,94 @@ void RecodeBeamSearch::ComputeSecTopN(std::unordered_set<int>* exList,
     }
   }
   top_n_flags_[null_char_] = TN_TOP2;
+  final_top_n_codes_.codes = nullptr;
+  next_top_n_codes_.codes = nullptr;
+}
+
+// Returns the codes of the given list from the recoder (which may be null)
+// for which top_n_flags_[code] == top_n_flag, in the same order. The result
+// is kept in cache for the next call, as consecutive contexts mostly have the
+// same prefix, and often no prefix at all.
+const std::vector<int>& RecodeBeamSearch::FilterTopNCodes(
+    const GenericVector<int>* codes, TopNState top_n_flag, TopNCodes* cache) {
+  if (codes == cache->codes && top_n_flag == cache->top_n_flag) {
+    return cache->matches;
+  }
+  cache->codes = codes;
+  cache->top_n_flag = top_n_flag;
+  int num_matches = 0;
+  if (codes != nullptr) {
+    // Without a branch per code, this is much faster than testing the codes
+    // as they are used.
+    cache->matches.resize(codes->size());
+    for (int i = 0; i < codes->size(); ++i) {
+      int code = (*codes)[i];
+      cache->matches[num_matches] = code;
+      num_matches += top_n_flags_[code] == top_n_flag;
+    }
+  }
+  cache->matches.resize(num_matches);
+  return cache->matches;
+}
+
+// Returns true if none of the continuations of prev that ContinueContext
+// would make with the given top_n_flag can get into their heaps in step, as
+// they are all full of nodes that score at least prev->score plus the
+// max_certs of their NodeContinuation. has_final_codes and has_next_codes
+// tell whether there are any whole or partial codes with the top_n_flag to
+// follow the prefix of prev.
+bool RecodeBeamSearch::IsHopeless(const RecodeNode* prev, int index,
+                                  TopNState top_n_flag, bool has_final_codes,
+                                  bool has_next_codes,
+                                  const float* max_certs,
+                                  const RecodeBeam& step) const {
+  // The worst in a full heap only gets better during the step, which also
+  // covers best_initial_dawgs_, as they are pushed to the dawg heaps at the
+  // end.
+  auto can_push = [&](bool dawg, NodeContinuation cont, int length) {
+    const RecodeHeap& heap = step.beams_[BeamIndex(dawg, cont, length)];
+    return heap.size() < kBeamWidths[length] ||
+           prev->score + max_certs[cont] > heap.PeekTop().data().score;
+  };
+  int length = LengthFromBeamsIndex(index);
+  bool use_dawgs = IsDawgFromBeamsIndex(index);
+  NodeContinuation prev_cont = ContinuationFromBeamsIndex(index);
+  bool top2 = top_n_flag == TN_TOP2;
+  // The same heaps as ContinueContext pushes to, in the same order.
+  if (!is_simple_text_) {
+    if (top_n_flags_[prev->code] == top_n_flag) {
+      if (prev_cont != NC_NO_DUP && can_push(use_dawgs, NC_ANYTHING, length)) {
+        return false;
+      }
+      if (prev_cont == NC_ANYTHING && top2 && prev->code != null_char_ &&
+          can_push(use_dawgs, NC_NO_DUP, length)) {
+        return false;
+      }
+    }
+    if (prev_cont == NC_ONLY_DUP) return true;
+    if (prev->code != null_char_ && length > 0 &&
+        top_n_flags_[null_char_] == top_n_flag &&
+        can_push(use_dawgs, NC_ANYTHING, length)) {
+      return false;
+    }
+  }
+  if (has_final_codes) {
+    // Whole unichars go to length 0 of the same type of heap, except that a
+    // dawg context may also push to the non-dawg heaps, and a non-dawg one
+    // to the initial dawgs.
+    for (int c = 0; c <= (top2 ? NC_ONLY_DUP : NC_ANYTHING); ++c) {
+      auto cont = static_cast<NodeContinuation>(c);
+      if (can_push(use_dawgs, cont, 0)) return false;
+      if (use_dawgs || dict_ != nullptr) {
+        if (can_push(!use_dawgs, cont, 0)) return false;
+      }
+    }
+  }
+  if (has_next_codes) {
+    if (can_push(use_dawgs, NC_ANYTHING, length + 1)) return false;
+    if (top2 && can_push(use_dawgs, NC_ONLY_DUP, length + 1)) return false;
+  }
+  return true;
 }
 
 // Adds the computation for the current time-step to the beam. Call at each
@@ -736,6 +874,23 @@ void RecodeBeamSearch::DecodeStep(const float* outputs, int t,
         DebugPath(charset, path);
       }
     }
+    // No continuation can be more certain than the top outputs allow, with
+    // or without the dict_ratio, which enables ContinueContext to skip the
+    // contexts that can't make it into the beam, before any dictionary work.
+    float max_certs[NC_COUNT];
+    const float* prune_certs = nullptr;
+    if (prune_contexts_ && dict_ratio >= 0.0) {
+      for (int c = 0; c < NC_COUNT; ++c) {
+        double prob = 0.0;
+        for (int i = 0; i < kNumCombinedOutputs[c]; ++i) {
+          prob += top_outputs_[i];
+        }
+        float cert =
+            NetworkIO::ProbToCertainty(prob * kProbSumMargin) + cert_offset;
+        max_certs[c] = std::max(cert, cert * static_cast<float>(dict_ratio));
+      }
+      prune_certs = max_certs;
+    }
     int total_beam = 0;
     // Work through the scores by group (top-2, top-n, the rest) while the beam
     // is empty. This enables extending the context using only the top-n results
@@ -749,7 +904,8 @@ void RecodeBeamSearch::DecodeStep(const float* outputs, int t,
         // more efficient than going forwards.
         for (int i = prev->beams_[index].size() - 1; i >= 0; --i) {
           ContinueContext(&prev->beams_[index].get(i).data(), index, outputs, top_n,
-                          charset, dict_ratio, cert_offset, worst_dict_cert, step);
+                          charset, dict_ratio, cert_offset, worst_dict_cert, step,
+                          prune_certs);
         }
       }
       for (int index = 0; index < kNumBeams; ++index) {
@@ -768,6 +924,7 @@ void RecodeBeamSearch::DecodeStep(const float* outputs, int t,
       }
     }
   }
+  RecycleDawgs(*step);
 }
 
 void RecodeBeamSearch::DecodeSecondaryStep(const float* outputs, int t,
@@ -837,6 +994,7 @@ void RecodeBeamSearch::DecodeSecondaryStep(const float* outputs, int t,
       }
     }
   }
+  RecycleDawgs(*step);
 }
 
 // Adds to the appropriate beams the legal (according to recoder)
@@ -850,7 +1008,8 @@ void RecodeBeamSearch::ContinueContext(const RecodeNode* prev, int index,
                                        double dict_ratio,
                                        double cert_offset,
                                        double worst_dict_cert,
-                                       RecodeBeam* step) {
+                                       RecodeBeam* step,
+                                       const float* max_certs) {
   RecodedCharID prefix;
   RecodedCharID full_code;
   const RecodeNode* previous = prev;
@@ -867,6 +1026,15 @@ void RecodeBeamSearch::ContinueContext(const RecodeNode* prev, int index,
       full_code.Set(p, previous->code);
     }
   }
+  const std::vector<int>& final_codes = FilterTopNCodes(
+      recoder_.GetFinalCodes(prefix), top_n_flag, &final_top_n_codes_);
+  const std::vector<int>& next_codes = FilterTopNCodes(
+      recoder_.GetNextCodes(prefix), top_n_flag, &next_top_n_codes_);
+  if (prev != nullptr && max_certs != nullptr &&
+      IsHopeless(prev, index, top_n_flag, !final_codes.empty(),
+                 !next_codes.empty(), max_certs, *step)) {
+    return;
+  }
   if (prev != nullptr && !is_simple_text_) {
     if (top_n_flags_[prev->code] == top_n_flag) {
       if (prev_cont != NC_NO_DUP) {
@@ -898,61 +1066,52 @@ void RecodeBeamSearch::ContinueContext(const RecodeNode* prev, int index,
                               NC_ANYTHING, prev, step);
     }
   }
-  const GenericVector<int>* final_codes = recoder_.GetFinalCodes(prefix);
-  if (final_codes != nullptr) {
-    for (int i = 0; i < final_codes->size(); ++i) {
-      int code = (*final_codes)[i];
-      if (top_n_flags_[code] != top_n_flag) continue;
-      if (prev != nullptr && prev->code == code && !is_simple_text_) continue;
-      float cert = NetworkIO::ProbToCertainty(outputs[code]) + cert_offset;
-      if (cert < kMinCertainty && code != null_char_) continue;
-      full_code.Set(length, code);
-      int unichar_id = recoder_.DecodeUnichar(full_code);
-      // Map the null char to INVALID.
-      if (length == 0 && code == null_char_) unichar_id = INVALID_UNICHAR_ID;
-      if (unichar_id != INVALID_UNICHAR_ID &&
-          charset != nullptr &&
-          !charset->get_enabled(unichar_id))
-        continue; // disabled by whitelist/blacklist
-      ContinueUnichar(code, unichar_id, cert, worst_dict_cert, dict_ratio,
-                      use_dawgs, NC_ANYTHING, prev, step);
-      if (top_n_flag == TN_TOP2 && code != null_char_) {
-        float prob = outputs[code] + outputs[null_char_];
-        if (prev != nullptr && prev_cont == NC_ANYTHING &&
-            prev->code != null_char_ &&
-            ((prev->code == top_code_ && code == second_code_) ||
-             (code == top_code_ && prev->code == second_code_))) {
-          prob += outputs[prev->code];
-        }
-        float cert = NetworkIO::ProbToCertainty(prob) + cert_offset;
-        ContinueUnichar(code, unichar_id, cert, worst_dict_cert, dict_ratio,
-                        use_dawgs, NC_ONLY_DUP, prev, step);
+  // The codes have already been filtered by top_n_flag.
+  for (int code : final_codes) {
+    if (prev != nullptr && prev->code == code && !is_simple_text_) continue;
+    float cert = NetworkIO::ProbToCertainty(outputs[code]) + cert_offset;
+    if (cert < kMinCertainty && code != null_char_) continue;
+    full_code.Set(length, code);
+    int unichar_id = recoder_.DecodeUnichar(full_code);
+    // Map the null char to INVALID.
+    if (length == 0 && code == null_char_) unichar_id = INVALID_UNICHAR_ID;
+    if (unichar_id != INVALID_UNICHAR_ID &&
+        charset != nullptr &&
+        !charset->get_enabled(unichar_id))
+      continue; // disabled by whitelist/blacklist
+    ContinueUnichar(code, unichar_id, cert, worst_dict_cert, dict_ratio,
+                    use_dawgs, NC_ANYTHING, prev, step);
+    if (top_n_flag == TN_TOP2 && code != null_char_) {
+      float prob = outputs[code] + outputs[null_char_];
+      if (prev != nullptr && prev_cont == NC_ANYTHING &&
+          prev->code != null_char_ &&
+          ((prev->code == top_code_ && code == second_code_) ||
+           (code == top_code_ && prev->code == second_code_))) {
+        prob += outputs[prev->code];
       }
+      float cert = NetworkIO::ProbToCertainty(prob) + cert_offset;
+      ContinueUnichar(code, unichar_id, cert, worst_dict_cert, dict_ratio,
+                      use_dawgs, NC_ONLY_DUP, prev, step);
     }
   }
-  const GenericVector<int>* next_codes = recoder_.GetNextCodes(prefix);
-  if (next_codes != nullptr) {
-    for (int i = 0; i < next_codes->size(); ++i) {
-      int code = (*next_codes)[i];
-      if (top_n_flags_[code] != top_n_flag) continue;
-      if (prev != nullptr && prev->code == code && !is_simple_text_) continue;
-      float cert = NetworkIO::ProbToCertainty(outputs[code]) + cert_offset;
-      PushDupOrNoDawgIfBetter(length + 1, false, code, INVALID_UNICHAR_ID, cert,
-                              worst_dict_cert, dict_ratio, use_dawgs,
-                              NC_ANYTHING, prev, step);
-      if (top_n_flag == TN_TOP2 && code != null_char_) {
-        float prob = outputs[code] + outputs[null_char_];
-        if (prev != nullptr && prev_cont == NC_ANYTHING &&
-            prev->code != null_char_ &&
-            ((prev->code == top_code_ && code == second_code_) ||
-             (code == top_code_ && prev->code == second_code_))) {
-          prob += outputs[prev->code];
-        }
-        float cert = NetworkIO::ProbToCertainty(prob) + cert_offset;
-        PushDupOrNoDawgIfBetter(length + 1, false, code, INVALID_UNICHAR_ID,
-                                cert, worst_dict_cert, dict_ratio, use_dawgs,
-                                NC_ONLY_DUP, prev, step);
+  for (int code : next_codes) {
+    if (prev != nullptr && prev->code == code && !is_simple_text_) continue;
+    float cert = NetworkIO::ProbToCertainty(outputs[code]) + cert_offset;
+    PushDupOrNoDawgIfBetter(length + 1, false, code, INVALID_UNICHAR_ID, cert,
+                            worst_dict_cert, dict_ratio, use_dawgs, NC_ANYTHING,
+                            prev, step);
+    if (top_n_flag == TN_TOP2 && code != null_char_) {
+      float prob = outputs[code] + outputs[null_char_];
+      if (prev != nullptr && prev_cont == NC_ANYTHING &&
+          prev->code != null_char_ &&
+          ((prev->code == top_code_ && code == second_code_) ||
+           (code == top_code_ && prev->code == second_code_))) {
+        prob += outputs[prev->code];
       }
+      float cert = NetworkIO::ProbToCertainty(prob) + cert_offset;
+      PushDupOrNoDawgIfBetter(length + 1, false, code, INVALID_UNICHAR_ID,
+                              cert, worst_dict_cert, dict_ratio, use_dawgs,
+                              NC_ONLY_DUP, prev, step);
     }
   }
 }
@@ -1044,13 +1203,10 @@ void RecodeBeamSearch::ContinueDawg(int code, int unichar_id, float cert,
              dict_->getUnicharset().IsSpaceDelimited(unichar_id)) {
     return;  // Can't break words between space delimited chars.
   }
-  DawgPositionVector initial_dawgs;
-  auto* updated_dawgs = new DawgPositionVector;
-  DawgArgs dawg_args(&initial_dawgs, updated_dawgs, NO_PERM);
+  DawgArgs dawg_args(&default_dawgs_, nullptr, NO_PERM);
   bool word_start = false;
   if (uni_prev == nullptr) {
     // Starting from beginning of line.
-    dict_->default_dawgs(&initial_dawgs, false);
     word_start = true;
   } else if (uni_prev->dawgs != nullptr) {
     // Continuing a previous dict word.
@@ -1059,6 +1215,8 @@ void RecodeBeamSearch::ContinueDawg(int code, int unichar_id, float cert,
   } else {
     return;  // Can't continue if not a dict word.
   }
+  DawgPositionVector* updated_dawgs = NewDawgs();
+  dawg_args.updated_dawgs = updated_dawgs;
   auto permuter = static_cast<PermuterType>(
       dict_->def_letter_is_okay(&dawg_args,
                                 dict_->getUnicharset(), unichar_id, false));
@@ -1077,7 +1235,7 @@ void RecodeBeamSearch::ContinueDawg(int code, int unichar_id, float cert,
                        nodawg_heap);
     }
   } else {
-    delete updated_dawgs;
+    ReleaseDawgs(updated_dawgs);
   }
 }
 
@@ -1094,8 +1252,8 @@ void RecodeBeamSearch::PushInitialDawgIfBetter(int code, int unichar_id,
   float score = cert;
   if (prev != nullptr) score += prev->score;
   if (best_initial_dawg->code < 0 || score > best_initial_dawg->score) {
-    auto* initial_dawgs = new DawgPositionVector;
-    dict_->default_dawgs(initial_dawgs, false);
+    DawgPositionVector* initial_dawgs = NewDawgs();
+    *initial_dawgs += default_dawgs_;
     RecodeNode node(code, unichar_id, permuter, true, start, end, false, cert,
                     score, prev, initial_dawgs,
                     ComputeCodeHash(code, false, prev));
@@ -1146,10 +1304,9 @@ void RecodeBeamSearch::PushHeapIfBetter(int max_size, int code, int unichar_id,
     if (UpdateHeapIfMatched(&node, heap)) return;
     RecodePair entry(score, node);
     heap->Push(&entry);
-    ASSERT_HOST(entry.data().dawgs == nullptr);
     if (heap->size() > max_size) heap->Pop(&entry);
   } else {
-    delete d;
+    ReleaseDawgs(d);
   }
 }
 
@@ -1163,7 +1320,6 @@ void RecodeBeamSearch::PushHeapIfBetter(int max_size, RecodeNode* node,
     }
     RecodePair entry(node->score, *node);
     heap->Push(&entry);
-    ASSERT_HOST(entry.data().dawgs == nullptr);
     if (heap->size() > max_size) heap->Pop(&entry);
   }
 }
@@ -1208,6 +1364,69 @@ uint64_t RecodeBeamSearch::ComputeCodeHash(int code, bool dup,
   return hash;
 }
 
+// Caches the default dawgs that start a dictionary word, and returns all the
+// dawg vectors to the arena for a new line.
+void RecodeBeamSearch::PrepareDawgs() {
+  dawg_arena_used_ = 0;
+  if (dict_ != nullptr) {
+    default_dawgs_.truncate(0);
+    dict_->default_dawgs(&default_dawgs_, false);
+  }
+}
+
+// Returns an empty dawg vector from the arena. The vectors stay in the arena
+// from one step and line to the next, so once it has grown to suit the beam,
+// the search no longer allocates them.
+DawgPositionVector* RecodeBeamSearch::NewDawgs() {
+  if (dawg_arena_used_ == static_cast<int>(dawg_arena_.size())) {
+    dawg_arena_.emplace_back(new DawgPositionVector);
+  }
+  DawgPositionVector* dawgs = dawg_arena_[dawg_arena_used_++].get();
+  dawgs->truncate(0);
+  return dawgs;
+}
+
+// Returns dawgs to the arena if it is the last one taken, as it is when it
+// didn't make it into a node.
+void RecodeBeamSearch::ReleaseDawgs(DawgPositionVector* dawgs) {
+  if (dawgs != nullptr && dawg_arena_used_ > 0 &&
+      dawg_arena_[dawg_arena_used_ - 1].get() == dawgs) {
+    --dawg_arena_used_;
+  }
+}
+
+// Returns to the arena the dawg vectors that no node of step leads back to.
+// ContinueDawg only uses the dawgs of the last unichar of the context, so
+// those are the only ones to keep: the dawgs of nodes that were popped off a
+// heap, replaced by a better match, or superseded by a later unichar are
+// free for reuse.
+void RecodeBeamSearch::RecycleDawgs(const RecodeBeam& step) {
+  if (dawg_arena_used_ == 0) return;
+  live_dawgs_.clear();
+  for (const auto& heap : step.beams_) {
+    for (int i = 0; i < heap.size(); ++i) {
+      // As in ContinueDawg.
+      const RecodeNode* uni_prev = &heap.get(i).data();
+      while (uni_prev != nullptr &&
+             (uni_prev->unichar_id == INVALID_UNICHAR_ID ||
+              uni_prev->duplicate)) {
+        uni_prev = uni_prev->prev;
+      }
+      if (uni_prev != nullptr && uni_prev->dawgs != nullptr) {
+        live_dawgs_.push_back(uni_prev->dawgs);
+      }
+    }
+  }
+  std::sort(live_dawgs_.begin(), live_dawgs_.end());
+  auto used_end = std::partition(
+      dawg_arena_.begin(), dawg_arena_.begin() + dawg_arena_used_,
+      [this](const std::unique_ptr<DawgPositionVector>& dawgs) {
+        return std::binary_search(live_dawgs_.begin(), live_dawgs_.end(),
+                                  dawgs.get());
+      });
+  dawg_arena_used_ = used_end - dawg_arena_.begin();
+}
+
 // Backtracks to extract the best path through the lattice that was built
 // during Decode. On return the best_nodes vector essentially contains the set
 // of code, score pairs that make the optimal path with the constraint that
@@ -28,6 +28,7 @@
 #include "ratngs.h"
 #include "unicharcompress.h"
 #include <deque>
+#include <memory>
 #include <set>
 #include <tuple>
 #include <vector>
@@ -119,22 +120,6 @@ struct RecodeNode {
         prev(p),
         dawgs(d),
         code_hash(hash) {}
-  // NOTE: If we could use C++11, then this would be a move constructor.
-  // Instead we have copy constructor that does a move!! This is because we
-  // don't want to copy the whole DawgPositionVector each time, and true
-  // copying isn't necessary for this struct. It does get moved around a lot
-  // though inside the heap and during heap push, hence the move semantics.
-  RecodeNode(const RecodeNode& src) : dawgs(nullptr) {
-    *this = src;
-    ASSERT_HOST(src.dawgs == nullptr);
-  }
-  RecodeNode& operator=(const RecodeNode& src) {
-    delete dawgs;
-    memcpy(this, &src, sizeof(src));
-    ((RecodeNode&)src).dawgs = nullptr;
-    return *this;
-  }
-  ~RecodeNode() { delete dawgs; }
   // Prints details of the node.
   void Print(int null_char, const UNICHARSET& unicharset, int depth) const;
 
@@ -166,7 +151,8 @@ struct RecodeNode {
   float score;
   // The previous node in this chain. Borrowed pointer.
   const RecodeNode* prev;
-  // The currently active dawgs at this position. Owned pointer.
+  // The currently active dawgs at this position. Borrowed pointer to a vector
+  // in the arena of the RecodeBeamSearch, so nodes can be copied freely.
   DawgPositionVector* dawgs;
   // A hash of all codes in the prefix and this->code as well. Used for
   // duplicate path removal.
@@ -217,6 +203,15 @@ class TESS_API RecodeBeamSearch {
   // Generates debug output of the content of the beams after a Decode.
   void DebugBeams(const UNICHARSET& unicharset) const;
 
+  // Turns the pruning of hopeless contexts in Decode on or off (the default).
+  // Pruning only skips contexts that cannot add anything to the beam, so the
+  // result is the same either way. It pays off when the beams are crowded
+  // with poor contexts, but costs a little on confident outputs.
+  // Tesseract sets it from its lstm_prune_contexts parameter.
+  void set_prune_contexts(bool prune) {
+    prune_contexts_ = prune;
+  }
+
   // Extract the best charakters from the current decode iteration and block
   // those symbols for the next iteration. In contrast to tesseracts standard
   // method to chose the best overall node chain, this methods looks at a short
@@ -329,6 +324,27 @@ class TESS_API RecodeBeamSearch {
   void ComputeSecTopN(std::unordered_set<int>* exList,
                       const float* outputs, int num_outputs, int top_n);
 
+  // The codes of a list from the recoder that have a given TopNState.
+  struct TopNCodes {
+    const GenericVector<int>* codes = nullptr;
+    TopNState top_n_flag = TN_COUNT;
+    std::vector<int> matches;
+  };
+  // Returns the codes of the given list from the recoder (which may be null)
+  // for which top_n_flags_[code] == top_n_flag, in the same order, using and
+  // updating cache.
+  const std::vector<int>& FilterTopNCodes(const GenericVector<int>* codes,
+                                          TopNState top_n_flag,
+                                          TopNCodes* cache);
+
+  // Returns true if none of the continuations of prev that ContinueContext
+  // would make with the given top_n_flag can get into their heaps in step, as
+  // they are all full of nodes that score at least prev->score plus the
+  // max_certs of their NodeContinuation.
+  bool IsHopeless(const RecodeNode* prev, int index, TopNState top_n_flag,
+                  bool has_final_codes, bool has_next_codes,
+                  const float* max_certs, const RecodeBeam& step) const;
+
   // Adds the computation for the current time-step to the beam. Call at each
   // time-step in sequence from left to right. outputs is the activation vector
   // for the current timestep.
@@ -355,10 +371,13 @@ class TESS_API RecodeBeamSearch {
   // continuations of context prev, which is from the given index to beams_,
   // using the given network outputs to provide scores to the choices. Uses only
   // those choices for which top_n_flags[code] == top_n_flag.
+  // If max_certs is not null, it bounds the certainty of the choices of each
+  // NodeContinuation, and a context that IsHopeless is skipped.
   void ContinueContext(const RecodeNode* prev, int index, const float* outputs,
                        TopNState top_n_flag, const UNICHARSET* unicharset,
                        double dict_ratio, double cert_offset,
-                       double worst_dict_cert, RecodeBeam* step);
+                       double worst_dict_cert, RecodeBeam* step,
+                       const float* max_certs = nullptr);
   // Continues for a new unichar, using dawg or non-dawg as per flag.
   void ContinueUnichar(int code, int unichar_id, float cert,
                        float worst_dict_cert, float dict_ratio, bool use_dawgs,
@@ -396,6 +415,17 @@ class TESS_API RecodeBeamSearch {
   bool UpdateHeapIfMatched(RecodeNode* new_node, RecodeHeap* heap);
   // Computes and returns the code-hash for the given code and prev.
   uint64_t ComputeCodeHash(int code, bool dup, const RecodeNode* prev) const;
+  // Caches the default dawgs that start a dictionary word, and returns all
+  // the dawg vectors to the arena for a new line.
+  void PrepareDawgs();
+  // Returns an empty dawg vector from the arena.
+  DawgPositionVector* NewDawgs();
+  // Returns dawgs to the arena if it is the last one taken, as it is when it
+  // didn't make it into a node.
+  void ReleaseDawgs(DawgPositionVector* dawgs);
+  // Returns to the arena the dawg vectors that the next step can't use, as
+  // no node of step leads back to them.
+  void RecycleDawgs(const RecodeBeam& step);
   // Backtracks to extract the best path through the lattice that was built
   // during Decode. On return the best_nodes vector essentially contains the set
   // of code, score pairs that make the optimal path with the constraint that
@@ -438,6 +468,29 @@ class TESS_API RecodeBeamSearch {
   int second_code_;
   // Heap used to compute the top_n_flags_.
   GenericHeap<TopPair> top_heap_;
+  // The final and next codes of the last prefix seen by ContinueContext that
+  // match the top_n_flag, cached until the top_n_flags_ change.
+  TopNCodes final_top_n_codes_;
+  TopNCodes next_top_n_codes_;
+  // The best outputs of the current timestep, best first. No continuation
+  // combines more than kNumTopOutputs outputs, so sums of these bound their
+  // probabilities.
+  static const int kNumTopOutputs = 3;
+  float top_outputs_[kNumTopOutputs];
+  // If true, Decode skips the contexts that IsHopeless.
+  bool prune_contexts_;
+  // Arena of the dawg vectors of the nodes of the current step. The first
+  // dawg_arena_used_ are in use, and the rest are kept, with their buffers,
+  // for reuse. As RecycleDawgs returns those of the nodes that drop out of
+  // the beam, the arena stays as small as the beam, whatever the length of
+  // the line.
+  std::vector<std::unique_ptr<DawgPositionVector>> dawg_arena_;
+  int dawg_arena_used_;
+  // The dawg vectors still in use by RecycleDawgs. Only a member to keep its
+  // buffer.
+  std::vector<const DawgPositionVector*> live_dawgs_;
+  // The dawgs at the start of a word, from dict_.
+  DawgPositionVector default_dawgs_;
   // Borrowed pointer to the dictionary to use in the search.
   Dict* dict_;
   // True if the language is space-delimited, which is true for most languages
@@ -18,6 +18,8 @@
 #include "weightmatrix.h"
 
 #include <cassert>              // for assert
+#include <cstring>              // for memcpy
+#include "errcode.h"            // for ASSERT_HOST
 #include "intsimdmatrix.h"
 #include "simddetect.h"         // for DotProduct
 #include "statistc.h"
@@ -76,6 +78,7 @@ TransposedArray::~TransposedArray() = default;
 int WeightMatrix::InitWeightsFloat(int no, int ni, bool use_adam,
                                    float weight_range, TRand* randomizer) {
   int_mode_ = false;
+  shared_ = nullptr;
   wf_.Resize(no, ni, 0.0);
   if (randomizer != nullptr) {
     for (int i = 0; i < no; ++i) {
@@ -95,6 +98,7 @@ int WeightMatrix::InitWeightsFloat(int no, int ni, bool use_adam,
 // for all outputs with negative code_map entries. Returns the new number of
 // weights.
 int WeightMatrix::RemapOutputs(const std::vector<int>& code_map) {
+  ASSERT_HOST(shared_ == nullptr);
   GENERIC_2D_ARRAY<double> old_wf(wf_);
   int old_no = wf_.dim1();
   int new_no = code_map.size();
@@ -123,6 +127,7 @@ int WeightMatrix::RemapOutputs(const std::vector<int>& code_map) {
 // Store a multiplicative scale factor (as a double) that will reproduce
 // the original value, subject to rounding errors.
 void WeightMatrix::ConvertToInt() {
+  ASSERT_HOST(shared_ == nullptr);
   wi_.ResizeNoInit(wf_.dim1(), wf_.dim2());
   scales_.reserve(wi_.dim1());
   int dim2 = wi_.dim2();
@@ -153,6 +158,7 @@ void WeightMatrix::ConvertToInt() {
 // Allocates any needed memory for running Backward, and zeroes the deltas,
 // thus eliminating any existing momentum.
 void WeightMatrix::InitBackward() {
+  ASSERT_HOST(shared_ == nullptr);
   int no = int_mode_ ? wi_.dim1() : wf_.dim1();
   int ni = int_mode_ ? wi_.dim2() : wf_.dim2();
   dw_.Resize(no, ni, 0.0);
@@ -161,6 +167,108 @@ void WeightMatrix::InitBackward() {
   if (use_adam_) dw_sq_sum_.Resize(no, ni, 0.0);
 }
 
+// Frees the weights of *this, and uses those of src instead, which must be
+// the same shape, and must stay unchanged for the life of *this.
+void WeightMatrix::ShareWeights(const WeightMatrix& src) {
+  const WeightMatrix& w = src.weights();
+  // Either may be empty: *this as a fused matrix that is never built, or src
+  // as a gate matrix that is only kept fused.
+  if (NumOutputs() > 0 && w.NumOutputs() > 0) {
+    ASSERT_HOST(int_mode_ == w.int_mode_);
+    ASSERT_HOST(NumOutputs() == w.NumOutputs());
+  }
+  FreeWeights();
+  int_mode_ = w.int_mode_;
+  shared_ = &w;
+}
+
+// Frees the weights of *this, keeping only its mode.
+void WeightMatrix::FreeWeights() {
+  shared_ = nullptr;
+  // ResizeWithCopy to 0 is the only way to give back the memory.
+  wf_.ResizeWithCopy(0, 0);
+  wi_.ResizeWithCopy(0, 0);
+  std::vector<double>().swap(scales_);
+  std::vector<int8_t>().swap(shaped_w_);
+}
+
+// Replaces *this with an inference-only matrix holding the outputs of each
+// of parts in turn, each padded with zero weights to stride outputs.
+void WeightMatrix::StackOutputs(const std::vector<const WeightMatrix*>& parts,
+                                int stride) {
+  ASSERT_HOST(!parts.empty());
+  const WeightMatrix& first = parts[0]->weights();
+  shared_ = nullptr;
+  int_mode_ = first.int_mode_;
+  use_adam_ = false;
+  int num_out = parts.size() * stride;
+  if (int_mode_) {
+    int num_in = first.wi_.dim2();
+    wi_.Resize(num_out, num_in, 0);
+    scales_.assign(num_out, 0.0);
+    for (size_t p = 0; p < parts.size(); ++p) {
+      const WeightMatrix& w = parts[p]->weights();
+      ASSERT_HOST(w.int_mode_ && w.wi_.dim2() == num_in);
+      ASSERT_HOST(w.wi_.dim1() <= stride);
+      for (int i = 0; i < w.wi_.dim1(); ++i) {
+        memcpy(wi_[p * stride + i], w.wi_[i], num_in * sizeof(int8_t));
+        scales_[p * stride + i] = w.scales_[i];
+      }
+    }
+    wf_.ResizeWithCopy(0, 0);
+    if (IntSimdMatrix::intSimdMatrix) {
+      int32_t rounded_num_out;
+      IntSimdMatrix::intSimdMatrix->Init(wi_, shaped_w_, rounded_num_out);
+      scales_.resize(rounded_num_out);
+    }
+  } else {
+    int num_in = first.wf_.dim2();
+    wf_.Resize(num_out, num_in, 0.0);
+    for (size_t p = 0; p < parts.size(); ++p) {
+      const WeightMatrix& w = parts[p]->weights();
+      ASSERT_HOST(!w.int_mode_ && w.wf_.dim2() == num_in);
+      ASSERT_HOST(w.wf_.dim1() <= stride);
+      for (int i = 0; i < w.wf_.dim1(); ++i) {
+        memcpy(wf_[p * stride + i], w.wf_[i], num_in * sizeof(double));
+      }
+    }
+    wi_.ResizeWithCopy(0, 0);
+    std::vector<double>().swap(scales_);
+    std::vector<int8_t>().swap(shaped_w_);
+  }
+}
+
+// Replaces *this with a copy of the first num_outputs outputs of the given
+// part of stacked.
+void WeightMatrix::UnstackOutputs(const WeightMatrix& stacked, int part,
+                                  int stride, int num_outputs) {
+  const WeightMatrix& s = stacked.weights();
+  FreeWeights();
+  int_mode_ = s.int_mode_;
+  use_adam_ = false;
+  int first = part * stride;
+  if (int_mode_) {
+    int num_in = s.wi_.dim2();
+    wi_.ResizeNoInit(num_outputs, num_in);
+    for (int i = 0; i < num_outputs; ++i) {
+      memcpy(wi_[i], s.wi_[first + i], num_in * sizeof(int8_t));
+    }
+    scales_.assign(s.scales_.begin() + first,
+                   s.scales_.begin() + first + num_outputs);
+    if (IntSimdMatrix::intSimdMatrix) {
+      int32_t rounded_num_out;
+      IntSimdMatrix::intSimdMatrix->Init(wi_, shaped_w_, rounded_num_out);
+      scales_.resize(rounded_num_out);
+    }
+  } else {
+    int num_in = s.wf_.dim2();
+    wf_.ResizeNoInit(num_outputs, num_in);
+    for (int i = 0; i < num_outputs; ++i) {
+      memcpy(wf_[i], s.wf_[first + i], num_in * sizeof(double));
+    }
+  }
+}
+
 // Flag on mode to indicate that this weightmatrix uses int8_t.
 const int kInt8Flag = 1;
 // Flag on mode to indicate that this weightmatrix uses adam.
@@ -172,6 +280,9 @@ const int kDoubleFlag = 128;
 
 // Writes to the given file. Returns false in case of error.
 bool WeightMatrix::Serialize(bool training, TFile* fp) const {
+  // A shared WeightMatrix can only be used for inference, so it writes the
+  // weights it uses.
+  if (shared_ != nullptr) return shared_->Serialize(false, fp);
   // For backward compatibility, add kDoubleFlag to mode to indicate the doubles
   // format, without errs, so we can detect and read old format weight matrices.
   uint8_t mode =
@@ -200,6 +311,7 @@ bool WeightMatrix::Serialize(bool training, TFile* fp) const {
 // Reads from the given file. Returns false in case of error.
 
 bool WeightMatrix::DeSerialize(bool training, TFile* fp) {
+  shared_ = nullptr;
   uint8_t mode;
   if (!fp->DeSerialize(&mode)) return false;
   int_mode_ = (mode & kInt8Flag) != 0;
@@ -230,6 +342,48 @@ bool WeightMatrix::DeSerialize(bool training, TFile* fp) {
   return true;
 }
 
+// As DeSerialize, but uses the weights of src instead of reading them.
+bool WeightMatrix::DeSerializeShared(bool training, TFile* fp,
+                                     const WeightMatrix& src) {
+  uint8_t mode;
+  if (!fp->DeSerialize(&mode)) return false;
+  if ((mode & kDoubleFlag) == 0) {
+    // The old format is rare enough to read in full and then throw away.
+    int_mode_ = (mode & kInt8Flag) != 0;
+    use_adam_ = (mode & kAdamFlag) != 0;
+    shared_ = nullptr;
+    if (!DeSerializeOld(training, fp)) return false;
+    ShareWeights(src);
+    return true;
+  }
+  int num_outputs;
+  if ((mode & kInt8Flag) != 0) {
+    if (!GENERIC_2D_ARRAY<int8_t>::Skip(fp, &num_outputs)) return false;
+    uint32_t size;
+    if (!fp->DeSerialize(&size)) return false;
+    if (!fp->Skip(size * sizeof(scales_[0]))) return false;
+  } else {
+    if (!GENERIC_2D_ARRAY<double>::Skip(fp, &num_outputs)) return false;
+    int unused;
+    if (training) {
+      if (!GENERIC_2D_ARRAY<double>::Skip(fp, &unused)) return false;
+      if ((mode & kAdamFlag) != 0 &&
+          !GENERIC_2D_ARRAY<double>::Skip(fp, &unused)) {
+        return false;
+      }
+    }
+  }
+  const WeightMatrix& w = src.weights();
+  if (w.int_mode_ != ((mode & kInt8Flag) != 0)) return false;
+  // src may be empty, as a gate matrix that is only kept fused, and then so
+  // is *this.
+  if (w.NumOutputs() != 0 && w.NumOutputs() != num_outputs) return false;
+  int_mode_ = w.int_mode_;
+  use_adam_ = false;
+  shared_ = &w;
+  return true;
+}
+
 // As DeSerialize, but reads an old (float) format WeightMatrix for
 // backward compatibility.
 bool WeightMatrix::DeSerializeOld(bool training, TFile* fp) {
@@ -263,16 +417,46 @@ bool WeightMatrix::DeSerializeOld(bool training, TFile* fp) {
 // Asserts that the call matches what we have.
 void WeightMatrix::MatrixDotVector(const double* u, double* v) const {
   assert(!int_mode_);
-  MatrixDotVectorInternal(wf_, true, false, u, v);
+  MatrixDotVectorInternal(weights().wf_, true, false, u, v);
 }
 
 void WeightMatrix::MatrixDotVector(const int8_t* u, double* v) const {
   assert(int_mode_);
+  const WeightMatrix& w = weights();
   if (IntSimdMatrix::intSimdMatrix) {
     IntSimdMatrix::intSimdMatrix->matrixDotVectorFunction(
-      wi_.dim1(), wi_.dim2(), &shaped_w_[0], &scales_[0], u, v);
+      w.wi_.dim1(), w.wi_.dim2(), &w.shaped_w_[0], &w.scales_[0], u, v);
+  } else {
+    IntSimdMatrix::MatrixDotVector(w.wi_, w.scales_, u, v);
+  }
+}
+
+// Computes v[r] = Wu[r] for each of the num_vectors inputs u[r]. Each row
+// of the weights is used for all the inputs while it is in cache.
+void WeightMatrix::MatrixDotVectors(int num_vectors, const double* const* u,
+                                    double* const* v) const {
+  assert(!int_mode_);
+  const GENERIC_2D_ARRAY<double>& wf = weights().wf_;
+  int num_results = wf.dim1();
+  int extent = wf.dim2() - 1;
+  for (int i = 0; i < num_results; ++i) {
+    const double* wi = wf[i];
+    for (int r = 0; r < num_vectors; ++r) {
+      v[r][i] = DotProduct(wi, u[r], extent) + wi[extent];
+    }
+  }
+}
+
+void WeightMatrix::MatrixDotVectors(int num_vectors, const int8_t* const* u,
+                                    double* const* v) const {
+  assert(int_mode_);
+  const WeightMatrix& w = weights();
+  if (IntSimdMatrix::intSimdMatrix) {
+    IntSimdMatrix::intSimdMatrix->MatrixDotVectors(
+      w.wi_.dim1(), w.wi_.dim2(), &w.shaped_w_[0], &w.scales_[0],
+      num_vectors, u, v);
   } else {
-    IntSimdMatrix::MatrixDotVector(wi_, scales_, u, v);
+    IntSimdMatrix::MatrixDotVectors(w.wi_, w.scales_, num_vectors, u, v);
   }
 }
 
@@ -280,9 +464,10 @@ void WeightMatrix::MatrixDotVector(const int8_t* u, double* v) const {
 // component-wise products of *this[0] and v to inout.
 void WeightMatrix::MultiplyAccumulate(const double* v, double* inout) {
   assert(!int_mode_);
-  assert(wf_.dim1() == 1);
-  int n = wf_.dim2();
-  const double* u = wf_[0];
+  const GENERIC_2D_ARRAY<double>& wf = weights().wf_;
+  assert(wf.dim1() == 1);
+  int n = wf.dim2();
+  const double* u = wf[0];
   for (int i = 0; i < n; ++i) {
     inout[i] += u[i] * v[i];
   }
@@ -335,6 +520,7 @@ void WeightMatrix::SumOuterTransposed(const TransposedArray& u,
 void WeightMatrix::Update(double learning_rate, double momentum,
                           double adam_beta, int num_samples) {
   assert(!int_mode_);
+  ASSERT_HOST(shared_ == nullptr);
   if (use_adam_ && num_samples > 0 && num_samples < kAdamCorrectionIterations) {
     learning_rate *= sqrt(1.0 - pow(adam_beta, num_samples));
     learning_rate /= 1.0 - pow(momentum, num_samples);
@@ -395,18 +581,19 @@ static void HistogramWeight(double weight, STATS* histogram) {
   histogram->add(bucket, 1);
 }
 
-void WeightMatrix::Debug2D(const char* msg) {
+void WeightMatrix::Debug2D(const char* msg) const {
+  const WeightMatrix& w = weights();
   STATS histogram(0, kHistogramBuckets);
   if (int_mode_) {
-    for (int i = 0; i < wi_.dim1(); ++i) {
-      for (int j = 0; j < wi_.dim2(); ++j) {
-        HistogramWeight(wi_[i][j] * scales_[i], &histogram);
+    for (int i = 0; i < w.wi_.dim1(); ++i) {
+      for (int j = 0; j < w.wi_.dim2(); ++j) {
+        HistogramWeight(w.wi_[i][j] * w.scales_[i], &histogram);
       }
     }
   } else {
-    for (int i = 0; i < wf_.dim1(); ++i) {
-      for (int j = 0; j < wf_.dim2(); ++j) {
-        HistogramWeight(wf_[i][j], &histogram);
+    for (int i = 0; i < w.wf_.dim1(); ++i) {
+      for (int j = 0; j < w.wf_.dim2(); ++j) {
+        HistogramWeight(w.wf_[i][j], &histogram);
       }
     }
   }
@@ -64,7 +64,7 @@ class TransposedArray : public GENERIC_2D_ARRAY<double> {
 // backward steps with the matrix and updates to the weights.
 class WeightMatrix {
  public:
-  WeightMatrix() : int_mode_(false), use_adam_(false) {}
+  WeightMatrix() : int_mode_(false), use_adam_(false), shared_(nullptr) {}
   // Sets up the network for training. Initializes weights using weights of
   // scale `range` picked according to the random number generator `randomizer`.
   // Note the order is outputs, inputs, as this is the order of indices to
@@ -98,9 +98,18 @@ class WeightMatrix {
   bool is_int_mode() const {
     return int_mode_;
   }
-  int NumOutputs() const { return int_mode_ ? wi_.dim1() : wf_.dim1(); }
+  int NumOutputs() const {
+    const WeightMatrix& w = weights();
+    return int_mode_ ? w.wi_.dim1() : w.wf_.dim1();
+  }
+  // Returns the number of outputs rounded up to suit the SIMD implementation,
+  // which is the number of values written by MatrixDotVector.
+  int RoundOutputs(int size) const {
+    if (!int_mode_ || !IntSimdMatrix::intSimdMatrix) return size;
+    return IntSimdMatrix::intSimdMatrix->RoundOutputs(size);
+  }
   // Provides one set of weights. Only used by peep weight maxpool.
-  const double* GetWeights(int index) const { return wf_[index]; }
+  const double* GetWeights(int index) const { return weights().wf_[index]; }
   // Provides access to the deltas (dw_).
   double GetDW(int i, int j) const { return dw_(i, j); }
 
@@ -108,6 +117,25 @@ class WeightMatrix {
   // thus eliminating any existing momentum.
   void InitBackward();
 
+  // Frees the weights of *this, and uses those of src instead, which must be
+  // the same shape, unless either is empty, and must stay unchanged for the
+  // life of *this.
+  // After this, *this can only be used for Forward, and not for training.
+  void ShareWeights(const WeightMatrix& src);
+
+  // Replaces *this with an inference-only matrix holding the outputs of each
+  // of parts in turn, so a single MatrixDotVector computes them all. Each part
+  // is padded with zero weights to stride outputs. The parts must all have the
+  // same number of inputs and the same mode, and at most stride outputs.
+  void StackOutputs(const std::vector<const WeightMatrix*>& parts, int stride);
+  // Replaces *this with a copy of the first num_outputs outputs of the given
+  // part of stacked, a matrix made by StackOutputs with the given stride.
+  void UnstackOutputs(const WeightMatrix& stacked, int part, int stride,
+                      int num_outputs);
+  // Frees the weights of *this, keeping only its mode, for when they are
+  // kept elsewhere. It can't be used again until it is given new weights.
+  void FreeWeights();
+
   // Writes to the given file. Returns false in case of error.
   bool Serialize(bool training, TFile* fp) const;
   // Reads from the given file. Returns false in case of error.
@@ -115,6 +143,10 @@ class WeightMatrix {
   // As DeSerialize, but reads an old (float) format WeightMatrix for
   // backward compatibility.
   bool DeSerializeOld(bool training, TFile* fp);
+  // As DeSerialize, but uses the weights of src, as ShareWeights does, and
+  // skips over those in the file instead of reading them. src must have the
+  // same shape as the matrix in the file.
+  bool DeSerializeShared(bool training, TFile* fp, const WeightMatrix& src);
 
   // Computes matrix.vector v = Wu.
   // u is of size W.dim2() - 1 and the output v is of size W.dim1().
@@ -123,6 +155,13 @@ class WeightMatrix {
   // Asserts that the call matches what we have.
   void MatrixDotVector(const double* u, double* v) const;
   void MatrixDotVector(const int8_t* u, double* v) const;
+  // Computes v[r] = Wu[r] for each of the num_vectors inputs u[r], with the
+  // same results as MatrixDotVector of each in turn, but with the weights
+  // fetched from memory once for all the inputs instead of once for each.
+  void MatrixDotVectors(int num_vectors, const double* const* u,
+                        double* const* v) const;
+  void MatrixDotVectors(int num_vectors, const int8_t* const* u,
+                        double* const* v) const;
   // MatrixDotVector for peep weights, MultiplyAccumulate adds the
   // component-wise products of *this[0] and v to inout.
   void MultiplyAccumulate(const double* v, double* inout);
@@ -149,7 +188,7 @@ class WeightMatrix {
   void CountAlternators(const WeightMatrix& other, double* same,
                         double* changed) const;
 
-  void Debug2D(const char* msg);
+  void Debug2D(const char* msg) const;
 
   // Utility function converts an array of float to the corresponding array
   // of double.
@@ -178,6 +217,14 @@ class WeightMatrix {
   GENERIC_2D_ARRAY<double> dw_sq_sum_;
   // The weights matrix reorganized in whatever way suits this instance.
   std::vector<int8_t> shaped_w_;
+  // If not nullptr, the WeightMatrix whose weights are used instead of the
+  // ones in *this, which are then empty.
+  const WeightMatrix* shared_;
+
+  // Returns the WeightMatrix that holds the weights to use.
+  const WeightMatrix& weights() const {
+    return shared_ != nullptr ? *shared_ : *this;
+  }
 };
 
 }  // namespace tesseract.
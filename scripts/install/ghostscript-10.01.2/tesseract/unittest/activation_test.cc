@@ -0,0 +1,125 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "activation.h"
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include "helpers.h"
+#include "include_gunit.h"
+#include "simddetect.h"
+
+namespace tesseract {
+
+class ActivationTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+  }
+
+  // Returns inputs that cover the whole range of the tables, both signs,
+  // exact table entries, the saturation limit and beyond.
+  std::vector<double> TestInputs() {
+    std::vector<double> inputs;
+    for (int i = -kTableSize - 8; i <= kTableSize + 8; ++i) {
+      inputs.push_back(i / kScaleFactor);
+      inputs.push_back((i + 0.5) / kScaleFactor);
+    }
+    for (int i = 0; i < 10000; ++i) {
+      inputs.push_back(random_.SignedRand(20.0));
+    }
+    inputs.push_back(0.0);
+    inputs.push_back(-0.0);
+    inputs.push_back(1e300);
+    inputs.push_back(-1e300);
+    return inputs;
+  }
+
+  // Checks that function gives identical results to the scalar version of
+  // the table lookup, for all lengths up to 20, so the tails are covered.
+  void ExpectEqualResults(ActivationFunction function,
+                          double (*scalar)(double)) {
+    std::vector<double> inputs = TestInputs();
+    std::vector<double> results(inputs);
+    function(results.size(), &results[0]);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      // Compare the bits, so that the signs of zeros also have to match.
+      double expected = scalar(inputs[i]);
+      EXPECT_EQ(0, memcmp(&expected, &results[i], sizeof(expected)))
+          << "x=" << inputs[i] << " expected " << expected << " got "
+          << results[i];
+    }
+    for (int n = 0; n <= 20; ++n) {
+      std::vector<double> values(inputs.begin(), inputs.begin() + n + 1);
+      double guard = values[n];
+      function(n, &values[0]);
+      for (int i = 0; i < n; ++i) EXPECT_EQ(scalar(inputs[i]), values[i]);
+      // Nothing beyond n is touched.
+      EXPECT_EQ(guard, values[n]);
+    }
+  }
+
+  // Checks both functions of a SIMD version, and reports their speed
+  // relative to the generic loop over the scalar table lookup.
+  void TestVersion(ActivationFunction tanh, ActivationFunction logistic) {
+    ExpectEqualResults(tanh, Tanh);
+    ExpectEqualResults(logistic, Logistic);
+    const int kSize = 512;
+    const int kRepeats = 2000;
+    std::vector<double> values(kSize);
+    auto time = [&](ActivationFunction function) {
+      for (int i = 0; i < kSize; ++i) values[i] = random_.SignedRand(8.0);
+      auto start = std::chrono::steady_clock::now();
+      for (int r = 0; r < kRepeats; ++r) function(kSize, &values[0]);
+      std::chrono::duration<double, std::nano> elapsed =
+          std::chrono::steady_clock::now() - start;
+      return elapsed.count() / (kSize * kRepeats);
+    };
+    auto generic_tanh = [](int n, double* inout) {
+      for (int i = 0; i < n; ++i) inout[i] = Tanh(inout[i]);
+    };
+    GTEST_LOG_(INFO) << "Tanh: " << time(generic_tanh) << " ns generic, "
+                     << time(tanh) << " ns SIMD per value";
+  }
+
+  TRand random_;
+};
+
+TEST_F(ActivationTest, Selected) {
+  TestVersion(TanhInPlace, LogisticInPlace);
+}
+
+TEST_F(ActivationTest, AVX2) {
+#if defined(HAVE_AVX2)
+  if (!SIMDDetect::IsAVX2Available()) {
+    GTEST_LOG_(INFO) << "No AVX2 found! Not tested!";
+    GTEST_SKIP();
+  }
+  TestVersion(TanhAVX2, LogisticAVX2);
+#else
+  GTEST_LOG_(INFO) << "AVX2 unsupported! Not tested!";
+  GTEST_SKIP();
+#endif
+}
+
+TEST_F(ActivationTest, AVX512F) {
+#if defined(HAVE_AVX512F)
+  if (!SIMDDetect::IsAVX512FAvailable()) {
+    GTEST_LOG_(INFO) << "No AVX512F found! Not tested!";
+    GTEST_SKIP();
+  }
+  TestVersion(TanhAVX512F, LogisticAVX512F);
+#else
+  GTEST_LOG_(INFO) << "AVX512F unsupported! Not tested!";
+  GTEST_SKIP();
+#endif
+}
+
+}  // namespace tesseract
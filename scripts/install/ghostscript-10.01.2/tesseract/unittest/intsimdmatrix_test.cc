@@ -86,7 +86,7 @@ class IntSimdMatrixTest : public ::testing::Test {
           IntSimdMatrix::MatrixDotVector(w, scales, u.data(), test_result.data());
         }
         for (int i = 0; i < num_out; ++i) {
-          EXPECT_FLOAT_EQ(base_result[i], test_result[i]) << "i=" << i;
+          EXPECT_EQ(base_result[i], test_result[i]) << "i=" << i;
           total += base_result[i];
         }
       }
@@ -94,6 +94,51 @@ class IntSimdMatrixTest : public ::testing::Test {
     // Compare sum of all results with expected value.
     EXPECT_FLOAT_EQ(total, 337849.39354684710);
   }
+  // Tests that MatrixDotVectors gets the same results as the generic version
+  // of MatrixDotVector on each input, with sizes that need several blocks.
+  void ExpectEqualBatchResults(const IntSimdMatrix& matrix) {
+    const int kNumVectors = 5;
+    for (int num_out : {1, 7, 64, 100, 300, 520}) {
+      for (int num_in : {1, 30, 129, 500, 1000}) {
+        GENERIC_2D_ARRAY<int8_t> w = InitRandom(num_out, num_in + 1);
+        std::vector<double> scales = RandomScales(num_out);
+        int ro = matrix.RoundOutputs(num_out);
+        std::vector<std::vector<int8_t>> inputs;
+        std::vector<std::vector<double>> base_results, test_results;
+        std::vector<const int8_t*> u;
+        std::vector<double*> v;
+        for (int r = 0; r < kNumVectors; ++r) {
+          inputs.push_back(RandomVector(num_in, matrix));
+          base_results.emplace_back(num_out);
+          test_results.emplace_back(ro);
+        }
+        for (int r = 0; r < kNumVectors; ++r) {
+          IntSimdMatrix::MatrixDotVector(w, scales, inputs[r].data(),
+                                         base_results[r].data());
+          u.push_back(inputs[r].data());
+          v.push_back(test_results[r].data());
+        }
+        std::vector<int8_t> shaped_wi;
+        int32_t rounded_num_out;
+        matrix.Init(w, shaped_wi, rounded_num_out);
+        scales.resize(rounded_num_out);
+        if (matrix.matrixDotVectorFunction) {
+          matrix.MatrixDotVectors(w.dim1(), w.dim2(), &shaped_wi[0],
+                                  &scales[0], kNumVectors, &u[0], &v[0]);
+        } else {
+          IntSimdMatrix::MatrixDotVectors(w, scales, kNumVectors, &u[0],
+                                          &v[0]);
+        }
+        for (int r = 0; r < kNumVectors; ++r) {
+          for (int i = 0; i < num_out; ++i) {
+            EXPECT_EQ(base_results[r][i], test_results[r][i])
+                << "num_out=" << num_out << " num_in=" << num_in << " r=" << r
+                << " i=" << i;
+          }
+        }
+      }
+    }
+  }
 
   TRand random_;
 };
@@ -102,6 +147,7 @@ class IntSimdMatrixTest : public ::testing::Test {
 TEST_F(IntSimdMatrixTest, C) {
   static const IntSimdMatrix matrix = {nullptr, 1, 1, 1, 1};
   ExpectEqualResults(matrix);
+  ExpectEqualBatchResults(matrix);
 }
 
 // Tests that the SSE implementation gets the same result as the vanilla.
@@ -112,6 +158,7 @@ TEST_F(IntSimdMatrixTest, SSE) {
     GTEST_SKIP();
   }
   ExpectEqualResults(IntSimdMatrix::intSimdMatrixSSE);
+  ExpectEqualBatchResults(IntSimdMatrix::intSimdMatrixSSE);
 #else
   GTEST_LOG_(INFO) << "SSE unsupported! Not tested!";
   GTEST_SKIP();
@@ -126,10 +173,43 @@ TEST_F(IntSimdMatrixTest, AVX2) {
     GTEST_SKIP();
   }
   ExpectEqualResults(IntSimdMatrix::intSimdMatrixAVX2);
+  ExpectEqualBatchResults(IntSimdMatrix::intSimdMatrixAVX2);
 #else
   GTEST_LOG_(INFO) << "AVX2 unsupported! Not tested!";
   GTEST_SKIP();
 #endif
 }
 
+// Tests that the AVX512 VNNI implementation gets the same result as the
+// vanilla.
+TEST_F(IntSimdMatrixTest, AVX512VNNI) {
+#if defined(HAVE_AVX512VNNI)
+  if (!SIMDDetect::IsAVX512VNNIAvailable() ||
+      !SIMDDetect::IsAVX512BWAvailable()) {
+    GTEST_LOG_(INFO) << "No AVX512 VNNI found! Not tested!";
+    GTEST_SKIP();
+  }
+  ExpectEqualResults(IntSimdMatrix::intSimdMatrixAVX512VNNI);
+  ExpectEqualBatchResults(IntSimdMatrix::intSimdMatrixAVX512VNNI);
+#else
+  GTEST_LOG_(INFO) << "AVX512 VNNI unsupported! Not tested!";
+  GTEST_SKIP();
+#endif
+}
+
+// Tests that the AVX VNNI implementation gets the same result as the vanilla.
+TEST_F(IntSimdMatrixTest, AVXVNNI) {
+#if defined(HAVE_AVXVNNI)
+  if (!SIMDDetect::IsAVXVNNIAvailable()) {
+    GTEST_LOG_(INFO) << "No AVX VNNI found! Not tested!";
+    GTEST_SKIP();
+  }
+  ExpectEqualResults(IntSimdMatrix::intSimdMatrixAVXVNNI);
+  ExpectEqualBatchResults(IntSimdMatrix::intSimdMatrixAVXVNNI);
+#else
+  GTEST_LOG_(INFO) << "AVX VNNI unsupported! Not tested!";
+  GTEST_SKIP();
+#endif
+}
+
 }  // namespace tesseract
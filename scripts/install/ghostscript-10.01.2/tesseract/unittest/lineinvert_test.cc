@@ -0,0 +1,87 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include_gunit.h"
+
+#include "imagedata.h"
+#include "ocrblock.h"
+#include "tesseractclass.h"
+
+#include <allheaders.h>
+
+namespace tesseract {
+
+const int kImageWidth = 400;
+const int kImageHeight = 300;
+// A white on black line, and plain white paper, in image coords.
+const TBOX kDarkLine(100, 50, 160, 250);
+const TBOX kLightLine(250, 50, 310, 250);
+
+class LineInvertTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+    Pix* pix = pixCreate(kImageWidth, kImageHeight, 1);
+    pixRasterop(pix, kDarkLine.left(), kImageHeight - kDarkLine.top(),
+                kDarkLine.width(), kDarkLine.height(), PIX_SET, nullptr, 0,
+                0);
+    tess_.set_pix_original(pixClone(pix));
+    *tess_.mutable_pix_binary() = pix;
+  }
+
+  // Returns the box in block (internal) coords of the given image box, for a
+  // block with the given re_rotation, as the layout analysis would give it.
+  static TBOX BlockBox(const TBOX& image_box, const FCOORD& re_rotation) {
+    TBOX box = image_box;
+    box.rotate(FCOORD(re_rotation.x(), -re_rotation.y()));
+    return box;
+  }
+
+  // Gets the line image of image_box in a block with the given re_rotation,
+  // as LSTMRecognizeWord does, and returns whether it may be inverted.
+  bool MayBeInverted(const TBOX& image_box, const FCOORD& re_rotation) {
+    TBOX word_box = BlockBox(image_box, re_rotation);
+    TBOX block_box = word_box;
+    block_box.pad(20, 20);
+    BLOCK block("", true, 0, 0, block_box.left(), block_box.bottom(),
+                block_box.right(), block_box.top());
+    block.set_re_rotation(re_rotation);
+    TBOX line_box;
+    ImageData* image_data = tess_.GetRectImage(word_box, block, 0, &line_box);
+    EXPECT_NE(nullptr, image_data);
+    delete image_data;
+    return tess_.LineMayBeInverted(block, line_box);
+  }
+
+  Tesseract tess_;
+};
+
+// The lines of blocks of all four orientations, whose images are rotated to
+// be horizontal: the dark line must be tried inverted, and the light one not.
+TEST_F(LineInvertTest, RotatedBlocks) {
+  const FCOORD kRotations[] = {FCOORD(1.0f, 0.0f), FCOORD(0.0f, 1.0f),
+                               FCOORD(-1.0f, 0.0f), FCOORD(0.0f, -1.0f)};
+  for (const auto& rotation : kRotations) {
+    EXPECT_TRUE(MayBeInverted(kDarkLine, rotation))
+        << "rotation " << rotation.x() << "," << rotation.y();
+    EXPECT_FALSE(MayBeInverted(kLightLine, rotation))
+        << "rotation " << rotation.x() << "," << rotation.y();
+  }
+}
+
+// Lines that are partly off the image are counted on the part that is on it.
+TEST_F(LineInvertTest, ClippedToImage) {
+  TBOX dark_overhang(kDarkLine.left(), kDarkLine.bottom(), kDarkLine.right(),
+                     kImageHeight + 40);
+  EXPECT_TRUE(MayBeInverted(dark_overhang, FCOORD(0.0f, 1.0f)));
+  EXPECT_TRUE(MayBeInverted(dark_overhang, FCOORD(1.0f, 0.0f)));
+}
+
+} // namespace tesseract
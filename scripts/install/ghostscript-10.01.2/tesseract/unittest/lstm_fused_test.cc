@@ -0,0 +1,197 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include_gunit.h"
+
+#include "lstm.h"
+#include "networkio.h"
+#include "networkscratch.h"
+#include "serialis.h"
+
+#include <memory>
+#include <vector>
+
+namespace tesseract {
+
+class LSTMFusedTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+  }
+
+  // Builds a small random LSTM of the given type, and returns it serialized.
+  std::vector<char> MakeModel(NetworkType type, bool int_mode) {
+    // Only a softmax LSTM can have outputs different from its states.
+    int num_outputs = type == NT_LSTM_SOFTMAX ? 10 : 12;
+    std::unique_ptr<Network> network(
+        new LSTM("lstm", kNumInputs, 12, num_outputs, false, type));
+    TRand randomizer;
+    randomizer.set_seed(7);
+    network->SetEnableTraining(TS_ENABLED);
+    network->InitWeights(0.5f, &randomizer);
+    network->SetEnableTraining(TS_DISABLED);
+    if (int_mode) network->ConvertToInt();
+    std::vector<char> data;
+    TFile fp;
+    fp.OpenWrite(&data);
+    EXPECT_TRUE(network->Serialize(&fp));
+    return data;
+  }
+
+  // Runs network forward on a fixed input of num_rows rows, and returns the
+  // outputs.
+  std::vector<double> RunForward(Network* network, bool int_mode,
+                                 int num_rows) {
+    std::vector<int> rows(num_rows);
+    for (int r = 0; r < num_rows; ++r) rows[r] = r;
+    return RunForward(network, int_mode, rows);
+  }
+  // Runs network forward on an input of the given rows of a fixed set of
+  // rows of different lengths, and returns the outputs.
+  std::vector<double> RunForward(Network* network, bool int_mode,
+                                 const std::vector<int>& rows) {
+    const int kWidth = 15;
+    StrideMap stride_map;
+    std::vector<std::pair<int, int>> h_w_pairs;
+    for (int r : rows) h_w_pairs.emplace_back(1, kWidth - r * 3);
+    stride_map.SetStride(h_w_pairs);
+    NetworkIO inputs;
+    inputs.ResizeToMap(int_mode, stride_map, kNumInputs);
+    StrideMap::Index index(stride_map);
+    do {
+      int r = rows[index.index(FD_BATCH)];
+      int x = index.index(FD_WIDTH);
+      std::vector<double> features(kNumInputs);
+      for (int f = 0; f < kNumInputs; ++f) {
+        features[f] = (((r * kWidth + x) * kNumInputs + f) % 19) / 9.5 - 1.0;
+      }
+      inputs.WriteTimeStep(index.t(), &features[0]);
+    } while (index.Increment());
+    NetworkScratch scratch;
+    NetworkIO outputs;
+    network->Forward(false, inputs, nullptr, &scratch, &outputs);
+    // Only the positions inside the rows, as the rest is padding.
+    std::vector<double> result;
+    std::vector<double> features(outputs.NumFeatures());
+    StrideMap::Index out_index(outputs.stride_map());
+    do {
+      outputs.ReadTimeStep(out_index.t(), &features[0]);
+      result.insert(result.end(), features.begin(), features.end());
+    } while (out_index.Increment());
+    return result;
+  }
+
+  // Checks that the fused inference path gives exactly the same outputs as
+  // the separate gate passes used when training.
+  void CheckFused(NetworkType type, bool int_mode) {
+    std::vector<char> data = MakeModel(type, int_mode);
+    TFile fp;
+    fp.Open(&data[0], data.size());
+    std::unique_ptr<Network> network(Network::CreateFromFile(&fp));
+    ASSERT_TRUE(network != nullptr);
+    // When training, Forward carries the softmax feedback over from one row
+    // to the next, so a softmax LSTM can only be compared on a single row.
+    int max_rows = type == NT_LSTM_SOFTMAX ? 1 : 3;
+    for (int num_rows = 1; num_rows <= max_rows; num_rows += 2) {
+      network->SetEnableTraining(TS_DISABLED);
+      std::vector<double> fused = RunForward(network.get(), int_mode, num_rows);
+      network->SetEnableTraining(TS_ENABLED);
+      std::vector<double> separate =
+          RunForward(network.get(), int_mode, num_rows);
+      EXPECT_FALSE(fused.empty());
+      EXPECT_EQ(separate, fused);
+    }
+  }
+
+  // Checks that running several rows together gives exactly the same outputs
+  // as running each row on its own.
+  void CheckRows(NetworkType type, bool int_mode) {
+    std::vector<char> data = MakeModel(type, int_mode);
+    TFile fp;
+    fp.Open(&data[0], data.size());
+    std::unique_ptr<Network> network(Network::CreateFromFile(&fp));
+    ASSERT_TRUE(network != nullptr);
+    network->SetEnableTraining(TS_DISABLED);
+    const int kNumRows = 4;
+    std::vector<double> together = RunForward(network.get(), int_mode, kNumRows);
+    std::vector<double> alone;
+    for (int r = 0; r < kNumRows; ++r) {
+      std::vector<double> row = RunForward(network.get(), int_mode,
+                                           std::vector<int>(1, r));
+      alone.insert(alone.end(), row.begin(), row.end());
+    }
+    EXPECT_FALSE(together.empty());
+    EXPECT_EQ(alone, together);
+  }
+
+  // Checks that an int network, which only keeps its gates fused, writes out
+  // exactly what it read, both on its own and sharing the weights of another.
+  void CheckRoundTrip(NetworkType type) {
+    std::vector<char> data = MakeModel(type, true);
+    TFile fp;
+    fp.Open(&data[0], data.size());
+    std::unique_ptr<Network> network(Network::CreateFromFile(&fp));
+    ASSERT_TRUE(network != nullptr);
+    fp.Open(&data[0], data.size());
+    std::unique_ptr<Network> shared(
+        Network::CreateFromFile(&fp, network.get()));
+    ASSERT_TRUE(shared != nullptr);
+    for (const Network* n : {network.get(), shared.get()}) {
+      std::vector<char> copy;
+      TFile out;
+      out.OpenWrite(&copy);
+      EXPECT_TRUE(n->Serialize(&out));
+      EXPECT_EQ(data, copy);
+    }
+    EXPECT_EQ(RunForward(network.get(), true, 3),
+              RunForward(shared.get(), true, 3));
+  }
+
+  static const int kNumInputs = 8;
+};
+
+TEST_F(LSTMFusedTest, Float) {
+  CheckFused(NT_LSTM, false);
+}
+
+TEST_F(LSTMFusedTest, Int) {
+  CheckFused(NT_LSTM, true);
+}
+
+TEST_F(LSTMFusedTest, SoftmaxFloat) {
+  CheckFused(NT_LSTM_SOFTMAX, false);
+}
+
+TEST_F(LSTMFusedTest, SoftmaxInt) {
+  CheckFused(NT_LSTM_SOFTMAX, true);
+}
+
+TEST_F(LSTMFusedTest, Summary) {
+  CheckFused(NT_LSTM_SUMMARY, false);
+}
+
+TEST_F(LSTMFusedTest, Rows) {
+  for (bool int_mode : {false, true}) {
+    CheckRows(NT_LSTM, int_mode);
+    CheckRows(NT_LSTM_SOFTMAX, int_mode);
+    CheckRows(NT_LSTM_SOFTMAX_ENCODED, int_mode);
+  }
+  CheckRows(NT_LSTM_SUMMARY, false);
+}
+
+TEST_F(LSTMFusedTest, IntRoundTrip) {
+  CheckRoundTrip(NT_LSTM);
+}
+
+TEST_F(LSTMFusedTest, SoftmaxIntRoundTrip) {
+  CheckRoundTrip(NT_LSTM_SOFTMAX);
+}
+
+}  // namespace tesseract
@@ -0,0 +1,165 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include_gunit.h"
+
+#include "fullyconnected.h"
+#include "input.h"
+#include "lstm.h"
+#include "networkcache.h"
+#include "networkio.h"
+#include "networkscratch.h"
+#include "series.h"
+#include "serialis.h"
+#include "tessdatamanager.h"
+
+#include <memory>
+#include <vector>
+
+namespace tesseract {
+
+class NetworkCacheTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+  }
+
+  // Builds a small random network, and puts it in mgr as the LSTM component.
+  void MakeModel(bool int_mode, int seed, TessdataManager* mgr) {
+    auto* series = new Series("net");
+    StaticShape shape;
+    shape.SetShape(1, 1, 0, 8);
+    series->AddToStack(new Input("in", shape));
+    series->AddToStack(new FullyConnected("fc", 8, 16, NT_TANH));
+    series->AddToStack(new LSTM("lstm", 16, 12, 10, false, NT_LSTM_SOFTMAX));
+    std::unique_ptr<Network> network(series);
+    TRand randomizer;
+    randomizer.set_seed(seed);
+    network->SetEnableTraining(TS_ENABLED);
+    network->InitWeights(0.5f, &randomizer);
+    network->SetEnableTraining(TS_DISABLED);
+    if (int_mode) network->ConvertToInt();
+    std::vector<char> data;
+    TFile fp;
+    fp.OpenWrite(&data);
+    ASSERT_TRUE(network->Serialize(&fp));
+    mgr->OverwriteEntry(TESSDATA_LSTM, &data[0], data.size());
+  }
+
+  // Runs network forward on a fixed input, and returns the outputs.
+  std::vector<double> RunForward(Network* network, bool int_mode) {
+    TRand randomizer;
+    network->SetRandomizer(&randomizer);
+    const int kWidth = 20;
+    StrideMap stride_map;
+    stride_map.SetStride({{1, kWidth}});
+    NetworkIO inputs;
+    inputs.ResizeToMap(int_mode, stride_map, 8);
+    for (int t = 0; t < kWidth; ++t) {
+      std::vector<double> features(8);
+      for (int f = 0; f < 8; ++f) features[f] = ((t * 8 + f) % 17) / 17.0;
+      inputs.WriteTimeStep(t, &features[0]);
+    }
+    NetworkScratch scratch;
+    NetworkIO outputs;
+    network->Forward(false, inputs, nullptr, &scratch, &outputs);
+    std::vector<double> result;
+    std::vector<double> features(outputs.NumFeatures());
+    for (int t = 0; t < outputs.Width(); ++t) {
+      outputs.ReadTimeStep(t, &features[0]);
+      result.insert(result.end(), features.begin(), features.end());
+    }
+    return result;
+  }
+
+  // Checks that a network that shares the weights of the cached one gives
+  // the same outputs as a private copy of the same model.
+  void CheckShared(bool int_mode) {
+    TessdataManager mgr;
+    MakeModel(int_mode, 11, &mgr);
+    NetworkCache cache;
+    const Network* cached = cache.GetNetwork(&mgr);
+    ASSERT_TRUE(cached != nullptr);
+    // A second user gets the same copy.
+    EXPECT_EQ(cached, cache.GetNetwork(&mgr));
+    TFile fp;
+    ASSERT_TRUE(mgr.GetComponent(TESSDATA_LSTM, &fp));
+    std::unique_ptr<Network> private_copy(Network::CreateFromFile(&fp));
+    ASSERT_TRUE(mgr.GetComponent(TESSDATA_LSTM, &fp));
+    std::unique_ptr<Network> shared_copy(Network::CreateFromFile(&fp));
+    shared_copy->ShareWeights(*cached);
+    // As does one that never reads the weights of its own.
+    ASSERT_TRUE(mgr.GetComponent(TESSDATA_LSTM, &fp));
+    std::unique_ptr<Network> skipped_copy(Network::CreateFromFile(&fp, cached));
+    ASSERT_TRUE(skipped_copy != nullptr);
+    std::vector<double> expected = RunForward(private_copy.get(), int_mode);
+    EXPECT_EQ(expected, RunForward(shared_copy.get(), int_mode));
+    EXPECT_EQ(expected, RunForward(skipped_copy.get(), int_mode));
+    // A shared network still serializes the weights that it uses.
+    std::vector<char> original, reserialized;
+    fp.OpenWrite(&original);
+    ASSERT_TRUE(private_copy->Serialize(&fp));
+    fp.OpenWrite(&reserialized);
+    ASSERT_TRUE(shared_copy->Serialize(&fp));
+    EXPECT_EQ(original, reserialized);
+    fp.OpenWrite(&reserialized);
+    ASSERT_TRUE(skipped_copy->Serialize(&fp));
+    EXPECT_EQ(original, reserialized);
+    shared_copy.reset();
+    skipped_copy.reset();
+    EXPECT_TRUE(cache.FreeNetwork(cached));
+    EXPECT_TRUE(cache.FreeNetwork(cached));
+    cache.DeleteUnusedNetworks();
+  }
+};
+
+TEST_F(NetworkCacheTest, SharedFloat) {
+  CheckShared(false);
+}
+
+TEST_F(NetworkCacheTest, SharedInt) {
+  CheckShared(true);
+}
+
+// Tests that different models with the same name are not confused.
+TEST_F(NetworkCacheTest, DifferentModels) {
+  TessdataManager mgr1, mgr2;
+  MakeModel(false, 11, &mgr1);
+  MakeModel(false, 12, &mgr2);
+  EXPECT_EQ(mgr1.GetDataFileName(), mgr2.GetDataFileName());
+  NetworkCache cache;
+  const Network* network1 = cache.GetNetwork(&mgr1);
+  const Network* network2 = cache.GetNetwork(&mgr2);
+  ASSERT_TRUE(network1 != nullptr);
+  ASSERT_TRUE(network2 != nullptr);
+  EXPECT_NE(network1, network2);
+  EXPECT_TRUE(cache.FreeNetwork(network1));
+  EXPECT_TRUE(cache.FreeNetwork(network2));
+  cache.DeleteUnusedNetworks();
+}
+
+// Tests that a model that is overwritten in the same manager is not confused
+// with the one it replaced.
+TEST_F(NetworkCacheTest, OverwrittenModel) {
+  TessdataManager mgr;
+  MakeModel(false, 11, &mgr);
+  NetworkCache cache;
+  const Network* network1 = cache.GetNetwork(&mgr);
+  MakeModel(false, 12, &mgr);
+  const Network* network2 = cache.GetNetwork(&mgr);
+  ASSERT_TRUE(network1 != nullptr);
+  ASSERT_TRUE(network2 != nullptr);
+  EXPECT_NE(network1, network2);
+  EXPECT_TRUE(cache.FreeNetwork(network1));
+  EXPECT_TRUE(cache.FreeNetwork(network2));
+  cache.DeleteUnusedNetworks();
+}
+
+}  // namespace tesseract
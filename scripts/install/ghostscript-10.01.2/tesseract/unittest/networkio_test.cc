@@ -214,4 +214,34 @@ TEST_F(NetworkioTest, CopyWithXYTranspose) {
 #endif
 }
 
+// Tests that CopyBatchItem extracts each image of a batch.
+TEST_F(NetworkioTest, CopyBatchItem) {
+#ifdef INCLUDE_TENSORFLOW
+  NetworkIO nio;
+  SetupNetworkIO(&nio);
+  NetworkIO copy;
+  // The second image is 4x5, with values starting at 12.
+  copy.CopyBatchItem(nio, 1);
+  EXPECT_EQ(copy.stride_map().Size(FD_BATCH), 1);
+  EXPECT_EQ(copy.stride_map().Size(FD_HEIGHT), 4);
+  EXPECT_EQ(copy.stride_map().Size(FD_WIDTH), 5);
+  EXPECT_EQ(copy.Width(), 20);
+  for (int t = 0; t < copy.Width(); ++t) {
+    EXPECT_EQ(copy.i(t)[0], 12 + t);
+    EXPECT_EQ(copy.i(t)[1], -12 - t);
+  }
+  // The first image is 3x4, with values starting at 0, and has no padding
+  // once it is extracted from the batch.
+  copy.CopyBatchItem(nio, 0);
+  EXPECT_EQ(copy.Width(), 12);
+  for (int t = 0; t < copy.Width(); ++t) {
+    EXPECT_EQ(copy.i(t)[0], t);
+    EXPECT_EQ(copy.i(t)[1], -t);
+  }
+#else
+  LOG(INFO) << "Skip test because of missing xla::Array2D";
+  GTEST_SKIP();
+#endif
+}
+
 }  // namespace
@@ -0,0 +1,147 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include_gunit.h"
+
+#include "pagearena.h"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace tesseract {
+
+class PageArenaTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+  }
+
+  // Allocates count objects of the given size, each filled with its index.
+  static std::vector<char*> AllocateMany(int count, size_t size) {
+    std::vector<char*> objects;
+    for (int i = 0; i < count; ++i) {
+      auto* p = static_cast<char*>(PageArena::Allocate(size));
+      memset(p, i & 0xff, size);
+      objects.push_back(p);
+    }
+    return objects;
+  }
+
+  static bool CheckMany(const std::vector<char*>& objects, size_t size) {
+    for (size_t i = 0; i < objects.size(); ++i) {
+      for (size_t j = 0; j < size; ++j) {
+        if (objects[i][j] != static_cast<char>(i & 0xff)) return false;
+      }
+    }
+    return true;
+  }
+
+  static void FreeMany(const std::vector<char*>& objects) {
+    for (auto* p : objects) {
+      PageArena::Free(p);
+    }
+  }
+};
+
+// Without a current arena, memory comes from the heap.
+TEST_F(PageArenaTest, NoArena) {
+  auto objects = AllocateMany(100, 24);
+  EXPECT_TRUE(CheckMany(objects, 24));
+  FreeMany(objects);
+}
+
+// Allocations are aligned, and don't overlap, whatever their size.
+TEST_F(PageArenaTest, Alignment) {
+  PageArena arena(true);
+  PageArena::Scope scope(&arena, PageArena::kLayout);
+  std::vector<char*> objects;
+  for (size_t size = 1; size < 100000; size = size * 3 + 1) {
+    auto* p = static_cast<char*>(PageArena::Allocate(size));
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % alignof(std::max_align_t));
+    memset(p, static_cast<int>(objects.size()), size);
+    objects.push_back(p);
+  }
+  size_t size = 1;
+  for (size_t i = 0; i < objects.size(); ++i, size = size * 3 + 1) {
+    EXPECT_EQ(static_cast<char>(i), objects[i][0]);
+    EXPECT_EQ(static_cast<char>(i), objects[i][size - 1]);
+  }
+  FreeMany(objects);
+  arena.Reset();
+}
+
+// Once everything from a page is deleted, Reset reuses the blocks.
+TEST_F(PageArenaTest, ReuseAfterReset) {
+  PageArena arena(true);
+  char* first = nullptr;
+  size_t reserved = 0;
+  for (int page = 0; page < 3; ++page) {
+    PageArena::Scope scope(&arena, PageArena::kRecognize);
+    auto objects = AllocateMany(20000, 40);
+    EXPECT_TRUE(CheckMany(objects, 40));
+    if (page == 0) {
+      first = objects[0];
+      reserved = arena.reserved_bytes();
+    } else {
+      EXPECT_EQ(first, objects[0]);
+      EXPECT_EQ(reserved, arena.reserved_bytes());
+    }
+    FreeMany(objects);
+    arena.Reset();
+  }
+}
+
+// Objects that outlive the page keep their memory, and may be deleted on
+// another thread.
+TEST_F(PageArenaTest, OutliveReset) {
+  PageArena arena(true);
+  std::vector<char*> kept;
+  {
+    PageArena::Scope scope(&arena, PageArena::kLayout);
+    auto objects = AllocateMany(5000, 56);
+    kept.assign(objects.begin(), objects.begin() + 100);
+    FreeMany(std::vector<char*>(objects.begin() + 100, objects.end()));
+  }
+  arena.Reset();
+  {
+    PageArena::Scope scope(&arena, PageArena::kLayout);
+    auto objects = AllocateMany(5000, 56);
+    EXPECT_TRUE(CheckMany(kept, 56));
+    FreeMany(objects);
+  }
+  arena.Reset();
+  std::thread deleter([&kept]() { FreeMany(kept); });
+  deleter.join();
+}
+
+// The arena counts allocations per stage, even when it isn't bumping.
+TEST_F(PageArenaTest, Counts) {
+  PageArena arena(false);
+  {
+    PageArena::Scope layout(&arena, PageArena::kLayout);
+    FreeMany(AllocateMany(10, 8));
+    {
+      PageArena::Scope output(&arena, PageArena::kOutput);
+      FreeMany(AllocateMany(3, 8));
+    }
+    FreeMany(AllocateMany(5, 8));
+  }
+  FreeMany(AllocateMany(7, 8));
+  EXPECT_EQ(15, arena.allocations(PageArena::kLayout));
+  EXPECT_EQ(0, arena.allocations(PageArena::kRecognize));
+  EXPECT_EQ(3, arena.allocations(PageArena::kOutput));
+  EXPECT_EQ(0, arena.reserved_bytes());
+  arena.Reset();
+  EXPECT_EQ(0, arena.allocations(PageArena::kLayout));
+}
+
+} // namespace tesseract
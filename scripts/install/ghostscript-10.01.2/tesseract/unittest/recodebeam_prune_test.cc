@@ -0,0 +1,176 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include_gunit.h"
+
+#include "ccutil.h"
+#include "dict.h"
+#include "helpers.h"
+#include "matrix.h"
+#include "recodebeam.h"
+#include "tessdatamanager.h"
+#include "unicharcompress.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace tesseract {
+
+// Words for the dictionary, which are also used to make the lines.
+const char* kWords[] = {"the",  "these", "word", "words", "right",
+                        "rig",  "tight", "sword", "swords", "가나",
+                        "다라", "가다", nullptr};
+// The characters of the unicharset, including those of the words.
+const char* kChars[] = {"t", "h", "e", "s", "w", "o", "r", "d", "i",
+                        "g", "f", "c", "W", "S", "I", "9", "b", ".",
+                        ",", "가", "나", "다", "라", "각", "낙", "닥",
+                        nullptr};
+
+// Decoding parameters, as used by LSTMRecognizer.
+const double kDictRatio = 2.25;
+const double kCertOffset = -0.085;
+const double kWorstDictCert = -25.0;
+
+class RecodeBeamPruneTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+    file::MakeTmpdir();
+  }
+
+  RecodeBeamPruneTest() : dict_(&ccutil_) {
+    UNICHARSET* unicharset = &ccutil_.unicharset;
+    for (int c = 0; kChars[c] != nullptr; ++c) {
+      unicharset->unichar_insert(kChars[c]);
+    }
+    // The Hangul syllables each encode as a sequence of 3 codes.
+    EXPECT_TRUE(recoder_.ComputeEncoding(*unicharset, UNICHAR_BROKEN, nullptr));
+    RecodedCharID code;
+    recoder_.EncodeUnichar(UNICHAR_BROKEN, &code);
+    null_char_ = code(0);
+  }
+  ~RecodeBeamPruneTest() override {
+    dict_.End();
+  }
+
+  // Loads the words as a user dictionary.
+  void LoadDict() {
+    std::string word_list;
+    for (int w = 0; kWords[w] != nullptr; ++w) {
+      word_list += kWords[w];
+      word_list += "\n";
+    }
+    std::string words_file =
+        file::JoinPath(FLAGS_test_tmpdir, "prune_words.txt");
+    CHECK_OK(file::SetContents(words_file, word_list, file::Defaults()));
+    dict_.user_words_file.set_value(words_file.c_str());
+    dict_.SetupForLoad(nullptr);
+    TessdataManager mgr;
+    dict_.LoadLSTM("test", &mgr);
+    EXPECT_TRUE(dict_.FinishLoad());
+  }
+
+  // Returns network outputs for a random line of the words, in which the
+  // correct codes are often not the best, with each code taking a random
+  // number of timesteps and nulls in between.
+  GENERIC_2D_ARRAY<float> MakeOutputs(int num_words) {
+    std::vector<int> codes;
+    for (int w = 0; w < num_words; ++w) {
+      if (w > 0) codes.push_back(UNICHAR_SPACE);
+      int word = random_.IntRand() % (ARRAYSIZE(kWords) - 1);
+      std::vector<int> unichar_ids;
+      ccutil_.unicharset.encode_string(kWords[word], true, &unichar_ids,
+                                       nullptr, nullptr);
+      for (int unichar_id : unichar_ids) {
+        RecodedCharID code;
+        int length = recoder_.EncodeUnichar(unichar_id, &code);
+        for (int i = 0; i < length; ++i) codes.push_back(code(i));
+      }
+    }
+    std::vector<int> labels;
+    for (int code : codes) {
+      labels.push_back(null_char_);
+      for (int n = random_.IntRand() % 3; n >= 0; --n) labels.push_back(code);
+    }
+    labels.push_back(null_char_);
+    int num_classes = recoder_.code_range();
+    GENERIC_2D_ARRAY<float> outputs(labels.size(), num_classes, 0.0f);
+    for (int t = 0; t < labels.size(); ++t) {
+      float* row = outputs[t];
+      // The correct code is usually, but not always, a clear winner, and a
+      // few random codes share what it doesn't get.
+      double remainder = random_.UnsignedRand(1.0);
+      remainder *= remainder * remainder * 0.95;
+      row[labels[t]] = 1.0 - remainder;
+      for (int i = 0; i < 3; ++i) {
+        double share = i < 2 ? remainder * random_.UnsignedRand(1.0) : remainder;
+        row[random_.IntRand() % num_classes] += share;
+        remainder -= share;
+      }
+    }
+    return outputs;
+  }
+
+  // Decodes many random lines with and without pruning, reusing the searches
+  // as LSTMRecognizer does, and expects identical results. Reports the time
+  // spent decoding.
+  void TestLines(Dict* dict) {
+    RecodeBeamSearch searches[2] = {
+        RecodeBeamSearch(recoder_, null_char_, false, dict),
+        RecodeBeamSearch(recoder_, null_char_, false, dict)};
+    searches[0].set_prune_contexts(true);
+    double seconds[2] = {0.0, 0.0};
+    for (int line = 0; line < 50; ++line) {
+      GENERIC_2D_ARRAY<float> outputs = MakeOutputs(1 + line % 8);
+      std::vector<int> labels[2], label_coords[2], unichar_ids[2], xcoords[2];
+      std::vector<float> certs[2], ratings[2];
+      for (int s = 0; s < 2; ++s) {
+        auto start = std::chrono::steady_clock::now();
+        searches[s].Decode(outputs, kDictRatio, kCertOffset, kWorstDictCert,
+                           nullptr);
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        seconds[s] += elapsed.count();
+        searches[s].ExtractBestPathAsLabels(&labels[s], &label_coords[s]);
+        searches[s].ExtractBestPathAsUnicharIds(
+            false, &ccutil_.unicharset, &unichar_ids[s], &certs[s],
+            &ratings[s], &xcoords[s]);
+      }
+      EXPECT_FALSE(labels[0].empty());
+      EXPECT_EQ(labels[1], labels[0]);
+      EXPECT_EQ(label_coords[1], label_coords[0]);
+      EXPECT_EQ(unichar_ids[1], unichar_ids[0]);
+      EXPECT_EQ(certs[1], certs[0]);
+      EXPECT_EQ(ratings[1], ratings[0]);
+      EXPECT_EQ(xcoords[1], xcoords[0]);
+    }
+    GTEST_LOG_(INFO) << "Decoding took " << seconds[0] * 1000.0
+                     << " ms with pruning, " << seconds[1] * 1000.0
+                     << " ms without";
+  }
+
+  CCUtil ccutil_;
+  Dict dict_;
+  UnicharCompress recoder_;
+  int null_char_;
+  TRand random_;
+};
+
+TEST_F(RecodeBeamPruneTest, NoDict) {
+  TestLines(nullptr);
+}
+
+TEST_F(RecodeBeamPruneTest, Dict) {
+  LoadDict();
+  TestLines(&dict_);
+}
+
+}  // namespace tesseract
@@ -0,0 +1,131 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include_gunit.h"
+
+#include "serialis.h"
+#include "tessdatamanager.h"
+
+#include <string>
+#include <vector>
+
+namespace tesseract {
+
+class TessdataManagerTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+    file::MakeTmpdir();
+  }
+
+  // Fills mgr with a few components of made-up data.
+  void MakeComponents(TessdataManager* mgr) {
+    unicharset_ = "3\nNULL 0 Common 0\na 3 Latin 1\nb 3 Latin 2\n";
+    for (int i = 0; i < 1000; ++i) lstm_.push_back(static_cast<char>(i * 7));
+    mgr->OverwriteEntry(TESSDATA_LSTM_UNICHARSET, unicharset_.data(),
+                        unicharset_.size());
+    mgr->OverwriteEntry(TESSDATA_LSTM, &lstm_[0], lstm_.size());
+  }
+
+  // Checks that mgr holds the components made by MakeComponents.
+  void CheckComponents(const TessdataManager& mgr) {
+    EXPECT_TRUE(mgr.IsLSTMAvailable());
+    EXPECT_FALSE(mgr.IsComponentAvailable(TESSDATA_INTTEMP));
+    TFile fp;
+    ASSERT_TRUE(mgr.GetComponent(TESSDATA_LSTM_UNICHARSET, &fp));
+    char line[64];
+    ASSERT_EQ(line, fp.FGets(line, sizeof(line)));
+    EXPECT_STREQ("3\n", line);
+    ASSERT_TRUE(mgr.GetComponent(TESSDATA_LSTM, &fp));
+    std::vector<char> lstm(lstm_.size() + 1);
+    EXPECT_EQ(static_cast<int>(lstm_.size()),
+              fp.FRead(&lstm[0], 1, lstm.size()));
+    lstm.resize(lstm_.size());
+    EXPECT_EQ(lstm_, lstm);
+  }
+
+  std::string unicharset_;
+  std::vector<char> lstm_;
+};
+
+// Tests that a traineddata file loads the same whether it is mapped into
+// memory or read from a buffer.
+TEST_F(TessdataManagerTest, MappedAndBuffered) {
+  TessdataManager writer;
+  MakeComponents(&writer);
+  writer.SetVersionString("test-version");
+  std::string filename =
+      std::string(FLAGS_test_tmpdir) + "/tessdatamanager_test.traineddata";
+  ASSERT_TRUE(writer.SaveFile(filename.c_str(), nullptr));
+  std::vector<char> data;
+  writer.Serialize(&data);
+
+  TessdataManager mapped;
+  ASSERT_TRUE(mapped.Init(filename.c_str()));
+#if defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
+  EXPECT_TRUE(mapped.is_mapped());
+#endif
+  EXPECT_EQ("test-version", mapped.VersionString());
+  CheckComponents(mapped);
+
+  TessdataManager buffered;
+  ASSERT_TRUE(buffered.LoadMemBuffer("test", &data[0], data.size()));
+  EXPECT_FALSE(buffered.is_mapped());
+  EXPECT_EQ("test-version", buffered.VersionString());
+  CheckComponents(buffered);
+
+  // Both must serialize back to the original.
+  std::vector<char> mapped_data;
+  mapped.Serialize(&mapped_data);
+  EXPECT_EQ(data, mapped_data);
+  std::vector<char> buffered_data;
+  buffered.Serialize(&buffered_data);
+  EXPECT_EQ(data, buffered_data);
+}
+
+// Tests that overwriting a component of a mapped file leaves the rest
+// intact, and the file unchanged.
+TEST_F(TessdataManagerTest, OverwriteMapped) {
+  TessdataManager writer;
+  MakeComponents(&writer);
+  std::string filename =
+      std::string(FLAGS_test_tmpdir) + "/tessdatamanager_ow.traineddata";
+  ASSERT_TRUE(writer.SaveFile(filename.c_str(), nullptr));
+
+  TessdataManager mapped;
+  ASSERT_TRUE(mapped.Init(filename.c_str()));
+  std::string config = "tessedit_num_threads 4\n";
+  mapped.OverwriteEntry(TESSDATA_LANG_CONFIG, config.data(), config.size());
+  CheckComponents(mapped);
+  TFile fp;
+  ASSERT_TRUE(mapped.GetComponent(TESSDATA_LANG_CONFIG, &fp));
+  char line[64];
+  ASSERT_EQ(line, fp.FGets(line, sizeof(line)));
+  EXPECT_EQ(config, line);
+
+  TessdataManager reloaded;
+  ASSERT_TRUE(reloaded.Init(filename.c_str()));
+  EXPECT_FALSE(reloaded.IsComponentAvailable(TESSDATA_LANG_CONFIG));
+  CheckComponents(reloaded);
+}
+
+// Tests that a truncated file is rejected rather than read out of bounds.
+TEST_F(TessdataManagerTest, Truncated) {
+  TessdataManager writer;
+  MakeComponents(&writer);
+  std::vector<char> data;
+  writer.Serialize(&data);
+  // Cut the file just after the table of offsets, into the first component.
+  data.resize(sizeof(int32_t) + TESSDATA_NUM_ENTRIES * sizeof(int64_t) + 10);
+  TessdataManager buffered;
+  EXPECT_FALSE(buffered.LoadMemBuffer("test", &data[0], data.size()));
+}
+
+}  // namespace tesseract
@@ -0,0 +1,70 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include_gunit.h"
+
+#include "threadpool.h"
+
+#include <atomic>
+#include <vector>
+
+namespace tesseract {
+
+class ThreadPoolTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+  }
+
+  // Runs count tasks on pool, and checks that each ran exactly once, on a
+  // valid thread.
+  void RunAndCheck(ThreadPool* pool, int count) {
+    std::vector<std::atomic<int>> runs(count);
+    for (auto& run : runs) run = 0;
+    std::atomic<int> bad_thread_ids(0);
+    pool->ParallelFor(count, [&](int index, int thread_id) {
+      if (thread_id < 0 || thread_id >= pool->num_threads()) ++bad_thread_ids;
+      ++runs[index];
+    });
+    EXPECT_EQ(0, bad_thread_ids);
+    for (int i = 0; i < count; ++i) {
+      EXPECT_EQ(1, runs[i]) << "at index " << i;
+    }
+  }
+};
+
+TEST_F(ThreadPoolTest, Serial) {
+  ThreadPool pool(1);
+  EXPECT_EQ(1, pool.num_threads());
+  // Everything runs in order on the caller.
+  std::vector<int> order;
+  pool.ParallelFor(10, [&order](int index, int thread_id) {
+    EXPECT_EQ(0, thread_id);
+    order.push_back(index);
+  });
+  for (int i = 0; i < 10; ++i) EXPECT_EQ(i, order[i]);
+}
+
+TEST_F(ThreadPoolTest, AllTasksRunOnce) {
+  ThreadPool pool(4);
+  EXPECT_EQ(4, pool.num_threads());
+  RunAndCheck(&pool, 0);
+  RunAndCheck(&pool, 1);
+  RunAndCheck(&pool, 3);
+  RunAndCheck(&pool, 1000);
+}
+
+TEST_F(ThreadPoolTest, Reuse) {
+  // The same threads serve many calls in a row.
+  ThreadPool pool(3);
+  for (int i = 0; i < 200; ++i) RunAndCheck(&pool, i % 17);
+}
+
+}  // namespace tesseract
@@ -0,0 +1,153 @@
+#!/usr/bin/env python
+# Copyright (C) 2001-2023 Artifex Software, Inc.
+# All Rights Reserved.
+#
+# This software is provided AS-IS with no warranty, either express or
+# implied.
+#
+# This software is distributed under license and may not be copied,
+# modified or distributed except as expressly authorized under the terms
+# of the license contained in the file LICENSE in this distribution.
+#
+# Refer to licensing information at http://www.artifex.com or contact
+# Artifex Software, Inc.,  1305 Grant Avenue - Suite 200, Novato,
+# CA 94945, U.S.A., +1(415)492-9861, for further information.
+#
+#
+# FlateDecode throughput benchmark. Pulls the Flate compressed streams
+# (content streams, fonts, images, object streams...) out of a corpus of
+# PDF files, and times Ghostscript decoding all of them through the
+# FlateDecode filter, which is the same zlib decoding filter the PDF
+# interpreter uses. Only the decoding is timed, not startup, and the
+# best of a number of runs is reported, in megabytes of decoded data per
+# second.
+
+USAGE = """\
+Usage: python flate_bench.py [-r repeats] [-k] gs file.pdf... [-- gs options]
+  Runs gs (e.g. bin/gs) over the FlateDecode streams of the given PDF
+  files repeats times (default 5), and prints the best rate. -k keeps the
+  extracted streams in flate_bench.dat in the current directory."""
+
+import os
+import re
+import sys
+import tempfile
+import subprocess
+import zlib
+
+# A stream, with the dictionary before it. We don't parse the file, so
+# we go by the Length where it's a direct number, and otherwise look for
+# the endstream.
+STREAM = re.compile(rb"<<((?:[^<>]|<<(?:[^<>]|<<[^<>]*>>)*>>|<[^<>]*>)*)>>\s*stream\r?\n",
+                    re.S)
+LENGTH = re.compile(rb"/Length\s+(\d+)(?!\s+\d+\s+R)")
+FLATE = re.compile(rb"/Filter\s*(?:/FlateDecode|/Fl\b|\[\s*(?:/FlateDecode|/Fl)\s*\])")
+
+# Decode each stream, which follows its decoded size on a line of its
+# own (token reads the newline too), into a scratch string. Go through
+# the file as many times as it takes to get a measurable time, and print
+# the time taken and the number of bytes decoded.
+PS = b"""
+/buf 65536 string def
+/total 0 def
+/start usertime def
+{
+  /f (%s) (r) file def
+  {
+    f token not { exit } if pop
+    f /FlateDecode filter
+    { dup buf readstring exch length total add /total exch def not { exit } if } loop
+    closefile
+  } loop
+  f closefile
+  usertime start sub 500 ge { exit } if
+} loop
+usertime start sub =only ( ) print total =
+"""
+
+def extract(paths):
+    streams = []
+    for path in paths:
+        with open(path, "rb") as f:
+            data = f.read()
+        for m in STREAM.finditer(data):
+            if not FLATE.search(m.group(1)):
+                continue
+            start = m.end()
+            length = LENGTH.search(m.group(1))
+            end = -1
+            if length:
+                end = start + int(length.group(1))
+                if data[end:end + 30].lstrip()[:9] != b"endstream":
+                    end = -1
+            if end < 0:
+                end = data.find(b"endstream", start)
+                if end < 0:
+                    continue
+            raw = data[start:end]
+            try:
+                d = zlib.decompressobj()
+                size = len(d.decompress(raw))
+            except zlib.error:
+                continue
+            if d.eof and size > 0:
+                streams.append((raw, size))
+    return streams
+
+def main(argv):
+    repeats = 5
+    keep = False
+    while len(argv) > 1 and argv[1] in ("-r", "-k"):
+        if argv[1] == "-k":
+            keep = True
+            argv = argv[1:]
+            continue
+        if len(argv) < 3:
+            sys.exit(USAGE)
+        repeats = int(argv[2])
+        argv = argv[2:]
+    options = []
+    if "--" in argv:
+        options = argv[argv.index("--") + 1:]
+        argv = argv[:argv.index("--")]
+    if len(argv) < 3:
+        sys.exit(USAGE)
+    gs = argv[1]
+
+    streams = extract(argv[2:])
+    if not streams:
+        sys.exit("No FlateDecode streams found")
+    compressed = sum(len(raw) for raw, size in streams)
+    decoded = sum(size for raw, size in streams)
+
+    directory = "." if keep else tempfile.mkdtemp()
+    dat = os.path.join(directory, "flate_bench.dat")
+    ps = os.path.join(directory, "flate_bench.ps")
+    with open(dat, "wb") as f:
+        for raw, size in streams:
+            f.write(b"%d\n" % size)
+            f.write(raw)
+    with open(ps, "wb") as f:
+        f.write(PS % dat.replace("\\", "/").encode("latin-1"))
+
+    best = None
+    for i in range(repeats):
+        out = subprocess.check_output([gs, "-q", "-dNODISPLAY", "-dBATCH", "-dNOSAFER"] +
+                                      options + [ps])
+        ms, total = [int(n) for n in out.split()[-2:]]
+        if total % decoded != 0:
+            sys.exit("Decoded %d bytes, expected a multiple of %d" % (total, decoded))
+        rate = total / (ms / 1000.0) / 1e6
+        if best is None or rate > best:
+            best = rate
+
+    if not keep:
+        os.remove(dat)
+        os.remove(ps)
+        os.rmdir(directory)
+
+    print("%d streams, %d bytes compressed, %d decoded: %.1f MB/s"
+          % (len(streams), compressed, decoded, best))
+
+if __name__ == "__main__":
+    main(sys.argv)
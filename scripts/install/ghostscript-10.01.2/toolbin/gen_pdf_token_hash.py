@@ -0,0 +1,111 @@
+#!/usr/bin/env python
+# Copyright (C) 2001-2023 Artifex Software, Inc.
+# All Rights Reserved.
+#
+# This software is provided AS-IS with no warranty, either express or
+# implied.
+#
+# This software is distributed under license and may not be copied,
+# modified or distributed except as expressly authorized under the terms
+# of the license contained in the file LICENSE in this distribution.
+#
+# Refer to licensing information at http://www.artifex.com or contact
+# Artifex Software, Inc.,  1305 Grant Avenue - Suite 200, Novato,
+# CA 94945, U.S.A., +1(415)492-9861, for further information.
+#
+#
+# Script to generate pdf/pdf_token_hash.h, the perfect hash table which
+# pdf_int.c uses to map keywords to the tokens in pdf/pdf_tokens.h.
+# Rerun it whenever a token is added to pdf_tokens.h:
+#
+#   python toolbin/gen_pdf_token_hash.py > pdf/pdf_token_hash.h
+#
+# The hash of a keyword of length len, with bytes s[0]..s[len-1], is
+#
+#   k = s[0] | s[1] << 8 | s[len-1] << 16 | len << 24   (s[1] is 0 if len is 1)
+#   h = (uint32_t)(k * PDF_TOKEN_HASH_MULTIPLIER) >> (32 - PDF_TOKEN_HASH_BITS)
+#
+# and we search for a multiplier which gives every token its own slot.
+
+import os
+import random
+import re
+import sys
+
+tokens_h = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                        "..", "pdf", "pdf_tokens.h")
+
+license = """/* Copyright (C) 2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  1305 Grant Avenue - Suite 200, Novato,
+   CA 94945, U.S.A., +1(415)492-9861, for further information.
+*/
+"""
+
+def read_tokens(path):
+    """Returns (string, enum name) for each token, in order."""
+    tokens = []
+    for line in open(path):
+        m = re.match(r'PARAM1\((\w+)\)', line)
+        if m:
+            tokens.append((m.group(1), "TOKEN_" + m.group(1)))
+            continue
+        m = re.match(r'PARAM2\(("(?:[^"\\]|\\.)*"),\s*(\w+)\)', line)
+        if m:
+            tokens.append((eval(m.group(1)), "TOKEN_" + m.group(2)))
+    return tokens
+
+def key(s):
+    b = bytearray(s, "latin-1")
+    return b[0] | ((b[1] if len(b) > 1 else 0) << 8) | (b[-1] << 16) | (len(b) << 24)
+
+def slot(k, multiplier, bits):
+    return ((k * multiplier) & 0xffffffff) >> (32 - bits)
+
+def search(keys, bits, tries):
+    rand = random.Random(1)
+    for i in range(tries):
+        multiplier = rand.getrandbits(32) | 1
+        if len(set(slot(k, multiplier, bits) for k in keys)) == len(keys):
+            return multiplier
+    return None
+
+def main():
+    tokens = read_tokens(tokens_h)
+    # The first tokens are the errors, which have no strings.
+    real = [t for t in tokens if t[0] != ""]
+    keys = [key(s) for s, name in real]
+
+    for bits in (8, 9, 10):
+        multiplier = search(keys, bits, 1000000)
+        if multiplier is not None:
+            break
+    else:
+        sys.exit("No perfect hash found")
+
+    table = ["TOKEN_NOT_A_KEYWORD"] * (1 << bits)
+    for (s, name), k in zip(real, keys):
+        table[slot(k, multiplier, bits)] = name
+
+    out = sys.stdout
+    out.write(license)
+    out.write("\n/* Generated by toolbin/gen_pdf_token_hash.py from pdf_tokens.h, do not edit. */\n\n")
+    out.write("#ifndef PDF_TOKEN_HASH_H\n#define PDF_TOKEN_HASH_H\n\n")
+    out.write("#define PDF_TOKEN_HASH_MULTIPLIER 0x%08xU\n" % multiplier)
+    out.write("#define PDF_TOKEN_HASH_BITS %d\n\n" % bits)
+    out.write("static const unsigned char pdf_token_hash[%d] = {\n" % (1 << bits))
+    for i in range(0, len(table), 4):
+        out.write("    " + " ".join("%-20s" % (name + ",") for name in table[i:i + 4]).rstrip() + "\n")
+    out.write("};\n\n#endif\n")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,131 @@
+#!/usr/bin/env python
+# Copyright (C) 2001-2023 Artifex Software, Inc.
+# All Rights Reserved.
+#
+# This software is provided AS-IS with no warranty, either express or
+# implied.
+#
+# This software is distributed under license and may not be copied,
+# modified or distributed except as expressly authorized under the terms
+# of the license contained in the file LICENSE in this distribution.
+#
+# Refer to licensing information at http://www.artifex.com or contact
+# Artifex Software, Inc.,  1305 Grant Avenue - Suite 200, Novato,
+# CA 94945, U.S.A., +1(415)492-9861, for further information.
+#
+#
+# Content stream microbenchmark for the PDF interpreter. Writes a PDF
+# whose page is a long content stream of a typical mix of operators and
+# operands, runs it through Ghostscript to the nullpage device, and
+# reports the number of operators interpreted per second. The time for
+# an empty page is subtracted, so startup is not counted.
+
+USAGE = """\
+Usage: python pdf_ops_bench.py [-r repeats] [-n operators] [-k] gs [gs options]
+  Runs gs (e.g. bin/gs) on a generated content stream of the given number
+  of operators (default 1000000), repeats times (default 3), and prints
+  the best rate. -k keeps the generated files in the current directory."""
+
+import os
+import sys
+import tempfile
+import time
+import subprocess
+
+# Each entry is a run of operands and operators, and the number of
+# operators in it. Most operators go through the graphics library, so
+# they are kept cheap: tiny paths, and text with no glyphs drawn.
+SNIPPETS = [
+    ("q 1 0 0 1 0.5 0.25 cm 0 0 1 1 re f Q\n", 5),
+    ("0.2 0.4 0.6 rg 0.1 0.2 0.3 RG 0.5 w 0 j 1 J\n", 5),
+    ("10 10 m 11 10 l 11 11 12 12 13 10 c h n\n", 5),
+    ("BT /F1 1 Tf 0 Tr 3 Tr 100 100 Td 12 TL T* ET\n", 7),
+    ("0.5 g 0.25 G /GS1 gs 0 0 m 0 0 l S\n", 6),
+]
+
+def make_pdf(path, operators):
+    content = []
+    count = 0
+    while count < operators:
+        snippet, n = SNIPPETS[(count // 8) % len(SNIPPETS)]
+        content.append(snippet)
+        count += n
+    content = "".join(content).encode("latin-1")
+
+    objects = [
+        b"<< /Type /Catalog /Pages 2 0 R >>",
+        b"<< /Type /Pages /Kids [3 0 R] /Count 1 >>",
+        b"<< /Type /Page /Parent 2 0 R /MediaBox [0 0 200 200] /Contents 4 0 R"
+        b" /Resources << /Font << /F1 5 0 R >> /ExtGState << /GS1 6 0 R >> >> >>",
+        b"<< /Length %d >>\nstream\n" % len(content) + content + b"\nendstream",
+        b"<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>",
+        b"<< /Type /ExtGState /LW 1 >>",
+    ]
+    out = [b"%PDF-1.4\n"]
+    offsets = []
+    pos = len(out[0])
+    for i, obj in enumerate(objects):
+        data = b"%d 0 obj\n" % (i + 1) + obj + b"\nendobj\n"
+        offsets.append(pos)
+        out.append(data)
+        pos += len(data)
+    out.append(b"xref\n0 %d\n0000000000 65535 f \n" % (len(objects) + 1))
+    for offset in offsets:
+        out.append(b"%010d 00000 n \n" % offset)
+    out.append(b"trailer\n<< /Size %d /Root 1 0 R >>\nstartxref\n%d\n%%%%EOF\n"
+               % (len(objects) + 1, pos))
+    with open(path, "wb") as f:
+        f.write(b"".join(out))
+    return count
+
+def best_time(cmd, repeats):
+    best = None
+    for i in range(repeats):
+        start = time.time()
+        subprocess.check_call(cmd, stdout=subprocess.DEVNULL)
+        elapsed = time.time() - start
+        if best is None or elapsed < best:
+            best = elapsed
+    return best
+
+def main(argv):
+    repeats = 3
+    operators = 1000000
+    keep = False
+    while len(argv) > 1 and argv[1].startswith("-") and argv[1] in ("-r", "-n", "-k"):
+        if argv[1] == "-k":
+            keep = True
+            argv = argv[1:]
+            continue
+        if len(argv) < 3:
+            sys.exit(USAGE)
+        if argv[1] == "-r":
+            repeats = int(argv[2])
+        else:
+            operators = int(argv[2])
+        argv = argv[2:]
+    if len(argv) < 2:
+        sys.exit(USAGE)
+    gs = argv[1:]
+
+    directory = "." if keep else tempfile.mkdtemp()
+    empty = os.path.join(directory, "pdf_ops_bench_empty.pdf")
+    full = os.path.join(directory, "pdf_ops_bench.pdf")
+    make_pdf(empty, 0)
+    count = make_pdf(full, operators)
+
+    args = ["-q", "-dNOPAUSE", "-dBATCH", "-dNOSAFER", "-sDEVICE=nullpage"]
+    base = best_time(gs + args + [empty], repeats)
+    total = best_time(gs + args + [full], repeats)
+
+    if not keep:
+        os.remove(empty)
+        os.remove(full)
+        os.rmdir(directory)
+
+    elapsed = max(total - base, 1e-6)
+    print("%d operators in %.3fs (%.3fs startup): %.0f operators/s"
+          % (count, elapsed, base, count / elapsed))
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,106 @@
+#!/usr/bin/env python
+# Copyright (C) 2001-2023 Artifex Software, Inc.
+# All Rights Reserved.
+#
+# This software is provided AS-IS with no warranty, either express or
+# implied.
+#
+# This software is distributed under license and may not be copied,
+# modified or distributed except as expressly authorized under the terms
+# of the license contained in the file LICENSE in this distribution.
+#
+# Refer to licensing information at http://www.artifex.com or contact
+# Artifex Software, Inc.,  1305 Grant Avenue - Suite 200, Novato,
+# CA 94945, U.S.A., +1(415)492-9861, for further information.
+#
+#
+# Checks that the jobs of server mode (gs --server) can't affect the jobs
+# that follow them. Each hostile job below is followed by a job that looks
+# for anything it might have left behind, and every one of those must
+# find a clean interpreter.
+
+USAGE = """\
+Usage: python server_test.py gs
+  Runs gs (e.g. bin/gs) in server mode over a stream of jobs that try to
+  leave something behind for the next job, and fails if one does."""
+
+import os
+import re
+import sys
+import tempfile
+import subprocess
+
+# Run by a job after each hostile job: print whether anything is left.
+CHECK = b"""
+/dirty 0 def
+systemdict /FOO known { /dirty dirty 1 add def } if
+userdict /leftover known { /dirty dirty 1 add def } if
+/.serverjobdict where { pop /dirty dirty 1 add def } if
+/.beginserverjob where { pop /dirty dirty 1 add def } if
+/.endserverjob where { pop /dirty dirty 1 add def } if
+vmstatus pop pop /level exch def
+(CHECK ) print dirty 0 eq { (clean) } { (dirty) } ifelse print
+( level ) print level =
+flush
+"""
+
+# The hostile jobs, each run with -sFOO=bar so that there is a switch to
+# undo as well.
+HOSTILE = [
+    # Left over definitions, and a save without a restore.
+    b"/leftover 1 def save pop save pop userdict /leftover 2 put",
+    # The procedures and dictionary of server mode, by name.
+    b"{ [] .beginserverjob } stopped pop /leftover 1 def",
+    b"{ .endserverjob } stopped pop /leftover 1 def",
+    b"{ //systemdict /.serverjobdict get /end get exec } stopped pop"
+    b" /leftover 1 def",
+    # Quitting, and stopping, in the middle of the job.
+    b"/leftover 1 def quit",
+    b"/leftover 1 def stop",
+]
+
+def main(argv):
+    if len(argv) != 2:
+        print(USAGE)
+        return 2
+    gs = argv[1]
+    with tempfile.TemporaryDirectory() as tmp:
+        check = os.path.join(tmp, "check.ps")
+        with open(check, "wb") as f:
+            f.write(CHECK)
+        jobs = ["-sDEVICE=nullpage " + check]
+        for i, ps in enumerate(HOSTILE):
+            name = os.path.join(tmp, "hostile%d.ps" % i)
+            with open(name, "wb") as f:
+                f.write(ps + b"\n")
+            jobs.append("-sDEVICE=nullpage -sFOO=bar " + name)
+            jobs.append("-sDEVICE=nullpage " + check)
+        jobfile = os.path.join(tmp, "jobs")
+        with open(jobfile, "w") as f:
+            f.write("\n".join(jobs) + "\n")
+        out = subprocess.run([gs, "-q", "-dSAFER", "--server=" + jobfile],
+                             stdout=subprocess.PIPE, stderr=subprocess.STDOUT
+                             ).stdout.decode("latin-1")
+
+    checks = re.findall(r"CHECK (\w+) level (\d+)", out)
+    replies = re.findall(r"%%\[ Job: (\d+); Status: (\w+) \]%%", out)
+    failures = []
+    if len(replies) != len(jobs):
+        failures.append("%d jobs run, of %d" % (len(replies), len(jobs)))
+    if len(checks) != len(HOSTILE) + 1:
+        failures.append("%d checks run, of %d" % (len(checks), len(HOSTILE) + 1))
+    for i, (state, level) in enumerate(checks):
+        if state != "clean" or level != checks[0][1]:
+            failures.append("after %s: %s at save level %s" %
+                            ("start" if i == 0 else HOSTILE[i - 1].decode(),
+                             state, level))
+    if failures:
+        sys.stdout.write(out)
+        for f in failures:
+            print("FAILED: " + f)
+        return 1
+    print("%d jobs, all isolated" % len(jobs))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
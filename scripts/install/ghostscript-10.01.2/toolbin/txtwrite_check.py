@@ -0,0 +1,235 @@
+#!/usr/bin/env python
+# Copyright (C) 2001-2023 Artifex Software, Inc.
+# All Rights Reserved.
+#
+# This software is provided AS-IS with no warranty, either express or
+# implied.
+#
+# This software is distributed under license and may not be copied,
+# modified or distributed except as expressly authorized under the terms
+# of the license contained in the file LICENSE in this distribution.
+#
+# Refer to licensing information at http://www.artifex.com or contact
+# Artifex Software, Inc.,  1305 Grant Avenue - Suite 200, Novato,
+# CA 94945, U.S.A., +1(415)492-9861, for further information.
+#
+#
+# Regression check for the txtwrite device. The corpus in toolbin/txtwrite
+# is a set of generated PostScript pages of the kinds that are hard for
+# txtwrite to put back together: every glyph shown on its own, glyphs
+# jittered about the baseline and drawn out of order, and superscripts and
+# subscripts. Each page is run through txtwrite with each TextFormat from
+# 0 to 4, and the output is compared with the expected output kept next
+# to the page, as <page>.<format>.txt.
+
+USAGE = """\
+Usage: python txtwrite_check.py [-g] [-u] gs [gs options]
+  Runs gs (e.g. bin/gs) with the txtwrite device on each page of the
+  corpus, for each TextFormat from 0 to 4, and reports any output that
+  differs from the expected output. -g regenerates the corpus pages, and
+  -u rewrites the expected output instead of comparing with it."""
+
+import os
+import sys
+import tempfile
+import subprocess
+
+CORPUS = os.path.join(os.path.dirname(os.path.abspath(__file__)), "txtwrite")
+FORMATS = range(5)
+
+WORDS = ("the of and to in is that for it as was with be by on not he this"
+         " are or his from at which but have an they you were her she there"
+         " would their we him been has when who will more no if out so said"
+         " what up its about into than them can only other new some could"
+         " time these two may then do first any my now such like our over man"
+         " me even most made after also did many before must through back"
+         " years where much your way well down should because each just those"
+         " people how too little state good very make world still own see men"
+         " work long get here between both life being under never day same"
+         " another know while last might us great old year off come since"
+         " against go came right used take three").split()
+
+class Random:
+    """A small LCG, so the corpus is the same wherever it is generated."""
+    def __init__(self, seed):
+        self.state = seed
+    def next(self):
+        self.state = (self.state * 1103515245 + 12345) & 0x7fffffff
+        return self.state >> 8
+    def uniform(self, lo, hi):
+        return lo + (hi - lo) * (self.next() % 10001) / 10000.0
+
+def make_lines(rand, count, width):
+    lines = []
+    for i in range(count):
+        line = []
+        length = 0
+        while True:
+            word = WORDS[rand.next() % len(WORDS)]
+            if length + len(word) + 1 > width:
+                break
+            line.append(word)
+            length += len(word) + 1
+        if i % 7 == 0:
+            line[0] = line[0].capitalize()
+        if i % 5 == 4:
+            line[-1] += rand.next() % 2 and "." or ","
+        lines.append(line)
+    return lines
+
+# Shows one glyph at a time: "x y at" sets the pen, "(c) dx dy g" shows c
+# offset by dx dy from the pen and advances it by the width of c, and "s"
+# advances it by the width of a space, without showing anything.
+PROLOG = """\
+%%!PS
+%% txtwrite regression page: %s
+%% Generated by toolbin/txtwrite_check.py -g
+/penx 0 def /peny 0 def
+/at { /peny exch def /penx exch def } bind def
+/g {
+  peny add exch penx add exch moveto
+  dup show stringwidth pop penx add /penx exch def
+} bind def
+/s { ( ) stringwidth pop penx add /penx exch def } bind def
+/big { /Times-Roman findfont 10 scalefont setfont } bind def
+/small { /Times-Roman findfont 6 scalefont setfont } bind def
+big
+"""
+
+def glyphs(word, jitter=None):
+    out = []
+    for c in word:
+        dx, dy = jitter() if jitter else (0, 0)
+        out.append("(%s) %g %g g" % (c, round(dx, 2), round(dy, 2)))
+    return " ".join(out)
+
+def column_origins(count):
+    """The pen positions of count lines set in two columns."""
+    per_column = (count + 1) // 2
+    return [(54 + 256 * (i // per_column), 740 - 12 * (i % per_column))
+            for i in range(count)]
+
+def per_glyph_page(rand):
+    lines = make_lines(rand, 30, 40)
+    out = [PROLOG % "every glyph shown on its own, in two columns"]
+    for (x, y), line in zip(column_origins(len(lines)), lines):
+        out.append("%d %d at %s" % (x, y, " s ".join(glyphs(w) for w in line)))
+    out.append("showpage\n")
+    return "\n".join(out)
+
+def jitter_page(rand):
+    lines = make_lines(rand, 30, 40)
+    jitter = lambda: (rand.uniform(-0.1, 0.1), rand.uniform(-0.05, 0.05))
+    drawn = []
+    for (x, y), line in zip(column_origins(len(lines)), lines):
+        # Some lines are drawn as two halves, which are drawn separately.
+        half = len(line) // 2 if rand.next() % 3 == 0 else len(line)
+        drawn.append("%d %d at %s" % (x, y, " s ".join(
+            glyphs(w, jitter) for w in line[:half])))
+        if half < len(line):
+            drawn.append("(%s) stringwidth pop %d add %d at s %s"
+                         % (" ".join(line[:half]), x, y,
+                            " s ".join(glyphs(w, jitter) for w in line[half:])))
+    # Draw the page in a shuffled order, so nothing comes sorted.
+    for i in range(len(drawn) - 1, 0, -1):
+        j = rand.next() % (i + 1)
+        drawn[i], drawn[j] = drawn[j], drawn[i]
+    out = [PROLOG % "jittered glyphs, with the lines drawn out of order"]
+    out.extend(drawn)
+    out.append("showpage\n")
+    return "\n".join(out)
+
+def superscript_page(rand):
+    lines = make_lines(rand, 24, 40)
+    out = [PROLOG % "superscripts and subscripts, in two columns"]
+    for n, ((x, y), line) in enumerate(zip(column_origins(len(lines)), lines)):
+        words = []
+        for i, word in enumerate(line):
+            text = glyphs(word)
+            if (n + i) % 9 == 3:
+                text += " small (%d) 0 4 g big" % (rand.next() % 20 + 1)
+            elif (n + i) % 13 == 5:
+                text += " small (%d) 0 -2 g big" % (rand.next() % 4 + 1)
+            words.append(text)
+        out.append("%d %d at %s" % (x, y, " s ".join(words)))
+    out.append("showpage\n")
+    return "\n".join(out)
+
+PAGES = [
+    ("per_glyph", per_glyph_page),
+    ("jitter", jitter_page),
+    ("superscript", superscript_page),
+]
+
+def generate():
+    for seed, (name, page) in enumerate(PAGES):
+        with open(os.path.join(CORPUS, name + ".ps"), "w") as f:
+            f.write(page(Random(seed + 1)))
+
+def normalize(data, text_format):
+    # TextFormat 2 is UTF-16 in the byte order of the machine it ran on,
+    # with a BOM, so compare the text it holds.
+    if text_format == 2:
+        return data.decode("utf-16")
+    return data
+
+def main(argv):
+    regenerate = False
+    update = False
+    while len(argv) > 1 and argv[1] in ("-g", "-u"):
+        if argv[1] == "-g":
+            regenerate = True
+        else:
+            update = True
+        argv = argv[1:]
+    if len(argv) < 2:
+        sys.exit(USAGE)
+    gs = argv[1:]
+
+    if regenerate:
+        generate()
+
+    directory = tempfile.mkdtemp()
+    output = os.path.join(directory, "txtwrite.txt")
+    failures = 0
+    for name, page in PAGES:
+        source = os.path.join(CORPUS, name + ".ps")
+        for text_format in FORMATS:
+            expected_file = os.path.join(CORPUS,
+                                         "%s.%d.txt" % (name, text_format))
+            subprocess.check_call(gs + ["-q", "-dNOPAUSE", "-dBATCH",
+                                        "-sDEVICE=txtwrite",
+                                        "-dTextFormat=%d" % text_format,
+                                        "-o", output, source])
+            with open(output, "rb") as f:
+                actual = f.read()
+            if update:
+                with open(expected_file, "wb") as f:
+                    f.write(actual)
+                continue
+            try:
+                with open(expected_file, "rb") as f:
+                    expected = f.read()
+            except IOError:
+                print("%s: missing" % expected_file)
+                failures += 1
+                continue
+            if (normalize(actual, text_format) !=
+                    normalize(expected, text_format)):
+                print("%s TextFormat=%d: differs from %s"
+                      % (name, text_format, expected_file))
+                failures += 1
+    if os.path.exists(output):
+        os.remove(output)
+    os.rmdir(directory)
+
+    if update:
+        print("Updated the expected output of %d pages" % len(PAGES))
+    elif failures:
+        print("%d of %d outputs differ" % (failures, len(PAGES) * len(FORMATS)))
+        sys.exit(1)
+    else:
+        print("All %d outputs match" % (len(PAGES) * len(FORMATS)))
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -59,6 +59,55 @@ local uLong adler32_combine_ OF((uLong adler1, uLong adler2, z_off64_t len2));
 #  define MOD63(a) a %= BASE
 #endif
 
+#ifdef HAVE_SSE2
+/* Ghostscript: sum 16 byte blocks with SSE2. For each block, adler gains
+   the sum of the bytes, and sum2 gains 16 times adler before the block,
+   plus the bytes weighted 16 down to 1. The sums of the bytes are kept in
+   vs1, the running total of vs1 before each block in vps, and the weighted
+   sums in vs2, all in 32 bit lanes, which hold for up to NMAX / 16 blocks
+   by the same argument as for NMAX. */
+#include <emmintrin.h>
+
+local void adler32_sse2 OF((unsigned long *adler, unsigned long *sum2,
+                            const Bytef *buf, unsigned n));
+
+local void adler32_sse2(adler, sum2, buf, n)
+    unsigned long *adler;
+    unsigned long *sum2;
+    const Bytef *buf;
+    unsigned n;
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wlo = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9);
+    const __m128i whi = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+    __m128i vs1 = zero, vs2 = zero, vps = zero;
+    unsigned long a = *adler;
+    unsigned blocks = n;
+
+    do {
+        __m128i v = _mm_loadu_si128((const __m128i *)buf);
+
+        vps = _mm_add_epi32(vps, vs1);
+        vs1 = _mm_add_epi32(vs1, _mm_sad_epu8(v, zero));
+        vs2 = _mm_add_epi32(vs2,
+                  _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), wlo));
+        vs2 = _mm_add_epi32(vs2,
+                  _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), whi));
+        buf += 16;
+    } while (--n);
+
+    /* add up the lanes */
+    vs1 = _mm_add_epi32(vs1, _mm_shuffle_epi32(vs1, _MM_SHUFFLE(1, 0, 3, 2)));
+    vps = _mm_add_epi32(vps, _mm_shuffle_epi32(vps, _MM_SHUFFLE(1, 0, 3, 2)));
+    vs2 = _mm_add_epi32(vs2, _mm_shuffle_epi32(vs2, _MM_SHUFFLE(1, 0, 3, 2)));
+    vs2 = _mm_add_epi32(vs2, _mm_shuffle_epi32(vs2, _MM_SHUFFLE(2, 3, 0, 1)));
+    *adler = a + (unsigned long)(unsigned)_mm_cvtsi128_si32(vs1);
+    *sum2 += ((unsigned long)blocks * a << 4) +
+             ((unsigned long)(unsigned)_mm_cvtsi128_si32(vps) << 4) +
+             (unsigned long)(unsigned)_mm_cvtsi128_si32(vs2);
+}
+#endif
+
 /* ========================================================================= */
 uLong ZEXPORT adler32_z(adler, buf, len)
     uLong adler;
@@ -103,21 +152,35 @@ uLong ZEXPORT adler32_z(adler, buf, len)
     while (len >= NMAX) {
         len -= NMAX;
         n = NMAX / 16;          /* NMAX is divisible by 16 */
+#ifdef HAVE_SSE2
+        adler32_sse2(&adler, &sum2, buf, n);
+        buf += NMAX;
+#else
         do {
             DO16(buf);          /* 16 sums unrolled */
             buf += 16;
         } while (--n);
+#endif
         MOD(adler);
         MOD(sum2);
     }
 
     /* do remaining bytes (less than NMAX, still just one modulo) */
     if (len) {                  /* avoid modulos if none remaining */
+#ifdef HAVE_SSE2
+        if (len >= 16) {
+            n = (unsigned)(len >> 4);
+            adler32_sse2(&adler, &sum2, buf, n);
+            buf += (z_size_t)n << 4;
+            len &= 15;
+        }
+#else
         while (len >= 16) {
             len -= 16;
             DO16(buf);
             buf += 16;
         }
+#endif
         while (len--) {
             adler += *buf++;
             sum2 += adler;
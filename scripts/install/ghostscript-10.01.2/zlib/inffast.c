@@ -12,6 +12,13 @@
 #  pragma message("Assembler code may have bugs -- use at your own risk")
 #else
 
+/* Ghostscript: we build with -fno-builtin, so ask for an inline copy */
+#if defined(__GNUC__)
+#  define COPY8(d, s) __builtin_memcpy(d, s, 8)
+#else
+#  define COPY8(d, s) zmemcpy(d, s, 8)
+#endif
+
 /*
    Decode literal, length, and distance codes and write out the resulting
    literal and match bytes until either not enough input or output is
@@ -248,6 +255,28 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
                             *out++ = *from++;
                     }
                 }
+#ifdef HAVE_MEMCPY
+                else if (dist == 1) {
+                    /* Ghostscript: a run of one byte, common in images */
+                    memset(out, out[-1], len);
+                    out += len;
+                }
+#endif
+                else if (dist >= 8 && len + 8 <= (unsigned)(end - out) + 257) {
+                    /* Ghostscript: copy eight bytes at a time, which may run
+                       up to seven bytes past the match, but not past the end
+                       of the output (end is 257 bytes short of it). The
+                       source is at least eight bytes back, so each copy
+                       only reads bytes that are already written. */
+                    from = out - dist;
+                    op = (len + 7) >> 3;
+                    do {
+                        COPY8(out, from);
+                        out += 8;
+                        from += 8;
+                    } while (--op);
+                    out -= (0U - len) & 7;
+                }
                 else {
                     from = out - dist;          /* copy direct from output */
                     do {                        /* minimum length is three */